@@ -0,0 +1,171 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+struct AllocatorStatistics
+{
+	size_t bytesReserved = 0;
+	size_t bytesUsed = 0;
+	size_t largestFreeBlock = 0;
+	size_t nrOfHeapChunks = 0;
+	size_t nrOfAllocations = 0;
+	size_t nrOfFreeBlocks = 0;
+	size_t totalAllocations = 0; // Counted since creation, clears do not reset it
+	size_t totalDeallocations = 0;
+	size_t bytesUsedHighWaterMark = 0;
+
+	// Set by allocators that are reset every frame, the counters and the high
+	// water mark then only cover the time since the last reset
+	bool countersSinceReset = false;
+
+	// Meant for statistics of the same kind. The high water marks are summed,
+	// which gives the sum of the individual peaks and not the combined peak
+	void Accumulate(const AllocatorStatistics& other)
+	{
+		bytesReserved += other.bytesReserved;
+		bytesUsed += other.bytesUsed;
+		largestFreeBlock = std::max(largestFreeBlock, other.largestFreeBlock);
+		nrOfHeapChunks += other.nrOfHeapChunks;
+		nrOfAllocations += other.nrOfAllocations;
+		nrOfFreeBlocks += other.nrOfFreeBlocks;
+		totalAllocations += other.totalAllocations;
+		totalDeallocations += other.totalDeallocations;
+		bytesUsedHighWaterMark += other.bytesUsedHighWaterMark;
+		countersSinceReset = countersSinceReset || other.countersSinceReset;
+	}
+
+	// 0 when all free memory is one block, approaching 1 as it is split up
+	double GetFragmentation() const
+	{
+		size_t bytesFree = bytesReserved - bytesUsed;
+
+		if (bytesFree == 0)
+			return 0.0;
+
+		return 1.0 - static_cast<double>(largestFreeBlock) / bytesFree;
+	}
+};
+
+// Adds the usage of a heap of heapSize bytes given the start and size of each
+// allocation in it, for allocators that do not track their free blocks
+inline void AccumulateAllocatedRanges(
+	std::vector<std::pair<size_t, size_t>>& ranges, size_t heapSize,
+	AllocatorStatistics& statistics)
+{
+	std::sort(ranges.begin(), ranges.end());
+	size_t freeStart = 0;
+
+	for (const auto& [start, size] : ranges)
+	{
+		if (start > freeStart)
+		{
+			statistics.largestFreeBlock = std::max(statistics.largestFreeBlock,
+				start - freeStart);
+			++statistics.nrOfFreeBlocks;
+		}
+
+		statistics.bytesUsed += size;
+		freeStart = std::max(freeStart, start + size);
+	}
+
+	if (heapSize > freeStart)
+	{
+		statistics.largestFreeBlock = std::max(statistics.largestFreeBlock,
+			heapSize - freeStart);
+		++statistics.nrOfFreeBlocks;
+	}
+
+	statistics.bytesReserved += heapSize;
+	statistics.nrOfAllocations += ranges.size();
+	++statistics.nrOfHeapChunks;
+}
+
+// Keeps the peaks of statistics that are sampled once per frame, which is
+// needed for allocators that are reset every frame and keep no history.
+// Such allocators should be sampled right before they are reset.
+class AllocatorStatisticsTracker
+{
+private:
+	AllocatorStatistics latest;
+	size_t peakBytesReserved = 0;
+	size_t peakBytesUsed = 0;
+	size_t peakNrOfAllocations = 0;
+	size_t totalAllocations = 0;
+	size_t totalDeallocations = 0;
+	size_t nrOfSamples = 0;
+
+public:
+	AllocatorStatisticsTracker() = default;
+	~AllocatorStatisticsTracker() = default;
+	AllocatorStatisticsTracker(const AllocatorStatisticsTracker& other) = default;
+	AllocatorStatisticsTracker& operator=(const AllocatorStatisticsTracker& other) = default;
+	AllocatorStatisticsTracker(AllocatorStatisticsTracker&& other) noexcept = default;
+	AllocatorStatisticsTracker& operator=(AllocatorStatisticsTracker&& other) noexcept = default;
+
+	void Sample(const AllocatorStatistics& statistics)
+	{
+		peakBytesReserved = std::max(peakBytesReserved, statistics.bytesReserved);
+		peakBytesUsed = std::max(peakBytesUsed,
+			std::max(statistics.bytesUsed, statistics.bytesUsedHighWaterMark));
+		peakNrOfAllocations = std::max(peakNrOfAllocations,
+			statistics.nrOfAllocations);
+
+		if (statistics.countersSinceReset)
+		{
+			// Everything allocated before the previous sample was freed by the reset
+			totalDeallocations += nrOfSamples != 0 ? latest.nrOfAllocations : 0;
+			totalAllocations += statistics.totalAllocations;
+			totalDeallocations += statistics.totalDeallocations;
+		}
+		else
+		{
+			totalAllocations = statistics.totalAllocations;
+			totalDeallocations = statistics.totalDeallocations;
+		}
+
+		latest = statistics;
+		++nrOfSamples;
+	}
+
+	const AllocatorStatistics& GetLatest() const
+	{
+		return latest;
+	}
+
+	size_t GetPeakBytesReserved() const
+	{
+		return peakBytesReserved;
+	}
+
+	size_t GetPeakBytesUsed() const
+	{
+		return peakBytesUsed;
+	}
+
+	size_t GetPeakNrOfAllocations() const
+	{
+		return peakNrOfAllocations;
+	}
+
+	size_t GetTotalAllocations() const
+	{
+		return totalAllocations;
+	}
+
+	size_t GetTotalDeallocations() const
+	{
+		return totalDeallocations;
+	}
+
+	size_t GetNrOfSamples() const
+	{
+		return nrOfSamples;
+	}
+
+	void Reset()
+	{
+		*this = AllocatorStatisticsTracker();
+	}
+};
\ No newline at end of file
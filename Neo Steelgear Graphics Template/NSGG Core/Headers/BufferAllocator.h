@@ -9,6 +9,8 @@
 #include "D3DPtr.h"
 #include "HeapHelper.h"
 #include "ResourceUploader.h"
+#include "AllocatorStatistics.h"
+#include "CompactionPlanner.h"
 
 struct BufferInfo
 {
@@ -76,6 +78,66 @@ public:
 	size_t GetElementSize();
 	size_t GetElementAlignment();
 	D3D12_RESOURCE_STATES GetCurrentState();
+	AllocatorStatistics GetStatistics() const;
+
+	// Adds every memory chunk as a heap, in order, so the heap indices of the
+	// plan are the heap chunk indices of the identifiers
+	void AddToCompactionPlan(CompactionPlanner<ResourceIdentifier>& planner) const;
 
 	void UpdateMappedBuffer(const ResourceIdentifier& identifier, void* data); // Map/Unmap method
-};
\ No newline at end of file
+};
+
+inline AllocatorStatistics BufferAllocator::GetStatistics() const
+{
+	// The counters are left for AllocatorStatisticsTracker to derive from
+	// samples
+	AllocatorStatistics toReturn;
+	std::vector<std::pair<size_t, size_t>> ranges;
+
+	for (const MemoryChunk& memoryChunk : memoryChunks)
+	{
+		ranges.clear();
+
+		for (size_t i = 0; i < memoryChunk.buffers.GetCurrentMaxIndex(); ++i)
+		{
+			if (memoryChunk.buffers.ChunkActive(i))
+			{
+				ranges.push_back({ memoryChunk.buffers.GetStartOfChunk(i),
+					memoryChunk.buffers.GetSizeOfChunk(i) });
+			}
+		}
+
+		AccumulateAllocatedRanges(ranges, memoryChunk.buffers.TotalSize(), toReturn);
+	}
+
+	return toReturn;
+}
+
+inline void BufferAllocator::AddToCompactionPlan(
+	CompactionPlanner<ResourceIdentifier>& planner) const
+{
+	std::vector<CompactionPlanner<ResourceIdentifier>::Allocation> allocations;
+
+	for (size_t chunkIndex = 0; chunkIndex < memoryChunks.size(); ++chunkIndex)
+	{
+		const MemoryChunk& memoryChunk = memoryChunks[chunkIndex];
+		allocations.clear();
+
+		for (size_t i = 0; i < memoryChunk.buffers.GetCurrentMaxIndex(); ++i)
+		{
+			if (memoryChunk.buffers.ChunkActive(i))
+			{
+				CompactionPlanner<ResourceIdentifier>::Allocation allocation;
+				allocation.identifier.heapChunkIndex = chunkIndex;
+				allocation.identifier.internalIndex = i;
+				allocation.startOffset = memoryChunk.buffers.GetStartOfChunk(i);
+				allocation.size = memoryChunk.buffers[i].nrOfElements *
+					bufferInfo.elementSize;
+				allocation.alignment = bufferInfo.alignment;
+				allocations.push_back(allocation);
+			}
+		}
+
+		planner.AddHeap(memoryChunk.buffers.TotalSize(), allocations);
+	}
+}
\ No newline at end of file
@@ -132,6 +132,11 @@ public:
 
 	void RemoveComponent(const ResourceIndex& indexToRemove);
 
+	// Plans moving buffers out of lightly used memory chunks, the moves refer
+	// to buffers by the allocator identifiers of their resource indices
+	void AddToCompactionPlan(CompactionPlanner<ResourceIdentifier>& planner) const;
+	AllocatorStatistics GetStatistics() const;
+
 	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapCBV() const override;
 	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapSRV() const override;
 	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapUAV() const override;
@@ -149,4 +154,15 @@ public:
 		std::optional<D3D12_RESOURCE_STATES> assumedInitialState = std::nullopt);
 
 	void UpdateMappedBuffer(const ResourceIndex& resourceIndex, void* data);
-};
\ No newline at end of file
+};
+
+inline void BufferComponent::AddToCompactionPlan(
+	CompactionPlanner<ResourceIdentifier>& planner) const
+{
+	bufferAllocator.AddToCompactionPlan(planner);
+}
+
+inline AllocatorStatistics BufferComponent::GetStatistics() const
+{
+	return bufferAllocator.GetStatistics();
+}
\ No newline at end of file
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+// Plans how to empty lightly used heaps by moving their allocations into the
+// free space of other heaps. A heap is only evacuated if all of its allocations
+// can be placed elsewhere, so every planned move helps release a heap. The
+// owner performs the copies and must reserve the destination ranges when the
+// plan is made, as later allocations could otherwise take them.
+template<typename Identifier>
+class CompactionPlanner
+{
+public:
+	struct Allocation
+	{
+		Identifier identifier = Identifier();
+		size_t startOffset = 0;
+		size_t size = 0;
+		size_t alignment = 1;
+	};
+
+	// Describes both the copy to perform and how the identifier is remapped
+	struct Move
+	{
+		Identifier identifier = Identifier();
+		size_t sourceHeap = size_t(-1);
+		size_t sourceOffset = 0;
+		size_t destinationHeap = size_t(-1);
+		size_t destinationOffset = 0;
+		size_t size = 0;
+	};
+
+private:
+	struct Gap
+	{
+		size_t startOffset = 0;
+		size_t size = 0;
+	};
+
+	struct Heap
+	{
+		size_t heapSize = 0;
+		size_t liveBytes = 0;
+		std::vector<Allocation> allocations;
+		std::vector<Gap> gaps;
+		bool evacuated = false;
+		bool receivesMoves = false;
+		size_t endOfMoves = 0; // Moves before this index empty the heap
+	};
+
+	std::vector<Heap> heaps;
+	std::vector<Move> moves;
+	std::vector<size_t> evacuatedHeaps;
+	size_t nextMove = 0;
+
+	size_t Align(size_t number, size_t alignment) const;
+	void CalculateGaps(Heap& heap) const;
+	bool PlaceAllocation(const Allocation& allocation, size_t sourceHeap,
+		std::vector<std::vector<Gap>>& gaps, Move& move) const;
+	bool TryEvacuate(size_t heapIndex);
+
+public:
+	CompactionPlanner() = default;
+	~CompactionPlanner() = default;
+	CompactionPlanner(const CompactionPlanner& other) = default;
+	CompactionPlanner& operator=(const CompactionPlanner& other) = default;
+	CompactionPlanner(CompactionPlanner&& other) noexcept = default;
+	CompactionPlanner& operator=(CompactionPlanner&& other) noexcept = default;
+
+	size_t AddHeap(size_t heapSize, const std::vector<Allocation>& allocations);
+	void Plan();
+
+	// Returns moves in plan order until the byte budget is spent, at least
+	// one move is returned as long as any remain so progress is guaranteed
+	size_t GetNextMoves(size_t byteBudget, std::vector<Move>& toAddTo);
+	bool Finished() const;
+	bool HeapReleasable(size_t heapIndex) const;
+
+	const std::vector<Move>& GetMoves() const;
+	const std::vector<size_t>& GetEvacuatedHeaps() const;
+	size_t GetBytesToMove() const;
+
+	void Clear();
+};
+
+template<typename Identifier>
+inline size_t CompactionPlanner<Identifier>::Align(size_t number,
+	size_t alignment) const
+{
+	if ((0 == alignment) || (alignment & (alignment - 1)))
+	{
+		throw std::runtime_error("Error: non-pow2 alignment");
+	}
+
+	return ((number + (alignment - 1)) & ~(alignment - 1));
+}
+
+template<typename Identifier>
+inline void CompactionPlanner<Identifier>::CalculateGaps(Heap& heap) const
+{
+	std::vector<const Allocation*> sorted;
+	sorted.reserve(heap.allocations.size());
+
+	for (const Allocation& allocation : heap.allocations)
+		sorted.push_back(&allocation);
+
+	std::sort(sorted.begin(), sorted.end(),
+		[](const Allocation* lhs, const Allocation* rhs)
+		{
+			return lhs->startOffset < rhs->startOffset;
+		});
+
+	size_t currentOffset = 0;
+	for (const Allocation* allocation : sorted)
+	{
+		if (allocation->startOffset < currentOffset ||
+			allocation->size > heap.heapSize - allocation->startOffset)
+		{
+			throw std::runtime_error("Error: Overlapping or out of bounds allocation in compaction planner");
+		}
+
+		if (allocation->startOffset != currentOffset)
+			heap.gaps.push_back({ currentOffset, allocation->startOffset - currentOffset });
+
+		currentOffset = allocation->startOffset + allocation->size;
+	}
+
+	if (currentOffset != heap.heapSize)
+		heap.gaps.push_back({ currentOffset, heap.heapSize - currentOffset });
+}
+
+template<typename Identifier>
+inline bool CompactionPlanner<Identifier>::PlaceAllocation(
+	const Allocation& allocation, size_t sourceHeap,
+	std::vector<std::vector<Gap>>& gaps, Move& move) const
+{
+	// Best fit over the gaps of every heap that is allowed to receive data
+	size_t bestHeap = size_t(-1);
+	size_t bestGap = size_t(-1);
+	size_t bestGapSize = size_t(-1);
+
+	for (size_t heapIndex = 0; heapIndex < heaps.size(); ++heapIndex)
+	{
+		if (heapIndex == sourceHeap || heaps[heapIndex].evacuated)
+			continue;
+
+		for (size_t gapIndex = 0; gapIndex < gaps[heapIndex].size(); ++gapIndex)
+		{
+			const Gap& gap = gaps[heapIndex][gapIndex];
+			size_t padding = Align(gap.startOffset, allocation.alignment) -
+				gap.startOffset;
+
+			if (padding < gap.size && gap.size - padding >= allocation.size &&
+				gap.size < bestGapSize)
+			{
+				bestHeap = heapIndex;
+				bestGap = gapIndex;
+				bestGapSize = gap.size;
+			}
+		}
+	}
+
+	if (bestHeap == size_t(-1))
+		return false;
+
+	std::vector<Gap>& heapGaps = gaps[bestHeap];
+	Gap gap = heapGaps[bestGap];
+	size_t alignedOffset = Align(gap.startOffset, allocation.alignment);
+	size_t endOffset = alignedOffset + allocation.size;
+	heapGaps.erase(heapGaps.begin() + bestGap);
+
+	if (alignedOffset != gap.startOffset)
+		heapGaps.push_back({ gap.startOffset, alignedOffset - gap.startOffset });
+
+	if (endOffset != gap.startOffset + gap.size)
+		heapGaps.push_back({ endOffset, gap.startOffset + gap.size - endOffset });
+
+	move.identifier = allocation.identifier;
+	move.sourceHeap = sourceHeap;
+	move.sourceOffset = allocation.startOffset;
+	move.destinationHeap = bestHeap;
+	move.destinationOffset = alignedOffset;
+	move.size = allocation.size;
+
+	return true;
+}
+
+template<typename Identifier>
+inline bool CompactionPlanner<Identifier>::TryEvacuate(size_t heapIndex)
+{
+	// Placement is done on a copy of the gaps so a failed attempt is discarded
+	std::vector<std::vector<Gap>> gaps;
+	gaps.reserve(heaps.size());
+
+	for (const Heap& heap : heaps)
+		gaps.push_back(heap.gaps);
+
+	std::vector<const Allocation*> sorted;
+	for (const Allocation& allocation : heaps[heapIndex].allocations)
+		sorted.push_back(&allocation);
+
+	std::sort(sorted.begin(), sorted.end(),
+		[](const Allocation* lhs, const Allocation* rhs)
+		{
+			return lhs->size > rhs->size;
+		});
+
+	std::vector<Move> plannedMoves(sorted.size());
+	for (size_t i = 0; i < sorted.size(); ++i)
+	{
+		if (!PlaceAllocation(*sorted[i], heapIndex, gaps, plannedMoves[i]))
+			return false;
+	}
+
+	for (const Move& move : plannedMoves)
+	{
+		heaps[move.destinationHeap].receivesMoves = true;
+		moves.push_back(move);
+	}
+
+	for (size_t i = 0; i < heaps.size(); ++i)
+		heaps[i].gaps = std::move(gaps[i]);
+
+	heaps[heapIndex].evacuated = true;
+	heaps[heapIndex].endOfMoves = moves.size();
+	evacuatedHeaps.push_back(heapIndex);
+
+	return true;
+}
+
+template<typename Identifier>
+inline size_t CompactionPlanner<Identifier>::AddHeap(size_t heapSize,
+	const std::vector<Allocation>& allocations)
+{
+	Heap toAdd;
+	toAdd.heapSize = heapSize;
+	toAdd.allocations = allocations;
+
+	for (const Allocation& allocation : allocations)
+		toAdd.liveBytes += allocation.size;
+
+	CalculateGaps(toAdd);
+	heaps.push_back(std::move(toAdd));
+
+	return heaps.size() - 1;
+}
+
+template<typename Identifier>
+inline void CompactionPlanner<Identifier>::Plan()
+{
+	// The heaps with the least live data are the cheapest to empty
+	std::vector<size_t> candidates(heaps.size());
+	std::iota(candidates.begin(), candidates.end(), size_t(0));
+	std::stable_sort(candidates.begin(), candidates.end(),
+		[this](size_t lhs, size_t rhs)
+		{
+			return heaps[lhs].liveBytes < heaps[rhs].liveBytes;
+		});
+
+	for (size_t heapIndex : candidates)
+	{
+		Heap& heap = heaps[heapIndex];
+
+		if (heap.evacuated || heap.receivesMoves)
+			continue;
+
+		if (heap.allocations.empty())
+		{
+			heap.evacuated = true;
+			heap.endOfMoves = 0;
+			evacuatedHeaps.push_back(heapIndex);
+			continue;
+		}
+
+		TryEvacuate(heapIndex);
+	}
+}
+
+template<typename Identifier>
+inline size_t CompactionPlanner<Identifier>::GetNextMoves(size_t byteBudget,
+	std::vector<Move>& toAddTo)
+{
+	size_t bytesIssued = 0;
+	size_t movesIssued = 0;
+
+	while (nextMove < moves.size() && (movesIssued == 0 ||
+		moves[nextMove].size <= byteBudget - bytesIssued))
+	{
+		bytesIssued += moves[nextMove].size;
+		toAddTo.push_back(moves[nextMove++]);
+		++movesIssued;
+
+		if (bytesIssued >= byteBudget)
+			break;
+	}
+
+	return bytesIssued;
+}
+
+template<typename Identifier>
+inline bool CompactionPlanner<Identifier>::Finished() const
+{
+	return nextMove == moves.size();
+}
+
+template<typename Identifier>
+inline bool CompactionPlanner<Identifier>::HeapReleasable(size_t heapIndex) const
+{
+	return heaps[heapIndex].evacuated && heaps[heapIndex].endOfMoves <= nextMove;
+}
+
+template<typename Identifier>
+inline const std::vector<typename CompactionPlanner<Identifier>::Move>&
+CompactionPlanner<Identifier>::GetMoves() const
+{
+	return moves;
+}
+
+template<typename Identifier>
+inline const std::vector<size_t>&
+CompactionPlanner<Identifier>::GetEvacuatedHeaps() const
+{
+	return evacuatedHeaps;
+}
+
+template<typename Identifier>
+inline size_t CompactionPlanner<Identifier>::GetBytesToMove() const
+{
+	size_t toReturn = 0;
+
+	for (size_t i = nextMove; i < moves.size(); ++i)
+		toReturn += moves[i].size;
+
+	return toReturn;
+}
+
+template<typename Identifier>
+inline void CompactionPlanner<Identifier>::Clear()
+{
+	heaps.clear();
+	moves.clear();
+	evacuatedHeaps.clear();
+	nextMove = 0;
+}
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
 
 #include <d3d12.h>
 
@@ -15,6 +18,52 @@ enum class UpdateType
 	COPY_UPDATE
 };
 
+// Tracks which fixed size pages of each component's data have been written
+// since they were last consumed, so that only those ranges need uploading.
+// Components are indexed by descriptor index, as the headers below are.
+class DirtyPageTracker
+{
+private:
+	struct TrackedComponent
+	{
+		ResourceIndex resourceIndex;
+		size_t dataSize = 0;
+		bool dirty = false;
+		std::vector<std::uint64_t> pageMasks;
+	};
+
+	size_t pageSizeShift = 8;
+	std::vector<TrackedComponent> components;
+	std::vector<size_t> dirtyComponents;
+
+public:
+	DirtyPageTracker() = default;
+	~DirtyPageTracker() = default;
+	DirtyPageTracker(const DirtyPageTracker& other) = default;
+	DirtyPageTracker& operator=(const DirtyPageTracker& other) = default;
+	DirtyPageTracker(DirtyPageTracker&& other) = default;
+	DirtyPageTracker& operator=(DirtyPageTracker&& other) = default;
+
+	void Initialize(size_t pageSize);
+
+	void Track(const ResourceIndex& resourceIndex, size_t dataSize);
+	void Untrack(const ResourceIndex& resourceIndex);
+	void MarkDirty(const ResourceIndex& resourceIndex, size_t offset, size_t size);
+
+	// Calls the function with the resource index, offset and size of every
+	// run of dirty pages, clamped to the data size, and then clears them
+	template<typename Function>
+	void ConsumeDirtyRanges(Function function);
+
+	// Same, but only for the dirty pages of one component that overlap the range
+	template<typename Function>
+	void ConsumeDirtyRanges(const ResourceIndex& resourceIndex, size_t offset,
+		size_t size, Function function);
+
+	bool HasDirtyPages() const;
+	size_t GetPageSize() const;
+};
+
 template<typename SpecificData>
 class ComponentData
 {
@@ -54,6 +103,199 @@ public:
 	void* GetComponentData(const ResourceIndex& resourceIndex);
 };
 
+inline void DirtyPageTracker::Initialize(size_t pageSize)
+{
+	if (pageSize == 0 || (pageSize & (pageSize - 1)) != 0)
+		throw std::runtime_error("Error: Dirty page size must be a power of two");
+
+	pageSizeShift = 0;
+	while ((size_t(1) << pageSizeShift) != pageSize)
+		++pageSizeShift;
+
+	components.clear();
+	dirtyComponents.clear();
+}
+
+inline void DirtyPageTracker::Track(const ResourceIndex& resourceIndex,
+	size_t dataSize)
+{
+	if (resourceIndex.descriptorIndex >= components.size())
+		components.resize(resourceIndex.descriptorIndex + 1);
+
+	size_t nrOfPages = (dataSize + (size_t(1) << pageSizeShift) - 1) >> pageSizeShift;
+	TrackedComponent& component = components[resourceIndex.descriptorIndex];
+	component.resourceIndex = resourceIndex;
+	component.dataSize = dataSize;
+	component.dirty = false;
+	component.pageMasks.assign((nrOfPages + 63) / 64, 0);
+}
+
+inline void DirtyPageTracker::Untrack(const ResourceIndex& resourceIndex)
+{
+	if (resourceIndex.descriptorIndex >= components.size())
+		return;
+
+	// Left in the dirty list, which skips components that are not dirty
+	TrackedComponent& component = components[resourceIndex.descriptorIndex];
+	component.dataSize = 0;
+	component.dirty = false;
+	component.pageMasks.clear();
+}
+
+inline void DirtyPageTracker::MarkDirty(const ResourceIndex& resourceIndex,
+	size_t offset, size_t size)
+{
+#ifdef _DEBUG
+	if (resourceIndex.descriptorIndex >= components.size() ||
+		offset + size > components[resourceIndex.descriptorIndex].dataSize)
+	{
+		throw std::runtime_error("Error: Dirty range outside of component data");
+	}
+#endif
+
+	if (size == 0)
+		return;
+
+	TrackedComponent& component = components[resourceIndex.descriptorIndex];
+	size_t firstPage = offset >> pageSizeShift;
+	size_t lastPage = (offset + size - 1) >> pageSizeShift;
+
+	for (size_t page = firstPage; page <= lastPage;)
+	{
+		size_t bit = page % 64;
+		size_t bitsInWord = std::min<size_t>(64 - bit, lastPage - page + 1);
+		std::uint64_t mask = bitsInWord == 64 ? ~std::uint64_t(0) :
+			((std::uint64_t(1) << bitsInWord) - 1) << bit;
+		component.pageMasks[page / 64] |= mask;
+		page += bitsInWord;
+	}
+
+	if (!component.dirty)
+	{
+		component.dirty = true;
+		dirtyComponents.push_back(resourceIndex.descriptorIndex);
+	}
+}
+
+template<typename Function>
+inline void DirtyPageTracker::ConsumeDirtyRanges(Function function)
+{
+	for (size_t componentIndex : dirtyComponents)
+	{
+		TrackedComponent& component = components[componentIndex];
+
+		if (!component.dirty)
+			continue;
+
+		auto emitRun = [&](size_t firstPage, size_t endPage)
+		{
+			size_t start = firstPage << pageSizeShift;
+			size_t end = std::min(endPage << pageSizeShift, component.dataSize);
+			function(component.resourceIndex, start, end - start);
+		};
+
+		size_t runStart = size_t(-1);
+		for (size_t word = 0; word < component.pageMasks.size(); ++word)
+		{
+			std::uint64_t mask = component.pageMasks[word];
+			component.pageMasks[word] = 0;
+
+			if (mask == 0 || mask == ~std::uint64_t(0))
+			{
+				if (mask == 0 && runStart != size_t(-1))
+				{
+					emitRun(runStart, word * 64);
+					runStart = size_t(-1);
+				}
+				else if (mask != 0 && runStart == size_t(-1))
+				{
+					runStart = word * 64;
+				}
+
+				continue;
+			}
+
+			for (size_t bit = 0; bit < 64; ++bit)
+			{
+				bool pageDirty = ((mask >> bit) & 1) != 0;
+
+				if (pageDirty && runStart == size_t(-1))
+				{
+					runStart = word * 64 + bit;
+				}
+				else if (!pageDirty && runStart != size_t(-1))
+				{
+					emitRun(runStart, word * 64 + bit);
+					runStart = size_t(-1);
+				}
+			}
+		}
+
+		if (runStart != size_t(-1))
+			emitRun(runStart, component.pageMasks.size() * 64);
+
+		component.dirty = false;
+	}
+
+	dirtyComponents.clear();
+}
+
+template<typename Function>
+inline void DirtyPageTracker::ConsumeDirtyRanges(const ResourceIndex& resourceIndex,
+	size_t offset, size_t size, Function function)
+{
+	if (size == 0 || resourceIndex.descriptorIndex >= components.size())
+		return;
+
+	TrackedComponent& component = components[resourceIndex.descriptorIndex];
+	if (!component.dirty)
+		return;
+
+	size_t firstPage = offset >> pageSizeShift;
+	size_t endPage = std::min(((offset + size - 1) >> pageSizeShift) + 1,
+		component.pageMasks.size() * 64);
+	size_t runStart = size_t(-1);
+
+	for (size_t page = firstPage; page <= endPage; ++page)
+	{
+		std::uint64_t bit = std::uint64_t(1) << (page % 64);
+		bool pageDirty = page < endPage && (component.pageMasks[page / 64] & bit) != 0;
+
+		if (pageDirty)
+		{
+			component.pageMasks[page / 64] &= ~bit;
+			runStart = runStart == size_t(-1) ? page : runStart;
+		}
+		else if (runStart != size_t(-1))
+		{
+			size_t start = runStart << pageSizeShift;
+			size_t end = std::min(page << pageSizeShift, component.dataSize);
+			function(component.resourceIndex, start, end - start);
+			runStart = size_t(-1);
+		}
+	}
+
+	// Left in the dirty list when clean, as for Untrack
+	component.dirty = std::any_of(component.pageMasks.begin(),
+		component.pageMasks.end(), [](std::uint64_t mask) { return mask != 0; });
+}
+
+inline bool DirtyPageTracker::HasDirtyPages() const
+{
+	for (size_t componentIndex : dirtyComponents)
+	{
+		if (components[componentIndex].dirty)
+			return true;
+	}
+
+	return false;
+}
+
+inline size_t DirtyPageTracker::GetPageSize() const
+{
+	return size_t(1) << pageSizeShift;
+}
+
 template<typename SpecificData>
 void ComponentData<SpecificData>::UpdateExistingHeaders(size_t indexOfOriginalChange,
 	std::int64_t sizeDifference)
@@ -0,0 +1,520 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+
+#include <d3d12.h>
+
+#include "FrameBased.h"
+#include "FrameBufferComponent.h"
+
+// Buffers for data that is rarely written. Every buffer has a single backing
+// allocation shared by all frames in flight, instead of one per frame. When a
+// buffer is written after its current version has been uploaded, a new
+// version is made and the old one is kept until the frames that could read it
+// have finished.
+// Ranged writes copy the rest of the old version on the GPU, so only the pages
+// they touch are uploaded.
+// The indices handed out are stable, but the descriptor index of a buffer
+// changes every time a write makes a new version. It has to be looked up
+// through GetResourceIndex after writing, rather than kept.
+template<FrameType Frames>
+class CopyOnWriteBufferComponent : public ResourceComponent, public FrameBased<Frames>
+{
+private:
+	struct SharedBuffer
+	{
+		ResourceIndex currentVersion;
+		size_t versionUpdate = size_t(-1); // Update the current version is part of
+		size_t nrOfElements = 0;
+		BufferReplacementViews replacementViews;
+	};
+
+	// A new version that gets the contents of the old one copied on the GPU
+	struct CarryOver
+	{
+		ResourceIndex from;
+		ResourceIndex to;
+		size_t nrOfElements = 0;
+	};
+
+	FrameBufferComponent<1> component;
+	size_t elementSize = 0;
+	size_t updateCounter = 0;
+	std::vector<SharedBuffer> buffers; // Indexed by the handed out descriptor index
+	std::vector<size_t> freeBufferSlots;
+
+	// Versions replaced or removed while each frame was active, released when
+	// that frame comes around again and has finished on the GPU
+	std::array<std::vector<ResourceIndex>, Frames> retiredVersions;
+	size_t nrOfRetiredVersions = 0;
+
+	// Recorded before the updates of the next PerformUpdates are uploaded
+	std::vector<CarryOver> carryOvers;
+
+	SharedBuffer& GetSharedBuffer(const ResourceIndex& index);
+	const SharedBuffer& GetSharedBuffer(const ResourceIndex& index) const;
+	bool CanCarryOver(ID3D12Resource* from, ID3D12Resource* to) const;
+	ResourceIndex PrepareForWrite(const ResourceIndex& index, bool overwritesAll);
+	void RecordCarryOvers(ID3D12GraphicsCommandList* commandList);
+
+public:
+	CopyOnWriteBufferComponent() = default;
+	virtual ~CopyOnWriteBufferComponent() = default;
+	CopyOnWriteBufferComponent(const CopyOnWriteBufferComponent& other) = delete;
+	CopyOnWriteBufferComponent& operator=(const CopyOnWriteBufferComponent& other) = delete;
+	CopyOnWriteBufferComponent(CopyOnWriteBufferComponent&& other) noexcept;
+	CopyOnWriteBufferComponent& operator=(CopyOnWriteBufferComponent&& other) noexcept;
+
+	void Initialize(ID3D12Device* deviceToUse, const BufferComponentInfo& bufferInfo,
+		const std::vector<DescriptorAllocationInfo<BufferViewDesc>>& descriptorInfo,
+		size_t dirtyPageSize = 256);
+
+	ResourceIndex CreateBuffer(size_t nrOfElements,
+		const BufferReplacementViews& replacementViews = BufferReplacementViews());
+
+	void RemoveComponent(const ResourceIndex& indexToRemove) override;
+
+	void SetUpdateData(const ResourceIndex& resourceIndex, void* dataAdress);
+	void SetUpdateDataRange(const ResourceIndex& resourceIndex,
+		const void* dataAdress, size_t offset, size_t size);
+	void PrepareResourcesForUpdates(std::vector<D3D12_RESOURCE_BARRIER>& barriers);
+	void PerformUpdates(ID3D12GraphicsCommandList* commandList,
+		ResourceUploader& uploader, RingBufferUploader* ringUploader = nullptr);
+
+	void GetInitializationBarriers(std::vector<D3D12_RESOURCE_BARRIER>& toAddTo);
+
+	D3D12_RESOURCE_STATES GetCurrentState();
+	void ChangeToState(std::vector<D3D12_RESOURCE_BARRIER>& barriers,
+		D3D12_RESOURCE_STATES newState,
+		std::optional<D3D12_RESOURCE_STATES> assumedInitialState = std::nullopt);
+
+	// The index of the current version, its descriptor index is the one to use
+	// until the next write that makes a new version
+	ResourceIndex GetResourceIndex(const ResourceIndex& index) const;
+	D3D12_GPU_VIRTUAL_ADDRESS GetVirtualAdress(const ResourceIndex& index);
+	BufferHandle GetBufferHandle(const ResourceIndex& index);
+	const BufferHandle GetBufferHandle(const ResourceIndex& index) const;
+
+	// Versions waiting for the frames that can read them to finish
+	size_t NrOfRetiredVersions() const;
+	// Includes the retired versions
+	AllocatorStatistics GetStatistics() const;
+
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapCBV() const override;
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapSRV() const override;
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapUAV() const override;
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapRTV() const override;
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapDSV() const override;
+
+	bool HasDescriptorsOfType(ViewType type) const override;
+
+	size_t NrOfDescriptors() const override;
+
+	void SwapFrame() override;
+};
+
+template<FrameType Frames>
+inline typename CopyOnWriteBufferComponent<Frames>::SharedBuffer&
+CopyOnWriteBufferComponent<Frames>::GetSharedBuffer(const ResourceIndex& index)
+{
+#ifdef _DEBUG
+	if (index.descriptorIndex >= buffers.size() ||
+		buffers[index.descriptorIndex].nrOfElements == 0)
+	{
+		throw std::runtime_error("Error: Invalid copy on write buffer index");
+	}
+#endif
+
+	return buffers[index.descriptorIndex];
+}
+
+template<FrameType Frames>
+inline const typename CopyOnWriteBufferComponent<Frames>::SharedBuffer&
+CopyOnWriteBufferComponent<Frames>::GetSharedBuffer(const ResourceIndex& index) const
+{
+#ifdef _DEBUG
+	if (index.descriptorIndex >= buffers.size() ||
+		buffers[index.descriptorIndex].nrOfElements == 0)
+	{
+		throw std::runtime_error("Error: Invalid copy on write buffer index");
+	}
+#endif
+
+	return buffers[index.descriptorIndex];
+}
+
+template<FrameType Frames>
+inline bool CopyOnWriteBufferComponent<Frames>::CanCarryOver(ID3D12Resource* from,
+	ID3D12Resource* to) const
+{
+	// Sources are copy sources and destinations copy destinations while the
+	// copies are recorded, no resource can be both
+	if (from == to)
+		return false;
+
+	for (const CarryOver& carryOver : carryOvers)
+	{
+		if (component.GetBufferHandle(carryOver.from).resource == to ||
+			component.GetBufferHandle(carryOver.to).resource == from)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<FrameType Frames>
+inline ResourceIndex CopyOnWriteBufferComponent<Frames>::PrepareForWrite(
+	const ResourceIndex& index, bool overwritesAll)
+{
+	SharedBuffer& buffer = GetSharedBuffer(index);
+
+	// A version made since the last update has not been read by the GPU yet
+	if (buffer.versionUpdate == updateCounter)
+		return buffer.currentVersion;
+
+	ResourceIndex newVersion = component.CreateBuffer(buffer.nrOfElements,
+		buffer.replacementViews);
+
+	// The new allocation starts out undefined, so unless the write covers the
+	// whole buffer the old contents are carried over before it is applied.
+	// The shadow data is copied without marking it dirty and the GPU copies
+	// the rest, unless the copy would need a resource in two states.
+	if (!overwritesAll)
+	{
+		void* oldData = component.GetUpdateData(buffer.currentVersion);
+		ID3D12Resource* from = component.GetBufferHandle(buffer.currentVersion).resource;
+		ID3D12Resource* to = component.GetBufferHandle(newVersion).resource;
+
+		if (CanCarryOver(from, to))
+		{
+			std::memcpy(component.GetUpdateData(newVersion), oldData,
+				buffer.nrOfElements * elementSize);
+			carryOvers.push_back({ buffer.currentVersion, newVersion,
+				buffer.nrOfElements });
+		}
+		else
+		{
+			component.SetUpdateData(newVersion, oldData);
+		}
+	}
+
+	retiredVersions[this->activeFrame].push_back(buffer.currentVersion);
+	++nrOfRetiredVersions;
+	buffer.currentVersion = newVersion;
+	buffer.versionUpdate = updateCounter;
+
+	return newVersion;
+}
+
+template<FrameType Frames>
+inline void CopyOnWriteBufferComponent<Frames>::RecordCarryOvers(
+	ID3D12GraphicsCommandList* commandList)
+{
+	if (carryOvers.empty())
+		return;
+
+	// The whole component is in the copy destination state, the sources are
+	// moved to the copy source state around the copies
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	for (const CarryOver& carryOver : carryOvers)
+	{
+		ID3D12Resource* source = component.GetBufferHandle(carryOver.from).resource;
+		auto sameSource = [source](const D3D12_RESOURCE_BARRIER& barrier)
+		{
+			return barrier.Transition.pResource == source;
+		};
+
+		if (std::find_if(barriers.begin(), barriers.end(), sameSource) != barriers.end())
+			continue;
+
+		D3D12_RESOURCE_BARRIER barrier;
+		barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+		barrier.Transition.pResource = source;
+		barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+		barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+		barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+		barriers.push_back(barrier);
+	}
+
+	commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+
+	for (const CarryOver& carryOver : carryOvers)
+	{
+		BufferHandle from = component.GetBufferHandle(carryOver.from);
+		BufferHandle to = component.GetBufferHandle(carryOver.to);
+		commandList->CopyBufferRegion(to.resource, to.startOffset, from.resource,
+			from.startOffset, carryOver.nrOfElements * elementSize);
+	}
+
+	for (D3D12_RESOURCE_BARRIER& barrier : barriers)
+		std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+
+	commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+	carryOvers.clear();
+}
+
+template<FrameType Frames>
+inline CopyOnWriteBufferComponent<Frames>::CopyOnWriteBufferComponent(
+	CopyOnWriteBufferComponent&& other) noexcept : ResourceComponent(std::move(other)),
+	FrameBased<Frames>(std::move(other)), component(std::move(other.component)),
+	elementSize(other.elementSize), updateCounter(other.updateCounter),
+	buffers(std::move(other.buffers)), freeBufferSlots(std::move(other.freeBufferSlots)),
+	retiredVersions(std::move(other.retiredVersions)),
+	nrOfRetiredVersions(other.nrOfRetiredVersions),
+	carryOvers(std::move(other.carryOvers))
+{
+	other.elementSize = 0;
+	other.updateCounter = 0;
+	other.nrOfRetiredVersions = 0;
+}
+
+template<FrameType Frames>
+inline CopyOnWriteBufferComponent<Frames>& CopyOnWriteBufferComponent<Frames>::operator=(
+	CopyOnWriteBufferComponent&& other) noexcept
+{
+	if (this != &other)
+	{
+		ResourceComponent::operator=(std::move(other));
+		FrameBased<Frames>::operator=(std::move(other));
+		component = std::move(other.component);
+		elementSize = other.elementSize;
+		updateCounter = other.updateCounter;
+		buffers = std::move(other.buffers);
+		freeBufferSlots = std::move(other.freeBufferSlots);
+		retiredVersions = std::move(other.retiredVersions);
+		nrOfRetiredVersions = other.nrOfRetiredVersions;
+		carryOvers = std::move(other.carryOvers);
+
+		other.elementSize = 0;
+		other.updateCounter = 0;
+		other.nrOfRetiredVersions = 0;
+	}
+
+	return *this;
+}
+
+template<FrameType Frames>
+inline void CopyOnWriteBufferComponent<Frames>::Initialize(ID3D12Device* deviceToUse,
+	const BufferComponentInfo& bufferInfo,
+	const std::vector<DescriptorAllocationInfo<BufferViewDesc>>& descriptorInfo,
+	size_t dirtyPageSize)
+{
+	component.Initialize(deviceToUse, UpdateType::COPY_UPDATE, bufferInfo,
+		descriptorInfo, dirtyPageSize);
+	elementSize = bufferInfo.bufferInfo.elementSize;
+}
+
+template<FrameType Frames>
+inline ResourceIndex CopyOnWriteBufferComponent<Frames>::CreateBuffer(
+	size_t nrOfElements, const BufferReplacementViews& replacementViews)
+{
+	if (nrOfElements == 0)
+		throw std::runtime_error("Error: Cannot create empty copy on write buffer");
+
+	size_t slot = buffers.size();
+	if (!freeBufferSlots.empty())
+	{
+		slot = freeBufferSlots.back();
+		freeBufferSlots.pop_back();
+	}
+	else
+	{
+		buffers.emplace_back();
+	}
+
+	SharedBuffer& buffer = buffers[slot];
+	buffer.currentVersion = component.CreateBuffer(nrOfElements, replacementViews);
+	buffer.versionUpdate = updateCounter;
+	buffer.nrOfElements = nrOfElements;
+	buffer.replacementViews = replacementViews;
+
+	ResourceIndex toReturn;
+	toReturn.descriptorIndex = slot;
+
+	return toReturn;
+}
+
+template<FrameType Frames>
+inline void CopyOnWriteBufferComponent<Frames>::RemoveComponent(
+	const ResourceIndex& indexToRemove)
+{
+	SharedBuffer& buffer = GetSharedBuffer(indexToRemove);
+	retiredVersions[this->activeFrame].push_back(buffer.currentVersion);
+	++nrOfRetiredVersions;
+
+	buffer = SharedBuffer();
+	freeBufferSlots.push_back(indexToRemove.descriptorIndex);
+}
+
+template<FrameType Frames>
+inline void CopyOnWriteBufferComponent<Frames>::SetUpdateData(
+	const ResourceIndex& resourceIndex, void* dataAdress)
+{
+	component.SetUpdateData(PrepareForWrite(resourceIndex, true), dataAdress);
+}
+
+template<FrameType Frames>
+inline void CopyOnWriteBufferComponent<Frames>::SetUpdateDataRange(
+	const ResourceIndex& resourceIndex, const void* dataAdress, size_t offset,
+	size_t size)
+{
+	component.SetUpdateDataRange(PrepareForWrite(resourceIndex, false),
+		dataAdress, offset, size);
+}
+
+template<FrameType Frames>
+inline void CopyOnWriteBufferComponent<Frames>::PrepareResourcesForUpdates(
+	std::vector<D3D12_RESOURCE_BARRIER>& barriers)
+{
+	component.PrepareResourcesForUpdates(barriers);
+
+	// Carried over versions need the copy destination state even when the
+	// write that made them touched no pages
+	if (!carryOvers.empty() &&
+		component.GetCurrentState() != D3D12_RESOURCE_STATE_COPY_DEST)
+	{
+		component.ChangeToState(barriers, D3D12_RESOURCE_STATE_COPY_DEST);
+	}
+}
+
+template<FrameType Frames>
+inline void CopyOnWriteBufferComponent<Frames>::PerformUpdates(
+	ID3D12GraphicsCommandList* commandList, ResourceUploader& uploader,
+	RingBufferUploader* ringUploader)
+{
+	RecordCarryOvers(commandList);
+	component.PerformUpdates(commandList, uploader, ringUploader);
+	++updateCounter;
+}
+
+template<FrameType Frames>
+inline void CopyOnWriteBufferComponent<Frames>::GetInitializationBarriers(
+	std::vector<D3D12_RESOURCE_BARRIER>& toAddTo)
+{
+	component.GetInitializationBarriers(toAddTo);
+}
+
+template<FrameType Frames>
+inline D3D12_RESOURCE_STATES CopyOnWriteBufferComponent<Frames>::GetCurrentState()
+{
+	return component.GetCurrentState();
+}
+
+template<FrameType Frames>
+inline void CopyOnWriteBufferComponent<Frames>::ChangeToState(
+	std::vector<D3D12_RESOURCE_BARRIER>& barriers, D3D12_RESOURCE_STATES newState,
+	std::optional<D3D12_RESOURCE_STATES> assumedInitialState)
+{
+	component.ChangeToState(barriers, newState, assumedInitialState);
+}
+
+template<FrameType Frames>
+inline ResourceIndex CopyOnWriteBufferComponent<Frames>::GetResourceIndex(
+	const ResourceIndex& index) const
+{
+	return GetSharedBuffer(index).currentVersion;
+}
+
+template<FrameType Frames>
+inline D3D12_GPU_VIRTUAL_ADDRESS CopyOnWriteBufferComponent<Frames>::GetVirtualAdress(
+	const ResourceIndex& index)
+{
+	return component.GetVirtualAdress(GetSharedBuffer(index).currentVersion);
+}
+
+template<FrameType Frames>
+inline BufferHandle CopyOnWriteBufferComponent<Frames>::GetBufferHandle(
+	const ResourceIndex& index)
+{
+	return component.GetBufferHandle(GetSharedBuffer(index).currentVersion);
+}
+
+template<FrameType Frames>
+inline const BufferHandle CopyOnWriteBufferComponent<Frames>::GetBufferHandle(
+	const ResourceIndex& index) const
+{
+	return component.GetBufferHandle(GetSharedBuffer(index).currentVersion);
+}
+
+template<FrameType Frames>
+inline size_t CopyOnWriteBufferComponent<Frames>::NrOfRetiredVersions() const
+{
+	return nrOfRetiredVersions;
+}
+
+template<FrameType Frames>
+inline AllocatorStatistics CopyOnWriteBufferComponent<Frames>::GetStatistics() const
+{
+	return component.GetStatistics();
+}
+
+template<FrameType Frames>
+inline const D3D12_CPU_DESCRIPTOR_HANDLE
+CopyOnWriteBufferComponent<Frames>::GetDescriptorHeapCBV() const
+{
+	return component.GetDescriptorHeapCBV();
+}
+
+template<FrameType Frames>
+inline const D3D12_CPU_DESCRIPTOR_HANDLE
+CopyOnWriteBufferComponent<Frames>::GetDescriptorHeapSRV() const
+{
+	return component.GetDescriptorHeapSRV();
+}
+
+template<FrameType Frames>
+inline const D3D12_CPU_DESCRIPTOR_HANDLE
+CopyOnWriteBufferComponent<Frames>::GetDescriptorHeapUAV() const
+{
+	return component.GetDescriptorHeapUAV();
+}
+
+template<FrameType Frames>
+inline const D3D12_CPU_DESCRIPTOR_HANDLE
+CopyOnWriteBufferComponent<Frames>::GetDescriptorHeapRTV() const
+{
+	return component.GetDescriptorHeapRTV();
+}
+
+template<FrameType Frames>
+inline const D3D12_CPU_DESCRIPTOR_HANDLE
+CopyOnWriteBufferComponent<Frames>::GetDescriptorHeapDSV() const
+{
+	return component.GetDescriptorHeapDSV();
+}
+
+template<FrameType Frames>
+inline bool CopyOnWriteBufferComponent<Frames>::HasDescriptorsOfType(
+	ViewType type) const
+{
+	return component.HasDescriptorsOfType(type);
+}
+
+template<FrameType Frames>
+inline size_t CopyOnWriteBufferComponent<Frames>::NrOfDescriptors() const
+{
+	return component.NrOfDescriptors();
+}
+
+template<FrameType Frames>
+inline void CopyOnWriteBufferComponent<Frames>::SwapFrame()
+{
+	FrameBased<Frames>::SwapFrame();
+
+	// The frame that last used this slot has finished, as has every frame
+	// that could have read the versions retired during it
+	for (const ResourceIndex& version : retiredVersions[this->activeFrame])
+		component.RemoveComponent(version);
+
+	nrOfRetiredVersions -= retiredVersions[this->activeFrame].size();
+	retiredVersions[this->activeFrame].clear();
+	component.SwapFrame();
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+
+#include "HeapAllocatorGPU.h"
+#include "AllocatorStatistics.h"
+
+// Adds allocation counters and a high water mark to an allocator whose
+// implementation is in the prebuilt library, where new members can not be
+// added without changing its layout
+template<typename Allocator>
+class CountingHeapAllocatorGPU : public Allocator
+{
+private:
+	size_t totalAllocations = 0;
+	size_t totalDeallocations = 0;
+	size_t bytesUsed = 0;
+	size_t bytesUsedHighWaterMark = 0;
+
+public:
+	CountingHeapAllocatorGPU() = default;
+	virtual ~CountingHeapAllocatorGPU() = default;
+	CountingHeapAllocatorGPU(const CountingHeapAllocatorGPU& other) = delete;
+	CountingHeapAllocatorGPU& operator=(const CountingHeapAllocatorGPU& other) = delete;
+	CountingHeapAllocatorGPU(CountingHeapAllocatorGPU&& other) = default;
+	CountingHeapAllocatorGPU& operator=(CountingHeapAllocatorGPU&& other) = default;
+
+	virtual HeapChunk AllocateChunk(size_t minimumRequiredSize,
+		D3D12_HEAP_TYPE requiredType, D3D12_HEAP_FLAGS requiredFlags) override;
+	virtual void DeallocateChunk(HeapChunk& chunk) override;
+
+	AllocatorStatistics GetStatistics() const;
+};
+
+template<typename Allocator>
+inline HeapChunk CountingHeapAllocatorGPU<Allocator>::AllocateChunk(
+	size_t minimumRequiredSize, D3D12_HEAP_TYPE requiredType,
+	D3D12_HEAP_FLAGS requiredFlags)
+{
+	HeapChunk toReturn = Allocator::AllocateChunk(minimumRequiredSize,
+		requiredType, requiredFlags);
+
+	++totalAllocations;
+	bytesUsed += toReturn.endOffset - toReturn.startOffset;
+	bytesUsedHighWaterMark = std::max(bytesUsedHighWaterMark, bytesUsed);
+
+	return toReturn;
+}
+
+template<typename Allocator>
+inline void CountingHeapAllocatorGPU<Allocator>::DeallocateChunk(HeapChunk& chunk)
+{
+	// The chunk is reset by the deallocation, so its size is read first
+	size_t chunkSize = chunk.endOffset - chunk.startOffset;
+	Allocator::DeallocateChunk(chunk);
+
+	++totalDeallocations;
+	bytesUsed -= chunkSize;
+}
+
+template<typename Allocator>
+inline AllocatorStatistics CountingHeapAllocatorGPU<Allocator>::GetStatistics() const
+{
+	AllocatorStatistics toReturn = Allocator::GetStatistics();
+	toReturn.totalAllocations = totalAllocations;
+	toReturn.totalDeallocations = totalDeallocations;
+	toReturn.bytesUsedHighWaterMark = bytesUsedHighWaterMark;
+
+	return toReturn;
+}
\ No newline at end of file
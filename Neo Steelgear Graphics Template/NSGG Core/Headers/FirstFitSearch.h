@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FIRST_FIT_SEARCH_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC allows intrinsics of any instruction set in any function, GCC and
+// Clang need the instruction set enabled per function
+#if defined(FIRST_FIT_SEARCH_X64) && !defined(_MSC_VER)
+#define FIRST_FIT_SEARCH_TARGET(instructionSet) __attribute__((target(instructionSet)))
+#else
+#define FIRST_FIT_SEARCH_TARGET(instructionSet)
+#endif
+
+// Searches parallel arrays of free chunk offsets and sizes for the chunk with
+// the lowest offset that fits a request. The vectorized kernels are picked at
+// runtime from what the CPU supports, so the build does not need /arch:AVX2
+// or -mavx2 to use them.
+
+enum class FirstFitSearchLevel
+{
+	SCALAR,
+	SSE4_2,
+	AVX2
+};
+
+struct FirstFitSearchResult
+{
+	size_t offset = size_t(-1);
+	size_t position = size_t(-1);
+};
+
+// Above this the vectorized fit check could overflow its signed lanes
+constexpr size_t FIRST_FIT_MAX_VECTORIZED_VALUE = size_t(1) << 62;
+
+inline FirstFitSearchLevel DetectFirstFitSearchLevel()
+{
+#if defined(FIRST_FIT_SEARCH_X64) && defined(_MSC_VER)
+	int registers[4] = {};
+	__cpuid(registers, 0);
+	int highestLeaf = registers[0];
+
+	__cpuid(registers, 1);
+	bool sse42 = (registers[2] & (1 << 20)) != 0;
+	bool osSavesAvx = (registers[2] & (1 << 27)) != 0 && (registers[2] & (1 << 28)) != 0 &&
+		(_xgetbv(0) & 0x6) == 0x6;
+	bool avx2 = false;
+
+	if (highestLeaf >= 7 && osSavesAvx)
+	{
+		__cpuidex(registers, 7, 0);
+		avx2 = (registers[1] & (1 << 5)) != 0;
+	}
+
+	if (avx2)
+		return FirstFitSearchLevel::AVX2;
+
+	return sse42 ? FirstFitSearchLevel::SSE4_2 : FirstFitSearchLevel::SCALAR;
+#elif defined(FIRST_FIT_SEARCH_X64)
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2"))
+		return FirstFitSearchLevel::AVX2;
+
+	return __builtin_cpu_supports("sse4.2") ?
+		FirstFitSearchLevel::SSE4_2 : FirstFitSearchLevel::SCALAR;
+#else
+	return FirstFitSearchLevel::SCALAR;
+#endif
+}
+
+inline FirstFitSearchLevel GetFirstFitSearchLevel()
+{
+	static const FirstFitSearchLevel level = DetectFirstFitSearchLevel();
+	return level;
+}
+
+// A chunk fits if its size covers the alignment padding plus the data, at
+// least one byte is required so that the padding can not fill the chunk
+inline void SearchFirstFitScalar(const size_t* offsets, const size_t* sizes,
+	size_t begin, size_t end, size_t dataSize, size_t alignment,
+	FirstFitSearchResult& result)
+{
+	size_t alignmentMask = alignment - 1;
+
+	for (size_t position = begin; position < end; ++position)
+	{
+		// Written without branches as the outcome is close to random per chunk
+		size_t offset = offsets[position];
+		size_t size = sizes[position];
+		size_t padding = ((offset + alignmentMask) & ~alignmentMask) - offset;
+		bool better = (padding < size) & (size - padding >= dataSize) &
+			(offset < result.offset);
+
+		result.offset = better ? offset : result.offset;
+		result.position = better ? position : result.position;
+	}
+}
+
+#ifdef FIRST_FIT_SEARCH_X64
+
+inline void MergeFirstFitLanes(const std::int64_t* laneOffsets,
+	const std::int64_t* lanePositions, size_t laneCount, FirstFitSearchResult& result)
+{
+	for (size_t lane = 0; lane < laneCount; ++lane)
+	{
+		if (lanePositions[lane] >= 0 && size_t(laneOffsets[lane]) < result.offset)
+		{
+			result.offset = size_t(laneOffsets[lane]);
+			result.position = size_t(lanePositions[lane]);
+		}
+	}
+}
+
+// Returns how many chunks were searched, the caller searches the rest.
+// All values have to be at most FIRST_FIT_MAX_VECTORIZED_VALUE, which keeps
+// the signed lane comparisons exact.
+FIRST_FIT_SEARCH_TARGET("sse4.2")
+inline size_t SearchFirstFitSSE42(const size_t* offsets, const size_t* sizes,
+	size_t count, size_t dataSize, size_t alignment, FirstFitSearchResult& result)
+{
+	constexpr size_t LANE_COUNT = 2;
+	const __m128i mask = _mm_set1_epi64x(std::int64_t(alignment - 1));
+	const __m128i inverseMask = _mm_set1_epi64x(~std::int64_t(alignment - 1));
+	const __m128i sizeNeeded = _mm_set1_epi64x(std::int64_t(dataSize == 0 ? 1 : dataSize));
+	const __m128i step = _mm_set1_epi64x(std::int64_t(LANE_COUNT));
+	__m128i positions = _mm_set_epi64x(1, 0);
+	__m128i bestOffsets = _mm_set1_epi64x(std::numeric_limits<std::int64_t>::max());
+	__m128i bestPositions = _mm_set1_epi64x(-1);
+	size_t position = 0;
+
+	for (; position + LANE_COUNT <= count; position += LANE_COUNT)
+	{
+		__m128i chunkOffsets = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(offsets + position));
+		__m128i chunkSizes = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(sizes + position));
+		__m128i aligned = _mm_and_si128(_mm_add_epi64(chunkOffsets, mask), inverseMask);
+		__m128i needed = _mm_add_epi64(_mm_sub_epi64(aligned, chunkOffsets), sizeNeeded);
+		__m128i tooSmall = _mm_cmpgt_epi64(needed, chunkSizes);
+		__m128i lower = _mm_cmpgt_epi64(bestOffsets, chunkOffsets);
+		__m128i better = _mm_andnot_si128(tooSmall, lower);
+		bestOffsets = _mm_blendv_epi8(bestOffsets, chunkOffsets, better);
+		bestPositions = _mm_blendv_epi8(bestPositions, positions, better);
+		positions = _mm_add_epi64(positions, step);
+	}
+
+	std::int64_t laneOffsets[LANE_COUNT];
+	std::int64_t lanePositions[LANE_COUNT];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(laneOffsets), bestOffsets);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanePositions), bestPositions);
+	MergeFirstFitLanes(laneOffsets, lanePositions, LANE_COUNT, result);
+
+	return position;
+}
+
+FIRST_FIT_SEARCH_TARGET("avx2")
+inline size_t SearchFirstFitAVX2(const size_t* offsets, const size_t* sizes,
+	size_t count, size_t dataSize, size_t alignment, FirstFitSearchResult& result)
+{
+	constexpr size_t LANE_COUNT = 4;
+	const __m256i mask = _mm256_set1_epi64x(std::int64_t(alignment - 1));
+	const __m256i inverseMask = _mm256_set1_epi64x(~std::int64_t(alignment - 1));
+	const __m256i sizeNeeded = _mm256_set1_epi64x(
+		std::int64_t(dataSize == 0 ? 1 : dataSize));
+	const __m256i step = _mm256_set1_epi64x(std::int64_t(LANE_COUNT));
+	__m256i positions = _mm256_setr_epi64x(0, 1, 2, 3);
+	__m256i bestOffsets = _mm256_set1_epi64x(std::numeric_limits<std::int64_t>::max());
+	__m256i bestPositions = _mm256_set1_epi64x(-1);
+	size_t position = 0;
+
+	for (; position + LANE_COUNT <= count; position += LANE_COUNT)
+	{
+		__m256i chunkOffsets = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(offsets + position));
+		__m256i chunkSizes = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(sizes + position));
+		__m256i aligned = _mm256_and_si256(
+			_mm256_add_epi64(chunkOffsets, mask), inverseMask);
+		__m256i needed = _mm256_add_epi64(
+			_mm256_sub_epi64(aligned, chunkOffsets), sizeNeeded);
+		__m256i tooSmall = _mm256_cmpgt_epi64(needed, chunkSizes);
+		__m256i lower = _mm256_cmpgt_epi64(bestOffsets, chunkOffsets);
+		__m256i better = _mm256_andnot_si256(tooSmall, lower);
+		bestOffsets = _mm256_blendv_epi8(bestOffsets, chunkOffsets, better);
+		bestPositions = _mm256_blendv_epi8(bestPositions, positions, better);
+		positions = _mm256_add_epi64(positions, step);
+	}
+
+	std::int64_t laneOffsets[LANE_COUNT];
+	std::int64_t lanePositions[LANE_COUNT];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(laneOffsets), bestOffsets);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanePositions), bestPositions);
+	MergeFirstFitLanes(laneOffsets, lanePositions, LANE_COUNT, result);
+
+	return position;
+}
+
+#endif
+
+// Returns the position of the fitting chunk with the lowest offset, or
+// size_t(-1). largestValue bounds every offset, size and alignment involved.
+inline size_t SearchFirstFit(const size_t* offsets, const size_t* sizes, size_t count,
+	size_t dataSize, size_t alignment, size_t largestValue,
+	FirstFitSearchLevel level = GetFirstFitSearchLevel())
+{
+	FirstFitSearchResult result;
+	size_t searched = 0;
+
+#ifdef FIRST_FIT_SEARCH_X64
+	bool vectorizable = largestValue <= FIRST_FIT_MAX_VECTORIZED_VALUE &&
+		alignment <= FIRST_FIT_MAX_VECTORIZED_VALUE &&
+		dataSize <= FIRST_FIT_MAX_VECTORIZED_VALUE;
+
+	if (vectorizable && level == FirstFitSearchLevel::AVX2)
+		searched = SearchFirstFitAVX2(offsets, sizes, count, dataSize, alignment, result);
+	else if (vectorizable && level == FirstFitSearchLevel::SSE4_2)
+		searched = SearchFirstFitSSE42(offsets, sizes, count, dataSize, alignment, result);
+#endif
+
+	SearchFirstFitScalar(offsets, sizes, searched, count, dataSize, alignment, result);
+
+	return result.position;
+}
\ No newline at end of file
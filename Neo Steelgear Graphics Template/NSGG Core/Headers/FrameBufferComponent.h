@@ -1,11 +1,15 @@
 #pragma once
 
 #include <d3d12.h>
+#include <array>
+#include <cstring>
 #include <optional>
 
 #include "FrameResourceComponent.h"
 #include "BufferComponent.h"
 #include "BufferComponentData.h"
+#include "PagedComponentData.h"
+#include "RingBufferUploader.h"
 
 struct BufferCreationOperation
 {
@@ -24,9 +28,28 @@ private:
 
 	size_t bufferSize = 0;
 	size_t bufferAlignment = 0;
-	BufferComponentData componentData;
+	UpdateType updateType = UpdateType::NONE;
+	BufferComponentData componentData; // Static categories
+	PagedComponentData shadowData; // Copy updated categories
+	std::array<DirtyPageTracker, Frames> dirtyPages; // One per frame copy
 
-	void HandleStoredOperations() override;
+	typedef typename FrameResourceComponent<BufferComponent, Frames,
+		BufferCreationOperation>::StoredLifetimeOperation StoredBufferOperation;
+
+	void HandleStoredOperations(const StoredBufferOperation* operations,
+		size_t nrOfOperations) override;
+	bool HasShadowData() const;
+	bool IsMapped() const;
+	void UploadDirtyPages(ID3D12GraphicsCommandList* commandList,
+		ResourceUploader& uploader, RingBufferUploader* ringUploader);
+
+	// Map updated categories have no shadow data. Every frame copy is caught
+	// up with the previous one, which holds the newest data for every page the
+	// active frame has not written itself.
+	void CopyFromPreviousFrame(const ResourceIndex& resourceIndex, size_t offset,
+		size_t size);
+	void MarkDirtyInOtherFrames(const ResourceIndex& resourceIndex, size_t offset,
+		size_t size);
 
 public:
 	FrameBufferComponent() = default;
@@ -38,17 +61,39 @@ public:
 
 	void Initialize(ID3D12Device* deviceToUse, UpdateType componentUpdateType,
 		const BufferComponentInfo& bufferInfo,
-		const std::vector<DescriptorAllocationInfo<BufferViewDesc>>& descriptorInfo);
+		const std::vector<DescriptorAllocationInfo<BufferViewDesc>>& descriptorInfo,
+		size_t dirtyPageSize = 256);
 
 	ResourceIndex CreateBuffer(size_t nrOfElements,
 		const BufferReplacementViews& replacementViews = BufferReplacementViews());
+	// Same as calling CreateBuffer for each, with the stored operations
+	// reserved up front
+	void CreateBuffers(const std::vector<BufferCreationOperation>& buffersToCreate,
+		std::vector<ResourceIndex>& createdIndices);
 
 	void RemoveComponent(const ResourceIndex& indexToRemove) override;
 
 	void SetUpdateData(const ResourceIndex& resourceIndex, void* dataAdress);
+
+	// Only the pages touched by the range are passed on to each frame copy as
+	// it becomes active, instead of the whole buffer. Map updated categories
+	// write the copy of the active frame directly, and the others are copied
+	// from it by PerformUpdates, which has to be called every frame.
+	void SetUpdateDataRange(const ResourceIndex& resourceIndex,
+		const void* dataAdress, size_t offset, size_t size);
+
+	// The shadow data of copy updated categories, null otherwise
+	void* GetUpdateData(const ResourceIndex& resourceIndex);
+
+	// Map updated categories only. Points into the persistently mapped copy of
+	// the active frame, and the whole buffer is passed on to the other frame
+	// copies as for SetUpdateData. Valid until the frame is swapped.
+	void* GetWritePointer(const ResourceIndex& resourceIndex);
 	void PrepareResourcesForUpdates(std::vector<D3D12_RESOURCE_BARRIER>& barriers);
+	// Dirty pages are staged in the ring uploader if one is given, so that
+	// adjacent ranges are coalesced when its copies are recorded
 	void PerformUpdates(ID3D12GraphicsCommandList* commandList,
-		ResourceUploader& uploader);
+		ResourceUploader& uploader, RingBufferUploader* ringUploader = nullptr);
 
 	D3D12_RESOURCE_STATES GetCurrentState();
 	void ChangeToState(std::vector<D3D12_RESOURCE_BARRIER>& barriers,
@@ -62,33 +107,90 @@ public:
 };
 
 template<short Frames>
-inline void FrameBufferComponent<Frames>::HandleStoredOperations()
+inline void FrameBufferComponent<Frames>::HandleStoredOperations(
+	const StoredBufferOperation* operations, size_t nrOfOperations)
 {
-	size_t nrToErase = 0;
-	for (auto& operation : this->storedLifetimeOperations)
+	BufferComponent& activeComponent = this->resourceComponents[this->activeFrame];
+
+	for (size_t i = 0; i < nrOfOperations; ++i)
 	{
+		const StoredBufferOperation& operation = operations[i];
+
 		if (operation.type == BufferLifetimeOperationType::CREATION)
 		{
 			auto& creationData = operation.creation;
-			auto identifier = this->resourceComponents[this->activeFrame].CreateBuffer(
+			auto identifier = activeComponent.CreateBuffer(
 				creationData.nrOfElements, creationData.replacementViews);
 
-			BufferHandle handle =
-				this->resourceComponents[this->activeFrame].GetBufferHandle(identifier);
+			BufferHandle handle = activeComponent.GetBufferHandle(identifier);
 			this->AddInitializationBarrier(handle.resource);
 		}
 		else
 		{
-			this->resourceComponents[this->activeFrame].RemoveComponent(
-				operation.removal.indexToRemove);
+			activeComponent.RemoveComponent(operation.removal.indexToRemove);
 		}
-
-		--operation.framesLeft;
-		nrToErase += operation.framesLeft == 0 ? 1 : 0;
 	}
+}
+
+template<short Frames>
+inline bool FrameBufferComponent<Frames>::HasShadowData() const
+{
+	return updateType == UpdateType::COPY_UPDATE;
+}
+
+template<short Frames>
+inline bool FrameBufferComponent<Frames>::IsMapped() const
+{
+	return updateType == UpdateType::MAP_UPDATE;
+}
+
+template<short Frames>
+inline void FrameBufferComponent<Frames>::UploadDirtyPages(
+	ID3D12GraphicsCommandList* commandList, ResourceUploader& uploader,
+	RingBufferUploader* ringUploader)
+{
+	BufferComponent& activeComponent = this->resourceComponents[this->activeFrame];
+
+	dirtyPages[this->activeFrame].ConsumeDirtyRanges(
+		[&](const ResourceIndex& resourceIndex, size_t offset, size_t size)
+		{
+			unsigned char* source = static_cast<unsigned char*>(
+				shadowData.GetComponentData(resourceIndex)) + offset;
+			BufferHandle handle = activeComponent.GetBufferHandle(resourceIndex);
+			if (ringUploader != nullptr && ringUploader->StageBufferData(handle.resource,
+				source, handle.startOffset + offset, size, bufferAlignment))
+			{
+				return;
+			}
+
+			if (!uploader.UploadBufferResourceData(handle.resource, commandList,
+				source, handle.startOffset + offset, size, bufferAlignment))
+			{
+				throw std::runtime_error("Error: Could not upload dirty buffer range");
+			}
+		});
+}
+
+template<short Frames>
+inline void FrameBufferComponent<Frames>::CopyFromPreviousFrame(
+	const ResourceIndex& resourceIndex, size_t offset, size_t size)
+{
+	FrameType previousFrame = (this->activeFrame + Frames - 1) % Frames;
+	std::memcpy(
+		this->resourceComponents[this->activeFrame].GetMappedPtr(resourceIndex) + offset,
+		this->resourceComponents[previousFrame].GetMappedPtr(resourceIndex) + offset,
+		size);
+}
 
-	this->storedLifetimeOperations.erase(this->storedLifetimeOperations.begin(),
-		this->storedLifetimeOperations.begin() + nrToErase);
+template<short Frames>
+inline void FrameBufferComponent<Frames>::MarkDirtyInOtherFrames(
+	const ResourceIndex& resourceIndex, size_t offset, size_t size)
+{
+	for (FrameType i = 1; i < Frames; ++i)
+	{
+		dirtyPages[(this->activeFrame + i) % Frames].MarkDirty(resourceIndex,
+			offset, size);
+	}
 }
 
 template<short Frames>
@@ -96,7 +198,8 @@ inline FrameBufferComponent<Frames>::FrameBufferComponent(
 	FrameBufferComponent&& other) noexcept : FrameResourceComponent<
 	BufferComponent, Frames, BufferCreationOperation>(std::move(other)),
 	bufferSize(other.bufferSize), bufferAlignment(other.bufferAlignment),
-	componentData(std::move(other.componentData))
+	updateType(other.updateType), componentData(std::move(other.componentData)),
+	shadowData(std::move(other.shadowData)), dirtyPages(std::move(other.dirtyPages))
 {
 	other.bufferSize = 0;
 	other.bufferAlignment = 0;
@@ -112,7 +215,10 @@ inline FrameBufferComponent<Frames>& FrameBufferComponent<Frames>::operator=(
 			Frames, BufferCreationOperation>::operator=(std::move(other));
 		bufferSize = other.bufferSize;
 		bufferAlignment = other.bufferAlignment;
+		updateType = other.updateType;
 		componentData = std::move(other.componentData);
+		shadowData = std::move(other.shadowData);
+		dirtyPages = std::move(other.dirtyPages);
 
 		other.bufferSize = 0;
 		other.bufferAlignment = 0;
@@ -124,24 +230,26 @@ inline FrameBufferComponent<Frames>& FrameBufferComponent<Frames>::operator=(
 template<short Frames>
 inline void FrameBufferComponent<Frames>::Initialize(ID3D12Device* deviceToUse,
 	UpdateType componentUpdateType, const BufferComponentInfo& bufferInfo,
-	const std::vector<DescriptorAllocationInfo<BufferViewDesc>>& descriptorInfo)
+	const std::vector<DescriptorAllocationInfo<BufferViewDesc>>& descriptorInfo,
+	size_t dirtyPageSize)
 {
 	FrameResourceComponent<BufferComponent, Frames,
 		BufferCreationOperation>::Initialize(deviceToUse, bufferInfo, descriptorInfo);
 	bufferSize = bufferInfo.bufferInfo.elementSize;
 	bufferAlignment = bufferInfo.bufferInfo.alignment;
-	if (componentUpdateType != UpdateType::INITIALISE_ONLY &&
-		componentUpdateType != UpdateType::NONE)
-	{
-		unsigned int initialSize =
-			static_cast<unsigned int>(bufferInfo.memoryInfo.initialMinimumHeapSize);
-		unsigned int expansionSize =
-			static_cast<unsigned int>(bufferInfo.memoryInfo.expansionMinimumSize);
+	updateType = componentUpdateType;
+
+	for (DirtyPageTracker& tracker : dirtyPages)
+		tracker.Initialize(dirtyPageSize);
 
-		this->componentData.Initialize(deviceToUse, Frames, 
-			componentUpdateType, initialSize, expansionSize);
+	// Copy updated categories keep their shadow data in pages that are never
+	// compacted, whole and ranged updates both go through the dirty pages.
+	// Map updated categories are written in place and only use the pages.
+	if (HasShadowData())
+	{
+		shadowData.Initialize();
 	}
-	else
+	else if (!IsMapped())
 	{
 		this->componentData.Initialize(deviceToUse, Frames,
 			componentUpdateType, 0, 0);
@@ -158,28 +266,62 @@ inline ResourceIndex FrameBufferComponent<Frames>::CreateBuffer(
 
 	if constexpr (Frames != 1)
 	{
-		typename FrameResourceComponent<BufferComponent, Frames,
-			BufferCreationOperation>::StoredLifetimeOperation lifetimeOperation;
+		StoredBufferOperation lifetimeOperation;
 		lifetimeOperation.type = BufferLifetimeOperationType::CREATION;
-		lifetimeOperation.framesLeft = Frames - 1;
 		lifetimeOperation.creation = { nrOfElements, replacementViews };
-		this->storedLifetimeOperations.push_back(lifetimeOperation);
+		this->StoreLifetimeOperation(lifetimeOperation);
 	}
 
 	BufferHandle handle =
 		this->resourceComponents[this->activeFrame].GetBufferHandle(toReturn);
 	this->AddInitializationBarrier(handle.resource);
-	this->componentData.AddComponent(toReturn, handle.startOffset,
-		static_cast<unsigned int>(nrOfElements * bufferSize));
+
+	if (HasShadowData())
+		shadowData.AddComponent(toReturn, nrOfElements * bufferSize);
+
+	if (HasShadowData() || IsMapped())
+	{
+		for (DirtyPageTracker& tracker : dirtyPages)
+			tracker.Track(toReturn, nrOfElements * bufferSize);
+	}
+	else
+	{
+		this->componentData.AddComponent(toReturn, handle.startOffset,
+			static_cast<unsigned int>(nrOfElements * bufferSize));
+	}
 
 	return toReturn;
 }
 
+template<short Frames>
+inline void FrameBufferComponent<Frames>::CreateBuffers(
+	const std::vector<BufferCreationOperation>& buffersToCreate,
+	std::vector<ResourceIndex>& createdIndices)
+{
+	this->ReserveLifetimeOperations(buffersToCreate.size());
+	createdIndices.reserve(createdIndices.size() + buffersToCreate.size());
+
+	for (const BufferCreationOperation& buffer : buffersToCreate)
+		createdIndices.push_back(CreateBuffer(buffer.nrOfElements, buffer.replacementViews));
+}
+
 template<short Frames>
 inline void FrameBufferComponent<Frames>::RemoveComponent(
 	const ResourceIndex& indexToRemove)
 {
-	componentData.RemoveComponent(indexToRemove);
+	if (HasShadowData())
+		shadowData.RemoveComponent(indexToRemove);
+
+	if (HasShadowData() || IsMapped())
+	{
+		for (DirtyPageTracker& tracker : dirtyPages)
+			tracker.Untrack(indexToRemove);
+	}
+	else
+	{
+		componentData.RemoveComponent(indexToRemove);
+	}
+
 	FrameResourceComponent<BufferComponent, Frames,
 		BufferCreationOperation>::RemoveComponent(indexToRemove);
 }
@@ -188,23 +330,142 @@ template<short Frames>
 inline void FrameBufferComponent<Frames>::SetUpdateData(
 	const ResourceIndex& resourceIndex, void* dataAdress)
 {
-	this->componentData.UpdateComponentData(resourceIndex, dataAdress);
+	if (HasShadowData())
+	{
+		SetUpdateDataRange(resourceIndex, dataAdress, 0,
+			shadowData.GetComponentDataSize(resourceIndex));
+	}
+	else if (IsMapped())
+	{
+		BufferHandle handle =
+			this->resourceComponents[this->activeFrame].GetBufferHandle(resourceIndex);
+		SetUpdateDataRange(resourceIndex, dataAdress, 0,
+			handle.nrOfElements * bufferSize);
+	}
+	else
+	{
+		this->componentData.UpdateComponentData(resourceIndex, dataAdress);
+	}
+}
+
+template<short Frames>
+inline void FrameBufferComponent<Frames>::SetUpdateDataRange(
+	const ResourceIndex& resourceIndex, const void* dataAdress, size_t offset,
+	size_t size)
+{
+	if (IsMapped())
+	{
+		// Pages written in other frames are caught up first, apart from the
+		// bytes about to be overwritten
+		dirtyPages[this->activeFrame].ConsumeDirtyRanges(resourceIndex, offset, size,
+			[&](const ResourceIndex&, size_t pagesOffset, size_t pagesSize)
+			{
+				if (pagesOffset < offset)
+					CopyFromPreviousFrame(resourceIndex, pagesOffset, offset - pagesOffset);
+
+				if (pagesOffset + pagesSize > offset + size)
+				{
+					CopyFromPreviousFrame(resourceIndex, offset + size,
+						pagesOffset + pagesSize - (offset + size));
+				}
+			});
+
+		unsigned char* destination =
+			this->resourceComponents[this->activeFrame].GetMappedPtr(resourceIndex);
+		std::memcpy(destination + offset, dataAdress, size);
+		MarkDirtyInOtherFrames(resourceIndex, offset, size);
+		return;
+	}
+
+	if (!HasShadowData())
+		throw std::runtime_error("Error: Ranged updates need an updateable category");
+
+	for (DirtyPageTracker& tracker : dirtyPages)
+		tracker.MarkDirty(resourceIndex, offset, size);
+
+	// The shadow data is written directly, the pages are what gets uploaded
+	unsigned char* destination = static_cast<unsigned char*>(
+		shadowData.GetComponentData(resourceIndex));
+	std::memcpy(destination + offset, dataAdress, size);
+}
+
+template<short Frames>
+inline void* FrameBufferComponent<Frames>::GetUpdateData(
+	const ResourceIndex& resourceIndex)
+{
+	return HasShadowData() ? shadowData.GetComponentData(resourceIndex) : nullptr;
+}
+
+template<short Frames>
+inline void* FrameBufferComponent<Frames>::GetWritePointer(
+	const ResourceIndex& resourceIndex)
+{
+	if (!IsMapped())
+		throw std::runtime_error("Error: Only map updated buffers can be written in place");
+
+	// What the caller writes is unknown, so the whole buffer is caught up and
+	// passed on
+	BufferComponent& activeComponent = this->resourceComponents[this->activeFrame];
+	size_t dataSize = activeComponent.GetBufferHandle(resourceIndex).nrOfElements *
+		bufferSize;
+	dirtyPages[this->activeFrame].ConsumeDirtyRanges(resourceIndex, 0, dataSize,
+		[&](const ResourceIndex&, size_t offset, size_t size)
+		{
+			CopyFromPreviousFrame(resourceIndex, offset, size);
+		});
+
+	MarkDirtyInOtherFrames(resourceIndex, 0, dataSize);
+	return activeComponent.GetMappedPtr(resourceIndex);
 }
 
 template<short Frames>
 inline void FrameBufferComponent<Frames>::PrepareResourcesForUpdates(
 	std::vector<D3D12_RESOURCE_BARRIER>& barriers)
 {
-	this->componentData.PrepareUpdates(barriers,
-		this->resourceComponents[this->activeFrame]);
+	if (IsMapped())
+		return;
+
+	if (!HasShadowData())
+	{
+		this->componentData.PrepareUpdates(barriers,
+			this->resourceComponents[this->activeFrame]);
+		return;
+	}
+
+	BufferComponent& activeComponent = this->resourceComponents[this->activeFrame];
+	if (updateType == UpdateType::COPY_UPDATE &&
+		dirtyPages[this->activeFrame].HasDirtyPages() &&
+		activeComponent.GetCurrentState() != D3D12_RESOURCE_STATE_COPY_DEST)
+	{
+		activeComponent.CreateTransitionBarrier(D3D12_RESOURCE_STATE_COPY_DEST,
+			barriers);
+	}
 }
 
 template<short Frames>
 inline void FrameBufferComponent<Frames>::PerformUpdates(
-	ID3D12GraphicsCommandList* commandList, ResourceUploader& uploader)
+	ID3D12GraphicsCommandList* commandList, ResourceUploader& uploader,
+	RingBufferUploader* ringUploader)
 {
-	this->componentData.UpdateComponentResources(commandList, uploader,
-		this->resourceComponents[this->activeFrame], bufferAlignment);
+	if (HasShadowData())
+	{
+		UploadDirtyPages(commandList, uploader, ringUploader);
+	}
+	else if (IsMapped())
+	{
+		// Whatever the active frame has not written itself is taken from the
+		// previous frame, before the GPU reads this copy
+		dirtyPages[this->activeFrame].ConsumeDirtyRanges(
+			[&](const ResourceIndex& resourceIndex, size_t offset, size_t size)
+			{
+				CopyFromPreviousFrame(resourceIndex, offset, size);
+			});
+	}
+	else
+	{
+		this->componentData.UpdateComponentResources(commandList, uploader,
+			this->resourceComponents[this->activeFrame], bufferAlignment);
+	}
 }
 
 template<short Frames>
@@ -25,18 +25,19 @@ protected:
 		REMOVAL
 	};
 
+	struct RemovalOperation
+	{
+		ResourceIndex indexToRemove;
+	};
+
 	struct StoredLifetimeOperation
 	{
 		LifetimeOperationType type;
-		std::uint8_t framesLeft;
 
 		union
 		{
 			CreationOperation creation;
-			struct RemovalOperation
-			{
-				ResourceIndex indexToRemove;
-			} removal;
+			RemovalOperation removal;
 		};
 
 		StoredLifetimeOperation()
@@ -45,11 +46,18 @@ protected:
 		}
 	};
 
-	std::vector<StoredLifetimeOperation> storedLifetimeOperations;
+	// The operations performed while each frame copy was active. When a copy
+	// becomes active it replays the batches of the other copies, oldest
+	// first, and the batch it recorded itself has then been replayed by every
+	// other copy and is retired by clearing it.
+	std::array<std::vector<StoredLifetimeOperation>, Frames> storedLifetimeOperations;
 	std::vector<D3D12_RESOURCE_BARRIER> initializationBarriers;
 
 	void AddInitializationBarrier(ID3D12Resource* resource);
-	virtual void HandleStoredOperations() = 0;
+	void StoreLifetimeOperation(const StoredLifetimeOperation& operation);
+	void ReserveLifetimeOperations(size_t nrOfOperations);
+	virtual void HandleStoredOperations(const StoredLifetimeOperation* operations,
+		size_t nrOfOperations) = 0;
 
 public:
 	FrameResourceComponent() = default;
@@ -64,6 +72,11 @@ public:
 
 	void RemoveComponent(const ResourceIndex& indexToRemove) override;
 
+	// Goes through RemoveComponent, so derived components clean up their own
+	// data. Only the stored operations are reserved up front, each frame copy
+	// still removes the components one at a time.
+	void RemoveComponents(const std::vector<ResourceIndex>& indicesToRemove);
+
 	void GetInitializationBarriers(std::vector<D3D12_RESOURCE_BARRIER>& toAddTo);
 
 	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapCBV() const override;
@@ -76,6 +89,9 @@ public:
 
 	size_t NrOfDescriptors() const override;
 
+	// Accumulated over the copies of every frame
+	AllocatorStatistics GetStatistics() const;
+
 	void SwapFrame() override;
 };
 
@@ -93,6 +109,28 @@ FrameResourceComponent<Component, Frames, CreationOperation>::AddInitializationB
 	initializationBarriers.push_back(toAdd);
 }
 
+template<typename Component, FrameType Frames, typename CreationOperation>
+inline void
+FrameResourceComponent<Component, Frames, CreationOperation>::StoreLifetimeOperation(
+	const StoredLifetimeOperation& operation)
+{
+	if constexpr (Frames != 1)
+		storedLifetimeOperations[this->activeFrame].push_back(operation);
+}
+
+template<typename Component, FrameType Frames, typename CreationOperation>
+inline void
+FrameResourceComponent<Component, Frames, CreationOperation>::ReserveLifetimeOperations(
+	size_t nrOfOperations)
+{
+	if constexpr (Frames != 1)
+	{
+		std::vector<StoredLifetimeOperation>& batch =
+			storedLifetimeOperations[this->activeFrame];
+		batch.reserve(batch.size() + nrOfOperations);
+	}
+}
+
 template<typename Component, FrameType Frames, typename CreationOperation>
 template<typename ...InitialisationArguments>
 inline void 
@@ -141,12 +179,22 @@ FrameResourceComponent<Component, Frames, CreationOperation>::RemoveComponent(
 	{
 		StoredLifetimeOperation toStore;
 		toStore.type = LifetimeOperationType::REMOVAL;
-		toStore.framesLeft = Frames - 1;
 		toStore.removal.indexToRemove = indexToRemove;
-		storedLifetimeOperations.push_back(toStore);
+		StoreLifetimeOperation(toStore);
 	}
 }
 
+template<typename Component, FrameType Frames, typename CreationOperation>
+inline void
+FrameResourceComponent<Component, Frames, CreationOperation>::RemoveComponents(
+	const std::vector<ResourceIndex>& indicesToRemove)
+{
+	ReserveLifetimeOperations(indicesToRemove.size());
+
+	for (const ResourceIndex& indexToRemove : indicesToRemove)
+		RemoveComponent(indexToRemove);
+}
+
 template<typename Component, FrameType Frames, typename CreationOperation>
 inline void 
 FrameResourceComponent<Component, Frames, CreationOperation>::GetInitializationBarriers(
@@ -206,10 +254,32 @@ inline size_t FrameResourceComponent<Component, Frames, CreationOperation>::NrOf
 	return resourceComponents[this->activeFrame].NrOfDescriptors();
 }
 
+template<typename Component, FrameType Frames, typename CreationOperation>
+inline AllocatorStatistics
+FrameResourceComponent<Component, Frames, CreationOperation>::GetStatistics() const
+{
+	AllocatorStatistics toReturn;
+
+	for (const Component& component : resourceComponents)
+		toReturn.Accumulate(component.GetStatistics());
+
+	return toReturn;
+}
+
 template<typename Component, FrameType Frames, typename CreationOperation>
 inline void 
 FrameResourceComponent<Component, Frames, CreationOperation>::SwapFrame()
 {
 	FrameBased<Frames>::SwapFrame();
-	HandleStoredOperations();
+
+	for (FrameType i = 1; i < Frames; ++i)
+	{
+		const std::vector<StoredLifetimeOperation>& batch =
+			storedLifetimeOperations[(this->activeFrame + i) % Frames];
+
+		if (!batch.empty())
+			HandleStoredOperations(batch.data(), batch.size());
+	}
+
+	storedLifetimeOperations[this->activeFrame].clear();
 }
\ No newline at end of file
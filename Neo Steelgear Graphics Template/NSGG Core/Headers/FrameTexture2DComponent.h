@@ -33,7 +33,11 @@ private:
 	DXGI_FORMAT textureFormat = DXGI_FORMAT_UNKNOWN;
 	Texture2DComponentData componentData;
 
-	void HandleStoredOperations() override;
+	typedef typename FrameResourceComponent<Texture2DComponent, Frames,
+		Texture2DCreationOperation>::StoredLifetimeOperation StoredTexture2DOperation;
+
+	void HandleStoredOperations(const StoredTexture2DOperation* operations,
+		size_t nrOfOperations) override;
 
 public:
 	FrameTexture2DComponent() = default;
@@ -51,6 +55,10 @@ public:
 		size_t mipLevels = 1, std::uint8_t sampleCount = 1,
 		std::uint8_t sampleQuality = 0, D3D12_CLEAR_VALUE* clearValue = nullptr,
 		const Texture2DComponentTemplate::TextureReplacementViews& replacementViews = {});
+	// Same as calling CreateTexture for each, with the stored operations
+	// reserved up front
+	void CreateTextures(const std::vector<Texture2DCreationOperation>& texturesToCreate,
+		std::vector<ResourceIndex>& createdIndices);
 
 	void RemoveComponent(const ResourceIndex& indexToRemove) override;
 
@@ -74,37 +82,33 @@ public:
 };
 
 template<FrameType Frames>
-inline void FrameTexture2DComponent<Frames>::HandleStoredOperations()
+inline void FrameTexture2DComponent<Frames>::HandleStoredOperations(
+	const StoredTexture2DOperation* operations, size_t nrOfOperations)
 {
-	size_t nrToErase = 0;
-	for (auto& operation : this->storedLifetimeOperations)
+	Texture2DComponent& activeComponent = this->resourceComponents[this->activeFrame];
+
+	for (size_t i = 0; i < nrOfOperations; ++i)
 	{
+		const StoredTexture2DOperation& operation = operations[i];
+
 		if (operation.type == Texture2DLifetimeOperationType::CREATION)
 		{
 			Texture2DCreationOperation creationInfo = operation.creation;
-			auto identifier = this->resourceComponents[this->activeFrame].CreateTexture(
+			auto identifier = activeComponent.CreateTexture(
 				creationInfo.width, creationInfo.height, 
 				creationInfo.arraySize, creationInfo.mipLevels,
 				creationInfo.sampleCount, creationInfo.sampleQuality,
 				creationInfo.clearValue.has_value() ? &(*creationInfo.clearValue) : nullptr,
 				creationInfo.replacementViews);
 
-			TextureHandle handle =
-				this->resourceComponents[this->activeFrame].GetTextureHandle(identifier);
+			TextureHandle handle = activeComponent.GetTextureHandle(identifier);
 			this->AddInitializationBarrier(handle.resource);
 		}
 		else
 		{
-			this->resourceComponents[this->activeFrame].RemoveComponent(
-				operation.removal.indexToRemove);
+			activeComponent.RemoveComponent(operation.removal.indexToRemove);
 		}
-
-		--operation.framesLeft;
-		nrToErase += operation.framesLeft == 0 ? 1 : 0;
 	}
-
-	this->storedLifetimeOperations.erase(this->storedLifetimeOperations.begin(),
-		this->storedLifetimeOperations.begin() + nrToErase);
 }
 
 template<FrameType Frames>
@@ -184,10 +188,8 @@ inline ResourceIndex FrameTexture2DComponent<Frames>::CreateTexture(
 
 	if constexpr (Frames != 1)
 	{
-		typename FrameResourceComponent<Texture2DComponent, Frames,
-			Texture2DCreationOperation>::StoredLifetimeOperation lifetimeOperation;
+		StoredTexture2DOperation lifetimeOperation;
 		lifetimeOperation.type = Texture2DLifetimeOperationType::CREATION;
-		lifetimeOperation.framesLeft = Frames - 1;
 		lifetimeOperation.creation.width = width; 
 		lifetimeOperation.creation.height = height;
 		lifetimeOperation.creation.arraySize = arraySize;
@@ -198,7 +200,7 @@ inline ResourceIndex FrameTexture2DComponent<Frames>::CreateTexture(
 			(clearValue == nullptr ? std::nullopt :
 				std::make_optional(*clearValue));
 		lifetimeOperation.creation.replacementViews = replacementViews;
-		this->storedLifetimeOperations.push_back(lifetimeOperation);
+		this->StoreLifetimeOperation(lifetimeOperation);
 	}
 
 	TextureHandle handle = 
@@ -232,6 +234,24 @@ inline ResourceIndex FrameTexture2DComponent<Frames>::CreateTexture(
 	return toReturn;
 }
 
+template<FrameType Frames>
+inline void FrameTexture2DComponent<Frames>::CreateTextures(
+	const std::vector<Texture2DCreationOperation>& texturesToCreate,
+	std::vector<ResourceIndex>& createdIndices)
+{
+	this->ReserveLifetimeOperations(texturesToCreate.size());
+	createdIndices.reserve(createdIndices.size() + texturesToCreate.size());
+
+	for (Texture2DCreationOperation texture : texturesToCreate)
+	{
+		createdIndices.push_back(CreateTexture(texture.width, texture.height,
+			texture.arraySize, texture.mipLevels, texture.sampleCount,
+			texture.sampleQuality,
+			texture.clearValue.has_value() ? &(*texture.clearValue) : nullptr,
+			texture.replacementViews));
+	}
+}
+
 template<FrameType Frames>
 inline void FrameTexture2DComponent<Frames>::RemoveComponent(
 	const ResourceIndex& indexToRemove)
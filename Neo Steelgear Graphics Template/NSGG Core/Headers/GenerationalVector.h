@@ -0,0 +1,403 @@
+#pragma once
+
+#include <vector>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+
+// StableVector with a generation per slot, packed into handles so that stale
+// use after Remove and a new Add can be detected, and an occupancy bitmap for
+// iterating only the active slots. StableVector is embedded in classes
+// compiled into the prebuilt library and has to keep its layout.
+template<typename T>
+class GenerationalVector
+{
+private:
+	static constexpr size_t HANDLE_INDEX_BITS = 40;
+	static constexpr size_t HANDLE_INDEX_MASK = (size_t(1) << HANDLE_INDEX_BITS) - 1;
+	static constexpr std::uint32_t GENERATION_MASK =
+		(std::uint32_t(1) << (64 - HANDLE_INDEX_BITS)) - 1;
+
+	std::vector<T> elements;
+	std::vector<size_t> nextFree;
+	std::vector<size_t> previousFree;
+	std::vector<std::uint32_t> generations;
+	std::vector<std::uint64_t> occupancy;
+	size_t firstFree = size_t(-1);
+	size_t firstUnlinked = 0; // Slots from here to the end are free but not linked
+	size_t nrOfActive = 0;
+
+	void Resize(size_t newSize);
+	void SetActive(size_t index, bool active);
+	void LinkFree(size_t index);
+	void UnlinkFree(size_t index);
+	size_t GetFreeIndex();
+
+public:
+	GenerationalVector() = default;
+	~GenerationalVector() = default;
+	GenerationalVector(const GenerationalVector& other) = delete;
+	GenerationalVector& operator=(const GenerationalVector& other) = delete;
+	GenerationalVector(GenerationalVector&& other) noexcept;
+	GenerationalVector& operator=(GenerationalVector&& other) noexcept;
+
+	size_t Add(const T& element);
+	size_t Add(T&& element);
+	// The index may be past TotalSize, the vector then grows to include it
+	size_t AddAt(const T& element, size_t index);
+	size_t AddAt(T&& element, size_t index);
+	void Remove(size_t index);
+
+	T& operator[](size_t index);
+	const T& operator[](size_t index) const;
+
+	size_t ActiveSize() const;
+	size_t TotalSize() const;
+	// Differs from StableVector, where Add hands out slots created by Expand
+	// first and from the highest index down. Here slots freed by Remove are
+	// reused first, then the expanded slots follow in ascending order.
+	void Expand(size_t newSize);
+	void Reserve(size_t capacity);
+	bool CheckIfActive(size_t index) const;
+	size_t NextActive(size_t index) const;
+
+	template<typename Function>
+	void ForEachActive(Function function);
+
+	// Handles pack the slot generation above the index to detect stale use
+	size_t GetHandle(size_t index) const;
+	static size_t GetIndexFromHandle(size_t handle);
+	bool CheckIfValid(size_t handle) const;
+	T& Get(size_t handle);
+	const T& Get(size_t handle) const;
+
+	void Clear();
+};
+
+template<typename T>
+inline void GenerationalVector<T>::Resize(size_t newSize)
+{
+	elements.resize(newSize);
+	nextFree.resize(newSize, size_t(-1));
+	previousFree.resize(newSize, size_t(-1));
+	generations.resize(newSize, 0);
+	occupancy.resize((newSize + 63) / 64, 0);
+}
+
+template<typename T>
+inline void GenerationalVector<T>::SetActive(size_t index, bool active)
+{
+	std::uint64_t bit = std::uint64_t(1) << (index % 64);
+
+	if (active)
+		occupancy[index / 64] |= bit;
+	else
+		occupancy[index / 64] &= ~bit;
+}
+
+template<typename T>
+inline void GenerationalVector<T>::LinkFree(size_t index)
+{
+	nextFree[index] = firstFree;
+	previousFree[index] = size_t(-1);
+
+	if (firstFree != size_t(-1))
+		previousFree[firstFree] = index;
+
+	firstFree = index;
+}
+
+template<typename T>
+inline void GenerationalVector<T>::UnlinkFree(size_t index)
+{
+	if (index >= firstUnlinked)
+	{
+		// Slots skipped over in the unlinked tail are moved to the free list
+		for (size_t i = firstUnlinked; i < index; ++i)
+			LinkFree(i);
+
+		firstUnlinked = index + 1;
+		return;
+	}
+
+	size_t previousIndex = previousFree[index];
+	size_t nextIndex = nextFree[index];
+
+	if (previousIndex != size_t(-1))
+		nextFree[previousIndex] = nextIndex;
+	else
+		firstFree = nextIndex;
+
+	if (nextIndex != size_t(-1))
+		previousFree[nextIndex] = previousIndex;
+
+	nextFree[index] = size_t(-1);
+	previousFree[index] = size_t(-1);
+}
+
+template<typename T>
+inline size_t GenerationalVector<T>::GetFreeIndex()
+{
+	size_t toReturn = firstFree;
+
+	if (toReturn != size_t(-1))
+	{
+		UnlinkFree(toReturn);
+	}
+	else if (firstUnlinked < elements.size())
+	{
+		toReturn = firstUnlinked++;
+	}
+	else
+	{
+		toReturn = elements.size();
+		Resize(toReturn + 1);
+		firstUnlinked = toReturn + 1;
+	}
+
+	SetActive(toReturn, true);
+	++nrOfActive;
+
+	return toReturn;
+}
+
+template<typename T>
+inline GenerationalVector<T>::GenerationalVector(GenerationalVector&& other) noexcept :
+	elements(std::move(other.elements)), nextFree(std::move(other.nextFree)),
+	previousFree(std::move(other.previousFree)),
+	generations(std::move(other.generations)),
+	occupancy(std::move(other.occupancy)), firstFree(other.firstFree),
+	firstUnlinked(other.firstUnlinked), nrOfActive(other.nrOfActive)
+{
+	other.firstFree = size_t(-1);
+	other.firstUnlinked = 0;
+	other.nrOfActive = 0;
+}
+
+template<typename T>
+inline GenerationalVector<T>& GenerationalVector<T>::operator=(GenerationalVector&& other) noexcept
+{
+	if (this != &other)
+	{
+		elements = std::move(other.elements);
+		nextFree = std::move(other.nextFree);
+		previousFree = std::move(other.previousFree);
+		generations = std::move(other.generations);
+		occupancy = std::move(other.occupancy);
+		firstFree = other.firstFree;
+		other.firstFree = size_t(-1);
+		firstUnlinked = other.firstUnlinked;
+		other.firstUnlinked = 0;
+		nrOfActive = other.nrOfActive;
+		other.nrOfActive = 0;
+	}
+
+	return *this;
+}
+
+template<typename T>
+inline size_t GenerationalVector<T>::Add(const T& element)
+{
+	size_t toReturn = GetFreeIndex();
+	elements[toReturn] = element;
+
+	return toReturn;
+}
+
+template<typename T>
+inline size_t GenerationalVector<T>::Add(T&& element)
+{
+	size_t toReturn = GetFreeIndex();
+	elements[toReturn] = std::move(element);
+
+	return toReturn;
+}
+
+template<typename T>
+inline size_t GenerationalVector<T>::AddAt(const T& element, size_t index)
+{
+	if (index >= elements.size())
+		Resize(index + 1);
+
+	if (CheckIfActive(index))
+	{
+		++generations[index];
+	}
+	else
+	{
+		UnlinkFree(index);
+		SetActive(index, true);
+		++nrOfActive;
+	}
+
+	elements[index] = element;
+
+	return index;
+}
+
+template<typename T>
+inline size_t GenerationalVector<T>::AddAt(T&& element, size_t index)
+{
+	if (index >= elements.size())
+		Resize(index + 1);
+
+	if (CheckIfActive(index))
+	{
+		++generations[index];
+	}
+	else
+	{
+		UnlinkFree(index);
+		SetActive(index, true);
+		++nrOfActive;
+	}
+
+	elements[index] = std::move(element);
+
+	return index;
+}
+
+template<typename T>
+inline void GenerationalVector<T>::Remove(size_t index)
+{
+	LinkFree(index);
+	SetActive(index, false);
+	++generations[index];
+	--nrOfActive;
+}
+
+template<typename T>
+inline T& GenerationalVector<T>::operator[](size_t index)
+{
+	return elements[index];
+}
+
+template<typename T>
+inline const T& GenerationalVector<T>::operator[](size_t index) const
+{
+	return elements[index];
+}
+
+template<typename T>
+inline size_t GenerationalVector<T>::ActiveSize() const
+{
+	return nrOfActive;
+}
+
+template<typename T>
+inline size_t GenerationalVector<T>::TotalSize() const
+{
+	return elements.size();
+}
+
+template<typename T>
+inline void GenerationalVector<T>::Expand(size_t newSize)
+{
+	if (newSize <= elements.size())
+		return;
+
+	// The new slots join the unlinked tail, no free list entries are written
+	Resize(newSize);
+}
+
+template<typename T>
+inline void GenerationalVector<T>::Reserve(size_t capacity)
+{
+	elements.reserve(capacity);
+	nextFree.reserve(capacity);
+	previousFree.reserve(capacity);
+	generations.reserve(capacity);
+	occupancy.reserve((capacity + 63) / 64);
+}
+
+template<typename T>
+inline bool GenerationalVector<T>::CheckIfActive(size_t index) const
+{
+	return (occupancy[index / 64] >> (index % 64)) & 1;
+}
+
+template<typename T>
+inline size_t GenerationalVector<T>::NextActive(size_t index) const
+{
+	size_t wordIndex = index / 64;
+
+	if (wordIndex >= occupancy.size())
+		return elements.size();
+
+	std::uint64_t word = occupancy[wordIndex] & (~std::uint64_t(0) << (index % 64));
+
+	while (word == 0)
+	{
+		if (++wordIndex == occupancy.size())
+			return elements.size();
+
+		word = occupancy[wordIndex];
+	}
+
+	return wordIndex * 64 + std::countr_zero(word);
+}
+
+template<typename T>
+template<typename Function>
+inline void GenerationalVector<T>::ForEachActive(Function function)
+{
+	for (size_t i = NextActive(0); i < elements.size(); i = NextActive(i + 1))
+		function(i, elements[i]);
+}
+
+template<typename T>
+inline size_t GenerationalVector<T>::GetHandle(size_t index) const
+{
+	size_t generation = generations[index] & GENERATION_MASK;
+	return (generation << HANDLE_INDEX_BITS) | index;
+}
+
+template<typename T>
+inline size_t GenerationalVector<T>::GetIndexFromHandle(size_t handle)
+{
+	return handle & HANDLE_INDEX_MASK;
+}
+
+template<typename T>
+inline bool GenerationalVector<T>::CheckIfValid(size_t handle) const
+{
+	size_t index = GetIndexFromHandle(handle);
+
+	return index < elements.size() && CheckIfActive(index) &&
+		GetHandle(index) == handle;
+}
+
+template<typename T>
+inline T& GenerationalVector<T>::Get(size_t handle)
+{
+#ifdef _DEBUG
+	if (!CheckIfValid(handle))
+		throw std::runtime_error("Error: Stale or invalid generational vector handle");
+#endif
+
+	return elements[GetIndexFromHandle(handle)];
+}
+
+template<typename T>
+inline const T& GenerationalVector<T>::Get(size_t handle) const
+{
+#ifdef _DEBUG
+	if (!CheckIfValid(handle))
+		throw std::runtime_error("Error: Stale or invalid generational vector handle");
+#endif
+
+	return elements[GetIndexFromHandle(handle)];
+}
+
+template<typename T>
+inline void GenerationalVector<T>::Clear()
+{
+	firstFree = size_t(-1);
+	firstUnlinked = 0;
+	nrOfActive = 0;
+	elements.clear();
+	nextFree.clear();
+	previousFree.clear();
+	generations.clear();
+	occupancy.clear();
+}
\ No newline at end of file
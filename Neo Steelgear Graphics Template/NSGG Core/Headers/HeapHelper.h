@@ -69,6 +69,7 @@ public:
 	const T& operator[](size_t index) const;
 
 	size_t GetStartOfChunk(size_t index) const;
+	size_t GetSizeOfChunk(size_t index) const; // The size it was allocated with
 	size_t TotalSize() const;
 	size_t NrOfAllocatedChunks() const;
 	size_t GetCurrentMaxIndex() const;
@@ -376,6 +377,12 @@ inline size_t HeapHelper<T>::GetStartOfChunk(size_t index) const
 	return chunks[index].startOffset;
 }
 
+template<typename T>
+inline size_t HeapHelper<T>::GetSizeOfChunk(size_t index) const
+{
+	return chunks[index].chunkSize;
+}
+
 template<typename T>
 inline size_t HeapHelper<T>::TotalSize() const
 {
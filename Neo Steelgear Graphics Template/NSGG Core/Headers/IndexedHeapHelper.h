@@ -0,0 +1,890 @@
+#pragma once
+
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+#include <set>
+#include <vector>
+#include <bit>
+#include <cstdint>
+
+#include "GenerationalVector.h"
+#include "FirstFitSearch.h"
+#include "HeapHelper.h"
+#include "AllocatorStatistics.h"
+
+// AllocationStrategy is shared with the library, so strategies only
+// IndexedHeapHelper supports are added in an enum of its own. The values up
+// to WORST_FIT match those of AllocationStrategy.
+enum class IndexedAllocationStrategy
+{
+	FIRST_FIT,
+	BEST_FIT,
+	WORST_FIT,
+	TLSF // Two-level segregated fit, bounded time allocation and deallocation
+};
+
+// HeapHelper with its free chunks indexed, so allocating and freeing does not
+// scan every chunk. HeapHelper itself is embedded in classes compiled into the
+// prebuilt library and has to keep its layout, this is for header code.
+template<typename T>
+class IndexedHeapHelper
+{
+private:
+
+	enum class ChunkStatus : std::uint8_t
+	{
+		AVAILABLE,
+		OCCUPIED
+	};
+
+	// Only the fields used while searching and merging, the user data of
+	// each chunk lives in the parallel chunkData vector
+	struct Chunk
+	{
+		size_t startOffset = 0;
+		size_t chunkSize = 0;
+		size_t previousChunk = size_t(-1); // Neighbour at a lower address
+		size_t nextChunk = size_t(-1); // Neighbour at a higher address
+		size_t previousFree = size_t(-1); // Neighbours in the segregated list
+		size_t nextFree = size_t(-1);
+		size_t densePosition = size_t(-1); // Position in the dense free arrays
+		ChunkStatus status = ChunkStatus::AVAILABLE;
+	};
+
+	enum FreeIndex : std::uint8_t
+	{
+		SIZE_INDEX = 1 << 0,
+		DENSE_INDEX = 1 << 1,
+		SEGREGATED_INDEX = 1 << 2
+	};
+
+	static constexpr size_t SECOND_LEVEL_LOG2 = 5;
+	static constexpr size_t SECOND_LEVEL_COUNT = size_t(1) << SECOND_LEVEL_LOG2;
+	static constexpr size_t FIRST_LEVEL_COUNT = 64 - SECOND_LEVEL_LOG2 + 1;
+
+	struct FreeChunkKey
+	{
+		size_t chunkSize = 0;
+		size_t startOffset = 0;
+		size_t chunkIndex = size_t(-1);
+
+		bool operator<(const FreeChunkKey& other) const
+		{
+			if (chunkSize != other.chunkSize)
+				return chunkSize < other.chunkSize;
+
+			if (startOffset != other.startOffset)
+				return startOffset < other.startOffset;
+
+			return chunkIndex < other.chunkIndex;
+		}
+	};
+
+	GenerationalVector<Chunk> chunks;
+	std::vector<T> chunkData;
+	std::set<FreeChunkKey> freeChunksBySize;
+	std::vector<size_t> denseFreeOffsets;
+	std::vector<size_t> denseFreeSizes;
+	std::vector<size_t> denseFreeChunks;
+	std::uint64_t firstLevelBitmap = 0;
+	std::vector<std::uint32_t> secondLevelBitmaps;
+	std::vector<size_t> segregatedLists;
+	std::uint8_t activeFreeIndices = 0;
+	size_t currentSize = 0;
+	size_t currentlyActiveChunks = 0;
+	size_t lastChunk = size_t(-1);
+	size_t usedSize = 0;
+	size_t usedSizeHighWaterMark = 0;
+	size_t totalAllocations = 0;
+	size_t totalDeallocations = 0;
+
+	size_t StoreChunk(Chunk&& chunk);
+
+	void ActivateFreeIndex(FreeIndex index);
+	void AddFreeChunk(size_t chunkIndex);
+	void RemoveFreeChunk(size_t chunkIndex);
+
+	void InsertDense(size_t chunkIndex);
+	void RemoveDense(size_t chunkIndex);
+	size_t SearchDenseFirstFit(size_t dataSize, size_t alignment) const;
+
+	void MapSegregatedList(size_t size, size_t& firstLevel, size_t& secondLevel) const;
+	void InsertSegregated(size_t chunkIndex);
+	void RemoveSegregated(size_t chunkIndex);
+	size_t SearchSegregated(size_t dataSize) const;
+	void LinkChunkAfter(size_t chunkIndex, size_t previousIndex);
+	size_t MergeWithNext(size_t chunkIndex);
+	void CombineAdjacentChunks(size_t chunkIndex);
+
+	bool ChunkFits(size_t chunkIndex, size_t dataSize, size_t alignment);
+
+	size_t FindFirstFit(size_t dataSize, size_t alignment);
+	size_t FindBestFit(size_t dataSize, size_t alignment);
+	size_t FindWorstFit(size_t dataSize, size_t alignment);
+	size_t FindSegregatedFit(size_t dataSize, size_t alignment);
+	size_t FindAvailableChunk(size_t dataSize, IndexedAllocationStrategy strategy,
+		size_t alignment);
+
+	void SplitChunk(size_t dataSize, size_t alignment, size_t chunkIndex);
+
+	size_t Align(size_t number, size_t alignment);
+
+public:
+	IndexedHeapHelper() = default;
+	~IndexedHeapHelper() = default;
+	IndexedHeapHelper(const IndexedHeapHelper& other) = delete;
+	IndexedHeapHelper& operator=(const IndexedHeapHelper& other) = delete;
+	IndexedHeapHelper(IndexedHeapHelper&& other);
+	IndexedHeapHelper& operator=(IndexedHeapHelper&& other);
+
+	void Initialize(size_t heapSize, size_t heapStartOffset = 0);
+	void Initialize(size_t heapSize, const T& specifics, size_t heapStartOffset = 0);
+
+	size_t AllocateChunk(size_t chunkSize, IndexedAllocationStrategy strategy,
+		size_t alignment);
+	size_t AllocateChunk(size_t chunkSize, AllocationStrategy strategy,
+		size_t alignment);
+	void DeallocateChunk(size_t chunkIndex);
+
+	void AddChunk(size_t chunkSize, bool combine);
+
+	T& operator[](size_t index);
+	const T& operator[](size_t index) const;
+
+	size_t GetStartOfChunk(size_t index) const;
+	size_t TotalSize() const;
+	size_t NrOfAllocatedChunks() const;
+	size_t GetCurrentMaxIndex() const;
+
+	bool ChunkActive(size_t index) const;
+
+	size_t GetLargestFreeChunkSize() const;
+	AllocatorStatistics GetStatistics() const;
+
+	void RemoveIf(std::function<bool(const T&)> toCheckWith);
+	void ClearHeap(size_t newSize = size_t(-1));
+};
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::StoreChunk(Chunk&& chunk)
+{
+	size_t chunkIndex = chunks.Add(std::move(chunk));
+
+	if (chunkIndex >= chunkData.size())
+		chunkData.resize(chunks.TotalSize());
+
+	chunkData[chunkIndex] = T();
+
+	return chunkIndex;
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::ActivateFreeIndex(FreeIndex index)
+{
+	// Indices are built the first time a strategy needing them is used
+	if ((activeFreeIndices & index) != 0)
+		return;
+
+	if (index == SEGREGATED_INDEX)
+	{
+		firstLevelBitmap = 0;
+		secondLevelBitmaps.assign(FIRST_LEVEL_COUNT, 0);
+		segregatedLists.assign(FIRST_LEVEL_COUNT * SECOND_LEVEL_COUNT, size_t(-1));
+	}
+
+	std::uint8_t previouslyActive = activeFreeIndices;
+	activeFreeIndices = index;
+
+	for (size_t i = chunks.NextActive(0); i < chunks.TotalSize();
+		i = chunks.NextActive(i + 1))
+	{
+		if (chunks[i].status == ChunkStatus::AVAILABLE)
+			AddFreeChunk(i);
+	}
+
+	activeFreeIndices = previouslyActive | index;
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::AddFreeChunk(size_t chunkIndex)
+{
+	const Chunk& chunk = chunks[chunkIndex];
+
+	if ((activeFreeIndices & SIZE_INDEX) != 0)
+		freeChunksBySize.insert({ chunk.chunkSize, chunk.startOffset, chunkIndex });
+
+	if ((activeFreeIndices & DENSE_INDEX) != 0)
+		InsertDense(chunkIndex);
+
+	if ((activeFreeIndices & SEGREGATED_INDEX) != 0)
+		InsertSegregated(chunkIndex);
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::RemoveFreeChunk(size_t chunkIndex)
+{
+	const Chunk& chunk = chunks[chunkIndex];
+
+	if ((activeFreeIndices & SIZE_INDEX) != 0)
+		freeChunksBySize.erase({ chunk.chunkSize, chunk.startOffset, chunkIndex });
+
+	if ((activeFreeIndices & DENSE_INDEX) != 0)
+		RemoveDense(chunkIndex);
+
+	if ((activeFreeIndices & SEGREGATED_INDEX) != 0)
+		RemoveSegregated(chunkIndex);
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::InsertDense(size_t chunkIndex)
+{
+	chunks[chunkIndex].densePosition = denseFreeChunks.size();
+	denseFreeOffsets.push_back(chunks[chunkIndex].startOffset);
+	denseFreeSizes.push_back(chunks[chunkIndex].chunkSize);
+	denseFreeChunks.push_back(chunkIndex);
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::RemoveDense(size_t chunkIndex)
+{
+	// The last entry is moved into the hole to keep the arrays contiguous
+	size_t position = chunks[chunkIndex].densePosition;
+	size_t lastPosition = denseFreeChunks.size() - 1;
+
+	if (position != lastPosition)
+	{
+		denseFreeOffsets[position] = denseFreeOffsets[lastPosition];
+		denseFreeSizes[position] = denseFreeSizes[lastPosition];
+		denseFreeChunks[position] = denseFreeChunks[lastPosition];
+		chunks[denseFreeChunks[position]].densePosition = position;
+	}
+
+	denseFreeOffsets.pop_back();
+	denseFreeSizes.pop_back();
+	denseFreeChunks.pop_back();
+	chunks[chunkIndex].densePosition = size_t(-1);
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::SearchDenseFirstFit(size_t dataSize,
+	size_t alignment) const
+{
+	// Offsets and sizes never exceed the heap size
+	return SearchFirstFit(denseFreeOffsets.data(), denseFreeSizes.data(),
+		denseFreeChunks.size(), dataSize, alignment, currentSize);
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::MapSegregatedList(size_t size, size_t& firstLevel,
+	size_t& secondLevel) const
+{
+	if (size < SECOND_LEVEL_COUNT)
+	{
+		firstLevel = 0;
+		secondLevel = size;
+	}
+	else
+	{
+		size_t mostSignificantBit = std::bit_width(size) - 1;
+		firstLevel = mostSignificantBit - SECOND_LEVEL_LOG2 + 1;
+		secondLevel = (size >> (mostSignificantBit - SECOND_LEVEL_LOG2)) ^
+			SECOND_LEVEL_COUNT;
+	}
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::InsertSegregated(size_t chunkIndex)
+{
+	size_t firstLevel, secondLevel;
+	MapSegregatedList(chunks[chunkIndex].chunkSize, firstLevel, secondLevel);
+	size_t& head = segregatedLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+
+	chunks[chunkIndex].previousFree = size_t(-1);
+	chunks[chunkIndex].nextFree = head;
+
+	if (head != size_t(-1))
+		chunks[head].previousFree = chunkIndex;
+
+	head = chunkIndex;
+	firstLevelBitmap |= std::uint64_t(1) << firstLevel;
+	secondLevelBitmaps[firstLevel] |= std::uint32_t(1) << secondLevel;
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::RemoveSegregated(size_t chunkIndex)
+{
+	size_t firstLevel, secondLevel;
+	MapSegregatedList(chunks[chunkIndex].chunkSize, firstLevel, secondLevel);
+	size_t& head = segregatedLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+	size_t previousIndex = chunks[chunkIndex].previousFree;
+	size_t nextIndex = chunks[chunkIndex].nextFree;
+
+	if (previousIndex != size_t(-1))
+		chunks[previousIndex].nextFree = nextIndex;
+	else
+		head = nextIndex;
+
+	if (nextIndex != size_t(-1))
+		chunks[nextIndex].previousFree = previousIndex;
+
+	chunks[chunkIndex].previousFree = size_t(-1);
+	chunks[chunkIndex].nextFree = size_t(-1);
+
+	if (head == size_t(-1))
+	{
+		secondLevelBitmaps[firstLevel] &= ~(std::uint32_t(1) << secondLevel);
+
+		if (secondLevelBitmaps[firstLevel] == 0)
+			firstLevelBitmap &= ~(std::uint64_t(1) << firstLevel);
+	}
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::SearchSegregated(size_t dataSize) const
+{
+	// Round up to the next list so that any chunk found is large enough
+	if (dataSize >= SECOND_LEVEL_COUNT)
+	{
+		size_t mostSignificantBit = std::bit_width(dataSize) - 1;
+		size_t roundingStep = size_t(1) << (mostSignificantBit - SECOND_LEVEL_LOG2);
+
+		if (dataSize > size_t(-1) - roundingStep)
+			return size_t(-1);
+
+		dataSize += roundingStep - 1;
+	}
+
+	size_t firstLevel, secondLevel;
+	MapSegregatedList(dataSize, firstLevel, secondLevel);
+
+	std::uint32_t secondLevelMap = secondLevelBitmaps[firstLevel] &
+		(~std::uint32_t(0) << secondLevel);
+
+	if (secondLevelMap == 0)
+	{
+		std::uint64_t firstLevelMap = firstLevel + 1 < 64 ?
+			firstLevelBitmap & (~std::uint64_t(0) << (firstLevel + 1)) : 0;
+
+		if (firstLevelMap == 0)
+			return size_t(-1);
+
+		firstLevel = std::countr_zero(firstLevelMap);
+		secondLevelMap = secondLevelBitmaps[firstLevel];
+	}
+
+	secondLevel = std::countr_zero(secondLevelMap);
+	return segregatedLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::LinkChunkAfter(size_t chunkIndex, size_t previousIndex)
+{
+	size_t nextIndex = previousIndex == size_t(-1) ? size_t(-1) :
+		chunks[previousIndex].nextChunk;
+
+	chunks[chunkIndex].previousChunk = previousIndex;
+	chunks[chunkIndex].nextChunk = nextIndex;
+
+	if (previousIndex != size_t(-1))
+		chunks[previousIndex].nextChunk = chunkIndex;
+
+	if (nextIndex != size_t(-1))
+		chunks[nextIndex].previousChunk = chunkIndex;
+	else
+		lastChunk = chunkIndex;
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::MergeWithNext(size_t chunkIndex)
+{
+	size_t toRemove = chunks[chunkIndex].nextChunk;
+	size_t newNext = chunks[toRemove].nextChunk;
+
+	chunks[chunkIndex].chunkSize += chunks[toRemove].chunkSize;
+	chunks[chunkIndex].nextChunk = newNext;
+
+	if (newNext != size_t(-1))
+		chunks[newNext].previousChunk = chunkIndex;
+	else
+		lastChunk = chunkIndex;
+
+	chunks[toRemove].startOffset = size_t(-1);
+	chunks[toRemove].chunkSize = 0;
+	chunks[toRemove].previousChunk = size_t(-1);
+	chunks[toRemove].nextChunk = size_t(-1);
+	chunks.Remove(toRemove);
+
+	return chunkIndex;
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::CombineAdjacentChunks(size_t chunkIndex)
+{
+	// The chunk at chunkIndex is expected to not be in the free chunk sets yet
+	size_t nextIndex = chunks[chunkIndex].nextChunk;
+	if (nextIndex != size_t(-1) &&
+		chunks[nextIndex].status == ChunkStatus::AVAILABLE)
+	{
+		RemoveFreeChunk(nextIndex);
+		MergeWithNext(chunkIndex);
+	}
+
+	size_t previousIndex = chunks[chunkIndex].previousChunk;
+	if (previousIndex != size_t(-1) &&
+		chunks[previousIndex].status == ChunkStatus::AVAILABLE)
+	{
+		RemoveFreeChunk(previousIndex);
+		chunkIndex = MergeWithNext(previousIndex);
+	}
+
+	AddFreeChunk(chunkIndex);
+}
+
+template<typename T>
+inline bool IndexedHeapHelper<T>::ChunkFits(size_t chunkIndex, size_t dataSize,
+	size_t alignment)
+{
+	size_t alignedAdress = Align(chunks[chunkIndex].startOffset, alignment);
+
+	if (alignedAdress - chunks[chunkIndex].startOffset >=
+		chunks[chunkIndex].chunkSize)
+	{
+		return false;
+	}
+
+	size_t alignedSize = chunks[chunkIndex].chunkSize -
+		(alignedAdress - chunks[chunkIndex].startOffset);
+
+	return alignedSize >= dataSize;
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::FindFirstFit(size_t dataSize, size_t alignment)
+{
+	// Validates the alignment before the unchecked arithmetic of the search
+	Align(0, alignment);
+	size_t position = SearchDenseFirstFit(dataSize, alignment);
+
+	return position == size_t(-1) ? size_t(-1) : denseFreeChunks[position];
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::FindBestFit(size_t dataSize, size_t alignment)
+{
+	// Only chunks that failed due to alignment padding are skipped past
+	auto it = freeChunksBySize.lower_bound({ dataSize, 0, 0 });
+
+	for (; it != freeChunksBySize.end(); ++it)
+	{
+		if (ChunkFits(it->chunkIndex, dataSize, alignment))
+			return it->chunkIndex;
+	}
+
+	return size_t(-1);
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::FindWorstFit(size_t dataSize, size_t alignment)
+{
+	for (auto it = freeChunksBySize.rbegin(); it != freeChunksBySize.rend() &&
+		it->chunkSize >= dataSize; ++it)
+	{
+		if (ChunkFits(it->chunkIndex, dataSize, alignment))
+			return it->chunkIndex;
+	}
+
+	return size_t(-1);
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::FindSegregatedFit(size_t dataSize, size_t alignment)
+{
+	size_t chunkIndex = SearchSegregated(dataSize);
+
+	if (chunkIndex != size_t(-1) && ChunkFits(chunkIndex, dataSize, alignment))
+		return chunkIndex;
+
+	// Searching with room for worst case padding guarantees an aligned fit
+	if (alignment > 1 && dataSize <= size_t(-1) - (alignment - 1))
+		return SearchSegregated(dataSize + alignment - 1);
+
+	return size_t(-1);
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::FindAvailableChunk(size_t dataSize,
+	IndexedAllocationStrategy strategy, size_t alignment)
+{
+	size_t chunkIndex;
+
+	switch (strategy)
+	{
+	case IndexedAllocationStrategy::FIRST_FIT:
+		ActivateFreeIndex(DENSE_INDEX);
+		chunkIndex = FindFirstFit(dataSize, alignment);
+		break;
+	case IndexedAllocationStrategy::BEST_FIT:
+		ActivateFreeIndex(SIZE_INDEX);
+		chunkIndex = FindBestFit(dataSize, alignment);
+		break;
+	case IndexedAllocationStrategy::WORST_FIT:
+		ActivateFreeIndex(SIZE_INDEX);
+		chunkIndex = FindWorstFit(dataSize, alignment);
+		break;
+	case IndexedAllocationStrategy::TLSF:
+		ActivateFreeIndex(SEGREGATED_INDEX);
+		chunkIndex = FindSegregatedFit(dataSize, alignment);
+		break;
+	default:
+		throw std::runtime_error("Error: Incorrect allocation strategy");
+	}
+
+	return chunkIndex;
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::SplitChunk(size_t dataSize, size_t alignment, 
+	size_t chunkIndex)
+{
+	size_t alignedAdress = Align(chunks[chunkIndex].startOffset,
+		alignment);
+	size_t actualSize = alignedAdress - 
+		chunks[chunkIndex].startOffset + dataSize;
+
+	RemoveFreeChunk(chunkIndex);
+
+	if (alignedAdress != chunks[chunkIndex].startOffset)
+	{
+		Chunk remainder;
+		remainder.startOffset = chunks[chunkIndex].startOffset;
+		remainder.chunkSize = alignedAdress - chunks[chunkIndex].startOffset;
+		remainder.status = ChunkStatus::AVAILABLE;
+		size_t remainderIndex = StoreChunk(std::move(remainder));
+		size_t previousIndex = chunks[chunkIndex].previousChunk;
+		chunks[remainderIndex].previousChunk = previousIndex;
+		chunks[remainderIndex].nextChunk = chunkIndex;
+		chunks[chunkIndex].previousChunk = remainderIndex;
+		if (previousIndex != size_t(-1))
+			chunks[previousIndex].nextChunk = remainderIndex;
+		AddFreeChunk(remainderIndex);
+	}
+
+	if (chunks[chunkIndex].chunkSize - actualSize != 0)
+	{
+		Chunk remainder;
+		remainder.startOffset = alignedAdress + dataSize;
+		remainder.chunkSize = (chunks[chunkIndex].chunkSize + 
+			chunks[chunkIndex].startOffset) - remainder.startOffset;
+		remainder.status = ChunkStatus::AVAILABLE;
+		size_t remainderIndex = StoreChunk(std::move(remainder));
+		LinkChunkAfter(remainderIndex, chunkIndex);
+		AddFreeChunk(remainderIndex);
+	}
+
+	chunks[chunkIndex].startOffset = alignedAdress;
+	chunks[chunkIndex].chunkSize = dataSize;
+	chunks[chunkIndex].status = ChunkStatus::OCCUPIED;
+	chunkData[chunkIndex] = T();
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::Align(size_t number, size_t alignment)
+{
+	if ((0 == alignment) || (alignment & (alignment - 1)))
+	{
+		throw std::runtime_error("Error: non-pow2 alignment");
+	}
+
+	return ((number + (alignment - 1)) & ~(alignment - 1));
+}
+
+template<typename T>
+inline IndexedHeapHelper<T>::IndexedHeapHelper(IndexedHeapHelper&& other) : 
+	chunks(std::move(other.chunks)),
+	chunkData(std::move(other.chunkData)),
+	freeChunksBySize(std::move(other.freeChunksBySize)),
+	denseFreeOffsets(std::move(other.denseFreeOffsets)),
+	denseFreeSizes(std::move(other.denseFreeSizes)),
+	denseFreeChunks(std::move(other.denseFreeChunks)),
+	firstLevelBitmap(other.firstLevelBitmap),
+	secondLevelBitmaps(std::move(other.secondLevelBitmaps)),
+	segregatedLists(std::move(other.segregatedLists)),
+	activeFreeIndices(other.activeFreeIndices),
+	currentSize(other.currentSize),
+	currentlyActiveChunks(other.currentlyActiveChunks),
+	lastChunk(other.lastChunk), usedSize(other.usedSize),
+	usedSizeHighWaterMark(other.usedSizeHighWaterMark),
+	totalAllocations(other.totalAllocations),
+	totalDeallocations(other.totalDeallocations)
+{
+	other.firstLevelBitmap = 0;
+	other.activeFreeIndices = 0;
+	other.currentSize = 0;
+	other.currentlyActiveChunks = 0;
+	other.lastChunk = size_t(-1);
+	other.usedSize = 0;
+	other.usedSizeHighWaterMark = 0;
+	other.totalAllocations = 0;
+	other.totalDeallocations = 0;
+}
+
+template<typename T>
+inline IndexedHeapHelper<T>& IndexedHeapHelper<T>::operator=(IndexedHeapHelper&& other)
+{
+	if (this != &other)
+	{
+		chunks = std::move(other.chunks);
+		chunkData = std::move(other.chunkData);
+		freeChunksBySize = std::move(other.freeChunksBySize);
+		denseFreeOffsets = std::move(other.denseFreeOffsets);
+		denseFreeSizes = std::move(other.denseFreeSizes);
+		denseFreeChunks = std::move(other.denseFreeChunks);
+		firstLevelBitmap = other.firstLevelBitmap;
+		secondLevelBitmaps = std::move(other.secondLevelBitmaps);
+		segregatedLists = std::move(other.segregatedLists);
+		activeFreeIndices = other.activeFreeIndices;
+		currentSize = other.currentSize;
+		currentlyActiveChunks = other.currentlyActiveChunks;
+		lastChunk = other.lastChunk;
+		usedSize = other.usedSize;
+		usedSizeHighWaterMark = other.usedSizeHighWaterMark;
+		totalAllocations = other.totalAllocations;
+		totalDeallocations = other.totalDeallocations;
+		other.firstLevelBitmap = 0;
+		other.activeFreeIndices = 0;
+		other.currentSize = 0;
+		other.currentlyActiveChunks = 0;
+		other.lastChunk = size_t(-1);
+		other.usedSize = 0;
+		other.usedSizeHighWaterMark = 0;
+		other.totalAllocations = 0;
+		other.totalDeallocations = 0;
+	}
+
+	return *this;
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::Initialize(size_t heapSize, size_t heapStartOffset)
+{
+	Chunk initialChunk;
+	initialChunk.startOffset = heapStartOffset;
+	initialChunk.chunkSize = heapSize;
+	currentSize = heapSize;
+	lastChunk = StoreChunk(std::move(initialChunk));
+	AddFreeChunk(lastChunk);
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::Initialize(size_t heapSize, const T& specifics,
+	size_t heapStartOffset)
+{
+	Chunk initialChunk;
+	initialChunk.startOffset = heapStartOffset;
+	initialChunk.chunkSize = heapSize;
+	currentSize = heapSize;
+	lastChunk = StoreChunk(std::move(initialChunk));
+	chunkData[lastChunk] = specifics;
+	AddFreeChunk(lastChunk);
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::AllocateChunk(size_t chunkSize, 
+	IndexedAllocationStrategy strategy, size_t alignment)
+{
+	size_t chunkIndex = FindAvailableChunk(chunkSize, strategy, alignment);
+
+	if (chunkIndex != size_t(-1))
+	{
+		SplitChunk(chunkSize, alignment, chunkIndex);
+		chunks[chunkIndex].status = ChunkStatus::OCCUPIED;
+		++currentlyActiveChunks;
+		++totalAllocations;
+		usedSize += chunks[chunkIndex].chunkSize;
+		usedSizeHighWaterMark = std::max(usedSizeHighWaterMark, usedSize);
+	}
+
+	return chunkIndex;
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::AllocateChunk(size_t chunkSize,
+	AllocationStrategy strategy, size_t alignment)
+{
+	return AllocateChunk(chunkSize,
+		static_cast<IndexedAllocationStrategy>(strategy), alignment);
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::DeallocateChunk(size_t chunkIndex)
+{
+	chunks[chunkIndex].status = ChunkStatus::AVAILABLE;
+	chunkData[chunkIndex] = T();
+	--currentlyActiveChunks;
+	++totalDeallocations;
+	usedSize -= chunks[chunkIndex].chunkSize;
+
+	CombineAdjacentChunks(chunkIndex);
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::AddChunk(size_t chunkSize, bool combine)
+{
+	Chunk toAdd;
+	toAdd.status = ChunkStatus::AVAILABLE;
+	toAdd.chunkSize = chunkSize;
+	toAdd.startOffset = currentSize;
+
+	size_t addedIndex = StoreChunk(std::move(toAdd));
+	LinkChunkAfter(addedIndex, lastChunk);
+	currentSize += chunkSize;
+
+	if (combine)
+		CombineAdjacentChunks(addedIndex);
+	else
+		AddFreeChunk(addedIndex);
+}
+
+template<typename T>
+inline T& IndexedHeapHelper<T>::operator[](size_t index)
+{
+	return chunkData[index];
+}
+
+template<typename T>
+inline const T& IndexedHeapHelper<T>::operator[](size_t index) const
+{
+	return chunkData[index];
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::GetStartOfChunk(size_t index) const
+{
+	return chunks[index].startOffset;
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::TotalSize() const
+{
+	return currentSize;
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::NrOfAllocatedChunks() const
+{
+	return currentlyActiveChunks;
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::GetCurrentMaxIndex() const
+{
+	return chunks.TotalSize();
+}
+
+template<typename T>
+inline bool IndexedHeapHelper<T>::ChunkActive(size_t index) const
+{
+	return chunks[index].status == ChunkStatus::OCCUPIED;
+}
+
+template<typename T>
+inline size_t IndexedHeapHelper<T>::GetLargestFreeChunkSize() const
+{
+	// Uses whichever free index is active, the segregated lists only need the
+	// highest non empty list to be walked
+	if ((activeFreeIndices & SIZE_INDEX) != 0)
+		return freeChunksBySize.empty() ? 0 : freeChunksBySize.rbegin()->chunkSize;
+
+	size_t toReturn = 0;
+
+	if ((activeFreeIndices & DENSE_INDEX) != 0)
+	{
+		for (size_t size : denseFreeSizes)
+			toReturn = std::max(toReturn, size);
+	}
+	else if ((activeFreeIndices & SEGREGATED_INDEX) != 0)
+	{
+		if (firstLevelBitmap == 0)
+			return 0;
+
+		size_t firstLevel = std::bit_width(firstLevelBitmap) - 1;
+		size_t secondLevel = std::bit_width(secondLevelBitmaps[firstLevel]) - 1;
+
+		for (size_t i = segregatedLists[firstLevel * SECOND_LEVEL_COUNT + secondLevel];
+			i != size_t(-1); i = chunks[i].nextFree)
+		{
+			toReturn = std::max(toReturn, chunks[i].chunkSize);
+		}
+	}
+	else
+	{
+		for (size_t i = chunks.NextActive(0); i < chunks.TotalSize();
+			i = chunks.NextActive(i + 1))
+		{
+			if (chunks[i].status == ChunkStatus::AVAILABLE)
+				toReturn = std::max(toReturn, chunks[i].chunkSize);
+		}
+	}
+
+	return toReturn;
+}
+
+template<typename T>
+inline AllocatorStatistics IndexedHeapHelper<T>::GetStatistics() const
+{
+	AllocatorStatistics toReturn;
+	toReturn.bytesReserved = currentSize;
+	toReturn.bytesUsed = usedSize;
+	toReturn.largestFreeBlock = GetLargestFreeChunkSize();
+	toReturn.nrOfAllocations = currentlyActiveChunks;
+	toReturn.nrOfFreeBlocks = chunks.ActiveSize() - currentlyActiveChunks;
+	toReturn.totalAllocations = totalAllocations;
+	toReturn.totalDeallocations = totalDeallocations;
+	toReturn.bytesUsedHighWaterMark = usedSizeHighWaterMark;
+
+	return toReturn;
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::RemoveIf(std::function<bool(const T&)> toCheckWith)
+{
+	for (size_t i = chunks.NextActive(0); i < chunks.TotalSize();
+		i = chunks.NextActive(i + 1))
+	{
+		if (chunks[i].status == ChunkStatus::OCCUPIED &&
+			toCheckWith(chunkData[i]))
+		{
+			DeallocateChunk(i);
+		}
+	}
+}
+
+template<typename T>
+inline void IndexedHeapHelper<T>::ClearHeap(size_t newSize)
+{
+	chunks.Clear();
+	chunkData.clear();
+	freeChunksBySize.clear();
+	denseFreeOffsets.clear();
+	denseFreeSizes.clear();
+	denseFreeChunks.clear();
+
+	if ((activeFreeIndices & SEGREGATED_INDEX) != 0)
+	{
+		firstLevelBitmap = 0;
+		secondLevelBitmaps.assign(FIRST_LEVEL_COUNT, 0);
+		segregatedLists.assign(FIRST_LEVEL_COUNT * SECOND_LEVEL_COUNT, size_t(-1));
+	}
+
+	currentSize = newSize == size_t(-1) ? currentSize : newSize;
+	totalDeallocations += currentlyActiveChunks;
+	currentlyActiveChunks = 0;
+	usedSize = 0;
+
+	Chunk newTotalChunk;
+	newTotalChunk.startOffset = 0;
+	newTotalChunk.chunkSize = currentSize;
+	lastChunk = StoreChunk(std::move(newTotalChunk));
+	AddFreeChunk(lastChunk);
+}
@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "HeapAllocatorGPU.h"
+#include "AllocatorStatistics.h"
 
 class MultiHeapAllocatorGPU : public HeapAllocatorGPU
 {
@@ -36,5 +37,36 @@ public:
 		D3D12_HEAP_TYPE requiredType, D3D12_HEAP_FLAGS requiredFlags) override;
 	virtual void DeallocateChunk(HeapChunk& chunk) override;
 
+	AllocatorStatistics GetStatistics() const;
+};
 
-};
\ No newline at end of file
+inline AllocatorStatistics MultiHeapAllocatorGPU::GetStatistics() const
+{
+	// Heaps are handed out whole, so a heap in use counts as one allocation.
+	// The counters and the high water mark are filled in by
+	// CountingHeapAllocatorGPU, as this class is compiled into the library.
+	AllocatorStatistics toReturn;
+
+	for (const auto* heaps : { &defaultHeaps, &uploadHeaps, &readbackHeaps })
+	{
+		for (const AllocatedHeap& allocatedHeap : *heaps)
+		{
+			toReturn.bytesReserved += allocatedHeap.size;
+			++toReturn.nrOfHeapChunks;
+
+			if (allocatedHeap.inUse)
+			{
+				toReturn.bytesUsed += allocatedHeap.size;
+				++toReturn.nrOfAllocations;
+			}
+			else
+			{
+				toReturn.largestFreeBlock = std::max(toReturn.largestFreeBlock,
+					allocatedHeap.size);
+				++toReturn.nrOfFreeBlocks;
+			}
+		}
+	}
+
+	return toReturn;
+}
\ No newline at end of file
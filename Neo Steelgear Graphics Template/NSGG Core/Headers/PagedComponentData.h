@@ -0,0 +1,262 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "IndexedHeapHelper.h"
+#include "ResourceComponent.h"
+
+// Shadow data for components, stored in fixed size pages that are never
+// moved or compacted. Each page is suballocated with an IndexedHeapHelper, so
+// adding and removing components only touches their own chunks, and lookups
+// go straight through a table indexed by descriptor index. Data larger than
+// a page gets a dedicated page that is freed when the component is removed,
+// shared pages are freed when they empty as long as another one is left.
+class PagedComponentData
+{
+private:
+	struct AlignedDeleter
+	{
+		std::align_val_t alignment;
+
+		void operator()(unsigned char* memory) const;
+	};
+
+	struct Page
+	{
+		// Aligned to the data alignment, null once the page is freed
+		std::unique_ptr<unsigned char[], AlignedDeleter> memory;
+		IndexedHeapHelper<size_t> heap; // Chunk data is the descriptor index
+		size_t nrOfComponents = 0;
+		bool dedicated = false; // Holds a single component larger than a page
+	};
+
+	struct Slot
+	{
+		unsigned char* data = nullptr;
+		size_t dataSize = 0;
+		size_t page = size_t(-1);
+		size_t chunkIndex = size_t(-1);
+	};
+
+	size_t pageSize = 65536;
+	size_t alignment = 16;
+	size_t pageCursor = 0;
+	size_t usedDataSize = 0;
+	size_t nrOfSharedPages = 0;
+	std::vector<Page> pages;
+	std::vector<size_t> freePages; // Freed pages, their entries reused by new pages
+	std::vector<Slot> slots;
+
+	void FreePage(size_t pageIndex);
+	void AllocateSlot(Slot& slot, size_t descriptorIndex);
+	void ReleaseSlot(Slot& slot);
+
+public:
+	PagedComponentData() = default;
+	~PagedComponentData() = default;
+	PagedComponentData(const PagedComponentData& other) = delete;
+	PagedComponentData& operator=(const PagedComponentData& other) = delete;
+	PagedComponentData(PagedComponentData&& other) = default;
+	PagedComponentData& operator=(PagedComponentData&& other) = default;
+
+	void Initialize(size_t sizeOfPages = 65536, size_t dataAlignment = 16);
+
+	// The data is zeroed unless initial data is provided
+	void* AddComponent(const ResourceIndex& resourceIndex, size_t dataSize,
+		const void* initialData = nullptr);
+	void RemoveComponent(const ResourceIndex& resourceIndex);
+	void UpdateComponentData(const ResourceIndex& resourceIndex, const void* dataPtr);
+
+	void* GetComponentData(const ResourceIndex& resourceIndex);
+	size_t GetComponentDataSize(const ResourceIndex& resourceIndex) const;
+
+	size_t NrOfPages() const;
+	size_t GetUsedDataSize() const;
+};
+
+inline void PagedComponentData::AlignedDeleter::operator()(
+	unsigned char* memory) const
+{
+	::operator delete[](memory, alignment);
+}
+
+inline void PagedComponentData::FreePage(size_t pageIndex)
+{
+	if (!pages[pageIndex].dedicated)
+		--nrOfSharedPages;
+
+	pages[pageIndex] = Page();
+	freePages.push_back(pageIndex);
+}
+
+inline void PagedComponentData::AllocateSlot(Slot& slot, size_t descriptorIndex)
+{
+	// Pages are tried starting from the one that last had room, a page is
+	// only added when none of the existing ones can fit the data
+	for (size_t i = 0; i < pages.size(); ++i)
+	{
+		size_t pageIndex = (pageCursor + i) % pages.size();
+
+		if (pages[pageIndex].dedicated || pages[pageIndex].memory == nullptr)
+			continue;
+
+		size_t chunkIndex = pages[pageIndex].heap.AllocateChunk(slot.dataSize,
+			IndexedAllocationStrategy::TLSF, alignment);
+
+		if (chunkIndex != size_t(-1))
+		{
+			slot.page = pageIndex;
+			slot.chunkIndex = chunkIndex;
+			pageCursor = pageIndex;
+			break;
+		}
+	}
+
+	if (slot.page == size_t(-1))
+	{
+		// Data larger than a page gets a page of its own
+		size_t newPageSize = std::max(pageSize,
+			(slot.dataSize + alignment - 1) / alignment * alignment);
+
+		Page toAdd;
+		toAdd.memory = std::unique_ptr<unsigned char[], AlignedDeleter>(
+			static_cast<unsigned char*>(::operator new[](newPageSize,
+			std::align_val_t(alignment))), AlignedDeleter{ std::align_val_t(alignment) });
+		toAdd.heap.Initialize(newPageSize);
+		toAdd.dedicated = newPageSize > pageSize;
+		nrOfSharedPages += toAdd.dedicated ? 0 : 1;
+
+		if (freePages.empty())
+		{
+			pages.push_back(std::move(toAdd));
+			slot.page = pages.size() - 1;
+		}
+		else
+		{
+			slot.page = freePages.back();
+			freePages.pop_back();
+			pages[slot.page] = std::move(toAdd);
+		}
+
+		// The segregated search rounds sizes up, a first fit always succeeds
+		// on a page that is at least as large as the data
+		slot.chunkIndex = pages[slot.page].heap.AllocateChunk(slot.dataSize,
+			IndexedAllocationStrategy::FIRST_FIT, alignment);
+		pageCursor = slot.page;
+
+		if (slot.chunkIndex == size_t(-1))
+			throw std::runtime_error("Error: Could not allocate component data");
+	}
+
+	Page& page = pages[slot.page];
+	page.heap[slot.chunkIndex] = descriptorIndex;
+	++page.nrOfComponents;
+	slot.data = page.memory.get() + page.heap.GetStartOfChunk(slot.chunkIndex);
+}
+
+inline void PagedComponentData::ReleaseSlot(Slot& slot)
+{
+	if (slot.page != size_t(-1))
+	{
+		Page& page = pages[slot.page];
+		page.heap.DeallocateChunk(slot.chunkIndex);
+		--page.nrOfComponents;
+
+		// The last shared page is kept so that a single component being
+		// added and removed does not allocate a page every time
+		if (page.nrOfComponents == 0 && (page.dedicated || nrOfSharedPages > 1))
+			FreePage(slot.page);
+	}
+
+	usedDataSize -= slot.dataSize;
+	slot = Slot();
+}
+
+inline void PagedComponentData::Initialize(size_t sizeOfPages, size_t dataAlignment)
+{
+	if (sizeOfPages == 0 || dataAlignment == 0 ||
+		(dataAlignment & (dataAlignment - 1)) != 0)
+	{
+		throw std::runtime_error("Error: Invalid paged component data settings");
+	}
+
+	pageSize = sizeOfPages;
+	alignment = dataAlignment;
+	pageCursor = 0;
+	usedDataSize = 0;
+	nrOfSharedPages = 0;
+	pages.clear();
+	freePages.clear();
+	slots.clear();
+}
+
+inline void* PagedComponentData::AddComponent(const ResourceIndex& resourceIndex,
+	size_t dataSize, const void* initialData)
+{
+	if (resourceIndex.descriptorIndex >= slots.size())
+		slots.resize(resourceIndex.descriptorIndex + 1);
+
+	Slot& slot = slots[resourceIndex.descriptorIndex];
+	ReleaseSlot(slot);
+	slot.dataSize = dataSize;
+	usedDataSize += dataSize;
+
+	if (dataSize == 0)
+		return nullptr;
+
+	AllocateSlot(slot, resourceIndex.descriptorIndex);
+
+	if (initialData != nullptr)
+		std::memcpy(slot.data, initialData, dataSize);
+	else
+		std::memset(slot.data, 0, dataSize);
+
+	return slot.data;
+}
+
+inline void PagedComponentData::RemoveComponent(const ResourceIndex& resourceIndex)
+{
+	if (resourceIndex.descriptorIndex < slots.size())
+		ReleaseSlot(slots[resourceIndex.descriptorIndex]);
+}
+
+inline void PagedComponentData::UpdateComponentData(
+	const ResourceIndex& resourceIndex, const void* dataPtr)
+{
+	Slot& slot = slots[resourceIndex.descriptorIndex];
+
+	if (slot.dataSize != 0)
+		std::memcpy(slot.data, dataPtr, slot.dataSize);
+}
+
+inline void* PagedComponentData::GetComponentData(const ResourceIndex& resourceIndex)
+{
+	if (resourceIndex.descriptorIndex >= slots.size())
+		return nullptr;
+
+	return slots[resourceIndex.descriptorIndex].data;
+}
+
+inline size_t PagedComponentData::GetComponentDataSize(
+	const ResourceIndex& resourceIndex) const
+{
+	if (resourceIndex.descriptorIndex >= slots.size())
+		return 0;
+
+	return slots[resourceIndex.descriptorIndex].dataSize;
+}
+
+inline size_t PagedComponentData::NrOfPages() const
+{
+	return pages.size() - freePages.size();
+}
+
+inline size_t PagedComponentData::GetUsedDataSize() const
+{
+	return usedDataSize;
+}
\ No newline at end of file
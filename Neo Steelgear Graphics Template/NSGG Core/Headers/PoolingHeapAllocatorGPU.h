@@ -0,0 +1,402 @@
+#pragma once
+
+#include <set>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+
+#include "HeapAllocatorGPU.h"
+#include "IndexedHeapHelper.h"
+#include "GenerationalVector.h"
+#include "AllocatorStatistics.h"
+
+struct PoolingHeapSettings
+{
+	size_t minimumHeapSize = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	size_t sizeClassesPerDoubling = 4;
+	size_t maximumReuseFactor = 2; // Idle heaps larger than this times the request are not reused
+	size_t subAllocationThreshold = 0; // Requests up to this size share larger heaps, 0 disables it
+	size_t subAllocationBlockSize = 64 * 1024 * 1024;
+	size_t subAllocationAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	size_t framesBeforeTrim = 120; // size_t(-1) keeps idle heaps forever
+};
+
+class PoolingHeapAllocatorGPU : public HeapAllocatorGPU
+{
+private:
+	struct PooledHeap
+	{
+		ID3D12Heap* heap = nullptr;
+		size_t size = 0;
+		D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+		D3D12_HEAP_FLAGS heapFlags = D3D12_HEAP_FLAG_NONE;
+		bool inUse = false;
+		size_t lastUsedFrame = 0;
+
+		bool subAllocated = false;
+		IndexedHeapHelper<size_t> subAllocations;
+		std::unordered_map<size_t, size_t> subAllocationIndices; // Offset to chunk index
+	};
+
+	struct IdleHeapKey
+	{
+		D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+		D3D12_HEAP_FLAGS heapFlags = D3D12_HEAP_FLAG_NONE;
+		size_t size = 0;
+		size_t heapHandle = 0;
+
+		bool operator<(const IdleHeapKey& other) const
+		{
+			if (heapType != other.heapType)
+				return heapType < other.heapType;
+
+			if (heapFlags != other.heapFlags)
+				return heapFlags < other.heapFlags;
+
+			if (size != other.size)
+				return size < other.size;
+
+			return heapHandle < other.heapHandle;
+		}
+	};
+
+	PoolingHeapSettings settings;
+	// Heaps are referred to by handles, so a released heap whose slot has
+	// been reused is caught in debug builds instead of silently aliased
+	GenerationalVector<PooledHeap> heaps;
+	std::unordered_map<ID3D12Heap*, size_t> heapHandles;
+	std::set<IdleHeapKey> idleHeaps;
+	std::vector<size_t> subAllocatedHeaps;
+	size_t currentFrame = 0;
+	size_t nrOfHeapsCreated = 0;
+	size_t nrOfHeapsReused = 0;
+	size_t totalAllocations = 0;
+	size_t totalDeallocations = 0;
+
+	size_t RoundToSizeClass(size_t size) const;
+	size_t CreatePooledHeap(size_t size, D3D12_HEAP_TYPE heapType,
+		D3D12_HEAP_FLAGS heapFlags);
+	void ReleasePooledHeap(size_t heapHandle);
+	HeapChunk MakeHeapChunk(const PooledHeap& pooledHeap, size_t startOffset,
+		size_t size) const;
+
+	bool TrySubAllocate(size_t heapHandle, size_t size, HeapChunk& chunk);
+	HeapChunk SubAllocateChunk(size_t size, D3D12_HEAP_TYPE heapType,
+		D3D12_HEAP_FLAGS heapFlags);
+	HeapChunk AllocateWholeHeap(size_t size, D3D12_HEAP_TYPE heapType,
+		D3D12_HEAP_FLAGS heapFlags);
+
+public:
+	PoolingHeapAllocatorGPU() = default;
+	virtual ~PoolingHeapAllocatorGPU();
+	PoolingHeapAllocatorGPU(const PoolingHeapAllocatorGPU& other) = delete;
+	PoolingHeapAllocatorGPU& operator=(const PoolingHeapAllocatorGPU& other) = delete;
+	PoolingHeapAllocatorGPU(PoolingHeapAllocatorGPU&& other) = delete;
+	PoolingHeapAllocatorGPU& operator=(PoolingHeapAllocatorGPU&& other) = delete;
+
+	void Initialize(ID3D12Device* deviceToUse,
+		const PoolingHeapSettings& settingsToUse = PoolingHeapSettings());
+
+	virtual HeapChunk AllocateChunk(size_t minimumRequiredSize,
+		D3D12_HEAP_TYPE requiredType, D3D12_HEAP_FLAGS requiredFlags) override;
+	virtual void DeallocateChunk(HeapChunk& chunk) override;
+
+	// Expected to be called once per frame, releases heaps idle for too long
+	void AdvanceFrame();
+	void TrimIdleHeaps(size_t minimumIdleFrames);
+
+	size_t GetNrOfHeapsCreated() const;
+	size_t GetNrOfHeapsReused() const;
+	AllocatorStatistics GetStatistics() const;
+};
+
+inline size_t PoolingHeapAllocatorGPU::RoundToSizeClass(size_t size) const
+{
+	// Each doubling of size is split into a fixed number of classes so that a
+	// released heap can serve any request of a similar size
+	if (size <= settings.minimumHeapSize)
+		return settings.minimumHeapSize;
+
+	size_t powerOfTwo = size_t(1) << (std::bit_width(size) - 1);
+	size_t step = std::max(powerOfTwo / settings.sizeClassesPerDoubling,
+		settings.minimumHeapSize);
+
+	return ((size + step - 1) / step) * step;
+}
+
+inline size_t PoolingHeapAllocatorGPU::CreatePooledHeap(size_t size,
+	D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags)
+{
+	PooledHeap toAdd;
+	toAdd.heap = CreateHeap(size, heapType, heapFlags);
+	toAdd.size = size;
+	toAdd.heapType = heapType;
+	toAdd.heapFlags = heapFlags;
+	toAdd.lastUsedFrame = currentFrame;
+
+	ID3D12Heap* heap = toAdd.heap;
+	size_t heapHandle = heaps.GetHandle(heaps.Add(std::move(toAdd)));
+	heapHandles[heap] = heapHandle;
+	++nrOfHeapsCreated;
+
+	return heapHandle;
+}
+
+inline void PoolingHeapAllocatorGPU::ReleasePooledHeap(size_t heapHandle)
+{
+	PooledHeap& pooledHeap = heaps.Get(heapHandle);
+	heapHandles.erase(pooledHeap.heap);
+	pooledHeap.heap->Release();
+	pooledHeap = PooledHeap();
+	heaps.Remove(GenerationalVector<PooledHeap>::GetIndexFromHandle(heapHandle));
+}
+
+inline HeapChunk PoolingHeapAllocatorGPU::MakeHeapChunk(
+	const PooledHeap& pooledHeap, size_t startOffset, size_t size) const
+{
+	HeapChunk toReturn;
+	toReturn.heapType = pooledHeap.heapType;
+	toReturn.heapFlags = pooledHeap.heapFlags;
+	toReturn.heap = pooledHeap.heap;
+	toReturn.startOffset = startOffset;
+	toReturn.endOffset = startOffset + size;
+
+	return toReturn;
+}
+
+inline bool PoolingHeapAllocatorGPU::TrySubAllocate(size_t heapHandle,
+	size_t size, HeapChunk& chunk)
+{
+	PooledHeap& pooledHeap = heaps.Get(heapHandle);
+	size_t chunkIndex = pooledHeap.subAllocations.AllocateChunk(size,
+		IndexedAllocationStrategy::TLSF, settings.subAllocationAlignment);
+
+	if (chunkIndex == size_t(-1))
+		return false;
+
+	size_t startOffset = pooledHeap.subAllocations.GetStartOfChunk(chunkIndex);
+	pooledHeap.subAllocationIndices[startOffset] = chunkIndex;
+	pooledHeap.lastUsedFrame = currentFrame;
+	chunk = MakeHeapChunk(pooledHeap, startOffset, size);
+
+	return true;
+}
+
+inline HeapChunk PoolingHeapAllocatorGPU::SubAllocateChunk(size_t size,
+	D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags)
+{
+	HeapChunk toReturn;
+
+	for (size_t heapHandle : subAllocatedHeaps)
+	{
+		const PooledHeap& pooledHeap = heaps.Get(heapHandle);
+
+		if (pooledHeap.heapType == heapType && pooledHeap.heapFlags == heapFlags &&
+			TrySubAllocate(heapHandle, size, toReturn))
+		{
+			return toReturn;
+		}
+	}
+
+	size_t blockSize = RoundToSizeClass(
+		std::max(settings.subAllocationBlockSize, size));
+	size_t heapHandle = CreatePooledHeap(blockSize, heapType, heapFlags);
+	PooledHeap& pooledHeap = heaps.Get(heapHandle);
+	pooledHeap.subAllocated = true;
+	pooledHeap.inUse = true;
+	pooledHeap.subAllocations.Initialize(blockSize);
+	subAllocatedHeaps.push_back(heapHandle);
+
+	if (!TrySubAllocate(heapHandle, size, toReturn))
+		throw std::runtime_error("Error: Could not sub allocate from new heap");
+
+	return toReturn;
+}
+
+inline HeapChunk PoolingHeapAllocatorGPU::AllocateWholeHeap(size_t size,
+	D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags)
+{
+	size_t classSize = RoundToSizeClass(size);
+	auto bestFit = idleHeaps.lower_bound({ heapType, heapFlags, classSize, 0 });
+	size_t heapHandle = size_t(-1);
+
+	if (bestFit != idleHeaps.end() && bestFit->heapType == heapType &&
+		bestFit->heapFlags == heapFlags &&
+		bestFit->size <= classSize * settings.maximumReuseFactor)
+	{
+		heapHandle = bestFit->heapHandle;
+		idleHeaps.erase(bestFit);
+		++nrOfHeapsReused;
+	}
+	else
+	{
+		heapHandle = CreatePooledHeap(classSize, heapType, heapFlags);
+	}
+
+	PooledHeap& pooledHeap = heaps.Get(heapHandle);
+	pooledHeap.inUse = true;
+	pooledHeap.lastUsedFrame = currentFrame;
+
+	return MakeHeapChunk(pooledHeap, 0, pooledHeap.size);
+}
+
+inline PoolingHeapAllocatorGPU::~PoolingHeapAllocatorGPU()
+{
+	for (size_t i = heaps.NextActive(0); i < heaps.TotalSize();
+		i = heaps.NextActive(i + 1))
+	{
+		heaps[i].heap->Release();
+	}
+}
+
+inline void PoolingHeapAllocatorGPU::Initialize(ID3D12Device* deviceToUse,
+	const PoolingHeapSettings& settingsToUse)
+{
+	if (settingsToUse.sizeClassesPerDoubling == 0 ||
+		settingsToUse.maximumReuseFactor == 0 || settingsToUse.minimumHeapSize == 0)
+	{
+		throw std::runtime_error("Error: Invalid pooling heap settings");
+	}
+
+	device = deviceToUse;
+	settings = settingsToUse;
+}
+
+inline HeapChunk PoolingHeapAllocatorGPU::AllocateChunk(
+	size_t minimumRequiredSize, D3D12_HEAP_TYPE requiredType,
+	D3D12_HEAP_FLAGS requiredFlags)
+{
+	++totalAllocations;
+
+	if (settings.subAllocationThreshold != 0 &&
+		minimumRequiredSize <= settings.subAllocationThreshold)
+	{
+		return SubAllocateChunk(minimumRequiredSize, requiredType, requiredFlags);
+	}
+
+	return AllocateWholeHeap(minimumRequiredSize, requiredType, requiredFlags);
+}
+
+inline void PoolingHeapAllocatorGPU::DeallocateChunk(HeapChunk& chunk)
+{
+	auto it = heapHandles.find(chunk.heap);
+
+	if (it == heapHandles.end())
+		throw std::runtime_error("Error: Deallocating heap chunk not owned by pooling allocator");
+
+	PooledHeap& pooledHeap = heaps.Get(it->second);
+	pooledHeap.lastUsedFrame = currentFrame;
+	++totalDeallocations;
+
+	if (pooledHeap.subAllocated)
+	{
+		auto subAllocation = pooledHeap.subAllocationIndices.find(chunk.startOffset);
+
+		if (subAllocation == pooledHeap.subAllocationIndices.end())
+			throw std::runtime_error("Error: Deallocating unknown sub allocation");
+
+		pooledHeap.subAllocations.DeallocateChunk(subAllocation->second);
+		pooledHeap.subAllocationIndices.erase(subAllocation);
+	}
+	else
+	{
+		pooledHeap.inUse = false;
+		idleHeaps.insert({ pooledHeap.heapType, pooledHeap.heapFlags,
+			pooledHeap.size, it->second });
+	}
+
+	chunk.heap = nullptr;
+	chunk.startOffset = size_t(-1);
+	chunk.endOffset = 0;
+}
+
+inline void PoolingHeapAllocatorGPU::AdvanceFrame()
+{
+	++currentFrame;
+
+	if (settings.framesBeforeTrim != size_t(-1))
+		TrimIdleHeaps(settings.framesBeforeTrim);
+}
+
+inline void PoolingHeapAllocatorGPU::TrimIdleHeaps(size_t minimumIdleFrames)
+{
+	for (auto it = idleHeaps.begin(); it != idleHeaps.end();)
+	{
+		if (currentFrame - heaps.Get(it->heapHandle).lastUsedFrame >= minimumIdleFrames)
+		{
+			ReleasePooledHeap(it->heapHandle);
+			it = idleHeaps.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for (size_t i = 0; i < subAllocatedHeaps.size();)
+	{
+		const PooledHeap& pooledHeap = heaps.Get(subAllocatedHeaps[i]);
+
+		if (pooledHeap.subAllocations.NrOfAllocatedChunks() == 0 &&
+			currentFrame - pooledHeap.lastUsedFrame >= minimumIdleFrames)
+		{
+			ReleasePooledHeap(subAllocatedHeaps[i]);
+			subAllocatedHeaps[i] = subAllocatedHeaps.back();
+			subAllocatedHeaps.pop_back();
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+inline size_t PoolingHeapAllocatorGPU::GetNrOfHeapsCreated() const
+{
+	return nrOfHeapsCreated;
+}
+
+inline size_t PoolingHeapAllocatorGPU::GetNrOfHeapsReused() const
+{
+	return nrOfHeapsReused;
+}
+
+inline AllocatorStatistics PoolingHeapAllocatorGPU::GetStatistics() const
+{
+	AllocatorStatistics toReturn;
+
+	for (size_t i = heaps.NextActive(0); i < heaps.TotalSize();
+		i = heaps.NextActive(i + 1))
+	{
+		const PooledHeap& pooledHeap = heaps[i];
+		toReturn.bytesReserved += pooledHeap.size;
+		++toReturn.nrOfHeapChunks;
+
+		if (pooledHeap.subAllocated)
+		{
+			AllocatorStatistics blockStatistics =
+				pooledHeap.subAllocations.GetStatistics();
+			toReturn.bytesUsed += blockStatistics.bytesUsed;
+			toReturn.nrOfAllocations += blockStatistics.nrOfAllocations;
+			toReturn.nrOfFreeBlocks += blockStatistics.nrOfFreeBlocks;
+			toReturn.largestFreeBlock = std::max(toReturn.largestFreeBlock,
+				blockStatistics.largestFreeBlock);
+		}
+		else if (pooledHeap.inUse)
+		{
+			toReturn.bytesUsed += pooledHeap.size;
+			++toReturn.nrOfAllocations;
+		}
+		else
+		{
+			toReturn.largestFreeBlock = std::max(toReturn.largestFreeBlock,
+				pooledHeap.size);
+			++toReturn.nrOfFreeBlocks;
+		}
+	}
+
+	toReturn.totalAllocations = totalAllocations;
+	toReturn.totalDeallocations = totalDeallocations;
+
+	return toReturn;
+}
\ No newline at end of file
@@ -0,0 +1,564 @@
+#pragma once
+
+#include <d3d12.h>
+#include <atomic>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+#include "D3DPtr.h"
+#include "ResourceUploader.h"
+#include "RowCopy.h"
+
+// Staging memory handed out linearly from a persistently mapped upload buffer.
+// Staging functions may be called from any number of threads at once, while
+// recording, submission and reclamation are done from the render thread once
+// the staging threads for that frame are done.
+class RingBufferUploader
+{
+private:
+	struct PendingCopy
+	{
+		ID3D12Resource* destination = nullptr; // Null if the staging failed
+		size_t sourceOffset = 0;
+		size_t destinationOffset = 0;
+		size_t dataSize = 0;
+		bool texture = false;
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+		unsigned int subresourceIndex = 0;
+		unsigned int offsetWidth = 0;
+		unsigned int offsetHeight = 0;
+		unsigned int offsetDepth = 0;
+	};
+
+	struct SubmissionMarker
+	{
+		UINT64 fenceValue = 0;
+		size_t headPosition = 0;
+	};
+
+	ID3D12Device* device = nullptr;
+	D3DPtr<ID3D12Resource> buffer;
+	unsigned char* mappedPtr = nullptr;
+	size_t capacity = 0;
+
+	// Positions only ever grow, the physical offset is the position modulo
+	// capacity. The counters are kept on separate cache lines as every
+	// staging thread writes to them.
+	alignas(64) std::atomic<size_t> head = 0;
+	alignas(64) std::atomic<size_t> tail = 0;
+	alignas(64) std::atomic<size_t> nrOfPendingCopies = 0;
+
+	std::vector<PendingCopy> pendingCopies;
+	std::vector<size_t> sortedBufferCopies;
+	std::deque<SubmissionMarker> submissionMarkers;
+
+	size_t nrOfCopiesRequested = 0;
+	size_t nrOfCopiesIssued = 0;
+
+	void AllocateBuffer(size_t size);
+	size_t AlignAdress(size_t adress, size_t alignment) const;
+	size_t ReserveMemory(size_t dataSize, size_t alignment);
+	PendingCopy* ReservePendingCopy();
+	void CopyStagedRows(const RowCopyInfo& copyInfo,
+		WorkStealingThreadPool* threadPool);
+
+	void RecordTextureCopy(ID3D12GraphicsCommandList* commandList,
+		const PendingCopy& pendingCopy);
+	void RecordBufferCopy(ID3D12GraphicsCommandList* commandList,
+		ID3D12Resource* destination, size_t destinationOffset,
+		size_t sourceOffset, size_t dataSize);
+	void RecordBufferCopies(ID3D12GraphicsCommandList* commandList,
+		size_t groupStart, size_t groupEnd);
+
+public:
+	RingBufferUploader() = default;
+	~RingBufferUploader();
+	RingBufferUploader(const RingBufferUploader& other) = delete;
+	RingBufferUploader& operator=(const RingBufferUploader& other) = delete;
+	RingBufferUploader(RingBufferUploader&& other) = delete;
+	RingBufferUploader& operator=(RingBufferUploader&& other) = delete;
+
+	void Initialize(ID3D12Device* deviceToUse, size_t ringSize,
+		size_t maximumPendingCopies);
+
+	bool StageBufferData(ID3D12Resource* toUploadTo, const void* data,
+		size_t offsetFromStart, size_t dataSize, size_t alignment = 4);
+
+	// Texture rows are split over the threads of the pool if one is given
+	bool StageTextureData(ID3D12Resource* toUploadTo, const void* data,
+		const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex = 0,
+		WorkStealingThreadPool* threadPool = nullptr);
+
+	// Stages a whole subresource laid out as the device reports it, which
+	// works for any format including block compressed ones
+	bool StageSubresourceData(ID3D12Resource* toUploadTo, const void* data,
+		size_t sourceRowPitch, size_t sourceSlicePitch,
+		unsigned int subresourceIndex, WorkStealingThreadPool* threadPool = nullptr);
+
+	// Buffer copies to the same destination are merged where both the
+	// destination and the staged ranges are adjacent, and copies that are
+	// completely overwritten by a later copy of the same range are dropped
+	void RecordPendingCopies(ID3D12GraphicsCommandList* commandList);
+	void MarkSubmitted(UINT64 fenceValue);
+	void ReclaimCompleted(UINT64 completedFenceValue);
+
+	size_t GetCapacity() const;
+	size_t GetUsedSize() const;
+	size_t GetNrOfCopiesRequested() const;
+	size_t GetNrOfCopiesIssued() const;
+	void ResetCopyCounters();
+};
+
+inline void RingBufferUploader::AllocateBuffer(size_t size)
+{
+	D3D12_HEAP_PROPERTIES heapProperties;
+	heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
+	heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	heapProperties.CreationNodeMask = 0;
+	heapProperties.VisibleNodeMask = 0;
+
+	D3D12_RESOURCE_DESC resourceDesc;
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	resourceDesc.Alignment = 0;
+	resourceDesc.Width = size;
+	resourceDesc.Height = 1;
+	resourceDesc.DepthOrArraySize = 1;
+	resourceDesc.MipLevels = 1;
+	resourceDesc.Format = DXGI_FORMAT_UNKNOWN;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.SampleDesc.Quality = 0;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	HRESULT hr = device->CreateCommittedResource(&heapProperties,
+		D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr, IID_PPV_ARGS(&buffer));
+
+	if (FAILED(hr))
+		throw std::runtime_error("Error: Could not create ring upload buffer");
+
+	D3D12_RANGE nothingRead = { 0, 0 };
+	hr = buffer->Map(0, &nothingRead, reinterpret_cast<void**>(&mappedPtr));
+
+	if (FAILED(hr))
+		throw std::runtime_error("Error: Could not map ring upload buffer");
+}
+
+inline size_t RingBufferUploader::AlignAdress(size_t adress,
+	size_t alignment) const
+{
+	if ((0 == alignment) || (alignment & (alignment - 1)))
+	{
+		throw std::runtime_error("Error: non-pow2 alignment");
+	}
+
+	return ((adress + (alignment - 1)) & ~(alignment - 1));
+}
+
+inline size_t RingBufferUploader::ReserveMemory(size_t dataSize,
+	size_t alignment)
+{
+	// Lock free bump allocation, a range that would cross the end of the
+	// buffer is instead started at the beginning of the next lap
+	if (dataSize > capacity)
+		return size_t(-1);
+
+	size_t currentHead = head.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		size_t start = AlignAdress(currentHead, alignment);
+		size_t physicalStart = start % capacity;
+
+		if (physicalStart + dataSize > capacity)
+			start += capacity - physicalStart;
+
+		size_t end = start + dataSize;
+
+		if (end - tail.load(std::memory_order_acquire) > capacity)
+			return size_t(-1);
+
+		if (head.compare_exchange_weak(currentHead, end,
+			std::memory_order_acq_rel, std::memory_order_relaxed))
+		{
+			return start % capacity;
+		}
+	}
+}
+
+inline RingBufferUploader::PendingCopy* RingBufferUploader::ReservePendingCopy()
+{
+	size_t slot = nrOfPendingCopies.fetch_add(1, std::memory_order_relaxed);
+
+	if (slot >= pendingCopies.size())
+		return nullptr;
+
+	return &pendingCopies[slot];
+}
+
+inline void RingBufferUploader::CopyStagedRows(const RowCopyInfo& copyInfo,
+	WorkStealingThreadPool* threadPool)
+{
+	if (threadPool != nullptr)
+		CopyRowsParallel(copyInfo, *threadPool);
+	else
+		CopyRows(copyInfo);
+}
+
+inline RingBufferUploader::~RingBufferUploader()
+{
+	if (mappedPtr != nullptr)
+		buffer->Unmap(0, nullptr);
+}
+
+inline void RingBufferUploader::Initialize(ID3D12Device* deviceToUse,
+	size_t ringSize, size_t maximumPendingCopies)
+{
+	device = deviceToUse;
+	capacity = AlignAdress(ringSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	AllocateBuffer(capacity);
+	pendingCopies.resize(maximumPendingCopies);
+}
+
+inline bool RingBufferUploader::StageBufferData(ID3D12Resource* toUploadTo,
+	const void* data, size_t offsetFromStart, size_t dataSize, size_t alignment)
+{
+	PendingCopy* pendingCopy = ReservePendingCopy();
+
+	if (pendingCopy == nullptr)
+		return false;
+
+	size_t sourceOffset = ReserveMemory(dataSize, alignment);
+
+	if (sourceOffset == size_t(-1))
+	{
+		pendingCopy->destination = nullptr;
+		return false;
+	}
+
+	std::memcpy(mappedPtr + sourceOffset, data, dataSize);
+
+	pendingCopy->destination = toUploadTo;
+	pendingCopy->sourceOffset = sourceOffset;
+	pendingCopy->destinationOffset = offsetFromStart;
+	pendingCopy->dataSize = dataSize;
+	pendingCopy->texture = false;
+
+	return true;
+}
+
+inline bool RingBufferUploader::StageTextureData(ID3D12Resource* toUploadTo,
+	const void* data, const TextureUploadInfo& uploadInfo,
+	unsigned int subresourceIndex, WorkStealingThreadPool* threadPool)
+{
+	PendingCopy* pendingCopy = ReservePendingCopy();
+
+	if (pendingCopy == nullptr)
+		return false;
+
+	size_t rowSize = uploadInfo.width * uploadInfo.texelSizeInBytes;
+	size_t rowPitch = AlignAdress(rowSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+	size_t nrOfRows = size_t(uploadInfo.height) * uploadInfo.depth;
+	size_t sourceOffset = ReserveMemory(rowPitch * nrOfRows,
+		D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+	if (sourceOffset == size_t(-1))
+	{
+		pendingCopy->destination = nullptr;
+		return false;
+	}
+
+	RowCopyInfo copyInfo;
+	copyInfo.destination = mappedPtr + sourceOffset;
+	copyInfo.destinationPitch = rowPitch;
+	copyInfo.source = data;
+	copyInfo.sourcePitch = rowSize;
+	copyInfo.rowSize = rowSize;
+	copyInfo.nrOfRows = nrOfRows;
+	CopyStagedRows(copyInfo, threadPool);
+
+	pendingCopy->destination = toUploadTo;
+	pendingCopy->sourceOffset = sourceOffset;
+	pendingCopy->dataSize = rowPitch * nrOfRows;
+	pendingCopy->texture = true;
+	pendingCopy->footprint.Offset = sourceOffset;
+	pendingCopy->footprint.Footprint.Format = uploadInfo.format;
+	pendingCopy->footprint.Footprint.Width = uploadInfo.width;
+	pendingCopy->footprint.Footprint.Height = uploadInfo.height;
+	pendingCopy->footprint.Footprint.Depth = uploadInfo.depth;
+	pendingCopy->footprint.Footprint.RowPitch = static_cast<UINT>(rowPitch);
+	pendingCopy->subresourceIndex = subresourceIndex;
+	pendingCopy->offsetWidth = uploadInfo.offsetWidth;
+	pendingCopy->offsetHeight = uploadInfo.offsetHeight;
+	pendingCopy->offsetDepth = uploadInfo.offsetDepth;
+
+	return true;
+}
+
+inline bool RingBufferUploader::StageSubresourceData(
+	ID3D12Resource* toUploadTo, const void* data, size_t sourceRowPitch,
+	size_t sourceSlicePitch, unsigned int subresourceIndex,
+	WorkStealingThreadPool* threadPool)
+{
+	PendingCopy* pendingCopy = ReservePendingCopy();
+
+	if (pendingCopy == nullptr)
+		return false;
+
+	D3D12_RESOURCE_DESC resourceDesc = toUploadTo->GetDesc();
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+	UINT nrOfRows = 0;
+	UINT64 rowSize = 0;
+	UINT64 totalSize = 0;
+	device->GetCopyableFootprints(&resourceDesc, subresourceIndex, 1, 0,
+		&footprint, &nrOfRows, &rowSize, &totalSize);
+
+	size_t sourceOffset = ReserveMemory(static_cast<size_t>(totalSize),
+		D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+	if (sourceOffset == size_t(-1))
+	{
+		pendingCopy->destination = nullptr;
+		return false;
+	}
+
+	for (UINT slice = 0; slice < footprint.Footprint.Depth; ++slice)
+	{
+		RowCopyInfo copyInfo;
+		copyInfo.destination = mappedPtr + sourceOffset +
+			static_cast<size_t>(slice) * footprint.Footprint.RowPitch * nrOfRows;
+		copyInfo.destinationPitch = footprint.Footprint.RowPitch;
+		copyInfo.source = static_cast<const unsigned char*>(data) +
+			slice * sourceSlicePitch;
+		copyInfo.sourcePitch = sourceRowPitch;
+		copyInfo.rowSize = static_cast<size_t>(rowSize);
+		copyInfo.nrOfRows = nrOfRows;
+		CopyStagedRows(copyInfo, threadPool);
+	}
+
+	footprint.Offset = sourceOffset;
+	pendingCopy->destination = toUploadTo;
+	pendingCopy->sourceOffset = sourceOffset;
+	pendingCopy->dataSize = static_cast<size_t>(totalSize);
+	pendingCopy->texture = true;
+	pendingCopy->footprint = footprint;
+	pendingCopy->subresourceIndex = subresourceIndex;
+	pendingCopy->offsetWidth = 0;
+	pendingCopy->offsetHeight = 0;
+	pendingCopy->offsetDepth = 0;
+
+	return true;
+}
+
+inline void RingBufferUploader::RecordTextureCopy(
+	ID3D12GraphicsCommandList* commandList, const PendingCopy& pendingCopy)
+{
+	D3D12_TEXTURE_COPY_LOCATION destination;
+	destination.pResource = pendingCopy.destination;
+	destination.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	destination.SubresourceIndex = pendingCopy.subresourceIndex;
+
+	D3D12_TEXTURE_COPY_LOCATION source;
+	source.pResource = buffer;
+	source.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+	source.PlacedFootprint = pendingCopy.footprint;
+
+	commandList->CopyTextureRegion(&destination, pendingCopy.offsetWidth,
+		pendingCopy.offsetHeight, pendingCopy.offsetDepth, &source, nullptr);
+	++nrOfCopiesIssued;
+}
+
+inline void RingBufferUploader::RecordBufferCopy(
+	ID3D12GraphicsCommandList* commandList, ID3D12Resource* destination,
+	size_t destinationOffset, size_t sourceOffset, size_t dataSize)
+{
+	commandList->CopyBufferRegion(destination, destinationOffset, buffer,
+		sourceOffset, dataSize);
+	++nrOfCopiesIssued;
+}
+
+inline void RingBufferUploader::RecordBufferCopies(
+	ID3D12GraphicsCommandList* commandList, size_t groupStart, size_t groupEnd)
+{
+	// The group is sorted on destination offset and then staging order, so of
+	// copies with identical ranges only the last one staged needs to be kept
+	size_t groupSize = 0;
+	for (size_t i = groupStart; i < groupEnd; ++i)
+	{
+		const PendingCopy& current = pendingCopies[sortedBufferCopies[i]];
+
+		if (groupSize != 0)
+		{
+			size_t& previousIndex = sortedBufferCopies[groupStart + groupSize - 1];
+			const PendingCopy& previous = pendingCopies[previousIndex];
+
+			if (previous.destinationOffset == current.destinationOffset &&
+				previous.dataSize == current.dataSize)
+			{
+				previousIndex = sortedBufferCopies[i];
+				continue;
+			}
+		}
+
+		sortedBufferCopies[groupStart + groupSize++] = sortedBufferCopies[i];
+	}
+
+	groupEnd = groupStart + groupSize;
+	bool overlapping = false;
+
+	for (size_t i = groupStart + 1; i < groupEnd && !overlapping; ++i)
+	{
+		const PendingCopy& previous = pendingCopies[sortedBufferCopies[i - 1]];
+		const PendingCopy& current = pendingCopies[sortedBufferCopies[i]];
+		overlapping = current.destinationOffset <
+			previous.destinationOffset + previous.dataSize;
+	}
+
+	if (overlapping)
+	{
+		// Partially overlapping writes must reach the GPU in the order they
+		// were staged, so the group is recorded without merging
+		std::sort(sortedBufferCopies.begin() + groupStart,
+			sortedBufferCopies.begin() + groupEnd);
+
+		for (size_t i = groupStart; i < groupEnd; ++i)
+		{
+			const PendingCopy& pendingCopy = pendingCopies[sortedBufferCopies[i]];
+			RecordBufferCopy(commandList, pendingCopy.destination,
+				pendingCopy.destinationOffset, pendingCopy.sourceOffset,
+				pendingCopy.dataSize);
+		}
+
+		return;
+	}
+
+	const PendingCopy& first = pendingCopies[sortedBufferCopies[groupStart]];
+	size_t destinationOffset = first.destinationOffset;
+	size_t sourceOffset = first.sourceOffset;
+	size_t dataSize = first.dataSize;
+
+	for (size_t i = groupStart + 1; i < groupEnd; ++i)
+	{
+		const PendingCopy& current = pendingCopies[sortedBufferCopies[i]];
+
+		if (current.destinationOffset == destinationOffset + dataSize &&
+			current.sourceOffset == sourceOffset + dataSize)
+		{
+			dataSize += current.dataSize;
+			continue;
+		}
+
+		RecordBufferCopy(commandList, first.destination, destinationOffset,
+			sourceOffset, dataSize);
+		destinationOffset = current.destinationOffset;
+		sourceOffset = current.sourceOffset;
+		dataSize = current.dataSize;
+	}
+
+	RecordBufferCopy(commandList, first.destination, destinationOffset,
+		sourceOffset, dataSize);
+}
+
+inline void RingBufferUploader::RecordPendingCopies(
+	ID3D12GraphicsCommandList* commandList)
+{
+	size_t nrOfCopies = std::min(nrOfPendingCopies.load(std::memory_order_acquire),
+		pendingCopies.size());
+	sortedBufferCopies.clear();
+
+	for (size_t i = 0; i < nrOfCopies; ++i)
+	{
+		const PendingCopy& pendingCopy = pendingCopies[i];
+
+		if (pendingCopy.destination == nullptr)
+			continue;
+
+		++nrOfCopiesRequested;
+
+		if (pendingCopy.texture)
+			RecordTextureCopy(commandList, pendingCopy);
+		else
+			sortedBufferCopies.push_back(i);
+	}
+
+	std::sort(sortedBufferCopies.begin(), sortedBufferCopies.end(),
+		[this](size_t lhs, size_t rhs)
+		{
+			const PendingCopy& left = pendingCopies[lhs];
+			const PendingCopy& right = pendingCopies[rhs];
+
+			if (left.destination != right.destination)
+				return std::less<ID3D12Resource*>()(left.destination, right.destination);
+
+			if (left.destinationOffset != right.destinationOffset)
+				return left.destinationOffset < right.destinationOffset;
+
+			return lhs < rhs;
+		});
+
+	size_t groupStart = 0;
+	for (size_t i = 1; i <= sortedBufferCopies.size(); ++i)
+	{
+		if (i == sortedBufferCopies.size() ||
+			pendingCopies[sortedBufferCopies[i]].destination !=
+			pendingCopies[sortedBufferCopies[groupStart]].destination)
+		{
+			RecordBufferCopies(commandList, groupStart, i);
+			groupStart = i;
+		}
+	}
+
+	for (size_t i = 0; i < nrOfCopies; ++i)
+		pendingCopies[i] = PendingCopy();
+
+	nrOfPendingCopies.store(0, std::memory_order_release);
+}
+
+inline void RingBufferUploader::MarkSubmitted(UINT64 fenceValue)
+{
+	submissionMarkers.push_back({ fenceValue,
+		head.load(std::memory_order_acquire) });
+}
+
+inline void RingBufferUploader::ReclaimCompleted(UINT64 completedFenceValue)
+{
+	while (!submissionMarkers.empty() &&
+		submissionMarkers.front().fenceValue <= completedFenceValue)
+	{
+		tail.store(submissionMarkers.front().headPosition,
+			std::memory_order_release);
+		submissionMarkers.pop_front();
+	}
+}
+
+inline size_t RingBufferUploader::GetCapacity() const
+{
+	return capacity;
+}
+
+inline size_t RingBufferUploader::GetUsedSize() const
+{
+	return head.load(std::memory_order_acquire) -
+		tail.load(std::memory_order_acquire);
+}
+
+inline size_t RingBufferUploader::GetNrOfCopiesRequested() const
+{
+	return nrOfCopiesRequested;
+}
+
+inline size_t RingBufferUploader::GetNrOfCopiesIssued() const
+{
+	return nrOfCopiesIssued;
+}
+
+inline void RingBufferUploader::ResetCopyCounters()
+{
+	nrOfCopiesRequested = 0;
+	nrOfCopiesIssued = 0;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "WorkStealingThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define NSGG_STREAMING_ROW_COPY
+#endif
+
+struct RowCopyInfo
+{
+	void* destination = nullptr;
+	size_t destinationPitch = 0;
+	const void* source = nullptr;
+	size_t sourcePitch = 0;
+	size_t rowSize = 0;
+	size_t nrOfRows = 0;
+};
+
+// Copies the rows in [firstRow, lastRow) using non-temporal stores, which
+// avoids reading the destination into the cache and suits the write combined
+// memory of upload heaps. The stores are fenced before returning.
+inline void CopyRows(const RowCopyInfo& info, size_t firstRow, size_t lastRow)
+{
+	unsigned char* destinationBase = static_cast<unsigned char*>(info.destination);
+	const unsigned char* sourceBase = static_cast<const unsigned char*>(info.source);
+
+#ifdef NSGG_STREAMING_ROW_COPY
+	for (size_t row = firstRow; row < lastRow; ++row)
+	{
+		unsigned char* destination = destinationBase + row * info.destinationPitch;
+		const unsigned char* source = sourceBase + row * info.sourcePitch;
+		size_t bytesLeft = info.rowSize;
+
+		// Streaming stores need an aligned destination, upload memory rows
+		// normally are which makes this a no-op
+		size_t misalignment = reinterpret_cast<std::uintptr_t>(destination) & 15;
+		if (misalignment != 0)
+		{
+			size_t headSize = std::min(16 - misalignment, bytesLeft);
+			std::memcpy(destination, source, headSize);
+			destination += headSize;
+			source += headSize;
+			bytesLeft -= headSize;
+		}
+
+		for (; bytesLeft >= 64; bytesLeft -= 64, destination += 64, source += 64)
+		{
+			__m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+			__m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 16));
+			__m128i third = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 32));
+			__m128i fourth = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 48));
+			_mm_stream_si128(reinterpret_cast<__m128i*>(destination), first);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(destination + 16), second);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(destination + 32), third);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(destination + 48), fourth);
+		}
+
+		for (; bytesLeft >= 16; bytesLeft -= 16, destination += 16, source += 16)
+		{
+			_mm_stream_si128(reinterpret_cast<__m128i*>(destination),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(source)));
+		}
+
+		if (bytesLeft != 0)
+			std::memcpy(destination, source, bytesLeft);
+	}
+
+	_mm_sfence();
+#else
+	for (size_t row = firstRow; row < lastRow; ++row)
+	{
+		std::memcpy(destinationBase + row * info.destinationPitch,
+			sourceBase + row * info.sourcePitch, info.rowSize);
+	}
+#endif
+}
+
+inline void CopyRows(const RowCopyInfo& info)
+{
+	if (info.destinationPitch == info.rowSize && info.sourcePitch == info.rowSize)
+	{
+		RowCopyInfo singleRow = info;
+		singleRow.rowSize = info.rowSize * info.nrOfRows;
+		singleRow.nrOfRows = 1;
+		CopyRows(singleRow, 0, 1);
+		return;
+	}
+
+	CopyRows(info, 0, info.nrOfRows);
+}
+
+// Splits the rows over the threads of the pool, the calling thread being one
+// of them. Copies too small to give every thread minimumBytesPerThread use
+// fewer threads, so small subresources stay on the calling thread.
+inline void CopyRowsParallel(const RowCopyInfo& info, WorkStealingThreadPool& threadPool,
+	size_t minimumBytesPerThread = 4 * 1024 * 1024)
+{
+	size_t totalBytes = info.rowSize * info.nrOfRows;
+	size_t threadsToUse = std::min<size_t>({ threadPool.NrOfThreads(), info.nrOfRows,
+		totalBytes / std::max<size_t>(minimumBytesPerThread, 1) });
+
+	if (threadsToUse <= 1)
+	{
+		CopyRows(info);
+		return;
+	}
+
+	size_t rowsPerThread = info.nrOfRows / threadsToUse;
+	size_t extraRows = info.nrOfRows % threadsToUse;
+
+	threadPool.ParallelFor(threadsToUse, [&](size_t partIndex)
+		{
+			size_t firstRow = partIndex * rowsPerThread + std::min(partIndex, extraRows);
+			size_t lastRow = firstRow + rowsPerThread + (partIndex < extraRows ? 1 : 0);
+			CopyRows(info, firstRow, lastRow);
+		});
+}
\ No newline at end of file
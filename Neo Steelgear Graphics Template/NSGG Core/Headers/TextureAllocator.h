@@ -9,6 +9,7 @@
 #include "ResourceAllocator.h"
 #include "HeapHelper.h"
 #include "ResourceUploader.h"
+#include "AllocatorStatistics.h"
 
 struct TextureDimensions
 {
@@ -152,4 +153,32 @@ public:
 	TextureHandle GetHandle(const ResourceIdentifier& identifier);
 	const TextureHandle GetHandle(const ResourceIdentifier& identifier) const;
 	D3D12_RESOURCE_STATES GetCurrentState(const ResourceIdentifier& identifier);
-};
\ No newline at end of file
+	AllocatorStatistics GetStatistics() const;
+};
+
+inline AllocatorStatistics TextureAllocator::GetStatistics() const
+{
+	// The chunk sizes are the allocation sizes the textures were placed with.
+	// The counters are left for AllocatorStatisticsTracker to derive from
+	// samples.
+	AllocatorStatistics toReturn;
+	std::vector<std::pair<size_t, size_t>> ranges;
+
+	for (const MemoryChunk& memoryChunk : memoryChunks)
+	{
+		ranges.clear();
+
+		for (size_t i = 0; i < memoryChunk.textures.GetCurrentMaxIndex(); ++i)
+		{
+			if (memoryChunk.textures.ChunkActive(i))
+			{
+				ranges.push_back({ memoryChunk.textures.GetStartOfChunk(i),
+					memoryChunk.textures.GetSizeOfChunk(i) });
+			}
+		}
+
+		AccumulateAllocatedRanges(ranges, memoryChunk.textures.TotalSize(), toReturn);
+	}
+
+	return toReturn;
+}
\ No newline at end of file
@@ -135,6 +135,8 @@ public:
 	D3D12_RESOURCE_BARRIER CreateTransitionBarrier(const ResourceIndex& resourceIndex,
 		D3D12_RESOURCE_STATES newState,
 		D3D12_RESOURCE_BARRIER_FLAGS flag = D3D12_RESOURCE_BARRIER_FLAG_NONE);
+
+	AllocatorStatistics GetStatistics() const;
 };
 
 template<typename DescSRV, typename DescUAV, typename DescRTV, typename DescDSV>
@@ -347,3 +349,11 @@ TextureComponent<DescSRV, DescUAV, DescRTV, DescDSV>::CreateTransitionBarrier(
 	return textureAllocator.CreateTransitionBarrier(
 		resourceIndex.allocatorIdentifier, newState, flag);
 }
+
+
+template<typename DescSRV, typename DescUAV, typename DescRTV, typename DescDSV>
+inline AllocatorStatistics
+TextureComponent<DescSRV, DescUAV, DescRTV, DescDSV>::GetStatistics() const
+{
+	return textureAllocator.GetStatistics();
+}
\ No newline at end of file
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+// Fork and join pool for per frame work. Every worker, and the thread calling
+// ParallelFor, has its own queue that it takes tasks from the back of, and
+// takes from the front of the other queues when its own runs dry.
+// ParallelFor may be called from several threads at once, each call waits for
+// its own tasks and may run those of the other calls meanwhile.
+class WorkStealingThreadPool
+{
+private:
+	struct TaskGroup
+	{
+		std::atomic<size_t> nrOfUnfinishedTasks = 0;
+		std::mutex exceptionMutex;
+		std::exception_ptr exception = nullptr;
+	};
+
+	struct Task
+	{
+		const std::function<void(size_t)>* function = nullptr;
+		size_t taskIndex = 0;
+		TaskGroup* group = nullptr;
+	};
+
+	struct TaskQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<TaskQueue>> queues; // The calling thread's is last
+	std::vector<std::thread> workers;
+	std::atomic<size_t> nrOfQueuedTasks = 0;
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+	bool stopWorkers = false;
+
+	void WorkerLoop(size_t queueIndex);
+	bool TryGetTask(size_t queueIndex, Task& task);
+	void RunTask(const Task& task);
+
+public:
+	WorkStealingThreadPool() = default;
+	~WorkStealingThreadPool();
+	WorkStealingThreadPool(const WorkStealingThreadPool& other) = delete;
+	WorkStealingThreadPool& operator=(const WorkStealingThreadPool& other) = delete;
+	WorkStealingThreadPool(WorkStealingThreadPool&& other) = delete;
+	WorkStealingThreadPool& operator=(WorkStealingThreadPool&& other) = delete;
+
+	// No threads are started if 0, all work then runs on the calling thread
+	void Initialize(size_t nrOfWorkerThreads);
+	void Shutdown();
+
+	// Calls the function once for every index in [0, nrOfTasks) and returns
+	// when all calls have finished. The first exception thrown by a call is
+	// rethrown once the rest are done.
+	void ParallelFor(size_t nrOfTasks, const std::function<void(size_t)>& function);
+
+	// Worker threads plus the thread calling ParallelFor
+	size_t NrOfThreads() const;
+};
+
+inline void WorkStealingThreadPool::WorkerLoop(size_t queueIndex)
+{
+	while (true)
+	{
+		Task task;
+		if (TryGetTask(queueIndex, task))
+		{
+			RunTask(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCondition.wait(lock, [this]()
+			{
+				return stopWorkers || nrOfQueuedTasks.load() != 0;
+			});
+
+		if (stopWorkers)
+			return;
+	}
+}
+
+inline bool WorkStealingThreadPool::TryGetTask(size_t queueIndex, Task& task)
+{
+	for (size_t i = 0; i < queues.size(); ++i)
+	{
+		TaskQueue& queue = *queues[(queueIndex + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (queue.tasks.empty())
+			continue;
+
+		if (i == 0)
+		{
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+		}
+
+		--nrOfQueuedTasks;
+		return true;
+	}
+
+	return false;
+}
+
+inline void WorkStealingThreadPool::RunTask(const Task& task)
+{
+	try
+	{
+		(*task.function)(task.taskIndex);
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(task.group->exceptionMutex);
+		if (task.group->exception == nullptr)
+			task.group->exception = std::current_exception();
+	}
+
+	// The group may be gone as soon as the last task is marked as finished
+	task.group->nrOfUnfinishedTasks.fetch_sub(1, std::memory_order_release);
+}
+
+inline WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+	Shutdown();
+}
+
+inline void WorkStealingThreadPool::Initialize(size_t nrOfWorkerThreads)
+{
+	Shutdown();
+	stopWorkers = false;
+
+	for (size_t i = 0; i < nrOfWorkerThreads + 1; ++i)
+		queues.push_back(std::make_unique<TaskQueue>());
+
+	for (size_t i = 0; i < nrOfWorkerThreads; ++i)
+		workers.emplace_back(&WorkStealingThreadPool::WorkerLoop, this, i);
+}
+
+inline void WorkStealingThreadPool::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopWorkers = true;
+	}
+
+	sleepCondition.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	workers.clear();
+	queues.clear();
+	nrOfQueuedTasks = 0;
+}
+
+inline void WorkStealingThreadPool::ParallelFor(size_t nrOfTasks,
+	const std::function<void(size_t)>& function)
+{
+	if (workers.empty() || nrOfTasks <= 1)
+	{
+		for (size_t i = 0; i < nrOfTasks; ++i)
+			function(i);
+
+		return;
+	}
+
+	TaskGroup group;
+	group.nrOfUnfinishedTasks = nrOfTasks;
+	nrOfQueuedTasks += nrOfTasks;
+
+	// Each queue gets a contiguous range, pushed so that its owner starts with
+	// the lowest index while thieves take from the other end
+	for (size_t i = 0; i < queues.size(); ++i)
+	{
+		size_t rangeStart = nrOfTasks * i / queues.size();
+		size_t rangeEnd = nrOfTasks * (i + 1) / queues.size();
+		std::lock_guard<std::mutex> lock(queues[i]->mutex);
+
+		for (size_t taskIndex = rangeEnd; taskIndex > rangeStart; --taskIndex)
+			queues[i]->tasks.push_back({ &function, taskIndex - 1, &group });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+
+	sleepCondition.notify_all();
+
+	size_t callingQueueIndex = queues.size() - 1;
+	while (group.nrOfUnfinishedTasks.load(std::memory_order_acquire) != 0)
+	{
+		Task task;
+		if (TryGetTask(callingQueueIndex, task))
+			RunTask(task);
+		else
+			std::this_thread::yield();
+	}
+
+	if (group.exception != nullptr)
+		std::rethrow_exception(group.exception);
+}
+
+inline size_t WorkStealingThreadPool::NrOfThreads() const
+{
+	return workers.size() + 1;
+}
\ No newline at end of file
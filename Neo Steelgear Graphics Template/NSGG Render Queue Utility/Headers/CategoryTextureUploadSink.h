@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdexcept>
+
+#include <ManagedResourceCategories.h>
+
+#include "TextureStreamer.h"
+
+typedef TextureUploadSink<CategoryIdentifier, CategoryResourceIdentifier>
+	CategoryUploadSink;
+typedef TextureStreamer<CategoryIdentifier, CategoryResourceIdentifier>
+	CategoryTextureStreamer;
+
+// Streams textures into a texture category of the resource categories, the
+// category format must match the format the decoder produces
+template<FrameType Frames>
+class CategoryTextureUploadSink : public CategoryUploadSink
+{
+private:
+	ManagedResourceCategories<Frames>* resourceCategories = nullptr;
+
+public:
+	CategoryTextureUploadSink() = default;
+	~CategoryTextureUploadSink() = default;
+	CategoryTextureUploadSink(const CategoryTextureUploadSink& other) = default;
+	CategoryTextureUploadSink& operator=(const CategoryTextureUploadSink& other) = default;
+	CategoryTextureUploadSink(CategoryTextureUploadSink&& other) = default;
+	CategoryTextureUploadSink& operator=(CategoryTextureUploadSink&& other) = default;
+
+	void Initialize(ManagedResourceCategories<Frames>* categoriesToUse);
+
+	bool CreateTexture(const CategoryIdentifier& category,
+		const DecodedTexture& texture, CategoryResourceIdentifier& created) override;
+	void UploadSubresource(const CategoryResourceIdentifier& identifier,
+		const DecodedTexture& texture, std::uint8_t subresourceIndex) override;
+
+	// The clamp is returned with the handle of the texture
+	void SetResidency(
+		const TextureResidency<CategoryResourceIdentifier>& residency) override;
+};
+
+template<FrameType Frames>
+inline void CategoryTextureUploadSink<Frames>::Initialize(
+	ManagedResourceCategories<Frames>* categoriesToUse)
+{
+	resourceCategories = categoriesToUse;
+}
+
+template<FrameType Frames>
+inline bool CategoryTextureUploadSink<Frames>::CreateTexture(
+	const CategoryIdentifier& category, const DecodedTexture& texture,
+	CategoryResourceIdentifier& created)
+{
+	if (category.type != CategoryType::TEXTURE2D)
+		return false;
+
+	try
+	{
+		created = resourceCategories->CreateTexture2D(category, texture.width,
+			texture.height, 1, texture.subresources.size());
+	}
+	catch (const std::runtime_error&)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+template<FrameType Frames>
+inline void CategoryTextureUploadSink<Frames>::UploadSubresource(
+	const CategoryResourceIdentifier& identifier, const DecodedTexture& texture,
+	std::uint8_t subresourceIndex)
+{
+	// The categories read the data when the updates are recorded, which the
+	// streamer outlives by keeping the data for a number of frames
+	resourceCategories->SetResourceData(identifier,
+		const_cast<unsigned char*>(texture.subresources[subresourceIndex].data()),
+		subresourceIndex);
+}
+
+template<FrameType Frames>
+inline void CategoryTextureUploadSink<Frames>::SetResidency(
+	const TextureResidency<CategoryResourceIdentifier>& residency)
+{
+	resourceCategories->SetTextureMinLODClamp(residency.identifier,
+		residency.GetMinLODClamp());
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include <d3d12.h>
+#include <dxgi1_6.h>
+
+#include <ResourceUploader.h>
+#include <RingBufferUploader.h>
+
+#include "MappedFile.h"
+#include "DDSHeaderParser.h"
+
+struct DDSTextureDesc
+{
+	D3D12_RESOURCE_DIMENSION dimension = D3D12_RESOURCE_DIMENSION_UNKNOWN;
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	unsigned int depth = 0;
+	unsigned int arraySize = 0; // Six per cube for cube maps
+	unsigned int mipLevels = 0;
+	bool cubeMap = false;
+	bool blockCompressed = false;
+	size_t bytesPerElement = 0; // Per texel, or per 4x4 block if block compressed
+
+	D3D12_RESOURCE_DESC GetResourceDesc() const;
+};
+
+// DDSHeaderParser numbers its formats and dimensions like Direct3D
+static_assert(static_cast<std::uint32_t>(DDSFormat::R8G8B8A8_UNORM) ==
+	DXGI_FORMAT_R8G8B8A8_UNORM);
+static_assert(static_cast<std::uint32_t>(DDSFormat::BC7_UNORM_SRGB) ==
+	DXGI_FORMAT_BC7_UNORM_SRGB);
+static_assert(static_cast<std::uint32_t>(DDSFormat::B4G4R4A4_UNORM) ==
+	DXGI_FORMAT_B4G4R4A4_UNORM);
+static_assert(static_cast<std::uint32_t>(DDSDimension::TEXTURE3D) ==
+	D3D12_RESOURCE_DIMENSION_TEXTURE3D);
+
+// Parses a DDS file where it lies in memory, subresources are read straight
+// from the mapped file when uploading so the data is copied only once
+class DDSFile
+{
+private:
+	MappedFile file;
+	const unsigned char* fileData = nullptr;
+	DDSTextureDesc desc;
+	std::vector<DDSSubresource> subresources;
+
+	static DDSTextureDesc ToTextureDesc(const DDSHeaderDesc& headerDesc);
+	static DDSHeaderDesc ToHeaderDesc(const DDSTextureDesc& textureDesc);
+
+public:
+	DDSFile() = default;
+	~DDSFile() = default;
+	DDSFile(const DDSFile& other) = delete;
+	DDSFile& operator=(const DDSFile& other) = delete;
+	DDSFile(DDSFile&& other) = default;
+	DDSFile& operator=(DDSFile&& other) = default;
+
+	void Open(const std::string& filePath);
+
+	// The data must outlive the object, nothing is copied
+	void Parse(const unsigned char* data, size_t dataSize);
+
+	const DDSTextureDesc& GetDesc() const;
+	const std::vector<DDSSubresource>& GetSubresources() const;
+	const unsigned char* GetSubresourceData(size_t subresourceIndex) const;
+
+	// Block compressed formats cannot be described by the texel based upload
+	// info, those need to be staged through the ring uploader instead
+	bool Upload(ResourceUploader& uploader, ID3D12GraphicsCommandList* commandList,
+		ID3D12Resource* toUploadTo) const;
+	bool Stage(RingBufferUploader& uploader, ID3D12Resource* toUploadTo,
+		WorkStealingThreadPool* threadPool = nullptr) const;
+
+	static bool GetFormatInfo(DXGI_FORMAT format, bool& blockCompressed,
+		size_t& bytesPerElement);
+	static size_t CalculateSubresourceLayout(const DDSTextureDesc& desc,
+		size_t dataOffset, std::vector<DDSSubresource>& layout);
+};
+
+inline D3D12_RESOURCE_DESC DDSTextureDesc::GetResourceDesc() const
+{
+	D3D12_RESOURCE_DESC toReturn;
+	toReturn.Dimension = dimension;
+	toReturn.Alignment = 0;
+	toReturn.Width = width;
+	toReturn.Height = height;
+	toReturn.DepthOrArraySize = static_cast<UINT16>(
+		dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? depth : arraySize);
+	toReturn.MipLevels = static_cast<UINT16>(mipLevels);
+	toReturn.Format = format;
+	toReturn.SampleDesc.Count = 1;
+	toReturn.SampleDesc.Quality = 0;
+	toReturn.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+	toReturn.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	return toReturn;
+}
+
+inline DDSTextureDesc DDSFile::ToTextureDesc(const DDSHeaderDesc& headerDesc)
+{
+	DDSTextureDesc toReturn;
+	toReturn.dimension = static_cast<D3D12_RESOURCE_DIMENSION>(headerDesc.dimension);
+	toReturn.format = static_cast<DXGI_FORMAT>(headerDesc.format);
+	toReturn.width = headerDesc.width;
+	toReturn.height = headerDesc.height;
+	toReturn.depth = headerDesc.depth;
+	toReturn.arraySize = headerDesc.arraySize;
+	toReturn.mipLevels = headerDesc.mipLevels;
+	toReturn.cubeMap = headerDesc.cubeMap;
+	toReturn.blockCompressed = headerDesc.blockCompressed;
+	toReturn.bytesPerElement = headerDesc.bytesPerElement;
+
+	return toReturn;
+}
+
+inline DDSHeaderDesc DDSFile::ToHeaderDesc(const DDSTextureDesc& textureDesc)
+{
+	DDSHeaderDesc toReturn;
+	toReturn.dimension = static_cast<DDSDimension>(textureDesc.dimension);
+	toReturn.format = static_cast<DDSFormat>(textureDesc.format);
+	toReturn.width = textureDesc.width;
+	toReturn.height = textureDesc.height;
+	toReturn.depth = textureDesc.depth;
+	toReturn.arraySize = textureDesc.arraySize;
+	toReturn.mipLevels = textureDesc.mipLevels;
+	toReturn.cubeMap = textureDesc.cubeMap;
+	toReturn.blockCompressed = textureDesc.blockCompressed;
+	toReturn.bytesPerElement = textureDesc.bytesPerElement;
+
+	return toReturn;
+}
+
+inline void DDSFile::Open(const std::string& filePath)
+{
+	file.Open(filePath);
+	Parse(file.GetData(), file.GetSize());
+}
+
+inline void DDSFile::Parse(const unsigned char* data, size_t dataSize)
+{
+	DDSHeaderDesc headerDesc;
+	size_t dataOffset = DDSHeaderParser::Parse(data, dataSize, headerDesc);
+	size_t endOffset = DDSHeaderParser::CalculateSubresourceLayout(headerDesc,
+		dataOffset, subresources);
+	desc = ToTextureDesc(headerDesc);
+
+	if (endOffset > dataSize)
+		throw std::runtime_error("Error: DDS file too small for its subresources");
+
+	fileData = data;
+}
+
+inline const DDSTextureDesc& DDSFile::GetDesc() const
+{
+	return desc;
+}
+
+inline const std::vector<DDSSubresource>& DDSFile::GetSubresources() const
+{
+	return subresources;
+}
+
+inline const unsigned char* DDSFile::GetSubresourceData(size_t subresourceIndex) const
+{
+	return fileData + subresources[subresourceIndex].offset;
+}
+
+inline bool DDSFile::Upload(ResourceUploader& uploader,
+	ID3D12GraphicsCommandList* commandList, ID3D12Resource* toUploadTo) const
+{
+	if (desc.blockCompressed)
+		throw std::runtime_error("Error: Block compressed DDS data must be staged");
+
+	for (size_t i = 0; i < subresources.size(); ++i)
+	{
+		TextureUploadInfo uploadInfo;
+		uploadInfo.width = subresources[i].width;
+		uploadInfo.height = subresources[i].height;
+		uploadInfo.depth = subresources[i].depth;
+		uploadInfo.texelSizeInBytes = desc.bytesPerElement;
+		uploadInfo.format = desc.format;
+
+		if (!uploader.UploadTextureResourceData(toUploadTo, commandList,
+			const_cast<unsigned char*>(GetSubresourceData(i)), uploadInfo,
+			static_cast<unsigned int>(i)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+inline bool DDSFile::Stage(RingBufferUploader& uploader,
+	ID3D12Resource* toUploadTo, WorkStealingThreadPool* threadPool) const
+{
+	for (size_t i = 0; i < subresources.size(); ++i)
+	{
+		if (!uploader.StageSubresourceData(toUploadTo, GetSubresourceData(i),
+			subresources[i].rowSize, subresources[i].slicePitch,
+			static_cast<unsigned int>(i), threadPool))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+inline bool DDSFile::GetFormatInfo(DXGI_FORMAT format, bool& blockCompressed,
+	size_t& bytesPerElement)
+{
+	return DDSHeaderParser::GetFormatInfo(static_cast<DDSFormat>(format),
+		blockCompressed, bytesPerElement);
+}
+
+inline size_t DDSFile::CalculateSubresourceLayout(const DDSTextureDesc& desc,
+	size_t dataOffset, std::vector<DDSSubresource>& layout)
+{
+	return DDSHeaderParser::CalculateSubresourceLayout(ToHeaderDesc(desc),
+		dataOffset, layout);
+}
\ No newline at end of file
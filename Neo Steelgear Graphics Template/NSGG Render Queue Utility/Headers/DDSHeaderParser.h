@@ -0,0 +1,568 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+// DDS header parsing and subresource layout without Direct3D, DDSFile builds
+// on this for the parts that upload
+
+// The formats DDS files are read with, numbered as DXGI_FORMAT
+enum class DDSFormat : std::uint32_t
+{
+	UNKNOWN = 0,
+	R32G32B32A32_TYPELESS = 1,
+	R32G32B32A32_FLOAT = 2,
+	R32G32B32A32_UINT = 3,
+	R32G32B32A32_SINT = 4,
+	R32G32B32_TYPELESS = 5,
+	R32G32B32_FLOAT = 6,
+	R32G32B32_UINT = 7,
+	R32G32B32_SINT = 8,
+	R16G16B16A16_TYPELESS = 9,
+	R16G16B16A16_FLOAT = 10,
+	R16G16B16A16_UNORM = 11,
+	R16G16B16A16_UINT = 12,
+	R16G16B16A16_SNORM = 13,
+	R16G16B16A16_SINT = 14,
+	R32G32_TYPELESS = 15,
+	R32G32_FLOAT = 16,
+	R32G32_UINT = 17,
+	R32G32_SINT = 18,
+	R10G10B10A2_TYPELESS = 23,
+	R10G10B10A2_UNORM = 24,
+	R10G10B10A2_UINT = 25,
+	R11G11B10_FLOAT = 26,
+	R8G8B8A8_TYPELESS = 27,
+	R8G8B8A8_UNORM = 28,
+	R8G8B8A8_UNORM_SRGB = 29,
+	R8G8B8A8_UINT = 30,
+	R8G8B8A8_SNORM = 31,
+	R8G8B8A8_SINT = 32,
+	R16G16_TYPELESS = 33,
+	R16G16_FLOAT = 34,
+	R16G16_UNORM = 35,
+	R16G16_UINT = 36,
+	R16G16_SNORM = 37,
+	R16G16_SINT = 38,
+	R32_TYPELESS = 39,
+	R32_FLOAT = 41,
+	R32_UINT = 42,
+	R32_SINT = 43,
+	R8G8_TYPELESS = 48,
+	R8G8_UNORM = 49,
+	R8G8_UINT = 50,
+	R8G8_SNORM = 51,
+	R8G8_SINT = 52,
+	R16_TYPELESS = 53,
+	R16_FLOAT = 54,
+	R16_UNORM = 56,
+	R16_UINT = 57,
+	R16_SNORM = 58,
+	R16_SINT = 59,
+	R8_TYPELESS = 60,
+	R8_UNORM = 61,
+	R8_UINT = 62,
+	R8_SNORM = 63,
+	R8_SINT = 64,
+	A8_UNORM = 65,
+	R9G9B9E5_SHAREDEXP = 67,
+	BC1_TYPELESS = 70,
+	BC1_UNORM = 71,
+	BC1_UNORM_SRGB = 72,
+	BC2_TYPELESS = 73,
+	BC2_UNORM = 74,
+	BC2_UNORM_SRGB = 75,
+	BC3_TYPELESS = 76,
+	BC3_UNORM = 77,
+	BC3_UNORM_SRGB = 78,
+	BC4_TYPELESS = 79,
+	BC4_UNORM = 80,
+	BC4_SNORM = 81,
+	BC5_TYPELESS = 82,
+	BC5_UNORM = 83,
+	BC5_SNORM = 84,
+	B5G6R5_UNORM = 85,
+	B5G5R5A1_UNORM = 86,
+	B8G8R8A8_UNORM = 87,
+	B8G8R8X8_UNORM = 88,
+	B8G8R8A8_TYPELESS = 90,
+	B8G8R8A8_UNORM_SRGB = 91,
+	B8G8R8X8_TYPELESS = 92,
+	B8G8R8X8_UNORM_SRGB = 93,
+	BC6H_TYPELESS = 94,
+	BC6H_UF16 = 95,
+	BC6H_SF16 = 96,
+	BC7_TYPELESS = 97,
+	BC7_UNORM = 98,
+	BC7_UNORM_SRGB = 99,
+	B4G4R4A4_UNORM = 115
+};
+
+// Numbered as D3D12_RESOURCE_DIMENSION and the DX10 header
+enum class DDSDimension : std::uint32_t
+{
+	UNKNOWN = 0,
+	TEXTURE1D = 2,
+	TEXTURE2D = 3,
+	TEXTURE3D = 4
+};
+
+struct DDSHeaderDesc
+{
+	DDSDimension dimension = DDSDimension::UNKNOWN;
+	DDSFormat format = DDSFormat::UNKNOWN;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	unsigned int depth = 0;
+	unsigned int arraySize = 0; // Six per cube for cube maps
+	unsigned int mipLevels = 0;
+	bool cubeMap = false;
+	bool blockCompressed = false;
+	size_t bytesPerElement = 0; // Per texel, or per 4x4 block if block compressed
+};
+
+struct DDSSubresource
+{
+	size_t offset = 0; // From the start of the file
+	size_t rowSize = 0; // Rows of blocks if block compressed
+	size_t nrOfRows = 0;
+	size_t slicePitch = 0;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	unsigned int depth = 0;
+};
+
+class DDSHeaderParser
+{
+private:
+	struct PixelFormat
+	{
+		std::uint32_t size;
+		std::uint32_t flags;
+		std::uint32_t fourCC;
+		std::uint32_t rgbBitCount;
+		std::uint32_t rBitMask;
+		std::uint32_t gBitMask;
+		std::uint32_t bBitMask;
+		std::uint32_t aBitMask;
+	};
+
+	struct Header
+	{
+		std::uint32_t size;
+		std::uint32_t flags;
+		std::uint32_t height;
+		std::uint32_t width;
+		std::uint32_t pitchOrLinearSize;
+		std::uint32_t depth;
+		std::uint32_t mipMapCount;
+		std::uint32_t reserved1[11];
+		PixelFormat pixelFormat;
+		std::uint32_t caps;
+		std::uint32_t caps2;
+		std::uint32_t caps3;
+		std::uint32_t caps4;
+		std::uint32_t reserved2;
+	};
+
+	struct HeaderDXT10
+	{
+		std::uint32_t dxgiFormat;
+		std::uint32_t resourceDimension;
+		std::uint32_t miscFlag;
+		std::uint32_t arraySize;
+		std::uint32_t miscFlags2;
+	};
+
+	static constexpr std::uint32_t MakeFourCC(char a, char b, char c, char d);
+	static DDSFormat GetLegacyFormat(const PixelFormat& pixelFormat);
+
+public:
+	DDSHeaderParser() = delete;
+
+	// Validates the header and returns the offset of the first subresource
+	static size_t Parse(const unsigned char* data, size_t dataSize,
+		DDSHeaderDesc& desc);
+
+	static bool GetFormatInfo(DDSFormat format, bool& blockCompressed,
+		size_t& bytesPerElement);
+	static size_t CalculateSubresourceLayout(const DDSHeaderDesc& desc,
+		size_t dataOffset, std::vector<DDSSubresource>& layout);
+};
+
+inline constexpr std::uint32_t DDSHeaderParser::MakeFourCC(char a, char b, char c, char d)
+{
+	return static_cast<std::uint32_t>(static_cast<unsigned char>(a)) |
+		(static_cast<std::uint32_t>(static_cast<unsigned char>(b)) << 8) |
+		(static_cast<std::uint32_t>(static_cast<unsigned char>(c)) << 16) |
+		(static_cast<std::uint32_t>(static_cast<unsigned char>(d)) << 24);
+}
+
+inline DDSFormat DDSHeaderParser::GetLegacyFormat(const PixelFormat& pixelFormat)
+{
+	const std::uint32_t FOURCC = 0x4;
+	const std::uint32_t RGB = 0x40;
+	const std::uint32_t LUMINANCE = 0x20000;
+	const std::uint32_t ALPHA = 0x2;
+
+	auto masksAre = [&pixelFormat](std::uint32_t r, std::uint32_t g,
+		std::uint32_t b, std::uint32_t a)
+	{
+		return pixelFormat.rBitMask == r && pixelFormat.gBitMask == g &&
+			pixelFormat.bBitMask == b && pixelFormat.aBitMask == a;
+	};
+
+	if (pixelFormat.flags & FOURCC)
+	{
+		switch (pixelFormat.fourCC)
+		{
+		case MakeFourCC('D', 'X', 'T', '1'): return DDSFormat::BC1_UNORM;
+		case MakeFourCC('D', 'X', 'T', '2'):
+		case MakeFourCC('D', 'X', 'T', '3'): return DDSFormat::BC2_UNORM;
+		case MakeFourCC('D', 'X', 'T', '4'):
+		case MakeFourCC('D', 'X', 'T', '5'): return DDSFormat::BC3_UNORM;
+		case MakeFourCC('A', 'T', 'I', '1'):
+		case MakeFourCC('B', 'C', '4', 'U'): return DDSFormat::BC4_UNORM;
+		case MakeFourCC('B', 'C', '4', 'S'): return DDSFormat::BC4_SNORM;
+		case MakeFourCC('A', 'T', 'I', '2'):
+		case MakeFourCC('B', 'C', '5', 'U'): return DDSFormat::BC5_UNORM;
+		case MakeFourCC('B', 'C', '5', 'S'): return DDSFormat::BC5_SNORM;
+		case 36: return DDSFormat::R16G16B16A16_UNORM;
+		case 110: return DDSFormat::R16G16B16A16_SNORM;
+		case 111: return DDSFormat::R16_FLOAT;
+		case 112: return DDSFormat::R16G16_FLOAT;
+		case 113: return DDSFormat::R16G16B16A16_FLOAT;
+		case 114: return DDSFormat::R32_FLOAT;
+		case 115: return DDSFormat::R32G32_FLOAT;
+		case 116: return DDSFormat::R32G32B32A32_FLOAT;
+		default: return DDSFormat::UNKNOWN;
+		}
+	}
+
+	if (pixelFormat.flags & RGB)
+	{
+		switch (pixelFormat.rgbBitCount)
+		{
+		case 32:
+			if (masksAre(0xff, 0xff00, 0xff0000, 0xff000000))
+				return DDSFormat::R8G8B8A8_UNORM;
+			if (masksAre(0xff0000, 0xff00, 0xff, 0xff000000))
+				return DDSFormat::B8G8R8A8_UNORM;
+			if (masksAre(0xff0000, 0xff00, 0xff, 0))
+				return DDSFormat::B8G8R8X8_UNORM;
+			if (masksAre(0x3ff, 0xffc00, 0x3ff00000, 0xc0000000))
+				return DDSFormat::R10G10B10A2_UNORM;
+			if (masksAre(0xffff, 0xffff0000, 0, 0))
+				return DDSFormat::R16G16_UNORM;
+			if (masksAre(0xffffffff, 0, 0, 0))
+				return DDSFormat::R32_FLOAT;
+			break;
+		case 16:
+			if (masksAre(0x7c00, 0x3e0, 0x1f, 0x8000))
+				return DDSFormat::B5G5R5A1_UNORM;
+			if (masksAre(0xf800, 0x7e0, 0x1f, 0))
+				return DDSFormat::B5G6R5_UNORM;
+			if (masksAre(0xf00, 0xf0, 0xf, 0xf000))
+				return DDSFormat::B4G4R4A4_UNORM;
+			break;
+		}
+
+		return DDSFormat::UNKNOWN;
+	}
+
+	if (pixelFormat.flags & LUMINANCE)
+	{
+		if (pixelFormat.rgbBitCount == 8 && masksAre(0xff, 0, 0, 0))
+			return DDSFormat::R8_UNORM;
+		if (pixelFormat.rgbBitCount == 16 && masksAre(0xffff, 0, 0, 0))
+			return DDSFormat::R16_UNORM;
+		if (pixelFormat.rgbBitCount == 16 && masksAre(0xff, 0, 0, 0xff00))
+			return DDSFormat::R8G8_UNORM;
+
+		return DDSFormat::UNKNOWN;
+	}
+
+	if ((pixelFormat.flags & ALPHA) && pixelFormat.rgbBitCount == 8)
+		return DDSFormat::A8_UNORM;
+
+	return DDSFormat::UNKNOWN;
+}
+
+inline size_t DDSHeaderParser::Parse(const unsigned char* data, size_t dataSize,
+	DDSHeaderDesc& desc)
+{
+	const std::uint32_t MAGIC = MakeFourCC('D', 'D', 'S', ' ');
+	const std::uint32_t HEADER_FLAGS_VOLUME = 0x800000;
+	const std::uint32_t CAPS2_CUBEMAP = 0x200;
+	const std::uint32_t CAPS2_CUBEMAP_ALLFACES = 0xfc00;
+	const std::uint32_t CAPS2_VOLUME = 0x200000;
+	const std::uint32_t MISC_TEXTURECUBE = 0x4;
+
+	// Copied out as the mapped data gives no alignment guarantees
+	std::uint32_t magic = 0;
+	Header header;
+
+	if (dataSize < sizeof(magic) + sizeof(header))
+		throw std::runtime_error("Error: DDS file too small for its header");
+
+	std::memcpy(&magic, data, sizeof(magic));
+	std::memcpy(&header, data + sizeof(magic), sizeof(header));
+	size_t dataOffset = sizeof(magic) + sizeof(header);
+
+	if (magic != MAGIC || header.size != sizeof(Header) ||
+		header.pixelFormat.size != sizeof(PixelFormat))
+	{
+		throw std::runtime_error("Error: Invalid DDS header");
+	}
+
+	desc = DDSHeaderDesc();
+	desc.width = header.width;
+	desc.height = std::max(header.height, std::uint32_t(1));
+	desc.depth = 1;
+	desc.arraySize = 1;
+	desc.mipLevels = std::max(header.mipMapCount, std::uint32_t(1));
+
+	if ((header.pixelFormat.flags & 0x4) &&
+		header.pixelFormat.fourCC == MakeFourCC('D', 'X', '1', '0'))
+	{
+		HeaderDXT10 extension;
+
+		if (dataSize < dataOffset + sizeof(extension))
+			throw std::runtime_error("Error: DDS file too small for its DX10 header");
+
+		std::memcpy(&extension, data + dataOffset, sizeof(extension));
+		dataOffset += sizeof(extension);
+
+		if (extension.arraySize > 2048)
+			throw std::runtime_error("Error: Invalid DDS array size");
+
+		desc.format = static_cast<DDSFormat>(extension.dxgiFormat);
+		desc.arraySize = extension.arraySize;
+
+		switch (extension.resourceDimension)
+		{
+		case 2: // TEXTURE1D
+			desc.dimension = DDSDimension::TEXTURE1D;
+			desc.height = 1;
+			break;
+		case 3: // TEXTURE2D
+			desc.dimension = DDSDimension::TEXTURE2D;
+			if (extension.miscFlag & MISC_TEXTURECUBE)
+			{
+				desc.cubeMap = true;
+				desc.arraySize *= 6;
+			}
+			break;
+		case 4: // TEXTURE3D
+			desc.dimension = DDSDimension::TEXTURE3D;
+			desc.depth = std::max(header.depth, std::uint32_t(1));
+			if (desc.arraySize != 1)
+				throw std::runtime_error("Error: DDS volume textures cannot be arrays");
+			break;
+		default:
+			throw std::runtime_error("Error: Unknown DDS resource dimension");
+		}
+	}
+	else
+	{
+		desc.format = GetLegacyFormat(header.pixelFormat);
+
+		if ((header.flags & HEADER_FLAGS_VOLUME) || (header.caps2 & CAPS2_VOLUME))
+		{
+			desc.dimension = DDSDimension::TEXTURE3D;
+			desc.depth = std::max(header.depth, std::uint32_t(1));
+		}
+		else if (header.caps2 & CAPS2_CUBEMAP)
+		{
+			if ((header.caps2 & CAPS2_CUBEMAP_ALLFACES) != CAPS2_CUBEMAP_ALLFACES)
+				throw std::runtime_error("Error: Partial DDS cube maps are not supported");
+
+			desc.dimension = DDSDimension::TEXTURE2D;
+			desc.cubeMap = true;
+			desc.arraySize = 6;
+		}
+		else
+		{
+			desc.dimension = DDSDimension::TEXTURE2D;
+		}
+	}
+
+	if (!GetFormatInfo(desc.format, desc.blockCompressed, desc.bytesPerElement))
+		throw std::runtime_error("Error: Unsupported DDS format");
+
+	if (desc.width == 0 || desc.arraySize == 0 || desc.width > 16384 ||
+		desc.height > 16384 || desc.depth > 2048 || desc.arraySize > 2048 * 6)
+	{
+		throw std::runtime_error("Error: Invalid DDS dimensions");
+	}
+
+	unsigned int largestDimension = std::max({ desc.width, desc.height, desc.depth });
+	unsigned int maximumMips = 1;
+	while ((largestDimension >> maximumMips) != 0)
+		++maximumMips;
+
+	if (desc.mipLevels > maximumMips)
+		throw std::runtime_error("Error: Too many mip levels in DDS file");
+
+	return dataOffset;
+}
+
+inline bool DDSHeaderParser::GetFormatInfo(DDSFormat format, bool& blockCompressed,
+	size_t& bytesPerElement)
+{
+	blockCompressed = false;
+
+	switch (format)
+	{
+	case DDSFormat::BC1_TYPELESS:
+	case DDSFormat::BC1_UNORM:
+	case DDSFormat::BC1_UNORM_SRGB:
+	case DDSFormat::BC4_TYPELESS:
+	case DDSFormat::BC4_UNORM:
+	case DDSFormat::BC4_SNORM:
+		blockCompressed = true;
+		bytesPerElement = 8;
+		return true;
+	case DDSFormat::BC2_TYPELESS:
+	case DDSFormat::BC2_UNORM:
+	case DDSFormat::BC2_UNORM_SRGB:
+	case DDSFormat::BC3_TYPELESS:
+	case DDSFormat::BC3_UNORM:
+	case DDSFormat::BC3_UNORM_SRGB:
+	case DDSFormat::BC5_TYPELESS:
+	case DDSFormat::BC5_UNORM:
+	case DDSFormat::BC5_SNORM:
+	case DDSFormat::BC6H_TYPELESS:
+	case DDSFormat::BC6H_UF16:
+	case DDSFormat::BC6H_SF16:
+	case DDSFormat::BC7_TYPELESS:
+	case DDSFormat::BC7_UNORM:
+	case DDSFormat::BC7_UNORM_SRGB:
+		blockCompressed = true;
+		bytesPerElement = 16;
+		return true;
+	case DDSFormat::R32G32B32A32_TYPELESS:
+	case DDSFormat::R32G32B32A32_FLOAT:
+	case DDSFormat::R32G32B32A32_UINT:
+	case DDSFormat::R32G32B32A32_SINT:
+		bytesPerElement = 16;
+		return true;
+	case DDSFormat::R32G32B32_TYPELESS:
+	case DDSFormat::R32G32B32_FLOAT:
+	case DDSFormat::R32G32B32_UINT:
+	case DDSFormat::R32G32B32_SINT:
+		bytesPerElement = 12;
+		return true;
+	case DDSFormat::R16G16B16A16_TYPELESS:
+	case DDSFormat::R16G16B16A16_FLOAT:
+	case DDSFormat::R16G16B16A16_UNORM:
+	case DDSFormat::R16G16B16A16_UINT:
+	case DDSFormat::R16G16B16A16_SNORM:
+	case DDSFormat::R16G16B16A16_SINT:
+	case DDSFormat::R32G32_TYPELESS:
+	case DDSFormat::R32G32_FLOAT:
+	case DDSFormat::R32G32_UINT:
+	case DDSFormat::R32G32_SINT:
+		bytesPerElement = 8;
+		return true;
+	case DDSFormat::R10G10B10A2_TYPELESS:
+	case DDSFormat::R10G10B10A2_UNORM:
+	case DDSFormat::R10G10B10A2_UINT:
+	case DDSFormat::R11G11B10_FLOAT:
+	case DDSFormat::R8G8B8A8_TYPELESS:
+	case DDSFormat::R8G8B8A8_UNORM:
+	case DDSFormat::R8G8B8A8_UNORM_SRGB:
+	case DDSFormat::R8G8B8A8_UINT:
+	case DDSFormat::R8G8B8A8_SNORM:
+	case DDSFormat::R8G8B8A8_SINT:
+	case DDSFormat::R16G16_TYPELESS:
+	case DDSFormat::R16G16_FLOAT:
+	case DDSFormat::R16G16_UNORM:
+	case DDSFormat::R16G16_UINT:
+	case DDSFormat::R16G16_SNORM:
+	case DDSFormat::R16G16_SINT:
+	case DDSFormat::R32_TYPELESS:
+	case DDSFormat::R32_FLOAT:
+	case DDSFormat::R32_UINT:
+	case DDSFormat::R32_SINT:
+	case DDSFormat::R9G9B9E5_SHAREDEXP:
+	case DDSFormat::B8G8R8A8_UNORM:
+	case DDSFormat::B8G8R8X8_UNORM:
+	case DDSFormat::B8G8R8A8_TYPELESS:
+	case DDSFormat::B8G8R8A8_UNORM_SRGB:
+	case DDSFormat::B8G8R8X8_TYPELESS:
+	case DDSFormat::B8G8R8X8_UNORM_SRGB:
+		bytesPerElement = 4;
+		return true;
+	case DDSFormat::R8G8_TYPELESS:
+	case DDSFormat::R8G8_UNORM:
+	case DDSFormat::R8G8_UINT:
+	case DDSFormat::R8G8_SNORM:
+	case DDSFormat::R8G8_SINT:
+	case DDSFormat::R16_TYPELESS:
+	case DDSFormat::R16_FLOAT:
+	case DDSFormat::R16_UNORM:
+	case DDSFormat::R16_UINT:
+	case DDSFormat::R16_SNORM:
+	case DDSFormat::R16_SINT:
+	case DDSFormat::B5G6R5_UNORM:
+	case DDSFormat::B5G5R5A1_UNORM:
+	case DDSFormat::B4G4R4A4_UNORM:
+		bytesPerElement = 2;
+		return true;
+	case DDSFormat::R8_TYPELESS:
+	case DDSFormat::R8_UNORM:
+	case DDSFormat::R8_UINT:
+	case DDSFormat::R8_SNORM:
+	case DDSFormat::R8_SINT:
+	case DDSFormat::A8_UNORM:
+		bytesPerElement = 1;
+		return true;
+	default:
+		bytesPerElement = 0;
+		return false;
+	}
+}
+
+inline size_t DDSHeaderParser::CalculateSubresourceLayout(const DDSHeaderDesc& desc,
+	size_t dataOffset, std::vector<DDSSubresource>& layout)
+{
+	// The file stores every mip of the first array slice, then the next slice,
+	// which is also the D3D12 subresource order
+	layout.clear();
+	layout.reserve(static_cast<size_t>(desc.arraySize) * desc.mipLevels);
+	size_t currentOffset = dataOffset;
+
+	for (unsigned int slice = 0; slice < desc.arraySize; ++slice)
+	{
+		for (unsigned int mip = 0; mip < desc.mipLevels; ++mip)
+		{
+			DDSSubresource subresource;
+			subresource.offset = currentOffset;
+			subresource.width = std::max(desc.width >> mip, 1u);
+			subresource.height = std::max(desc.height >> mip, 1u);
+			subresource.depth = std::max(desc.depth >> mip, 1u);
+
+			if (desc.blockCompressed)
+			{
+				subresource.rowSize = std::max((subresource.width + 3) / 4, 1u) *
+					desc.bytesPerElement;
+				subresource.nrOfRows = std::max((subresource.height + 3) / 4, 1u);
+			}
+			else
+			{
+				subresource.rowSize = subresource.width * desc.bytesPerElement;
+				subresource.nrOfRows = subresource.height;
+			}
+
+			subresource.slicePitch = subresource.rowSize * subresource.nrOfRows;
+			currentOffset += subresource.slicePitch * subresource.depth;
+			layout.push_back(subresource);
+		}
+	}
+
+	return currentOffset;
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <string>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Read only view of a whole file, the pages are loaded on first access
+class MappedFile
+{
+private:
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int file = -1;
+#endif
+
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile& operator=(const MappedFile& other) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	void Open(const std::string& filePath);
+	void Close();
+
+	const unsigned char* GetData() const;
+	size_t GetSize() const;
+};
+
+inline MappedFile::~MappedFile()
+{
+	Close();
+}
+
+inline MappedFile::MappedFile(MappedFile&& other) noexcept : data(other.data),
+	size(other.size), file(other.file)
+#ifdef _WIN32
+	, mapping(other.mapping)
+#endif
+{
+	other.data = nullptr;
+	other.size = 0;
+#ifdef _WIN32
+	other.file = INVALID_HANDLE_VALUE;
+	other.mapping = nullptr;
+#else
+	other.file = -1;
+#endif
+}
+
+inline MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		data = other.data;
+		size = other.size;
+		file = other.file;
+		other.data = nullptr;
+		other.size = 0;
+#ifdef _WIN32
+		mapping = other.mapping;
+		other.file = INVALID_HANDLE_VALUE;
+		other.mapping = nullptr;
+#else
+		other.file = -1;
+#endif
+	}
+
+	return *this;
+}
+
+inline void MappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Error: Could not open file for mapping");
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		throw std::runtime_error("Error: Could not map empty or unreadable file");
+	}
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (mapping == nullptr)
+	{
+		Close();
+		throw std::runtime_error("Error: Could not create file mapping");
+	}
+
+	data = static_cast<const unsigned char*>(
+		MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+	if (data == nullptr)
+	{
+		Close();
+		throw std::runtime_error("Error: Could not map view of file");
+	}
+
+	size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	file = open(filePath.c_str(), O_RDONLY);
+
+	if (file == -1)
+		throw std::runtime_error("Error: Could not open file for mapping");
+
+	struct stat fileInfo;
+	if (fstat(file, &fileInfo) != 0 || fileInfo.st_size == 0)
+	{
+		Close();
+		throw std::runtime_error("Error: Could not map empty or unreadable file");
+	}
+
+	void* mapped = mmap(nullptr, static_cast<size_t>(fileInfo.st_size),
+		PROT_READ, MAP_PRIVATE, file, 0);
+
+	if (mapped == MAP_FAILED)
+	{
+		Close();
+		throw std::runtime_error("Error: Could not map view of file");
+	}
+
+	data = static_cast<const unsigned char*>(mapped);
+	size = static_cast<size_t>(fileInfo.st_size);
+	madvise(mapped, size, MADV_SEQUENTIAL);
+#endif
+}
+
+inline void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+
+	mapping = nullptr;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (data != nullptr)
+		munmap(const_cast<unsigned char*>(data), size);
+
+	if (file != -1)
+		close(file);
+
+	file = -1;
+#endif
+
+	data = nullptr;
+	size = 0;
+}
+
+inline const unsigned char* MappedFile::GetData() const
+{
+	return data;
+}
+
+inline size_t MappedFile::GetSize() const
+{
+	return size;
+}
\ No newline at end of file
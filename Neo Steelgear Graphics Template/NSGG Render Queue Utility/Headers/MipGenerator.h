@@ -0,0 +1,701 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <array>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define NSGG_SIMD_MIP_GENERATION
+#endif
+
+#include <d3d12.h>
+
+#include "TextureStreamer.h"
+#include "WorkStealingThreadPool.h"
+
+struct MipGenerationSettings
+{
+	bool colorDataIsSRGB = false; // Filters UNORM textures as sRGB, _SRGB formats always are
+	WorkStealingThreadPool* threadPool = nullptr; // Splits the rows of large mips
+	size_t minimumBytesPerThread = 1024 * 1024;
+};
+
+// Builds the full mip chain of a texture from its top mip with a 2x2 box
+// filter. Odd dimensions clamp at the edge. sRGB data is filtered in linear
+// space with alpha kept linear, and is rounded to the nearest sRGB value.
+class MipGenerator
+{
+private:
+	enum class FilterType
+	{
+		UNORM8,
+		SRGB8,
+		FLOAT
+	};
+
+	struct LevelInfo
+	{
+		const unsigned char* source = nullptr;
+		size_t sourceWidth = 0;
+		size_t sourceHeight = 0;
+		unsigned char* destination = nullptr;
+		size_t destinationWidth = 0;
+		size_t channels = 0;
+		FilterType filterType = FilterType::UNORM8;
+	};
+
+	std::array<float, 256> srgbToLinear;
+	std::array<float, 256> linearToSRGBThresholds; // Linear value of each code midpoint
+	std::array<std::uint8_t, 4096> linearToSRGBStart; // Lowest code per linear bucket
+
+	FilterType GetFilterType(const DecodedTexture& texture,
+		const MipGenerationSettings& settings, size_t& channels) const;
+	std::uint8_t EncodeSRGB(float linear) const;
+
+#ifdef NSGG_SIMD_MIP_GENERATION
+	static void AverageTexelsUNORM8(const unsigned char* top,
+		const unsigned char* bottom, unsigned char* destination);
+	__m128 LoadLinear(const unsigned char* firstTexel) const;
+	__m128i EncodeSRGB(__m128 linear) const;
+#endif
+
+	void FilterRowsUNORM8(const LevelInfo& level, size_t firstRow, size_t lastRow) const;
+	void FilterRowsSRGB8(const LevelInfo& level, size_t firstRow, size_t lastRow) const;
+	void FilterRowsFloat(const LevelInfo& level, size_t firstRow, size_t lastRow) const;
+	void FilterRows(const LevelInfo& level, size_t firstRow, size_t lastRow) const;
+
+public:
+	MipGenerator();
+	~MipGenerator() = default;
+	MipGenerator(const MipGenerator& other) = default;
+	MipGenerator& operator=(const MipGenerator& other) = default;
+	MipGenerator(MipGenerator&& other) = default;
+	MipGenerator& operator=(MipGenerator&& other) = default;
+
+	// Replaces all but the first subresource with the generated chain
+	void GenerateMipChain(DecodedTexture& texture,
+		const MipGenerationSettings& settings = MipGenerationSettings()) const;
+
+	static size_t CalculateNrOfMips(size_t width, size_t height);
+};
+
+// Everything a generated chain depends on besides the contents of the source
+struct MipChainCacheKey
+{
+	std::string sourcePath;
+	std::uint32_t format = 0; // The DXGI_FORMAT the decoder produces
+	std::uint8_t texelSizeInBytes = 0;
+	bool colorDataIsSRGB = false;
+};
+
+// Keeps generated chains on disk. A chain is only served for the same full
+// source path, format, texel size and filter settings, and only while the
+// source has the size and write time it had when the chain was stored.
+class MipChainCache
+{
+private:
+	std::filesystem::path cacheDirectory;
+
+	static constexpr std::uint32_t FILTER_SRGB = 1;
+
+	struct FileHeader
+	{
+		std::uint32_t magic = 0x4D495053; // "MIPS"
+		std::uint32_t version = 2;
+		std::uint64_t sourceSize = 0;
+		std::int64_t sourceWriteTime = 0;
+		std::uint64_t width = 0;
+		std::uint64_t height = 0;
+		std::uint32_t texelSizeInBytes = 0;
+		std::uint32_t format = 0;
+		std::uint32_t nrOfSubresources = 0;
+		std::uint32_t filterFlags = 0;
+		std::uint64_t sourcePathLength = 0; // The absolute path follows the header
+	};
+
+	bool CreateHeader(const MipChainCacheKey& key, FileHeader& header,
+		std::string& absolutePath) const;
+	std::filesystem::path GetCachePath(const MipChainCacheKey& key,
+		const std::string& absolutePath) const;
+
+public:
+	MipChainCache() = default;
+	~MipChainCache() = default;
+	MipChainCache(const MipChainCache& other) = default;
+	MipChainCache& operator=(const MipChainCache& other) = default;
+	MipChainCache(MipChainCache&& other) = default;
+	MipChainCache& operator=(MipChainCache&& other) = default;
+
+	void Initialize(const std::string& directory);
+
+	bool Load(const MipChainCacheKey& key, DecodedTexture& toLoadInto) const;
+	// Fails if the texture does not have the format and texel size of the key
+	bool Store(const MipChainCacheKey& key, const DecodedTexture& texture) const;
+
+	static MipChainCacheKey CreateKey(const std::string& sourcePath,
+		const DecodedTexture& texture, const MipGenerationSettings& settings);
+};
+
+// Wraps a decoder so the textures it produces get a full mip chain. The cache
+// is checked before decoding, so with a cache the format and texel size must
+// be given and be what the decoder produces. The generator, cache and any
+// thread pool in the settings must outlive it.
+inline TextureDecoder CreateMipGeneratingDecoder(const TextureDecoder& decoder,
+	const MipGenerator* generator, const MipGenerationSettings& settings,
+	const MipChainCache* cache = nullptr, std::uint32_t format = 0,
+	std::uint8_t texelSizeInBytes = 0)
+{
+	if (cache != nullptr && (format == 0 || texelSizeInBytes == 0))
+		throw std::runtime_error("Error: A mip chain cache needs the decoded format and texel size");
+
+	MipChainCacheKey key;
+	key.format = format;
+	key.texelSizeInBytes = texelSizeInBytes;
+	key.colorDataIsSRGB = settings.colorDataIsSRGB;
+
+	return [decoder, generator, settings, cache, key](const std::string& filePath,
+		DecodedTexture& toDecodeInto)
+	{
+		MipChainCacheKey fileKey = key;
+		fileKey.sourcePath = filePath;
+
+		if (cache != nullptr && cache->Load(fileKey, toDecodeInto))
+			return true;
+
+		if (!decoder(filePath, toDecodeInto))
+			return false;
+
+		generator->GenerateMipChain(toDecodeInto, settings);
+
+		if (cache != nullptr)
+		{
+			cache->Store(MipChainCache::CreateKey(filePath, toDecodeInto, settings),
+				toDecodeInto);
+		}
+
+		return true;
+	};
+}
+
+inline MipGenerator::FilterType MipGenerator::GetFilterType(
+	const DecodedTexture& texture, const MipGenerationSettings& settings,
+	size_t& channels) const
+{
+	switch (texture.format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+		channels = 4;
+		return settings.colorDataIsSRGB ? FilterType::SRGB8 : FilterType::UNORM8;
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		channels = 4;
+		return FilterType::SRGB8;
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_R32G32B32_FLOAT:
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		channels = texture.texelSizeInBytes / sizeof(float);
+		return FilterType::FLOAT;
+	default:
+		throw std::runtime_error("Error: Unsupported format for mip generation");
+	}
+}
+
+inline std::uint8_t MipGenerator::EncodeSRGB(float linear) const
+{
+	// The bucket gives a code at most a couple of steps below the answer,
+	// which is the number of code midpoints below the value
+	linear = std::min(std::max(linear, 0.0f), 1.0f);
+	size_t code = linearToSRGBStart[static_cast<size_t>(linear * 4095.0f)];
+
+	while (code < 255 && linearToSRGBThresholds[code] < linear)
+		++code;
+
+	return static_cast<std::uint8_t>(code);
+}
+
+#ifdef NSGG_SIMD_MIP_GENERATION
+inline void MipGenerator::AverageTexelsUNORM8(const unsigned char* top,
+	const unsigned char* bottom, unsigned char* destination)
+{
+	// Four destination texels from eight source texels per row, the sums fit
+	// in 16 bits
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi16(2);
+	__m128i topTexels[2] = {
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(top)),
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 16)) };
+	__m128i bottomTexels[2] = {
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom)),
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 16)) };
+	__m128i results[2];
+
+	for (int half = 0; half < 2; ++half)
+	{
+		__m128i lowSum = _mm_add_epi16(_mm_unpacklo_epi8(topTexels[half], zero),
+			_mm_unpacklo_epi8(bottomTexels[half], zero));
+		__m128i highSum = _mm_add_epi16(_mm_unpackhi_epi8(topTexels[half], zero),
+			_mm_unpackhi_epi8(bottomTexels[half], zero));
+
+		// Each 64 bit half holds the four channels of one texel, so pairing
+		// the halves sums horizontally neighbouring texels
+		__m128i pairSum = _mm_add_epi16(_mm_unpacklo_epi64(lowSum, highSum),
+			_mm_unpackhi_epi64(lowSum, highSum));
+		results[half] = _mm_srli_epi16(_mm_add_epi16(pairSum, rounding), 2);
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(destination),
+		_mm_packus_epi16(results[0], results[1]));
+}
+
+inline __m128 MipGenerator::LoadLinear(const unsigned char* firstTexel) const
+{
+	// One channel of every other texel, as every destination texel starts at
+	// an even source texel
+	return _mm_set_ps(srgbToLinear[firstTexel[24]], srgbToLinear[firstTexel[16]],
+		srgbToLinear[firstTexel[8]], srgbToLinear[firstTexel[0]]);
+}
+
+inline __m128i MipGenerator::EncodeSRGB(__m128 linear) const
+{
+	// The bucket gives the code or the one below it for every value in [0, 1],
+	// so a single compare against the midpoint above the bucket code is exact
+	linear = _mm_min_ps(_mm_max_ps(linear, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	alignas(16) std::int32_t buckets[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(buckets),
+		_mm_cvttps_epi32(_mm_mul_ps(linear, _mm_set1_ps(4095.0f))));
+
+	std::uint8_t codes[4] = { linearToSRGBStart[buckets[0]],
+		linearToSRGBStart[buckets[1]], linearToSRGBStart[buckets[2]],
+		linearToSRGBStart[buckets[3]] };
+	__m128 thresholds = _mm_set_ps(linearToSRGBThresholds[codes[3]],
+		linearToSRGBThresholds[codes[2]], linearToSRGBThresholds[codes[1]],
+		linearToSRGBThresholds[codes[0]]);
+	__m128i below = _mm_castps_si128(_mm_cmplt_ps(thresholds, linear));
+
+	return _mm_sub_epi32(_mm_set_epi32(codes[3], codes[2], codes[1], codes[0]), below);
+}
+#endif
+
+inline void MipGenerator::FilterRowsUNORM8(const LevelInfo& level,
+	size_t firstRow, size_t lastRow) const
+{
+	size_t rowSize = level.sourceWidth * level.channels;
+
+	for (size_t y = firstRow; y < lastRow; ++y)
+	{
+		const unsigned char* top = level.source + std::min(2 * y,
+			level.sourceHeight - 1) * rowSize;
+		const unsigned char* bottom = level.source + std::min(2 * y + 1,
+			level.sourceHeight - 1) * rowSize;
+		unsigned char* destination = level.destination +
+			y * level.destinationWidth * level.channels;
+		size_t x = 0;
+
+#ifdef NSGG_SIMD_MIP_GENERATION
+		if (level.channels == 4)
+		{
+			for (; x + 4 <= level.destinationWidth && 2 * x + 8 <= level.sourceWidth; x += 4)
+				AverageTexelsUNORM8(top + 8 * x, bottom + 8 * x, destination + 4 * x);
+		}
+#endif
+
+		for (; x < level.destinationWidth; ++x)
+		{
+			size_t left = std::min(2 * x, level.sourceWidth - 1) * level.channels;
+			size_t right = std::min(2 * x + 1, level.sourceWidth - 1) * level.channels;
+
+			for (size_t channel = 0; channel < level.channels; ++channel)
+			{
+				unsigned int sum = top[left + channel] + top[right + channel] +
+					bottom[left + channel] + bottom[right + channel];
+				destination[x * level.channels + channel] =
+					static_cast<unsigned char>((sum + 2) >> 2);
+			}
+		}
+	}
+}
+
+inline void MipGenerator::FilterRowsSRGB8(const LevelInfo& level,
+	size_t firstRow, size_t lastRow) const
+{
+	size_t rowSize = level.sourceWidth * 4;
+
+	for (size_t y = firstRow; y < lastRow; ++y)
+	{
+		const unsigned char* top = level.source + std::min(2 * y,
+			level.sourceHeight - 1) * rowSize;
+		const unsigned char* bottom = level.source + std::min(2 * y + 1,
+			level.sourceHeight - 1) * rowSize;
+		unsigned char* destination = level.destination + y * level.destinationWidth * 4;
+		size_t x = 0;
+
+#ifdef NSGG_SIMD_MIP_GENERATION
+		// Alpha is averaged with the UNORM filter, then the colour channels of
+		// the four texels are filtered and encoded together
+		const __m128 quarter = _mm_set1_ps(0.25f);
+
+		for (; x + 4 <= level.destinationWidth && 2 * x + 8 <= level.sourceWidth; x += 4)
+		{
+			AverageTexelsUNORM8(top + 8 * x, bottom + 8 * x, destination + 4 * x);
+
+			for (size_t channel = 0; channel < 3; ++channel)
+			{
+				const unsigned char* topTexels = top + 8 * x + channel;
+				const unsigned char* bottomTexels = bottom + 8 * x + channel;
+				__m128 sum = _mm_add_ps(
+					_mm_add_ps(LoadLinear(topTexels), LoadLinear(topTexels + 4)),
+					_mm_add_ps(LoadLinear(bottomTexels), LoadLinear(bottomTexels + 4)));
+
+				alignas(16) std::int32_t codes[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(codes),
+					EncodeSRGB(_mm_mul_ps(sum, quarter)));
+
+				for (size_t i = 0; i < 4; ++i)
+					destination[(x + i) * 4 + channel] = static_cast<unsigned char>(codes[i]);
+			}
+		}
+#endif
+
+		for (; x < level.destinationWidth; ++x)
+		{
+			size_t left = std::min(2 * x, level.sourceWidth - 1) * 4;
+			size_t right = std::min(2 * x + 1, level.sourceWidth - 1) * 4;
+
+			for (size_t channel = 0; channel < 3; ++channel)
+			{
+				float sum = srgbToLinear[top[left + channel]] +
+					srgbToLinear[top[right + channel]] +
+					srgbToLinear[bottom[left + channel]] +
+					srgbToLinear[bottom[right + channel]];
+				destination[x * 4 + channel] = EncodeSRGB(sum * 0.25f);
+			}
+
+			unsigned int alphaSum = top[left + 3] + top[right + 3] +
+				bottom[left + 3] + bottom[right + 3];
+			destination[x * 4 + 3] = static_cast<unsigned char>((alphaSum + 2) >> 2);
+		}
+	}
+}
+
+inline void MipGenerator::FilterRowsFloat(const LevelInfo& level,
+	size_t firstRow, size_t lastRow) const
+{
+	size_t rowSize = level.sourceWidth * level.channels;
+	const float* source = reinterpret_cast<const float*>(level.source);
+	float* destinationBase = reinterpret_cast<float*>(level.destination);
+
+	for (size_t y = firstRow; y < lastRow; ++y)
+	{
+		const float* top = source + std::min(2 * y, level.sourceHeight - 1) * rowSize;
+		const float* bottom = source + std::min(2 * y + 1,
+			level.sourceHeight - 1) * rowSize;
+		float* destination = destinationBase + y * level.destinationWidth * level.channels;
+		size_t x = 0;
+
+#ifdef NSGG_SIMD_MIP_GENERATION
+		if (level.channels == 4)
+		{
+			const __m128 quarter = _mm_set1_ps(0.25f);
+
+			for (; x < level.destinationWidth && 2 * x + 1 < level.sourceWidth; ++x)
+			{
+				__m128 sum = _mm_add_ps(
+					_mm_add_ps(_mm_loadu_ps(top + 8 * x), _mm_loadu_ps(top + 8 * x + 4)),
+					_mm_add_ps(_mm_loadu_ps(bottom + 8 * x), _mm_loadu_ps(bottom + 8 * x + 4)));
+				_mm_storeu_ps(destination + 4 * x, _mm_mul_ps(sum, quarter));
+			}
+		}
+#endif
+
+		for (; x < level.destinationWidth; ++x)
+		{
+			size_t left = std::min(2 * x, level.sourceWidth - 1) * level.channels;
+			size_t right = std::min(2 * x + 1, level.sourceWidth - 1) * level.channels;
+
+			for (size_t channel = 0; channel < level.channels; ++channel)
+			{
+				destination[x * level.channels + channel] = 0.25f *
+					(top[left + channel] + top[right + channel] +
+					bottom[left + channel] + bottom[right + channel]);
+			}
+		}
+	}
+}
+
+inline void MipGenerator::FilterRows(const LevelInfo& level, size_t firstRow,
+	size_t lastRow) const
+{
+	switch (level.filterType)
+	{
+	case FilterType::UNORM8:
+		FilterRowsUNORM8(level, firstRow, lastRow);
+		break;
+	case FilterType::SRGB8:
+		FilterRowsSRGB8(level, firstRow, lastRow);
+		break;
+	case FilterType::FLOAT:
+		FilterRowsFloat(level, firstRow, lastRow);
+		break;
+	}
+}
+
+inline MipGenerator::MipGenerator()
+{
+	for (size_t i = 0; i < 256; ++i)
+	{
+		float encoded = i / 255.0f;
+		srgbToLinear[i] = encoded <= 0.04045f ? encoded / 12.92f :
+			std::pow((encoded + 0.055f) / 1.055f, 2.4f);
+
+		float midpoint = (i + 0.5f) / 255.0f;
+		linearToSRGBThresholds[i] = midpoint <= 0.04045f ? midpoint / 12.92f :
+			std::pow((midpoint + 0.055f) / 1.055f, 2.4f);
+	}
+
+	size_t code = 0;
+	for (size_t bucket = 0; bucket < linearToSRGBStart.size(); ++bucket)
+	{
+		while (code < 255 && linearToSRGBThresholds[code] < bucket / 4095.0f)
+			++code;
+
+		linearToSRGBStart[bucket] = static_cast<std::uint8_t>(code);
+	}
+}
+
+inline void MipGenerator::GenerateMipChain(DecodedTexture& texture,
+	const MipGenerationSettings& settings) const
+{
+	if (texture.subresources.empty() ||
+		texture.subresources[0].size() != texture.GetSubresourceSize(0))
+	{
+		throw std::runtime_error("Error: Mip generation needs a valid top mip");
+	}
+
+	LevelInfo level;
+	level.filterType = GetFilterType(texture, settings, level.channels);
+
+	size_t nrOfMips = CalculateNrOfMips(texture.width, texture.height);
+	texture.subresources.resize(nrOfMips);
+
+	for (size_t mip = 1; mip < nrOfMips; ++mip)
+	{
+		texture.subresources[mip].resize(texture.GetSubresourceSize(mip));
+		level.source = texture.subresources[mip - 1].data();
+		level.sourceWidth = texture.GetSubresourceWidth(mip - 1);
+		level.sourceHeight = texture.GetSubresourceHeight(mip - 1);
+		level.destination = texture.subresources[mip].data();
+		level.destinationWidth = texture.GetSubresourceWidth(mip);
+		size_t destinationHeight = texture.GetSubresourceHeight(mip);
+
+		size_t threadsToUse = settings.threadPool == nullptr ? 1 :
+			std::min<size_t>({ settings.threadPool->NrOfThreads(), destinationHeight,
+			texture.subresources[mip].size() /
+			std::max<size_t>(settings.minimumBytesPerThread, 1) });
+
+		if (threadsToUse <= 1)
+		{
+			FilterRows(level, 0, destinationHeight);
+			continue;
+		}
+
+		size_t rowsPerThread = destinationHeight / threadsToUse;
+		size_t extraRows = destinationHeight % threadsToUse;
+
+		settings.threadPool->ParallelFor(threadsToUse, [&](size_t partIndex)
+			{
+				size_t firstRow = partIndex * rowsPerThread + std::min(partIndex, extraRows);
+				size_t lastRow = firstRow + rowsPerThread + (partIndex < extraRows ? 1 : 0);
+				FilterRows(level, firstRow, lastRow);
+			});
+	}
+}
+
+inline size_t MipGenerator::CalculateNrOfMips(size_t width, size_t height)
+{
+	size_t nrOfMips = 1;
+	while ((width >> nrOfMips) != 0 || (height >> nrOfMips) != 0)
+		++nrOfMips;
+
+	return nrOfMips;
+}
+
+inline bool MipChainCache::CreateHeader(const MipChainCacheKey& key,
+	FileHeader& header, std::string& absolutePath) const
+{
+	std::error_code error;
+	absolutePath = std::filesystem::absolute(key.sourcePath, error).string();
+
+	if (error)
+		return false;
+
+	header.sourceSize = std::filesystem::file_size(absolutePath, error);
+
+	if (error)
+		return false;
+
+	auto writeTime = std::filesystem::last_write_time(absolutePath, error);
+
+	if (error)
+		return false;
+
+	header.sourceWriteTime = static_cast<std::int64_t>(
+		writeTime.time_since_epoch().count());
+	header.texelSizeInBytes = key.texelSizeInBytes;
+	header.format = key.format;
+	header.filterFlags = key.colorDataIsSRGB ? FILTER_SRGB : 0;
+	header.sourcePathLength = absolutePath.size();
+
+	return true;
+}
+
+inline std::filesystem::path MipChainCache::GetCachePath(
+	const MipChainCacheKey& key, const std::string& absolutePath) const
+{
+	// Collisions only cost a cache miss, as Load checks the full key
+	std::string keyString = absolutePath + '|' + std::to_string(key.format) + '|' +
+		std::to_string(key.texelSizeInBytes) + '|' + (key.colorDataIsSRGB ? "srgb" : "linear");
+	size_t hash = std::hash<std::string>()(keyString);
+
+	char fileName[32];
+	std::snprintf(fileName, sizeof(fileName), "%016llx.mips",
+		static_cast<unsigned long long>(hash));
+
+	return cacheDirectory / fileName;
+}
+
+inline void MipChainCache::Initialize(const std::string& directory)
+{
+	cacheDirectory = directory;
+	std::filesystem::create_directories(cacheDirectory);
+}
+
+inline bool MipChainCache::Load(const MipChainCacheKey& key,
+	DecodedTexture& toLoadInto) const
+{
+	FileHeader expected;
+	std::string absolutePath;
+	if (!CreateHeader(key, expected, absolutePath))
+		return false;
+
+	std::ifstream file(GetCachePath(key, absolutePath), std::ios::binary);
+	FileHeader header;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+		header.magic != expected.magic || header.version != expected.version ||
+		header.sourceSize != expected.sourceSize ||
+		header.sourceWriteTime != expected.sourceWriteTime ||
+		header.texelSizeInBytes != expected.texelSizeInBytes ||
+		header.format != expected.format ||
+		header.filterFlags != expected.filterFlags ||
+		header.sourcePathLength != expected.sourcePathLength ||
+		header.nrOfSubresources == 0 || header.nrOfSubresources > 255 ||
+		header.texelSizeInBytes == 0 || header.texelSizeInBytes > 255)
+	{
+		return false;
+	}
+
+	std::string storedPath(header.sourcePathLength, '\0');
+	if (!file.read(storedPath.data(), storedPath.size()) || storedPath != absolutePath)
+		return false;
+
+	DecodedTexture loaded;
+	loaded.width = static_cast<size_t>(header.width);
+	loaded.height = static_cast<size_t>(header.height);
+	loaded.texelSizeInBytes = static_cast<std::uint8_t>(header.texelSizeInBytes);
+	loaded.format = header.format;
+	loaded.subresources.resize(header.nrOfSubresources);
+
+	for (size_t i = 0; i < loaded.subresources.size(); ++i)
+	{
+		loaded.subresources[i].resize(loaded.GetSubresourceSize(i));
+
+		if (!file.read(reinterpret_cast<char*>(loaded.subresources[i].data()),
+			loaded.subresources[i].size()))
+		{
+			return false;
+		}
+	}
+
+	toLoadInto = std::move(loaded);
+	return true;
+}
+
+inline bool MipChainCache::Store(const MipChainCacheKey& key,
+	const DecodedTexture& texture) const
+{
+	if (texture.format != key.format || texture.texelSizeInBytes != key.texelSizeInBytes)
+		return false;
+
+	FileHeader header;
+	std::string absolutePath;
+	if (!CreateHeader(key, header, absolutePath))
+		return false;
+
+	header.width = texture.width;
+	header.height = texture.height;
+	header.nrOfSubresources = static_cast<std::uint32_t>(texture.subresources.size());
+
+	// Written under a temporary name so a reader never sees half a file
+	std::filesystem::path cachePath = GetCachePath(key, absolutePath);
+	std::filesystem::path temporaryPath = cachePath;
+	temporaryPath += std::to_string(std::hash<std::thread::id>()(
+		std::this_thread::get_id()));
+
+	bool written = false;
+
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(absolutePath.data(), absolutePath.size());
+
+		for (const std::vector<unsigned char>& subresource : texture.subresources)
+		{
+			file.write(reinterpret_cast<const char*>(subresource.data()),
+				subresource.size());
+		}
+
+		file.close();
+		written = !file.fail();
+	}
+
+	std::error_code error;
+
+	if (!written)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	std::filesystem::rename(temporaryPath, cachePath, error);
+
+	if (error)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	return true;
+}
+
+inline MipChainCacheKey MipChainCache::CreateKey(const std::string& sourcePath,
+	const DecodedTexture& texture, const MipGenerationSettings& settings)
+{
+	MipChainCacheKey toReturn;
+	toReturn.sourcePath = sourcePath;
+	toReturn.format = texture.format;
+	toReturn.texelSizeInBytes = texture.texelSizeInBytes;
+	toReturn.colorDataIsSRGB = settings.colorDataIsSRGB;
+
+	return toReturn;
+}
\ No newline at end of file
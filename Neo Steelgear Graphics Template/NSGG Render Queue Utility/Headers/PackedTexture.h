@@ -0,0 +1,474 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+
+#include <d3d12.h>
+#include <dxgi1_6.h>
+
+#include <ResourceUploader.h>
+#include <RingBufferUploader.h>
+
+#include "DDSFile.h"
+#include "MappedFile.h"
+#include "TextureStreamer.h"
+
+typedef DDSTextureDesc PackedTextureDesc;
+
+enum class PackedRowLayout
+{
+	TIGHT, // Rows follow each other, as the resource uploader expects
+	UPLOAD_PITCHED // Rows and subresources aligned as in an upload buffer
+};
+
+struct PackedSubresource
+{
+	size_t offset = 0; // From the start of the file
+	size_t rowSize = 0; // Rows of blocks if block compressed
+	size_t rowPitch = 0;
+	size_t nrOfRows = 0;
+	size_t slicePitch = 0;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	unsigned int depth = 0;
+};
+
+// Texture container produced offline by the texture cooker. A header and a
+// table of contents are followed by the subresources in D3D12 order, stored
+// in the target format with all mips so that loading is only copying.
+class PackedTextureFile
+{
+private:
+	struct FileHeader
+	{
+		std::uint32_t magic = 0x5450534E; // "NSPT"
+		std::uint32_t version = 1;
+		std::uint32_t format = 0;
+		std::uint32_t dimension = 0;
+		std::uint32_t width = 0;
+		std::uint32_t height = 0;
+		std::uint32_t depth = 0;
+		std::uint32_t arraySize = 0;
+		std::uint32_t mipLevels = 0;
+		std::uint32_t flags = 0;
+		std::uint32_t nrOfSubresources = 0;
+		std::uint32_t rowLayout = 0;
+		std::uint64_t dataOffset = 0;
+		std::uint64_t dataSize = 0;
+	};
+
+	struct FileSubresource
+	{
+		std::uint64_t offset = 0; // From the start of the data
+		std::uint64_t rowPitch = 0;
+		std::uint64_t slicePitch = 0;
+		std::uint32_t rowSize = 0;
+		std::uint32_t nrOfRows = 0;
+	};
+
+	static constexpr std::uint32_t CUBE_MAP_FLAG = 0x1;
+
+	MappedFile file;
+	const unsigned char* fileData = nullptr;
+	PackedTextureDesc desc;
+	PackedRowLayout rowLayout = PackedRowLayout::TIGHT;
+	std::vector<PackedSubresource> subresources;
+
+	static size_t GetDataOffset(size_t nrOfSubresources);
+
+public:
+	PackedTextureFile() = default;
+	~PackedTextureFile() = default;
+	PackedTextureFile(const PackedTextureFile& other) = delete;
+	PackedTextureFile& operator=(const PackedTextureFile& other) = delete;
+	PackedTextureFile(PackedTextureFile&& other) = default;
+	PackedTextureFile& operator=(PackedTextureFile&& other) = default;
+
+	void Open(const std::string& filePath);
+
+	// The data must outlive the object, nothing is copied
+	void Parse(const unsigned char* data, size_t dataSize);
+
+	const PackedTextureDesc& GetDesc() const;
+	PackedRowLayout GetRowLayout() const;
+	const std::vector<PackedSubresource>& GetSubresources() const;
+	const unsigned char* GetSubresourceData(size_t subresourceIndex) const;
+
+	// The resource uploader takes tightly packed texels, so this requires an
+	// uncompressed texture. Pitched rows are first packed into a scratch copy.
+	bool Upload(ResourceUploader& uploader, ID3D12GraphicsCommandList* commandList,
+		ID3D12Resource* toUploadTo) const;
+	bool Stage(RingBufferUploader& uploader, ID3D12Resource* toUploadTo,
+		WorkStealingThreadPool* threadPool = nullptr) const;
+
+	// Copies a single slice, uncompressed 2D texture into tightly packed
+	// mips for use with the texture streamer
+	void CopyTo(DecodedTexture& toCopyInto) const;
+
+	// Subresource data is given with tightly packed rows, one pointer per
+	// subresource in D3D12 order. Returns the total size of the data.
+	static size_t CalculateSubresourceLayout(const PackedTextureDesc& desc,
+		PackedRowLayout rowLayout, size_t dataOffset,
+		std::vector<PackedSubresource>& layout);
+	static void Write(const std::string& filePath, const PackedTextureDesc& desc,
+		const std::vector<const unsigned char*>& subresourceData,
+		PackedRowLayout rowLayout);
+};
+
+// Decoder for the texture streamer, see PackedTextureFile::CopyTo
+inline bool DecodePackedTexture(const std::string& filePath,
+	DecodedTexture& toDecodeInto)
+{
+	try
+	{
+		PackedTextureFile packedFile;
+		packedFile.Open(filePath);
+		packedFile.CopyTo(toDecodeInto);
+	}
+	catch (const std::runtime_error&)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+inline size_t PackedTextureFile::GetDataOffset(size_t nrOfSubresources)
+{
+	size_t tableEnd = sizeof(FileHeader) + nrOfSubresources * sizeof(FileSubresource);
+	size_t alignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+	return ((tableEnd + alignment - 1) / alignment) * alignment;
+}
+
+inline void PackedTextureFile::Open(const std::string& filePath)
+{
+	file.Open(filePath);
+	Parse(file.GetData(), file.GetSize());
+}
+
+inline void PackedTextureFile::Parse(const unsigned char* data, size_t dataSize)
+{
+	// Copied out as the mapped data gives no alignment guarantees
+	FileHeader header;
+	const FileHeader expectedHeader;
+
+	if (dataSize < sizeof(header))
+		throw std::runtime_error("Error: Packed texture file too small for its header");
+
+	std::memcpy(&header, data, sizeof(header));
+
+	if (header.magic != expectedHeader.magic ||
+		header.version != expectedHeader.version ||
+		header.dimension < D3D12_RESOURCE_DIMENSION_TEXTURE1D ||
+		header.dimension > D3D12_RESOURCE_DIMENSION_TEXTURE3D ||
+		header.rowLayout > static_cast<std::uint32_t>(PackedRowLayout::UPLOAD_PITCHED))
+	{
+		throw std::runtime_error("Error: Invalid packed texture header");
+	}
+
+	PackedTextureDesc parsedDesc;
+	parsedDesc.format = static_cast<DXGI_FORMAT>(header.format);
+	parsedDesc.dimension = static_cast<D3D12_RESOURCE_DIMENSION>(header.dimension);
+	parsedDesc.width = header.width;
+	parsedDesc.height = header.height;
+	parsedDesc.depth = header.depth;
+	parsedDesc.arraySize = header.arraySize;
+	parsedDesc.mipLevels = header.mipLevels;
+	parsedDesc.cubeMap = (header.flags & CUBE_MAP_FLAG) != 0;
+
+	if (!DDSFile::GetFormatInfo(parsedDesc.format, parsedDesc.blockCompressed,
+		parsedDesc.bytesPerElement))
+	{
+		throw std::runtime_error("Error: Unsupported packed texture format");
+	}
+
+	if (parsedDesc.width == 0 || parsedDesc.height == 0 || parsedDesc.depth == 0 ||
+		parsedDesc.arraySize == 0 || parsedDesc.mipLevels == 0 ||
+		parsedDesc.width > 16384 || parsedDesc.height > 16384 ||
+		parsedDesc.depth > 2048 || parsedDesc.arraySize > 2048 * 6 ||
+		parsedDesc.mipLevels > 15 || (parsedDesc.cubeMap && parsedDesc.arraySize % 6 != 0) ||
+		(parsedDesc.dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ?
+			parsedDesc.arraySize != 1 : parsedDesc.depth != 1) ||
+		header.nrOfSubresources != parsedDesc.arraySize * parsedDesc.mipLevels)
+	{
+		throw std::runtime_error("Error: Invalid packed texture dimensions");
+	}
+
+	size_t dataOffset = GetDataOffset(header.nrOfSubresources);
+	PackedRowLayout parsedLayout = static_cast<PackedRowLayout>(header.rowLayout);
+	std::vector<PackedSubresource> layout;
+	size_t layoutSize = CalculateSubresourceLayout(parsedDesc, parsedLayout,
+		dataOffset, layout);
+
+	if (header.dataOffset != dataOffset || header.dataSize != layoutSize ||
+		dataSize < dataOffset || dataSize - dataOffset < layoutSize)
+	{
+		throw std::runtime_error("Error: Packed texture file too small for its subresources");
+	}
+
+	// The table must agree with the layout derived from the header, which
+	// is what the bounds were checked against
+	for (size_t i = 0; i < layout.size(); ++i)
+	{
+		FileSubresource entry;
+		std::memcpy(&entry, data + sizeof(header) + i * sizeof(entry), sizeof(entry));
+
+		if (entry.offset + dataOffset != layout[i].offset ||
+			entry.rowPitch != layout[i].rowPitch ||
+			entry.slicePitch != layout[i].slicePitch ||
+			entry.rowSize != layout[i].rowSize || entry.nrOfRows != layout[i].nrOfRows)
+		{
+			throw std::runtime_error("Error: Invalid packed texture table of contents");
+		}
+	}
+
+	desc = parsedDesc;
+	rowLayout = parsedLayout;
+	subresources = std::move(layout);
+	fileData = data;
+}
+
+inline const PackedTextureDesc& PackedTextureFile::GetDesc() const
+{
+	return desc;
+}
+
+inline PackedRowLayout PackedTextureFile::GetRowLayout() const
+{
+	return rowLayout;
+}
+
+inline const std::vector<PackedSubresource>& PackedTextureFile::GetSubresources() const
+{
+	return subresources;
+}
+
+inline const unsigned char* PackedTextureFile::GetSubresourceData(
+	size_t subresourceIndex) const
+{
+	return fileData + subresources[subresourceIndex].offset;
+}
+
+inline bool PackedTextureFile::Upload(ResourceUploader& uploader,
+	ID3D12GraphicsCommandList* commandList, ID3D12Resource* toUploadTo) const
+{
+	if (desc.blockCompressed)
+		throw std::runtime_error("Error: Packed texture data must be staged");
+
+	std::vector<unsigned char> tightData;
+
+	for (size_t i = 0; i < subresources.size(); ++i)
+	{
+		const PackedSubresource& subresource = subresources[i];
+		unsigned char* data = const_cast<unsigned char*>(GetSubresourceData(i));
+
+		if (rowLayout != PackedRowLayout::TIGHT)
+		{
+			size_t nrOfRows = subresource.nrOfRows * subresource.depth;
+			tightData.resize(subresource.rowSize * nrOfRows);
+
+			for (size_t row = 0; row < nrOfRows; ++row)
+			{
+				std::memcpy(tightData.data() + row * subresource.rowSize,
+					data + row * subresource.rowPitch, subresource.rowSize);
+			}
+
+			data = tightData.data();
+		}
+
+		TextureUploadInfo uploadInfo;
+		uploadInfo.width = subresource.width;
+		uploadInfo.height = subresource.height;
+		uploadInfo.depth = subresource.depth;
+		uploadInfo.texelSizeInBytes = desc.bytesPerElement;
+		uploadInfo.format = desc.format;
+
+		if (!uploader.UploadTextureResourceData(toUploadTo, commandList, data,
+			uploadInfo, static_cast<unsigned int>(i)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+inline bool PackedTextureFile::Stage(RingBufferUploader& uploader,
+	ID3D12Resource* toUploadTo, WorkStealingThreadPool* threadPool) const
+{
+	for (size_t i = 0; i < subresources.size(); ++i)
+	{
+		if (!uploader.StageSubresourceData(toUploadTo, GetSubresourceData(i),
+			subresources[i].rowPitch, subresources[i].slicePitch,
+			static_cast<unsigned int>(i), threadPool))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+inline void PackedTextureFile::CopyTo(DecodedTexture& toCopyInto) const
+{
+	if (desc.dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D ||
+		desc.arraySize != 1 || desc.blockCompressed || desc.bytesPerElement > 255)
+	{
+		throw std::runtime_error("Error: Packed texture cannot be used as a decoded texture");
+	}
+
+	DecodedTexture copied;
+	copied.width = desc.width;
+	copied.height = desc.height;
+	copied.texelSizeInBytes = static_cast<std::uint8_t>(desc.bytesPerElement);
+	copied.format = desc.format;
+	copied.subresources.resize(subresources.size());
+
+	for (size_t i = 0; i < subresources.size(); ++i)
+	{
+		const PackedSubresource& subresource = subresources[i];
+		copied.subresources[i].resize(subresource.rowSize * subresource.nrOfRows);
+
+		for (size_t row = 0; row < subresource.nrOfRows; ++row)
+		{
+			std::memcpy(copied.subresources[i].data() + row * subresource.rowSize,
+				GetSubresourceData(i) + row * subresource.rowPitch, subresource.rowSize);
+		}
+	}
+
+	toCopyInto = std::move(copied);
+}
+
+inline size_t PackedTextureFile::CalculateSubresourceLayout(
+	const PackedTextureDesc& desc, PackedRowLayout rowLayout, size_t dataOffset,
+	std::vector<PackedSubresource>& layout)
+{
+	std::vector<DDSSubresource> tightLayout;
+	DDSFile::CalculateSubresourceLayout(desc, 0, tightLayout);
+
+	size_t pitchAlignment = 1;
+	size_t placementAlignment = 1;
+
+	if (rowLayout == PackedRowLayout::UPLOAD_PITCHED)
+	{
+		pitchAlignment = D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+		placementAlignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+	}
+
+	layout.clear();
+	layout.reserve(tightLayout.size());
+	size_t currentOffset = 0;
+
+	for (const DDSSubresource& tight : tightLayout)
+	{
+		PackedSubresource subresource;
+		currentOffset = ((currentOffset + placementAlignment - 1) /
+			placementAlignment) * placementAlignment;
+		subresource.offset = dataOffset + currentOffset;
+		subresource.rowSize = tight.rowSize;
+		subresource.rowPitch = ((tight.rowSize + pitchAlignment - 1) /
+			pitchAlignment) * pitchAlignment;
+		subresource.nrOfRows = tight.nrOfRows;
+		subresource.slicePitch = subresource.rowPitch * subresource.nrOfRows;
+		subresource.width = tight.width;
+		subresource.height = tight.height;
+		subresource.depth = tight.depth;
+		currentOffset += subresource.slicePitch * subresource.depth;
+		layout.push_back(subresource);
+	}
+
+	return currentOffset;
+}
+
+inline void PackedTextureFile::Write(const std::string& filePath,
+	const PackedTextureDesc& desc,
+	const std::vector<const unsigned char*>& subresourceData,
+	PackedRowLayout rowLayout)
+{
+	if (subresourceData.size() != static_cast<size_t>(desc.arraySize) * desc.mipLevels)
+		throw std::runtime_error("Error: Packed texture needs data for every subresource");
+
+	FileHeader header;
+	header.format = static_cast<std::uint32_t>(desc.format);
+	header.dimension = static_cast<std::uint32_t>(desc.dimension);
+	header.width = desc.width;
+	header.height = desc.height;
+	header.depth = desc.depth;
+	header.arraySize = desc.arraySize;
+	header.mipLevels = desc.mipLevels;
+	header.flags = desc.cubeMap ? CUBE_MAP_FLAG : 0;
+	header.nrOfSubresources = static_cast<std::uint32_t>(subresourceData.size());
+	header.rowLayout = static_cast<std::uint32_t>(rowLayout);
+	header.dataOffset = GetDataOffset(subresourceData.size());
+
+	std::vector<PackedSubresource> layout;
+	header.dataSize = CalculateSubresourceLayout(desc, rowLayout,
+		static_cast<size_t>(header.dataOffset), layout);
+
+	// Written under a temporary name so a reader never sees half a file
+	std::filesystem::path temporaryPath = filePath;
+	temporaryPath += std::to_string(std::hash<std::thread::id>()(
+		std::this_thread::get_id()));
+
+	{
+		std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (const PackedSubresource& subresource : layout)
+		{
+			FileSubresource entry;
+			entry.offset = subresource.offset - header.dataOffset;
+			entry.rowPitch = subresource.rowPitch;
+			entry.slicePitch = subresource.slicePitch;
+			entry.rowSize = static_cast<std::uint32_t>(subresource.rowSize);
+			entry.nrOfRows = static_cast<std::uint32_t>(subresource.nrOfRows);
+			output.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+		}
+
+		// Padding between rows and subresources is written as zeroes
+		std::vector<char> padding(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, 0);
+		size_t written = sizeof(header) + layout.size() * sizeof(FileSubresource);
+
+		for (size_t i = 0; i < layout.size(); ++i)
+		{
+			const PackedSubresource& subresource = layout[i];
+			output.write(padding.data(), subresource.offset - written);
+			written = subresource.offset;
+
+			size_t nrOfRows = subresource.nrOfRows * subresource.depth;
+			for (size_t row = 0; row < nrOfRows; ++row)
+			{
+				output.write(reinterpret_cast<const char*>(subresourceData[i] +
+					row * subresource.rowSize), subresource.rowSize);
+				output.write(padding.data(), subresource.rowPitch - subresource.rowSize);
+			}
+
+			written += subresource.rowPitch * nrOfRows;
+		}
+
+		if (!output)
+		{
+			output.close();
+			std::error_code error;
+			std::filesystem::remove(temporaryPath, error);
+			throw std::runtime_error("Error: Could not write packed texture file");
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, filePath, error);
+
+	if (error)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		throw std::runtime_error("Error: Could not replace packed texture file");
+	}
+}
\ No newline at end of file
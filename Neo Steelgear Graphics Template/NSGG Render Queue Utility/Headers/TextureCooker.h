@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+
+#include "stb_image.h"
+#include "DDSFile.h"
+#include "MipGenerator.h"
+#include "PackedTexture.h"
+#include "TextureDecoders.h"
+
+struct TextureCookerSettings
+{
+	PackedRowLayout rowLayout = PackedRowLayout::UPLOAD_PITCHED;
+	bool generateMips = true;
+	bool colorDataIsSRGB = false; // 8 bit images are stored as _SRGB
+	bool skipUpToDate = true; // Directories only, compares write times
+	WorkStealingThreadPool* threadPool = nullptr; // For the rows of large mips
+};
+
+// Converts source images into packed texture files ahead of time. Images
+// stb_image can read are decoded and given a full mip chain, DDS files keep
+// their format and mips which is how block compressed data is packed.
+class TextureCooker
+{
+private:
+	MipGenerator mipGenerator;
+
+	void CookImage(const std::string& sourcePath, const std::string& destinationPath,
+		const TextureCookerSettings& settings) const;
+	void CookDDS(const std::string& sourcePath, const std::string& destinationPath,
+		const TextureCookerSettings& settings) const;
+
+public:
+	TextureCooker() = default;
+	~TextureCooker() = default;
+	TextureCooker(const TextureCooker& other) = default;
+	TextureCooker& operator=(const TextureCooker& other) = default;
+	TextureCooker(TextureCooker&& other) = default;
+	TextureCooker& operator=(TextureCooker&& other) = default;
+
+	void Cook(const std::string& sourcePath, const std::string& destinationPath,
+		const TextureCookerSettings& settings = TextureCookerSettings()) const;
+
+	// Cooks every supported file below the source directory into the same
+	// relative path below the destination. Returns the number of files cooked,
+	// a message per failed file is added to the errors.
+	size_t CookDirectory(const std::string& sourceDirectory,
+		const std::string& destinationDirectory, const TextureCookerSettings& settings,
+		std::vector<std::string>& errors) const;
+
+	static bool IsSupportedSource(const std::filesystem::path& path);
+};
+
+// Command line front end, the main function of a cooker tool only needs to
+// forward its arguments to this
+inline int RunTextureCooker(int argc, char* argv[])
+{
+	const char* usage = "Usage: %s [--srgb] [--tight] [--no-mips] [--force] "
+		"[--threads count] <source file or directory> <destination>\n";
+
+	TextureCookerSettings settings;
+	size_t nrOfThreads = 1;
+	std::vector<std::string> paths;
+	bool validArguments = true;
+
+	for (int i = 1; i < argc && validArguments; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (argument == "--srgb")
+			settings.colorDataIsSRGB = true;
+		else if (argument == "--tight")
+			settings.rowLayout = PackedRowLayout::TIGHT;
+		else if (argument == "--no-mips")
+			settings.generateMips = false;
+		else if (argument == "--force")
+			settings.skipUpToDate = false;
+		else if (argument == "--threads" && i + 1 < argc)
+			nrOfThreads = static_cast<size_t>(std::max(std::atoi(argv[++i]), 1));
+		else if (argument.rfind("--", 0) != 0)
+			paths.push_back(argument);
+		else
+			validArguments = false;
+	}
+
+	if (!validArguments || paths.size() != 2)
+	{
+		std::fprintf(stderr, usage, argc > 0 ? argv[0] : "TextureCooker");
+		return 1;
+	}
+
+	WorkStealingThreadPool threadPool;
+	threadPool.Initialize(nrOfThreads - 1);
+	settings.threadPool = &threadPool;
+	TextureCooker cooker;
+
+	if (std::filesystem::is_directory(paths[0]))
+	{
+		std::vector<std::string> errors;
+		size_t nrOfCooked = cooker.CookDirectory(paths[0], paths[1], settings, errors);
+
+		for (const std::string& error : errors)
+			std::fprintf(stderr, "%s\n", error.c_str());
+
+		std::printf("Cooked %zu textures, %zu failed\n", nrOfCooked, errors.size());
+		return errors.empty() ? 0 : 1;
+	}
+
+	try
+	{
+		cooker.Cook(paths[0], paths[1], settings);
+	}
+	catch (const std::runtime_error& error)
+	{
+		std::fprintf(stderr, "%s: %s\n", paths[0].c_str(), error.what());
+		return 1;
+	}
+
+	return 0;
+}
+
+inline void TextureCooker::CookImage(const std::string& sourcePath,
+	const std::string& destinationPath, const TextureCookerSettings& settings) const
+{
+	DecodedTexture texture;
+	bool decoded = stbi_is_hdr(sourcePath.c_str()) ?
+		CreateTextureDecoderHDR(4)(sourcePath, texture) :
+		DecodeTextureStandard(sourcePath, texture);
+
+	if (!decoded)
+		throw std::runtime_error("Error: Could not decode source image");
+
+	if (settings.colorDataIsSRGB && texture.format == DXGI_FORMAT_R8G8B8A8_UNORM)
+		texture.format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+	if (settings.generateMips)
+	{
+		MipGenerationSettings mipSettings;
+		mipSettings.threadPool = settings.threadPool;
+		mipGenerator.GenerateMipChain(texture, mipSettings);
+	}
+
+	PackedTextureDesc desc;
+	desc.dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	desc.format = static_cast<DXGI_FORMAT>(texture.format);
+	desc.width = static_cast<unsigned int>(texture.width);
+	desc.height = static_cast<unsigned int>(texture.height);
+	desc.depth = 1;
+	desc.arraySize = 1;
+	desc.mipLevels = static_cast<unsigned int>(texture.subresources.size());
+	desc.bytesPerElement = texture.texelSizeInBytes;
+
+	std::vector<const unsigned char*> subresourceData;
+	for (const std::vector<unsigned char>& subresource : texture.subresources)
+		subresourceData.push_back(subresource.data());
+
+	PackedTextureFile::Write(destinationPath, desc, subresourceData,
+		settings.rowLayout);
+}
+
+inline void TextureCooker::CookDDS(const std::string& sourcePath,
+	const std::string& destinationPath, const TextureCookerSettings& settings) const
+{
+	DDSFile ddsFile;
+	ddsFile.Open(sourcePath);
+
+	std::vector<const unsigned char*> subresourceData;
+	for (size_t i = 0; i < ddsFile.GetSubresources().size(); ++i)
+		subresourceData.push_back(ddsFile.GetSubresourceData(i));
+
+	PackedTextureFile::Write(destinationPath, ddsFile.GetDesc(), subresourceData,
+		settings.rowLayout);
+}
+
+inline void TextureCooker::Cook(const std::string& sourcePath,
+	const std::string& destinationPath, const TextureCookerSettings& settings) const
+{
+	std::filesystem::path destination = destinationPath;
+
+	if (destination.has_parent_path())
+		std::filesystem::create_directories(destination.parent_path());
+
+	std::string extension = std::filesystem::path(sourcePath).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(),
+		[](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+
+	if (extension == ".dds")
+		CookDDS(sourcePath, destinationPath, settings);
+	else
+		CookImage(sourcePath, destinationPath, settings);
+}
+
+inline size_t TextureCooker::CookDirectory(const std::string& sourceDirectory,
+	const std::string& destinationDirectory, const TextureCookerSettings& settings,
+	std::vector<std::string>& errors) const
+{
+	size_t nrOfCooked = 0;
+
+	for (const std::filesystem::directory_entry& entry :
+		std::filesystem::recursive_directory_iterator(sourceDirectory))
+	{
+		if (!entry.is_regular_file() || !IsSupportedSource(entry.path()))
+			continue;
+
+		std::filesystem::path destination = std::filesystem::path(destinationDirectory) /
+			std::filesystem::relative(entry.path(), sourceDirectory);
+		destination.replace_extension(".nspt");
+
+		std::error_code error;
+		if (settings.skipUpToDate && std::filesystem::exists(destination, error) &&
+			std::filesystem::last_write_time(destination, error) >= entry.last_write_time())
+		{
+			continue;
+		}
+
+		try
+		{
+			Cook(entry.path().string(), destination.string(), settings);
+			++nrOfCooked;
+		}
+		catch (const std::runtime_error& cookError)
+		{
+			errors.push_back(entry.path().string() + ": " + cookError.what());
+		}
+	}
+
+	return nrOfCooked;
+}
+
+inline bool TextureCooker::IsSupportedSource(const std::filesystem::path& path)
+{
+	static const char* extensions[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp",
+		".psd", ".gif", ".hdr", ".pic", ".pnm", ".ppm", ".pgm", ".dds" };
+
+	std::string extension = path.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(),
+		[](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+
+	return std::find(std::begin(extensions), std::end(extensions), extension) !=
+		std::end(extensions);
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstring>
+
+#include <d3d12.h>
+
+#include "stb_image.h"
+#include "TextureStreamer.h"
+
+// Decoders for the texture streamer matching LoadTextureStandard and
+// LoadTextureHDR, only the top mip is produced
+
+inline bool DecodeTextureStandard(const std::string& filePath,
+	DecodedTexture& toDecodeInto)
+{
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	unsigned char* imageData = stbi_load(filePath.c_str(), &width, &height,
+		&channels, 4);
+
+	if (imageData == nullptr)
+		return false;
+
+	toDecodeInto.width = static_cast<size_t>(width);
+	toDecodeInto.height = static_cast<size_t>(height);
+	toDecodeInto.texelSizeInBytes = 4;
+	toDecodeInto.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	toDecodeInto.subresources.resize(1);
+	toDecodeInto.subresources[0].assign(imageData,
+		imageData + toDecodeInto.GetSubresourceSize(0));
+	stbi_image_free(imageData);
+
+	return true;
+}
+
+inline TextureDecoder CreateTextureDecoderHDR(int channels)
+{
+	static const DXGI_FORMAT formats[] = { DXGI_FORMAT_R32_FLOAT,
+		DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT,
+		DXGI_FORMAT_R32G32B32A32_FLOAT };
+
+	if (channels < 1 || channels > 4)
+		throw std::runtime_error("Error: HDR textures must have 1 to 4 channels");
+
+	return [channels](const std::string& filePath, DecodedTexture& toDecodeInto)
+	{
+		int width = 0;
+		int height = 0;
+		int channelsInFile = 0;
+		float* imageData = stbi_loadf(filePath.c_str(), &width, &height,
+			&channelsInFile, channels);
+
+		if (imageData == nullptr)
+			return false;
+
+		toDecodeInto.width = static_cast<size_t>(width);
+		toDecodeInto.height = static_cast<size_t>(height);
+		toDecodeInto.texelSizeInBytes =
+			static_cast<std::uint8_t>(sizeof(float) * channels);
+		toDecodeInto.format = formats[channels - 1];
+		toDecodeInto.subresources.resize(1);
+		toDecodeInto.subresources[0].resize(toDecodeInto.GetSubresourceSize(0));
+		std::memcpy(toDecodeInto.subresources[0].data(), imageData,
+			toDecodeInto.subresources[0].size());
+		stbi_image_free(imageData);
+
+		return true;
+	};
+}
\ No newline at end of file
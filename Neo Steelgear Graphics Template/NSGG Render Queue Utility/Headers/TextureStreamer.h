@@ -0,0 +1,525 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+struct DecodedTexture
+{
+	size_t width = 0;
+	size_t height = 0;
+	std::uint8_t texelSizeInBytes = 0;
+	std::uint32_t format = 0; // A DXGI_FORMAT, 0 being DXGI_FORMAT_UNKNOWN
+	std::vector<std::vector<unsigned char>> subresources; // Mip 0 first, packed rows
+
+	size_t GetSubresourceWidth(size_t subresourceIndex) const
+	{
+		return std::max(width >> subresourceIndex, size_t(1));
+	}
+
+	size_t GetSubresourceHeight(size_t subresourceIndex) const
+	{
+		return std::max(height >> subresourceIndex, size_t(1));
+	}
+
+	size_t GetSubresourceSize(size_t subresourceIndex) const
+	{
+		return GetSubresourceWidth(subresourceIndex) *
+			GetSubresourceHeight(subresourceIndex) * texelSizeInBytes;
+	}
+};
+
+// Runs on a decode worker, returns false if the file could not be decoded
+typedef std::function<bool(const std::string& filePath,
+	DecodedTexture& toDecodeInto)> TextureDecoder;
+
+// Runs on the thread calling TextureStreamer::Update or Shutdown
+template<typename Identifier>
+using TextureStreamCallback = std::function<void(bool success,
+	const Identifier& identifier)>;
+
+template<typename Identifier>
+struct TextureResidency
+{
+	Identifier identifier;
+	std::uint8_t mostDetailedMip = 0; // Mips from this one to the last are resident
+	std::uint8_t mipLevels = 0;
+
+	// For ResourceMinLODClamp or a clamp done in the shader
+	float GetMinLODClamp() const
+	{
+		return static_cast<float>(mostDetailedMip);
+	}
+};
+
+// Runs on the thread calling TextureStreamer::Update, after the update that
+// made more mips resident. The first call means the texture can be sampled.
+template<typename Identifier>
+using TextureResidencyCallback = std::function<void(
+	const TextureResidency<Identifier>& residency)>;
+
+// Where decoded textures end up. The category and identifier types are only
+// passed through, which keeps the scheduling free of Direct3D so that it can
+// be run without a device.
+template<typename Category, typename Identifier>
+class TextureUploadSink
+{
+public:
+	virtual ~TextureUploadSink() = default;
+
+	virtual bool CreateTexture(const Category& category,
+		const DecodedTexture& texture, Identifier& created) = 0;
+
+	// The texture data is kept alive for framesToKeepData updates after this
+	virtual void UploadSubresource(const Identifier& identifier,
+		const DecodedTexture& texture, std::uint8_t subresourceIndex) = 0;
+
+	// Progressive requests only, before their residency callback is called
+	virtual void SetResidency(const TextureResidency<Identifier>&)
+	{
+		// Empty
+	}
+};
+
+struct TextureStreamerSettings
+{
+	unsigned int nrOfDecodeWorkers = 2;
+	size_t uploadBytesPerFrame = 32 * 1024 * 1024; // At least one subresource is uploaded per frame
+	size_t framesToKeepData = 3; // Frames the sink may still read uploaded data
+	size_t mipTailBytes = 64 * 1024; // Largest mip uploaded before any texture continues past its tail
+};
+
+template<typename Category, typename Identifier>
+class TextureStreamer
+{
+private:
+	struct Request
+	{
+		size_t requestIndex = size_t(-1);
+		int priority = 0;
+		std::string filePath;
+		Category category;
+		TextureDecoder decoder;
+		TextureStreamCallback<Identifier> callback;
+		TextureResidencyCallback<Identifier> residencyCallback;
+	};
+
+	struct RequestOrder
+	{
+		// Higher priorities first, then the order the requests were made in
+		template<typename T>
+		bool operator()(const T& lhs, const T& rhs) const
+		{
+			if (lhs.priority != rhs.priority)
+				return lhs.priority < rhs.priority;
+
+			return lhs.requestIndex > rhs.requestIndex;
+		}
+	};
+
+	struct DecodedRequest
+	{
+		size_t requestIndex = size_t(-1);
+		int priority = 0;
+		Category category;
+		TextureStreamCallback<Identifier> callback;
+		TextureResidencyCallback<Identifier> residencyCallback; // Set for progressive requests
+		bool success = false;
+		DecodedTexture texture;
+		bool created = false;
+		Identifier identifier;
+		size_t residentMips = 0; // Counted from the least detailed mip
+		size_t reportedMips = 0;
+	};
+
+	struct RetiredData
+	{
+		size_t retiredFrame = 0;
+		DecodedTexture texture;
+	};
+
+	TextureStreamerSettings settings;
+	TextureUploadSink<Category, Identifier>* sink = nullptr;
+
+	std::vector<std::thread> workers;
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	bool stopWorkers = false;
+	std::priority_queue<Request, std::vector<Request>, RequestOrder> waitingRequests;
+	std::vector<DecodedRequest> finishedDecodes;
+	size_t nrOfDecodesInFlight = 0;
+
+	std::vector<DecodedRequest> readyRequests; // Sorted with the next upload last
+	std::deque<RetiredData> retiredData;
+	size_t nextRequestIndex = 0;
+	size_t frameIndex = 0;
+	size_t bytesUploadedLastUpdate = 0;
+
+	void WorkerLoop();
+	bool ValidateTexture(const DecodedTexture& texture) const;
+	bool UploadSubresources(DecodedRequest& request, size_t& bytesUploaded,
+		size_t largestSubresource);
+	bool FinishRequest(DecodedRequest& request);
+	size_t AddRequest(Request&& request);
+	void FailUnfinishedRequests();
+
+public:
+	TextureStreamer() = default;
+	~TextureStreamer();
+	TextureStreamer(const TextureStreamer& other) = delete;
+	TextureStreamer& operator=(const TextureStreamer& other) = delete;
+	TextureStreamer(TextureStreamer&& other) = delete;
+	TextureStreamer& operator=(TextureStreamer&& other) = delete;
+
+	void Initialize(TextureUploadSink<Category, Identifier>* sinkToUse,
+		const TextureStreamerSettings& streamerSettings = TextureStreamerSettings());
+
+	size_t RequestTexture(const std::string& filePath,
+		const Category& category, const TextureDecoder& decoder,
+		const TextureStreamCallback<Identifier>& callback, int priority = 0);
+
+	// Uploads the smallest mips first so the texture can be used at a lower
+	// detail level while the rest streams in over the following frames
+	size_t RequestTextureProgressive(const std::string& filePath,
+		const Category& category, const TextureDecoder& decoder,
+		const TextureResidencyCallback<Identifier>& residencyCallback,
+		const TextureStreamCallback<Identifier>& callback, int priority = 0);
+
+	// Call once per frame from the thread that owns the sink, before the
+	// frame's category updates are recorded
+	void Update();
+
+	// Stops the workers and fails every request that has not finished, call
+	// it from the thread that owns the sink
+	void Shutdown();
+
+	size_t GetNrOfUnfinishedRequests();
+	size_t GetBytesUploadedLastUpdate() const;
+};
+
+template<typename Category, typename Identifier>
+inline void TextureStreamer<Category, Identifier>::WorkerLoop()
+{
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		queueCondition.wait(lock, [this]()
+			{
+				return stopWorkers || !waitingRequests.empty();
+			});
+
+		if (stopWorkers)
+			return;
+
+		Request request = waitingRequests.top();
+		waitingRequests.pop();
+		++nrOfDecodesInFlight;
+		lock.unlock();
+
+		DecodedRequest decoded;
+		decoded.requestIndex = request.requestIndex;
+		decoded.priority = request.priority;
+		decoded.category = request.category;
+		decoded.callback = std::move(request.callback);
+		decoded.residencyCallback = std::move(request.residencyCallback);
+
+		try
+		{
+			decoded.success = request.decoder(request.filePath, decoded.texture) &&
+				ValidateTexture(decoded.texture);
+		}
+		catch (...)
+		{
+			decoded.success = false;
+		}
+
+		lock.lock();
+		finishedDecodes.push_back(std::move(decoded));
+		--nrOfDecodesInFlight;
+	}
+}
+
+template<typename Category, typename Identifier>
+inline bool TextureStreamer<Category, Identifier>::ValidateTexture(
+	const DecodedTexture& texture) const
+{
+	if (texture.width == 0 || texture.height == 0 ||
+		texture.texelSizeInBytes == 0 || texture.subresources.empty() ||
+		texture.subresources.size() > 255)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < texture.subresources.size(); ++i)
+	{
+		if (texture.subresources[i].size() != texture.GetSubresourceSize(i))
+			return false;
+	}
+
+	return true;
+}
+
+template<typename Category, typename Identifier>
+inline bool TextureStreamer<Category, Identifier>::UploadSubresources(
+	DecodedRequest& request, size_t& bytesUploaded, size_t largestSubresource)
+{
+	if (!request.created)
+	{
+		request.created = sink->CreateTexture(request.category, request.texture,
+			request.identifier);
+
+		if (!request.created)
+		{
+			request.success = false;
+			return true;
+		}
+	}
+
+	size_t nrOfMips = request.texture.subresources.size();
+	while (request.residentMips < nrOfMips)
+	{
+		size_t subresourceIndex = nrOfMips - request.residentMips - 1;
+		size_t subresourceSize = request.texture.subresources[subresourceIndex].size();
+
+		if (request.residentMips != 0 && subresourceSize > largestSubresource)
+			return true;
+
+		if (bytesUploaded != 0 &&
+			bytesUploaded + subresourceSize > settings.uploadBytesPerFrame)
+		{
+			return false;
+		}
+
+		sink->UploadSubresource(request.identifier, request.texture,
+			static_cast<std::uint8_t>(subresourceIndex));
+		bytesUploaded += subresourceSize;
+		++request.residentMips;
+	}
+
+	return true;
+}
+
+template<typename Category, typename Identifier>
+inline bool TextureStreamer<Category, Identifier>::FinishRequest(
+	DecodedRequest& request)
+{
+	size_t nrOfMips = request.texture.subresources.size();
+
+	if (request.success && request.residencyCallback &&
+		request.residentMips != request.reportedMips)
+	{
+		TextureResidency<Identifier> residency;
+		residency.identifier = request.identifier;
+		residency.mostDetailedMip =
+			static_cast<std::uint8_t>(nrOfMips - request.residentMips);
+		residency.mipLevels = static_cast<std::uint8_t>(nrOfMips);
+		sink->SetResidency(residency);
+		request.residencyCallback(residency);
+		request.reportedMips = request.residentMips;
+	}
+
+	if (request.success && request.residentMips != nrOfMips)
+		return false;
+
+	if (request.callback)
+		request.callback(request.success, request.identifier);
+
+	if (request.created)
+		retiredData.push_back({ frameIndex, std::move(request.texture) });
+
+	return true;
+}
+
+template<typename Category, typename Identifier>
+inline size_t TextureStreamer<Category, Identifier>::AddRequest(Request&& request)
+{
+	request.requestIndex = nextRequestIndex++;
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		waitingRequests.push(std::move(request));
+	}
+
+	queueCondition.notify_one();
+	return nextRequestIndex - 1;
+}
+
+template<typename Category, typename Identifier>
+inline void TextureStreamer<Category, Identifier>::FailUnfinishedRequests()
+{
+	// Only called once the workers are joined, so the queues need no lock
+	while (!waitingRequests.empty())
+	{
+		Request request = waitingRequests.top();
+		waitingRequests.pop();
+
+		if (request.callback)
+			request.callback(false, Identifier());
+	}
+
+	for (DecodedRequest& decoded : finishedDecodes)
+		readyRequests.push_back(std::move(decoded));
+
+	finishedDecodes.clear();
+
+	// Textures already created in the sink are reported with their identifier
+	for (DecodedRequest& request : readyRequests)
+	{
+		request.success = false;
+		FinishRequest(request);
+	}
+
+	readyRequests.clear();
+}
+
+template<typename Category, typename Identifier>
+inline TextureStreamer<Category, Identifier>::~TextureStreamer()
+{
+	Shutdown();
+}
+
+template<typename Category, typename Identifier>
+inline void TextureStreamer<Category, Identifier>::Initialize(
+	TextureUploadSink<Category, Identifier>* sinkToUse,
+	const TextureStreamerSettings& streamerSettings)
+{
+	if (sinkToUse == nullptr || streamerSettings.nrOfDecodeWorkers == 0)
+		throw std::runtime_error("Error: Texture streamer needs a sink and at least one worker");
+
+	sink = sinkToUse;
+	settings = streamerSettings;
+	stopWorkers = false;
+
+	for (unsigned int i = 0; i < settings.nrOfDecodeWorkers; ++i)
+		workers.emplace_back(&TextureStreamer<Category, Identifier>::WorkerLoop, this);
+}
+
+template<typename Category, typename Identifier>
+inline size_t TextureStreamer<Category, Identifier>::RequestTexture(
+	const std::string& filePath, const Category& category, const TextureDecoder& decoder,
+	const TextureStreamCallback<Identifier>& callback, int priority)
+{
+	Request request;
+	request.priority = priority;
+	request.filePath = filePath;
+	request.category = category;
+	request.decoder = decoder;
+	request.callback = callback;
+
+	return AddRequest(std::move(request));
+}
+
+template<typename Category, typename Identifier>
+inline size_t TextureStreamer<Category, Identifier>::RequestTextureProgressive(
+	const std::string& filePath, const Category& category,
+	const TextureDecoder& decoder,
+	const TextureResidencyCallback<Identifier>& residencyCallback,
+	const TextureStreamCallback<Identifier>& callback, int priority)
+{
+	if (!residencyCallback)
+		throw std::runtime_error("Error: Progressive texture requests need a residency callback");
+
+	Request request;
+	request.priority = priority;
+	request.filePath = filePath;
+	request.category = category;
+	request.decoder = decoder;
+	request.callback = callback;
+	request.residencyCallback = residencyCallback;
+
+	return AddRequest(std::move(request));
+}
+
+template<typename Category, typename Identifier>
+inline void TextureStreamer<Category, Identifier>::Update()
+{
+	++frameIndex;
+	bytesUploadedLastUpdate = 0;
+
+	while (!retiredData.empty() &&
+		frameIndex - retiredData.front().retiredFrame >= settings.framesToKeepData)
+	{
+		retiredData.pop_front();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		for (DecodedRequest& decoded : finishedDecodes)
+			readyRequests.push_back(std::move(decoded));
+
+		finishedDecodes.clear();
+	}
+
+	// Ascending order puts the request to upload next at the back
+	std::sort(readyRequests.begin(), readyRequests.end(), RequestOrder());
+
+	// Every progressive texture is made usable through its mip tail before
+	// the detailed mips of any texture are uploaded
+	size_t bytesUploaded = 0;
+	bool budgetLeft = true;
+	for (auto it = readyRequests.rbegin(); it != readyRequests.rend() && budgetLeft; ++it)
+	{
+		if (it->success && it->residencyCallback && it->residentMips == 0)
+			budgetLeft = UploadSubresources(*it, bytesUploaded, settings.mipTailBytes);
+	}
+
+	for (auto it = readyRequests.rbegin(); it != readyRequests.rend() && budgetLeft; ++it)
+	{
+		if (it->success)
+			budgetLeft = UploadSubresources(*it, bytesUploaded, size_t(-1));
+	}
+
+	size_t nrOfKept = 0;
+	for (size_t i = 0; i < readyRequests.size(); ++i)
+	{
+		if (!FinishRequest(readyRequests[i]))
+		{
+			if (nrOfKept != i)
+				readyRequests[nrOfKept] = std::move(readyRequests[i]);
+
+			++nrOfKept;
+		}
+	}
+
+	readyRequests.resize(nrOfKept);
+	bytesUploadedLastUpdate = bytesUploaded;
+}
+
+template<typename Category, typename Identifier>
+inline void TextureStreamer<Category, Identifier>::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopWorkers = true;
+	}
+
+	queueCondition.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	workers.clear();
+	FailUnfinishedRequests();
+}
+
+template<typename Category, typename Identifier>
+inline size_t TextureStreamer<Category, Identifier>::GetNrOfUnfinishedRequests()
+{
+	std::lock_guard<std::mutex> lock(queueMutex);
+	return waitingRequests.size() + nrOfDecodesInFlight +
+		finishedDecodes.size() + readyRequests.size();
+}
+
+template<typename Category, typename Identifier>
+inline size_t TextureStreamer<Category, Identifier>::GetBytesUploadedLastUpdate() const
+{
+	return bytesUploadedLastUpdate;
+}
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <FrameBased.h>
 #include <FrameObject.h>
 #include <MultiHeapAllocatorGPU.h>
+#include <CountingHeapAllocatorGPU.h>
 
 #include "ResourceIdentifiers.h"
 #include "LocalResourceAllocator.h"
@@ -20,7 +21,7 @@ template<FrameType Frames>
 class Blackboard : FrameBased<Frames>
 {
 private:
-    MultiHeapAllocatorGPU allocator;
+    CountingHeapAllocatorGPU<MultiHeapAllocatorGPU> allocator;
     LocalResourceAllocator<Frames> localAllocator;
     FrameObject<TransientResourceAllocator, Frames> transientAllocators;
 
@@ -63,6 +64,8 @@ public:
     void GetInitializeBarriers(std::vector<D3D12_RESOURCE_BARRIER>& toAddTo);
     void DiscardAndClearResources(ID3D12GraphicsCommandList* list);
     void SwapFrame() override;
+
+    AllocatorStatistics GetHeapStatistics() const;
 };
 
 template<FrameType Frames>
@@ -212,4 +215,10 @@ inline void Blackboard<Frames>::SwapFrame()
     localAllocator.SwapFrame();
     transientAllocators.SwapFrame();
     transientAllocators.Active().Clear();
+}
+
+template<FrameType Frames>
+inline AllocatorStatistics Blackboard<Frames>::GetHeapStatistics() const
+{
+    return allocator.GetStatistics();
 }
\ No newline at end of file
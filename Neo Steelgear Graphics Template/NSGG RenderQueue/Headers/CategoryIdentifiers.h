@@ -15,11 +15,13 @@ struct CategoryIdentifier
 	CategoryType type;
 	size_t localIndex = size_t(-1);
 	bool dynamicCategory = true;
+	bool copyOnWrite = false; // Buffers only, resources share one allocation
 
 	bool operator==(const CategoryIdentifier& other) const
 	{
 		return this->type == other.type && this->localIndex == other.localIndex &&
-			this->dynamicCategory == other.dynamicCategory;
+			this->dynamicCategory == other.dynamicCategory &&
+			this->copyOnWrite == other.copyOnWrite;
 	}
 };
 
@@ -32,7 +34,8 @@ namespace std
 		{
 			return ((hash<CategoryType>()(identifier.type)
 				^ (hash<size_t>()(identifier.localIndex) << 1)) >> 1)
-				^ (hash<bool>()(identifier.dynamicCategory) << 1);
+				^ (hash<bool>()(identifier.dynamicCategory) << 1)
+				^ (hash<bool>()(identifier.copyOnWrite) << 2);
 		}
 	};
 }
@@ -52,4 +55,20 @@ struct CategoryResourceIdentifier
 			internalIndex.descriptorIndex == other.internalIndex.descriptorIndex;
 		// Temporary implementation, can be made default once the internal types have op== implemented
 	}
-};
\ No newline at end of file
+};
+
+namespace std
+{
+	template <>
+	struct hash<CategoryResourceIdentifier>
+	{
+		size_t operator()(const CategoryResourceIdentifier& identifier) const
+		{
+			const ResourceIndex& internalIndex = identifier.internalIndex;
+			return hash<CategoryIdentifier>()(identifier.categoryIdentifier)
+				^ (hash<size_t>()(internalIndex.allocatorIdentifier.heapChunkIndex) << 1)
+				^ (hash<size_t>()(internalIndex.allocatorIdentifier.internalIndex) << 2)
+				^ (hash<size_t>()(internalIndex.descriptorIndex) << 3);
+		}
+	};
+}
\ No newline at end of file
@@ -30,6 +30,14 @@ public:
 		std::vector<D3D12_RESOURCE_BARRIER>& barrierVector,
 		FrameResourceContext<Frames>& context);
 
+	// ProcessJob split in two, so barriers can be resolved in job order and
+	// the recording done on another thread
+	void AddBarriers(std::vector<D3D12_RESOURCE_BARRIER>& barrierVector,
+		FrameResourceContext<Frames>& context);
+	void RecordJob(ID3D12GraphicsCommandList* list,
+		const std::vector<D3D12_RESOURCE_BARRIER>& barrierVector,
+		FrameResourceContext<Frames>& context);
+
 	QueueJob<Frames>* GetQueueJob();
 };
 
@@ -62,6 +70,15 @@ template<FrameType Frames>
 inline void EnqueuedJob<Frames>::ProcessJob(ID3D12GraphicsCommandList* list,
 	std::vector<D3D12_RESOURCE_BARRIER>& barrierVector,
 	FrameResourceContext<Frames>& context)
+{
+	AddBarriers(barrierVector, context);
+	RecordJob(list, barrierVector, context);
+}
+
+template<FrameType Frames>
+inline void EnqueuedJob<Frames>::AddBarriers(
+	std::vector<D3D12_RESOURCE_BARRIER>& barrierVector,
+	FrameResourceContext<Frames>& context)
 {
 	barrierVector.clear();
 	barrierVector.reserve(barriers.size());
@@ -70,7 +87,13 @@ inline void EnqueuedJob<Frames>::ProcessJob(ID3D12GraphicsCommandList* list,
 	{
 		barrier.AddBarriers(barrierVector, context);
 	}
+}
 
+template<FrameType Frames>
+inline void EnqueuedJob<Frames>::RecordJob(ID3D12GraphicsCommandList* list,
+	const std::vector<D3D12_RESOURCE_BARRIER>& barrierVector,
+	FrameResourceContext<Frames>& context)
+{
 	if (barrierVector.size() != 0)
 	{
 		list->ResourceBarrier(barrierVector.size(), barrierVector.data());
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ManagedDescriptorHeap.h"
+#include "ManagedResourceCategories.h"
 #include "CategoryIdentifiers.h"
 
 template<FrameType Frames>
@@ -8,6 +9,7 @@ class FramePreparationContext
 {
 private:
 	ManagedDescriptorHeap<Frames>* descriptorHeap = nullptr;
+	const ManagedResourceCategories<Frames>* resourceCategories = nullptr;
 
 public:
 	FramePreparationContext() = default;
@@ -17,7 +19,8 @@ public:
 	FramePreparationContext(FramePreparationContext&& other) noexcept = default;
 	FramePreparationContext& operator=(FramePreparationContext&& other) noexcept = default;
 
-	void Initialize(ManagedDescriptorHeap<Frames>* descriptorHeap);
+	void Initialize(ManagedDescriptorHeap<Frames>* descriptorHeap,
+		const ManagedResourceCategories<Frames>* resourceCategories);
 
 	unsigned int GetCategoryDescriptorStart(
 		const CategoryIdentifier& identifier, ViewType viewType) const;
@@ -29,9 +32,11 @@ public:
 
 template<FrameType Frames>
 void FramePreparationContext<Frames>::Initialize(
-	ManagedDescriptorHeap<Frames>* descriptorHeapToUse)
+	ManagedDescriptorHeap<Frames>* descriptorHeapToUse,
+	const ManagedResourceCategories<Frames>* resourceCategoriesToUse)
 {
 	descriptorHeap = descriptorHeapToUse;
+	resourceCategories = resourceCategoriesToUse;
 }
 
 template<FrameType Frames>
@@ -55,7 +60,7 @@ inline unsigned int FramePreparationContext<Frames>::GetCategoryResourceDescript
 {
 	size_t toReturn = GetCategoryDescriptorStart(
 		identifier.categoryIdentifier, viewType);
-	toReturn += identifier.internalIndex.descriptorIndex;
+	toReturn += resourceCategories->GetResourceDescriptorIndex(identifier);
 
 	return toReturn;
 }
\ No newline at end of file
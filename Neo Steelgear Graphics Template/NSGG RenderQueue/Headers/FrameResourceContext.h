@@ -1,6 +1,8 @@
 #pragma once
 
+#include <mutex>
 #include <optional>
+#include <stdexcept>
 
 #include <FrameBased.h>
 
@@ -17,24 +19,32 @@ private:
 	ManagedDescriptorHeap<Frames>* descriptorHeap = nullptr;
 	ManagedResourceCategories<Frames>* resourceCategories = nullptr;
 	Blackboard<Frames>* blackboard = nullptr;
+	bool parallelRecording = false;
+	std::mutex categoryWriteMutex;
 
 public:
 	FrameResourceContext() = default;
 	~FrameResourceContext() = default;
 	FrameResourceContext(const FrameResourceContext& other) = delete;
 	FrameResourceContext& operator=(const FrameResourceContext& other) = delete;
-	FrameResourceContext(FrameResourceContext&& other) noexcept = default;
-	FrameResourceContext& operator=(FrameResourceContext&& other) noexcept = default;
+	FrameResourceContext(FrameResourceContext&& other) = delete;
+	FrameResourceContext& operator=(FrameResourceContext&& other) = delete;
 
 	void Initialize(ManagedDescriptorHeap<Frames>* descriptorHeap,
 		ManagedResourceCategories<Frames>* resourceCategories,
 		Blackboard<Frames>* blackboard);
 
+	// Set by the render queue while jobs are recorded on several threads
+	void SetParallelRecording(bool parallel);
+
+	// Category states are tracked in job order, so this throws while jobs are
+	// recorded in parallel. Declare the transition as a job barrier instead.
 	void TransitionCategoryResources(const CategoryIdentifier& identifier,
 		std::vector<D3D12_RESOURCE_BARRIER>& toAddTo,
 		D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter);
 
 	void SetLocalResourceData(const LocalResourceIndex& index, const void* data);
+	void* GetCategoryResourceWritePointer(const CategoryResourceIdentifier& identifier);
 
 	TransientResourceHandle GetTransientResource(const TransientResourceIndex& index) const;
 	LocalResourceHandle GetLocalResource(const LocalResourceIndex& index) const;
@@ -57,11 +67,23 @@ void FrameResourceContext<Frames>::Initialize(
 	blackboard = blackboardToUse;
 }
 
+template<FrameType Frames>
+void FrameResourceContext<Frames>::SetParallelRecording(bool parallel)
+{
+	parallelRecording = parallel;
+}
+
 template<FrameType Frames>
 void FrameResourceContext<Frames>::TransitionCategoryResources(
 	const CategoryIdentifier& identifier, std::vector<D3D12_RESOURCE_BARRIER>& toAddTo,
 	D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
 {
+	if (parallelRecording)
+	{
+		throw std::runtime_error("Error: Category resources cannot be transitioned "
+			"while jobs are recorded in parallel, use a job barrier");
+	}
+
 	resourceCategories->TransitionCategoryState(identifier, toAddTo, stateAfter, stateBefore);
 }
 
@@ -72,6 +94,16 @@ void FrameResourceContext<Frames>::SetLocalResourceData(
 	blackboard->SetLocalResourceData(index, data);
 }
 
+template<FrameType Frames>
+void* FrameResourceContext<Frames>::GetCategoryResourceWritePointer(
+	const CategoryResourceIdentifier& identifier)
+{
+	// Jobs recorded in parallel may write buffers of the same category, whose
+	// dirty pages are shared
+	std::lock_guard<std::mutex> lock(categoryWriteMutex);
+	return resourceCategories->GetResourceWritePointer(identifier);
+}
+
 template<FrameType Frames>
 TransientResourceHandle FrameResourceContext<Frames>::GetTransientResource(
 	const TransientResourceIndex& index) const
@@ -106,7 +138,7 @@ inline size_t FrameResourceContext<Frames>::GetCategoryResourceDescriptor(
 {
 	size_t toReturn = GetCategoryDescriptorStart(
 		identifier.categoryIdentifier, viewType);
-	toReturn += identifier.internalIndex.descriptorIndex;
+	toReturn += resourceCategories->GetResourceDescriptorIndex(identifier);
 
 	return toReturn;
 }
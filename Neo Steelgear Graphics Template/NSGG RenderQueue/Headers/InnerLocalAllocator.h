@@ -6,6 +6,7 @@
 #include <utility>
 
 #include <HeapAllocatorGPU.h>
+#include <AllocatorStatistics.h>
 
 #include "LocalResourceDesc.h"
 #include "ResourceIdentifiers.h"
@@ -65,7 +66,26 @@ public:
 
 	LocalResourceHandle GetHandle(const LocalResourceIndex& index) const;
 	size_t GetCurrentSize() const;
+	AllocatorStatistics GetStatistics() const;
 	D3D12_RESOURCE_BARRIER GetInitializationBarrier();
 
 	void UpdateData(void* dataPtr, size_t dataSize);
-};
\ No newline at end of file
+};
+
+inline AllocatorStatistics InnerLocalAllocator::GetStatistics() const
+{
+	// Buffers are only freed all at once by Reset, so every buffer is an
+	// allocation since the reset and the current offset is the peak
+	AllocatorStatistics toReturn;
+	toReturn.bytesReserved = currentSize;
+	toReturn.bytesUsed = currentOffset;
+	toReturn.largestFreeBlock = currentSize - currentOffset;
+	toReturn.nrOfHeapChunks = heapChunk.heap != nullptr ? 1 : 0;
+	toReturn.nrOfAllocations = buffers.size();
+	toReturn.nrOfFreeBlocks = currentSize != currentOffset ? 1 : 0;
+	toReturn.totalAllocations = buffers.size();
+	toReturn.bytesUsedHighWaterMark = currentOffset;
+	toReturn.countersSinceReset = true;
+
+	return toReturn;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "WorkStealingThreadPool.h"
+
+struct JobBatch
+{
+	size_t startJobIndex = 0;
+	size_t nrOfJobs = 0;
+};
+
+// Splits the jobs into at most nrOfPartitions contiguous batches of roughly
+// equal cost, getCost is called with a job index
+template<typename CostFunction>
+void CreateJobBatches(size_t nrOfJobs, size_t nrOfPartitions,
+	CostFunction getCost, std::vector<JobBatch>& batches)
+{
+	batches.clear();
+
+	if (nrOfJobs == 0)
+		return;
+
+	nrOfPartitions = std::max<size_t>(nrOfPartitions, 1);
+	size_t totalCost = 0;
+	for (size_t i = 0; i < nrOfJobs; ++i)
+		totalCost += getCost(i);
+
+	size_t costPerBatch = totalCost / nrOfPartitions;
+	size_t currentBatchCost = 0;
+	JobBatch currentBatch;
+
+	for (size_t i = 0; i < nrOfJobs; ++i)
+	{
+		currentBatchCost += getCost(i);
+		++currentBatch.nrOfJobs;
+
+		// The last partition takes whatever is left
+		if (currentBatchCost >= costPerBatch && batches.size() + 1 < nrOfPartitions)
+		{
+			batches.push_back(currentBatch);
+			currentBatchCost = 0;
+			currentBatch.startJobIndex = i + 1;
+			currentBatch.nrOfJobs = 0;
+		}
+	}
+
+	if (currentBatch.nrOfJobs != 0)
+		batches.push_back(currentBatch);
+}
+
+// Records batch i into lists[i], on the thread pool if one is given. Whichever
+// thread records a batch, submitting the first batches.size() lists in order
+// keeps the jobs in order. The list type is a template so the scheduling can
+// be used with any command list interface.
+template<typename CommandList, typename RecordFunction>
+void RecordJobBatches(const std::vector<JobBatch>& batches,
+	const std::vector<CommandList*>& lists, WorkStealingThreadPool* threadPool,
+	RecordFunction recordBatch)
+{
+	if (batches.size() > lists.size())
+		throw std::runtime_error("Error: More job batches than command lists");
+
+	auto record = [&](size_t batchIndex)
+	{
+		recordBatch(batches[batchIndex], batchIndex, lists[batchIndex]);
+	};
+
+	if (threadPool != nullptr)
+	{
+		threadPool->ParallelFor(batches.size(), record);
+	}
+	else
+	{
+		for (size_t i = 0; i < batches.size(); ++i)
+			record(i);
+	}
+}
\ No newline at end of file
@@ -28,6 +28,7 @@ public:
 
 	LocalResourceHandle GetLocalResourceHandle(const LocalResourceIndex& index) const;
 	D3D12_RESOURCE_BARRIER GetInitializationBarrier();
+	AllocatorStatistics GetStatistics() const;
 
 	void UploadData();
 
@@ -79,6 +80,12 @@ D3D12_RESOURCE_BARRIER LocalResourceAllocator<Frames>::GetInitializationBarrier(
 	return allocators.Active().GetInitializationBarrier();
 }
 
+template<FrameType Frames>
+AllocatorStatistics LocalResourceAllocator<Frames>::GetStatistics() const
+{
+	return allocators.Active().GetStatistics();
+}
+
 template<FrameType Frames>
 void LocalResourceAllocator<Frames>::UploadData()
 {
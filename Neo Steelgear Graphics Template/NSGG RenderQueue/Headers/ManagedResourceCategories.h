@@ -1,14 +1,19 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 
 #include <d3d12.h>
 
 #include <HeapAllocatorGPU.h>
 #include <MultiHeapAllocatorGPU.h>
+#include <PoolingHeapAllocatorGPU.h>
+#include <CountingHeapAllocatorGPU.h>
 #include <FrameBufferComponent.h>
+#include <CopyOnWriteBufferComponent.h>
 #include <FrameTexture2DComponent.h>
 #include <ResourceUploader.h>
+#include <RingBufferUploader.h>
 #include <FrameObject.h>
 
 #include "CategoryIdentifiers.h"
@@ -25,6 +30,7 @@ struct CategoryResourceHandle
 	ID3D12Resource* resource = nullptr;
 	size_t offset = size_t(-1);
 	size_t nrOfElements = 0;
+	float minLODClamp = 0.0f; // Textures only, for a clamp done in the shader
 };
 
 struct ResourceCategoriesSettings
@@ -34,8 +40,31 @@ struct ResourceCategoriesSettings
 	std::shared_ptr<HeapAllocatorGPU> defaultStaticTexture2DAllocator = nullptr;
 	std::shared_ptr<HeapAllocatorGPU> defaultDynamicTexture2DAllocator = nullptr;
 
+	// Unset entries above share a MultiHeapAllocatorGPU, or a heap pooling
+	// allocator using the pooling settings if enabled
+	bool usePoolingHeapAllocator = false;
+	PoolingHeapSettings poolingHeapSettings;
+
 	UploaderSettings staticResourcesUploadSettings;
 	UploaderSettings dynamicResourcesUploadSettings;
+
+	// Buffer updates are staged in the ring and their copies coalesced, falling
+	// back to the per category uploaders when it is full. 0 disables the ring.
+	size_t ringUploaderSize = 8 * 1024 * 1024;
+	size_t maximumRingUploads = 4096; // Per frame
+
+	size_t bufferDirtyPageSize = 256; // Granularity of ranged buffer updates
+};
+
+// Category statistics cover the placement of resources within their heap
+// chunks, the default heaps cover the chunks handed out to the categories
+struct ResourceCategoriesStatistics
+{
+	AllocatorStatistics staticBuffers;
+	AllocatorStatistics dynamicBuffers; // Including copy on write categories
+	AllocatorStatistics staticTextures;
+	AllocatorStatistics dynamicTextures;
+	AllocatorStatistics defaultHeaps;
 };
 
 template<FrameType Frames>
@@ -46,11 +75,16 @@ private:
 
 	ID3D12Device* device;
 
+	std::shared_ptr<HeapAllocatorGPU> defaultAllocator;
+	PoolingHeapAllocatorGPU* poolingAllocator = nullptr; // Set if the default pools heaps
+	CountingHeapAllocatorGPU<MultiHeapAllocatorGPU>* multiHeapAllocator = nullptr; // Otherwise
+
 	std::shared_ptr<HeapAllocatorGPU> staticBufferAllocator;
 	std::vector<FrameBufferComponent<1>> staticBufferCategories;
 
 	std::shared_ptr<HeapAllocatorGPU> dynamicBufferAllocator;
 	std::vector<FrameBufferComponent<Frames>> dynamicBufferCategories;
+	std::vector<CopyOnWriteBufferComponent<Frames>> copyOnWriteBufferCategories;
 
 	std::shared_ptr<HeapAllocatorGPU> staticTexture2DAllocator;
 	std::vector<FrameTexture2DComponent<1>> staticTexture2DCategories;
@@ -61,6 +95,11 @@ private:
 	FrameObject<ResourceUploader, Frames> staticResourcesUploader;
 	FrameObject<ResourceUploader, Frames> dynamicResourcesUploader;
 
+	std::unique_ptr<RingBufferUploader> ringUploader;
+	size_t frameIndex = 0;
+	size_t bufferDirtyPageSize = 256;
+	std::unordered_map<CategoryResourceIdentifier, float> textureMinLODClamps;
+
 	DescriptorAllocationInfo<BufferViewDesc> CreateDefaultBufferDAI(
 		ViewType viewType, size_t nrOfDescriptors);
 	DescriptorAllocationInfo<Texture2DViewDesc> CreateDefaultTexture2DDAI(
@@ -68,7 +107,7 @@ private:
 
 	void UpdateDescriptorHeapHelper(bool dynamic, CategoryType CategoryType,
 		size_t localIndex, ResourceCategory& Category,
-		ManagedDescriptorHeap<Frames>& descriptorHeap);
+		ManagedDescriptorHeap<Frames>& descriptorHeap, bool copyOnWrite = false);
 
 public:
 	ManagedResourceCategories() = default;
@@ -92,6 +131,11 @@ public:
 		TextureComponentInfo categoryInfo, size_t nrOfStartingDescriptors,
 		bool srv, bool uav, bool rtv, bool dsv);
 
+	// For buffers that are rarely written, each has one allocation instead of
+	// one per frame. Writes are set like for copy updated categories.
+	CategoryIdentifier CreateCopyOnWriteBufferCategory(BufferComponentInfo categoryInfo,
+		size_t nrOfStartingDescriptors, bool cbv, bool srv, bool uav);
+
 	CategoryResourceIdentifier CreateBuffer(const CategoryIdentifier& category,
 		size_t nrOfElements,
 		const BufferReplacementViews& replacementViews = BufferReplacementViews());
@@ -106,16 +150,41 @@ public:
 	void SetResourceData(const CategoryResourceIdentifier& identifier, 
 		void* dataAddress, std::uint8_t subresourceIndex = 0);
 
+	// Buffers in updateable categories only, just the written range is uploaded
+	void SetResourceDataRange(const CategoryResourceIdentifier& identifier,
+		const void* dataAddress, size_t offset, size_t size);
+
+	// Buffers in map updated categories only. Writes go straight to the copy
+	// read by the current frame, and reach the other frames like any update.
+	void* GetResourceWritePointer(const CategoryResourceIdentifier& identifier);
+
 	void TransitionCategoryState(const CategoryIdentifier& identifier,
 		std::vector<D3D12_RESOURCE_BARRIER>& barriers, D3D12_RESOURCE_STATES neededState,
 		std::optional<D3D12_RESOURCE_STATES> assumedInitialState = std::nullopt);
 
 	CategoryResourceHandle GetResourceHandle(const CategoryResourceIdentifier& identifier) const;
 
+	// Returned with the handle of the texture until changed, such as for the
+	// mips of a streamed texture that are not yet resident
+	void SetTextureMinLODClamp(const CategoryResourceIdentifier& identifier,
+		float minLODClamp);
+
+	// Offset of the resource within the descriptors of its category. For copy on
+	// write buffers it changes with each write that makes a new version, so it
+	// has to be fetched again after writing instead of being kept.
+	size_t GetResourceDescriptorIndex(const CategoryResourceIdentifier& identifier) const;
+
 	void UpdateDescriptorHeap(ManagedDescriptorHeap<Frames>& descriptorHeap);
 	void ActivateNewCategories(ID3D12GraphicsCommandList* list);
 	void UpdateCategories(ID3D12GraphicsCommandList* list);
 
+	// Data staged here is copied, with adjacent ranges merged, at the end of
+	// UpdateCategories. Null if no ring uploader size was set.
+	RingBufferUploader* GetRingUploader();
+
+	// Allocators passed in through the settings are not included
+	ResourceCategoriesStatistics GetStatistics() const;
+
 	void SwapFrame() override;
 };
 
@@ -142,12 +211,14 @@ ManagedResourceCategories<Frames>::CreateDefaultTexture2DDAI(
 template<FrameType Frames>
 inline void ManagedResourceCategories<Frames>::UpdateDescriptorHeapHelper(
 	bool dynamic, CategoryType categoryType, size_t localIndex,
-	ResourceCategory& category, ManagedDescriptorHeap<Frames>& descriptorHeap)
+	ResourceCategory& category, ManagedDescriptorHeap<Frames>& descriptorHeap,
+	bool copyOnWrite)
 {
 	CategoryIdentifier identifier;
 	identifier.type = categoryType;
 	identifier.localIndex = localIndex;
 	identifier.dynamicCategory = dynamic;
+	identifier.copyOnWrite = copyOnWrite;
 
 	descriptorHeap.AddCategoryDescriptors(identifier, category);
 }
@@ -157,9 +228,25 @@ inline void ManagedResourceCategories<Frames>::Initialize(ID3D12Device* deviceTo
 	const ResourceCategoriesSettings& heapSettings)
 {
 	device = deviceToUse;
+	bufferDirtyPageSize = heapSettings.bufferDirtyPageSize;
 
-	std::shared_ptr<MultiHeapAllocatorGPU> defaultAllocator(new MultiHeapAllocatorGPU());
-	defaultAllocator->Initialize(device);
+	if (heapSettings.usePoolingHeapAllocator)
+	{
+		std::shared_ptr<PoolingHeapAllocatorGPU> pooling(new PoolingHeapAllocatorGPU());
+		pooling->Initialize(device, heapSettings.poolingHeapSettings);
+		poolingAllocator = pooling.get();
+		multiHeapAllocator = nullptr;
+		defaultAllocator = pooling;
+	}
+	else
+	{
+		std::shared_ptr<CountingHeapAllocatorGPU<MultiHeapAllocatorGPU>> multiHeap(
+			new CountingHeapAllocatorGPU<MultiHeapAllocatorGPU>());
+		multiHeap->Initialize(device);
+		poolingAllocator = nullptr;
+		multiHeapAllocator = multiHeap.get();
+		defaultAllocator = multiHeap;
+	}
 
 	staticBufferAllocator = heapSettings.defaultStaticBufferAllocator != nullptr ?
 		heapSettings.defaultStaticBufferAllocator : defaultAllocator;
@@ -176,6 +263,13 @@ inline void ManagedResourceCategories<Frames>::Initialize(ID3D12Device* deviceTo
 	dynamicResourcesUploader.Initialize(&ResourceUploader::Initialize, device,
 		heapSettings.dynamicResourcesUploadSettings.heapSize,
 		heapSettings.dynamicResourcesUploadSettings.allocationStrategy);
+
+	if (heapSettings.ringUploaderSize != 0)
+	{
+		ringUploader = std::unique_ptr<RingBufferUploader>(new RingBufferUploader());
+		ringUploader->Initialize(device, heapSettings.ringUploaderSize,
+			heapSettings.maximumRingUploads);
+	}
 }
 
 template<FrameType Frames>
@@ -222,7 +316,8 @@ inline CategoryIdentifier ManagedResourceCategories<Frames>::CreateBufferCategor
 		if (categoryInfo.memoryInfo.heapAllocator == nullptr)
 			categoryInfo.memoryInfo.heapAllocator = dynamicBufferAllocator.get();
 
-		toAdd.Initialize(device, categoryUpdateType, categoryInfo, dai);
+		toAdd.Initialize(device, categoryUpdateType, categoryInfo, dai,
+			bufferDirtyPageSize);
 		dynamicBufferCategories.push_back(std::move(toAdd));
 		toReturn.localIndex = dynamicBufferCategories.size() - 1;
 	}
@@ -233,7 +328,8 @@ inline CategoryIdentifier ManagedResourceCategories<Frames>::CreateBufferCategor
 		if (categoryInfo.memoryInfo.heapAllocator == nullptr)
 			categoryInfo.memoryInfo.heapAllocator = staticBufferAllocator.get();
 
-		toAdd.Initialize(device, categoryUpdateType, categoryInfo, dai);
+		toAdd.Initialize(device, categoryUpdateType, categoryInfo, dai,
+			bufferDirtyPageSize);
 		staticBufferCategories.push_back(std::move(toAdd));
 		toReturn.localIndex = staticBufferCategories.size() - 1;
 	}
@@ -288,6 +384,37 @@ inline CategoryIdentifier ManagedResourceCategories<Frames>::CreateTexture2DCate
 	return toReturn;
 }
 
+template<FrameType Frames>
+inline CategoryIdentifier ManagedResourceCategories<Frames>::CreateCopyOnWriteBufferCategory(
+	BufferComponentInfo categoryInfo, size_t nrOfStartingDescriptors,
+	bool cbv, bool srv, bool uav)
+{
+	CategoryIdentifier toReturn;
+	toReturn.dynamicCategory = true;
+	toReturn.copyOnWrite = true;
+	toReturn.type = CategoryType::BUFFER;
+	std::vector<DescriptorAllocationInfo<BufferViewDesc>> dai;
+
+	if (cbv)
+		dai.push_back(CreateDefaultBufferDAI(ViewType::CBV, nrOfStartingDescriptors));
+	if (srv)
+		dai.push_back(CreateDefaultBufferDAI(ViewType::SRV, nrOfStartingDescriptors));
+	if (uav)
+		dai.push_back(CreateDefaultBufferDAI(ViewType::UAV, nrOfStartingDescriptors));
+
+	CopyOnWriteBufferComponent<Frames> toAdd;
+	categoryInfo.mappedResource = false;
+
+	if (categoryInfo.memoryInfo.heapAllocator == nullptr)
+		categoryInfo.memoryInfo.heapAllocator = dynamicBufferAllocator.get();
+
+	toAdd.Initialize(device, categoryInfo, dai, bufferDirtyPageSize);
+	copyOnWriteBufferCategories.push_back(std::move(toAdd));
+	toReturn.localIndex = copyOnWriteBufferCategories.size() - 1;
+
+	return toReturn;
+}
+
 template<FrameType Frames>
 inline CategoryResourceIdentifier ManagedResourceCategories<Frames>::CreateBuffer(
 	const CategoryIdentifier& category, size_t nrOfElements,
@@ -295,7 +422,12 @@ inline CategoryResourceIdentifier ManagedResourceCategories<Frames>::CreateBuffe
 {
 	ResourceIndex internalIndex;
 
-	if (category.dynamicCategory == true)
+	if (category.copyOnWrite == true)
+	{
+		internalIndex = copyOnWriteBufferCategories[category.localIndex].CreateBuffer(
+			nrOfElements, replacementViews);
+	}
+	else if (category.dynamicCategory == true)
 	{
 		internalIndex = dynamicBufferCategories[category.localIndex].CreateBuffer(
 			nrOfElements, replacementViews);
@@ -344,7 +476,11 @@ inline void ManagedResourceCategories<Frames>::RemoveResource(
 	switch (identifier.categoryIdentifier.type)
 	{
 	case CategoryType::BUFFER:
-		if (identifier.categoryIdentifier.dynamicCategory == true)
+		if (identifier.categoryIdentifier.copyOnWrite == true)
+		{
+			copyOnWriteBufferCategories[localIndex].RemoveComponent(internalIndex);
+		}
+		else if (identifier.categoryIdentifier.dynamicCategory == true)
 		{
 			dynamicBufferCategories[localIndex].RemoveComponent(internalIndex);
 		}
@@ -362,6 +498,7 @@ inline void ManagedResourceCategories<Frames>::RemoveResource(
 		{
 			staticTexture2DCategories[localIndex].RemoveComponent(internalIndex);
 		}
+		textureMinLODClamps.erase(identifier);
 		break;
 	default:
 		throw std::runtime_error("Unknown category type when removing resource");
@@ -380,7 +517,12 @@ void ManagedResourceCategories<Frames>::SetResourceData(
 	switch (identifier.categoryIdentifier.type)
 	{
 	case CategoryType::BUFFER:
-		if (identifier.categoryIdentifier.dynamicCategory == true)
+		if (identifier.categoryIdentifier.copyOnWrite == true)
+		{
+			copyOnWriteBufferCategories[localIndex].SetUpdateData(internalIndex,
+				dataAddress);
+		}
+		else if (identifier.categoryIdentifier.dynamicCategory == true)
 		{
 			dynamicBufferCategories[localIndex].SetUpdateData(internalIndex,
 				dataAddress);
@@ -409,6 +551,50 @@ void ManagedResourceCategories<Frames>::SetResourceData(
 	}
 }
 
+template<FrameType Frames>
+inline void ManagedResourceCategories<Frames>::SetResourceDataRange(
+	const CategoryResourceIdentifier& identifier, const void* dataAddress,
+	size_t offset, size_t size)
+{
+	size_t localIndex = identifier.categoryIdentifier.localIndex;
+	ResourceIndex internalIndex = identifier.internalIndex;
+
+	if (identifier.categoryIdentifier.type != CategoryType::BUFFER)
+		throw std::runtime_error("Ranged resource data can only be set for buffers");
+
+	if (identifier.categoryIdentifier.copyOnWrite == true)
+	{
+		copyOnWriteBufferCategories[localIndex].SetUpdateDataRange(internalIndex,
+			dataAddress, offset, size);
+	}
+	else if (identifier.categoryIdentifier.dynamicCategory == true)
+	{
+		dynamicBufferCategories[localIndex].SetUpdateDataRange(internalIndex,
+			dataAddress, offset, size);
+	}
+	else
+	{
+		staticBufferCategories[localIndex].SetUpdateDataRange(internalIndex,
+			dataAddress, offset, size);
+	}
+}
+
+template<FrameType Frames>
+inline void* ManagedResourceCategories<Frames>::GetResourceWritePointer(
+	const CategoryResourceIdentifier& identifier)
+{
+	const CategoryIdentifier& category = identifier.categoryIdentifier;
+
+	if (category.type != CategoryType::BUFFER || category.dynamicCategory == false ||
+		category.copyOnWrite == true)
+	{
+		throw std::runtime_error("Write pointers can only be used for map updated buffers");
+	}
+
+	return dynamicBufferCategories[category.localIndex].GetWritePointer(
+		identifier.internalIndex);
+}
+
 template<FrameType Frames>
 inline void ManagedResourceCategories<Frames>::TransitionCategoryState(
 	const CategoryIdentifier& identifier, std::vector<D3D12_RESOURCE_BARRIER>& barriers,
@@ -417,7 +603,12 @@ inline void ManagedResourceCategories<Frames>::TransitionCategoryState(
 	switch (identifier.type)
 	{
 	case CategoryType::BUFFER:
-		if (identifier.dynamicCategory == true)
+		if (identifier.copyOnWrite == true)
+		{
+			copyOnWriteBufferCategories[identifier.localIndex].ChangeToState(
+				barriers, neededState, assumedInitialState);
+		}
+		else if (identifier.dynamicCategory == true)
 		{
 			dynamicBufferCategories[identifier.localIndex].ChangeToState(
 				barriers, neededState, assumedInitialState);
@@ -454,6 +645,9 @@ inline void ManagedResourceCategories<Frames>::SwapFrame()
 	for (auto& category : dynamicBufferCategories)
 		category.SwapFrame();
 
+	for (auto& category : copyOnWriteBufferCategories)
+		category.SwapFrame();
+
 	for (auto& category : staticTexture2DCategories)
 		category.SwapFrame();
 
@@ -464,6 +658,14 @@ inline void ManagedResourceCategories<Frames>::SwapFrame()
 	staticResourcesUploader.Active().RestoreUsedMemory();
 	dynamicResourcesUploader.SwapFrame();
 	dynamicResourcesUploader.Active().RestoreUsedMemory();
+
+	// The frame that is about to be reused has finished on the GPU
+	++frameIndex;
+	if (ringUploader != nullptr && frameIndex >= Frames)
+		ringUploader->ReclaimCompleted(frameIndex - Frames);
+
+	if (poolingAllocator != nullptr)
+		poolingAllocator->AdvanceFrame();
 }
 
 template<FrameType Frames>
@@ -475,7 +677,16 @@ inline CategoryResourceHandle ManagedResourceCategories<Frames>::GetResourceHand
 	switch (identifier.categoryIdentifier.type)
 	{
 	case CategoryType::BUFFER:
-		if (identifier.categoryIdentifier.dynamicCategory == true)
+		if (identifier.categoryIdentifier.copyOnWrite == true)
+		{
+			BufferHandle internalHandle =
+				copyOnWriteBufferCategories[identifier.categoryIdentifier.localIndex].GetBufferHandle(
+					identifier.internalIndex);
+			toReturn.resource = internalHandle.resource;
+			toReturn.offset = internalHandle.startOffset;
+			toReturn.nrOfElements = internalHandle.nrOfElements;
+		}
+		else if (identifier.categoryIdentifier.dynamicCategory == true)
 		{
 			BufferHandle internalHandle =
 				dynamicBufferCategories[identifier.categoryIdentifier.localIndex].GetBufferHandle(
@@ -513,6 +724,12 @@ inline CategoryResourceHandle ManagedResourceCategories<Frames>::GetResourceHand
 			toReturn.offset = 0;
 			toReturn.nrOfElements = 1;
 		}
+
+		if (auto clamp = textureMinLODClamps.find(identifier);
+			clamp != textureMinLODClamps.end())
+		{
+			toReturn.minLODClamp = clamp->second;
+		}
 		break;
 	default:
 		throw std::runtime_error("Unknown category type when getting resource handle");
@@ -522,6 +739,35 @@ inline CategoryResourceHandle ManagedResourceCategories<Frames>::GetResourceHand
 	return toReturn;
 }
 
+template<FrameType Frames>
+inline void ManagedResourceCategories<Frames>::SetTextureMinLODClamp(
+	const CategoryResourceIdentifier& identifier, float minLODClamp)
+{
+	if (identifier.categoryIdentifier.type != CategoryType::TEXTURE2D)
+		throw std::runtime_error("Error: Only textures have a min LOD clamp");
+
+	if (minLODClamp == 0.0f)
+		textureMinLODClamps.erase(identifier);
+	else
+		textureMinLODClamps[identifier] = minLODClamp;
+}
+
+template<FrameType Frames>
+inline size_t ManagedResourceCategories<Frames>::GetResourceDescriptorIndex(
+	const CategoryResourceIdentifier& identifier) const
+{
+	// Copy on write buffers hand out stable indices, the descriptors belong
+	// to whichever version of the buffer is current
+	if (identifier.categoryIdentifier.copyOnWrite == true)
+	{
+		return copyOnWriteBufferCategories[
+			identifier.categoryIdentifier.localIndex].GetResourceIndex(
+				identifier.internalIndex).descriptorIndex;
+	}
+
+	return identifier.internalIndex.descriptorIndex;
+}
+
 template<FrameType Frames>
 inline void ManagedResourceCategories<Frames>::UpdateDescriptorHeap(
 	ManagedDescriptorHeap<Frames>& descriptorHeap)
@@ -538,6 +784,12 @@ inline void ManagedResourceCategories<Frames>::UpdateDescriptorHeap(
 			i, dynamicBufferCategories[i], descriptorHeap);
 	}
 
+	for (size_t i = 0; i < copyOnWriteBufferCategories.size(); ++i)
+	{
+		UpdateDescriptorHeapHelper(true, CategoryType::BUFFER,
+			i, copyOnWriteBufferCategories[i], descriptorHeap, true);
+	}
+
 	for (size_t i = 0; i < staticTexture2DCategories.size(); ++i)
 	{
 		UpdateDescriptorHeapHelper(false, CategoryType::TEXTURE2D,
@@ -563,6 +815,9 @@ inline void ManagedResourceCategories<Frames>::ActivateNewCategories(
 	for (auto& Category : dynamicBufferCategories)
 		Category.GetInitializationBarriers(barriers);
 
+	for (auto& Category : copyOnWriteBufferCategories)
+		Category.GetInitializationBarriers(barriers);
+
 	for (auto& Category : staticTexture2DCategories)
 		Category.GetInitializationBarriers(barriers);
 
@@ -581,14 +836,66 @@ inline void ManagedResourceCategories<Frames>::UpdateCategories(
 	ID3D12GraphicsCommandList* list)
 {
 	for (auto& category : staticBufferCategories)
-		category.PerformUpdates(list, staticResourcesUploader.Active());
+	{
+		category.PerformUpdates(list, staticResourcesUploader.Active(),
+			ringUploader.get());
+	}
 
 	for (auto& category : dynamicBufferCategories)
-		category.PerformUpdates(list, dynamicResourcesUploader.Active());
+	{
+		category.PerformUpdates(list, dynamicResourcesUploader.Active(),
+			ringUploader.get());
+	}
+
+	for (auto& category : copyOnWriteBufferCategories)
+	{
+		category.PerformUpdates(list, dynamicResourcesUploader.Active(),
+			ringUploader.get());
+	}
 
 	for (auto& category : staticTexture2DCategories)
 		category.PerformUpdates(list, staticResourcesUploader.Active());
 
 	for (auto& category : dynamicTexture2DCategories)
 		category.PerformUpdates(list, dynamicResourcesUploader.Active());
+
+	if (ringUploader != nullptr)
+	{
+		ringUploader->RecordPendingCopies(list);
+		ringUploader->MarkSubmitted(frameIndex);
+	}
+}
+
+template<FrameType Frames>
+inline RingBufferUploader* ManagedResourceCategories<Frames>::GetRingUploader()
+{
+	return ringUploader.get();
+}
+
+template<FrameType Frames>
+inline ResourceCategoriesStatistics ManagedResourceCategories<Frames>::GetStatistics() const
+{
+	ResourceCategoriesStatistics toReturn;
+
+	for (const FrameBufferComponent<1>& category : staticBufferCategories)
+		toReturn.staticBuffers.Accumulate(category.GetStatistics());
+
+	for (const FrameBufferComponent<Frames>& category : dynamicBufferCategories)
+		toReturn.dynamicBuffers.Accumulate(category.GetStatistics());
+
+	for (const CopyOnWriteBufferComponent<Frames>& category : copyOnWriteBufferCategories)
+		toReturn.dynamicBuffers.Accumulate(category.GetStatistics());
+
+	for (const FrameTexture2DComponent<1>& category : staticTexture2DCategories)
+		toReturn.staticTextures.Accumulate(category.GetStatistics());
+
+	for (const FrameTexture2DComponent<Frames>& category : dynamicTexture2DCategories)
+		toReturn.dynamicTextures.Accumulate(category.GetStatistics());
+
+	if (poolingAllocator != nullptr)
+		toReturn.defaultHeaps = poolingAllocator->GetStatistics();
+	else if (multiHeapAllocator != nullptr)
+		toReturn.defaultHeaps = multiHeapAllocator->GetStatistics();
+
+	return toReturn;
 }
\ No newline at end of file
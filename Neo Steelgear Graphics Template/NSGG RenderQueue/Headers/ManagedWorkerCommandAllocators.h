@@ -0,0 +1,93 @@
+#pragma once
+
+#include <d3d12.h>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+#include "ManagedCommandAllocator.h"
+
+// One command allocator per recording thread, since an allocator may only be
+// used by one thread at a time. The active lists are submitted together in a
+// single call so the queue sees them in index order.
+class ManagedWorkerCommandAllocators
+{
+private:
+	std::vector<std::unique_ptr<ManagedCommandAllocator>> allocators;
+	std::vector<ID3D12CommandList*> listsToExecute;
+
+public:
+	ManagedWorkerCommandAllocators() = default;
+	~ManagedWorkerCommandAllocators() = default;
+	ManagedWorkerCommandAllocators(const ManagedWorkerCommandAllocators& other) = delete;
+	ManagedWorkerCommandAllocators& operator=(const ManagedWorkerCommandAllocators& other) = delete;
+	ManagedWorkerCommandAllocators(ManagedWorkerCommandAllocators&& other) = default;
+	ManagedWorkerCommandAllocators& operator=(ManagedWorkerCommandAllocators&& other) = default;
+
+	void Initialize(ID3D12Device* deviceToUse, D3D12_COMMAND_LIST_TYPE typeOfList,
+		size_t nrOfWorkers);
+
+	size_t NrOfWorkers() const;
+	ID3D12GraphicsCommandList* ActiveList(size_t workerIndex);
+
+	// Closes every active list and submits the first nrOfUsedLists of them, no
+	// new lists are opened until Reset is called
+	void ExecuteCommands(ID3D12CommandQueue* queue, size_t nrOfUsedLists);
+	void Reset();
+};
+
+inline void ManagedWorkerCommandAllocators::Initialize(ID3D12Device* deviceToUse,
+	D3D12_COMMAND_LIST_TYPE typeOfList, size_t nrOfWorkers)
+{
+	if (nrOfWorkers == 0)
+		throw std::runtime_error("Error: Cannot create zero worker command allocators");
+
+	allocators.clear();
+	for (size_t i = 0; i < nrOfWorkers; ++i)
+	{
+		allocators.push_back(std::make_unique<ManagedCommandAllocator>());
+		allocators.back()->Initialize(deviceToUse, typeOfList);
+	}
+
+	listsToExecute.reserve(nrOfWorkers);
+}
+
+inline size_t ManagedWorkerCommandAllocators::NrOfWorkers() const
+{
+	return allocators.size();
+}
+
+inline ID3D12GraphicsCommandList* ManagedWorkerCommandAllocators::ActiveList(
+	size_t workerIndex)
+{
+	return allocators[workerIndex]->ActiveList();
+}
+
+inline void ManagedWorkerCommandAllocators::ExecuteCommands(
+	ID3D12CommandQueue* queue, size_t nrOfUsedLists)
+{
+	if (nrOfUsedLists > allocators.size())
+		throw std::runtime_error("Error: More used lists than worker command allocators");
+
+	listsToExecute.clear();
+	for (size_t i = 0; i < allocators.size(); ++i)
+	{
+		if (i < nrOfUsedLists)
+			listsToExecute.push_back(allocators[i]->ActiveList());
+
+		// Unused lists are closed as well so that no list is left open
+		allocators[i]->FinishActiveList();
+	}
+
+	if (listsToExecute.size() != 0)
+	{
+		queue->ExecuteCommandLists(static_cast<UINT>(listsToExecute.size()),
+			listsToExecute.data());
+	}
+}
+
+inline void ManagedWorkerCommandAllocators::Reset()
+{
+	for (auto& allocator : allocators)
+		allocator->Reset();
+}
\ No newline at end of file
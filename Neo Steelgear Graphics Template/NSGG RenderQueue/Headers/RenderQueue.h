@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <mutex>
 
 #include <entt.hpp>
 #include <FrameBased.h>
@@ -14,6 +15,8 @@
 #include "RenderQueueTimerCPU.h"
 #include "RenderQueueTimerGPU.h"
 #include "ImguiContext.h"
+#include "WorkStealingThreadPool.h"
+#include "JobBatches.h"
 
 template<FrameType Frames>
 class RenderQueue
@@ -34,15 +37,17 @@ private:
 	TransientResourceIndex endTextureIndex = TransientResourceIndex(-1);
 
 	FrameSetupContext setupContext;
+	std::vector<JobBatch> batches;
+	std::vector<std::vector<D3D12_RESOURCE_BARRIER>> jobBarriers;
 
 	void PrepareBatch(size_t startJobIndex, size_t nrOfJobsToProcess,
 		const entt::registry& frameRegistry,
 		const FramePreparationContext<Frames>& context,
-		size_t batchIndex, RenderQueueTimerCPU& cpuTimer);
+		size_t batchIndex, RenderQueueTimerCPU& cpuTimer, std::mutex& timerMutex);
 	void ExecuteBatch(size_t startJobIndex, size_t nrOfJobsToProcess,
 		ID3D12GraphicsCommandList* list, FrameResourceContext<Frames>& context,
 		size_t batchIndex, RenderQueueTimerCPU& cpuTimer,
-		RenderQueueTimerGPU<Frames>& gpuTimer);
+		RenderQueueTimerGPU<Frames>& gpuTimer, std::mutex& timerMutex);
 
 public:
 	RenderQueue() = default;
@@ -52,18 +57,25 @@ public:
 	RenderQueue(RenderQueue&& other) noexcept = default;
 	RenderQueue& operator=(RenderQueue&& other) noexcept = default;
 
+	// Batches are prepared in parallel when a thread pool is given, jobs may
+	// only read the registry and the context while preparing
 	void PrepareFrame(const entt::registry& frameRegistry,
 		std::uint8_t nrOfPartitions,
 		const FramePreparationContext<Frames>& context,
-		RenderQueueTimerCPU& cpuTimer);
+		RenderQueueTimerCPU& cpuTimer, WorkStealingThreadPool* threadPool = nullptr);
 
 	void SetResourceInfo(
 		const std::vector<std::pair<TransientResourceIndex, TransientResourceDesc>>& globalDescs);
 	void SetupTransientResources(Blackboard<Frames>& blackboard);
 
-	void ExecuteJobs(const std::vector<ID3D12GraphicsCommandList*> lists,
+	// Batch i is recorded into lists[i], in parallel when a thread pool is
+	// given. The barriers of every job are resolved in job order beforehand, so
+	// category transitions must be declared as job barriers rather than made
+	// while recording. The context throws on such transitions while recording
+	// is parallel. Returns the number of lists used.
+	size_t ExecuteJobs(const std::vector<ID3D12GraphicsCommandList*>& lists,
 		FrameResourceContext<Frames>& context, RenderQueueTimerCPU& cpuTimer,
-		RenderQueueTimerGPU<Frames>& gpuTimer);
+		RenderQueueTimerGPU<Frames>& gpuTimer, WorkStealingThreadPool* threadPool = nullptr);
 
 	void PerformImguiOperations(const FrameTimesCPU& cpuTimes,
 		const FrameTimesGPU& gpuTimes, ImguiContext& imguiContext);
@@ -79,7 +91,7 @@ void RenderQueue<Frames>::PrepareBatch(
 	size_t startJobIndex, size_t nrOfJobsToProcess,
 	const entt::registry& frameRegistry,
 	const FramePreparationContext<Frames>& context, size_t batchIndex,
-	RenderQueueTimerCPU& cpuTimer)
+	RenderQueueTimerCPU& cpuTimer, std::mutex& timerMutex)
 {
 	auto batchStartPoint = cpuTimer.GetCurrentTimePoint();
 	for (size_t i = 0; i < nrOfJobsToProcess; ++i)
@@ -87,8 +99,12 @@ void RenderQueue<Frames>::PrepareBatch(
 		auto jobStartPoint = cpuTimer.GetCurrentTimePoint();
 		jobs[i + startJobIndex].GetQueueJob()->PrepareFrame(
 			frameRegistry, context);
+
+		std::lock_guard<std::mutex> lock(timerMutex);
 		cpuTimer.MarkJobPreparation(i + startJobIndex, jobStartPoint);
 	}
+
+	std::lock_guard<std::mutex> lock(timerMutex);
 	cpuTimer.MarkBatchPreparation(batchIndex, batchStartPoint);
 }
 
@@ -97,21 +113,24 @@ void RenderQueue<Frames>::ExecuteBatch(
 	size_t startJobIndex, size_t nrOfJobsToProcess,
 	ID3D12GraphicsCommandList* list, FrameResourceContext<Frames>& context,
 	size_t batchIndex, RenderQueueTimerCPU& cpuTimer,
-	RenderQueueTimerGPU<Frames>& gpuTimer)
+	RenderQueueTimerGPU<Frames>& gpuTimer, std::mutex& timerMutex)
 {
-	std::vector<D3D12_RESOURCE_BARRIER> barrierVector;
-
 	auto batchStartPoint = cpuTimer.GetCurrentTimePoint();
 	gpuTimer.MarkBatchStart(list, batchIndex);
 	for (size_t i = 0; i < nrOfJobsToProcess; ++i)
 	{
 		auto jobStartPoint = cpuTimer.GetCurrentTimePoint();
 		gpuTimer.MarkJobStart(list, i + startJobIndex);
-		jobs[i + startJobIndex].ProcessJob(list, barrierVector, context);
+		jobs[i + startJobIndex].RecordJob(list, jobBarriers[i + startJobIndex],
+			context);
 		gpuTimer.MarkJobEnd(list, i + startJobIndex);
+
+		std::lock_guard<std::mutex> lock(timerMutex);
 		cpuTimer.MarkJobExecution(i + startJobIndex, jobStartPoint);
 	}
 	gpuTimer.MarkBatchEnd(list, batchIndex);
+
+	std::lock_guard<std::mutex> lock(timerMutex);
 	cpuTimer.MarkBatchExecution(batchIndex, batchStartPoint);
 }
 
@@ -119,44 +138,31 @@ template<FrameType Frames>
 void RenderQueue<Frames>::PrepareFrame(
 	const entt::registry& frameRegistry, std::uint8_t nrOfPartitions,
 	const FramePreparationContext<Frames>& context,
-	RenderQueueTimerCPU& cpuTimer)
+	RenderQueueTimerCPU& cpuTimer, WorkStealingThreadPool* threadPool)
 {
-	PassCost totalPreparationCost = 0;
 	for (auto& job : jobs)
-	{
 		job.GetQueueJob()->CalculateFrameCosts(frameRegistry);
-		totalPreparationCost += job.GetQueueJob()->GetPreparationCost();
-	}
-
-	PassCost costPerBatch = totalPreparationCost / nrOfPartitions;
 
-	size_t currentBatchCost = 0;
-	size_t currentBatchStartIndex = 0;
-	size_t currentBatchJobAmount = 0;
-	size_t batchIndex = 0;
+	CreateJobBatches(jobs.size(), nrOfPartitions, [this](size_t jobIndex)
+		{
+			return jobs[jobIndex].GetQueueJob()->GetPreparationCost();
+		}, batches);
 
-	for (size_t i = 0; i < jobs.size(); ++i)
+	std::mutex timerMutex;
+	auto prepareBatch = [&](size_t batchIndex)
 	{
-		currentBatchCost += jobs[i].GetQueueJob()->GetPreparationCost();
+		PrepareBatch(batches[batchIndex].startJobIndex, batches[batchIndex].nrOfJobs,
+			frameRegistry, context, batchIndex, cpuTimer, timerMutex);
+	};
 
-		if (currentBatchCost >= costPerBatch)
-		{
-			PrepareBatch(currentBatchStartIndex, currentBatchJobAmount + 1,
-				frameRegistry, context, batchIndex++, cpuTimer);
-			currentBatchCost = 0;
-			currentBatchStartIndex = i + 1;
-			currentBatchJobAmount = 0;
-		}
-		else
-		{
-			++currentBatchJobAmount;
-		}
+	if (threadPool != nullptr)
+	{
+		threadPool->ParallelFor(batches.size(), prepareBatch);
 	}
-
-	if (currentBatchStartIndex < jobs.size()) // The last batch was not executed in the loop
+	else
 	{
-		PrepareBatch(currentBatchStartIndex, currentBatchJobAmount,
-			frameRegistry, context, batchIndex, cpuTimer);
+		for (size_t i = 0; i < batches.size(); ++i)
+			prepareBatch(i);
 	}
 }
 
@@ -198,50 +204,35 @@ void RenderQueue<Frames>::SetupTransientResources(
 }
 
 template<FrameType Frames>
-void RenderQueue<Frames>::ExecuteJobs(
-	const std::vector<ID3D12GraphicsCommandList*> lists,
+size_t RenderQueue<Frames>::ExecuteJobs(
+	const std::vector<ID3D12GraphicsCommandList*>& lists,
 	FrameResourceContext<Frames>& context, RenderQueueTimerCPU& cpuTimer,
-	RenderQueueTimerGPU<Frames>& gpuTimer)
+	RenderQueueTimerGPU<Frames>& gpuTimer, WorkStealingThreadPool* threadPool)
 {
-	PassCost totalExecutionCost = 0;
-	for (auto& job : jobs)
-	{
-		totalExecutionCost += job.GetQueueJob()->GetExecutionCost();
-	}
-
-	PassCost costPerBatch = totalExecutionCost / lists.size();
-
-	size_t currentBatchCost = 0;
-	size_t currentBatchStartIndex = 0;
-	size_t currentBatchJobAmount = 0;
-	size_t currentListIndex = 0;
+	CreateJobBatches(jobs.size(), lists.size(), [this](size_t jobIndex)
+		{
+			return jobs[jobIndex].GetQueueJob()->GetExecutionCost();
+		}, batches);
 
+	// Category states are tracked as barriers are added, which has to happen
+	// in job order no matter which thread records the job
+	jobBarriers.resize(jobs.size());
 	for (size_t i = 0; i < jobs.size(); ++i)
-	{
-		currentBatchCost += jobs[i].GetQueueJob()->GetExecutionCost();
+		jobs[i].AddBarriers(jobBarriers[i], context);
 
-		if (currentBatchCost >= costPerBatch)
-		{
-			size_t batchIndex = currentListIndex;
-			ExecuteBatch(currentBatchStartIndex, currentBatchJobAmount + 1,
-				lists[currentListIndex++], context, batchIndex, cpuTimer,
-				gpuTimer);
-			currentBatchCost = 0;
-			currentBatchStartIndex = i + 1;
-			currentBatchJobAmount = 0;
-		}
-		else
+	std::mutex timerMutex;
+	context.SetParallelRecording(threadPool != nullptr &&
+		threadPool->NrOfThreads() > 1 && batches.size() > 1);
+
+	RecordJobBatches(batches, lists, threadPool,
+		[&](const JobBatch& batch, size_t batchIndex, ID3D12GraphicsCommandList* list)
 		{
-			++currentBatchJobAmount;
-		}
-	}
+			ExecuteBatch(batch.startJobIndex, batch.nrOfJobs, list, context,
+				batchIndex, cpuTimer, gpuTimer, timerMutex);
+		});
 
-	if (currentBatchStartIndex < jobs.size()) // The last batch was not executed in the loop
-	{
-		ExecuteBatch(currentBatchStartIndex, currentBatchJobAmount,
-			lists[currentListIndex], context, currentListIndex, cpuTimer,
-			gpuTimer);
-	}
+	context.SetParallelRecording(false);
+	return batches.size();
 }
 
 template<FrameType Frames>
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include <thread>
+#include <algorithm>
 #include <functional>
 
 #include <dxgidebug.h>
@@ -12,6 +14,7 @@
 
 #include "Blackboard.h"
 #include "ManagedCommandAllocator.h"
+#include "ManagedWorkerCommandAllocators.h"
 #include "ManagedDevice.h"
 #include "FramePreparationContext.h"
 #include "FrameResourceContext.h"
@@ -24,6 +27,7 @@
 #include "RenderQueueTimerCPU.h"
 #include "RenderQueueTimerGPU.h"
 #include "ImguiContext.h"
+#include "WorkStealingThreadPool.h"
 
 struct DebugSettings
 {
@@ -49,10 +53,13 @@ struct InformationSettings
 	bool renderImgui = true;
 };
 
-//struct ThreadingSettings
-//{
-//	WorkQueue* workQueueToUse = nullptr;
-//};
+struct ThreadingSettings
+{
+	// Parallelism is opt in. 0 prepares and records every job on the rendering
+	// thread, size_t(-1) starts one per hardware thread besides the rendering one.
+	size_t nrOfWorkerThreads = 0;
+	size_t preparationBatchesPerThread = 4; // More batches gives more to steal
+};
 
 struct RenderSettings
 {
@@ -62,10 +69,16 @@ struct RenderSettings
 	BlackboardSettings blackboard;
 	DescriptorHeapSettings descriptorHeap;
 	ResourceCategoriesSettings resourceCategories;
-	//ThreadingSettings threading;
+	ThreadingSettings threading;
 	InformationSettings information;
 };
 
+struct RendererAllocatorStatistics
+{
+	ResourceCategoriesStatistics resourceCategories;
+	AllocatorStatistics blackboardHeaps; // Local and transient resources
+};
+
 template<FrameType Frames>
 class Renderer : FrameBased<Frames>
 {
@@ -94,6 +107,11 @@ private:
 	FrameObject<ManagedCommandAllocator, Frames> updateAllocator;
 	FrameObject<ManagedCommandAllocator, Frames> mainAllocator;
 
+	WorkStealingThreadPool threadPool;
+	std::uint8_t nrOfPreparationBatches = 1;
+	FrameObject<ManagedWorkerCommandAllocators, Frames> jobAllocators;
+	std::vector<ID3D12GraphicsCommandList*> jobLists;
+
 	RenderQueueTimerCPU cpuTimer;
 	RenderQueueTimerGPU<Frames> gpuTimer;
 	std::vector<std::function<void(ImguiContext&)>> externalImguiFunctions;
@@ -144,6 +162,10 @@ public:
 
 	const FrameTimesCPU& GetLastFrameTimes();
 	const FrameTimesGPU& GetLastCycleFrameTimes();
+	RendererAllocatorStatistics GetAllocatorStatistics() const;
+
+	// For splitting up other work, such as texture staging or mip generation
+	WorkStealingThreadPool& GetThreadPool();
 	void AddImguiFunction(std::function<void(ImguiContext&)>& function);
 };
 
@@ -276,7 +298,8 @@ inline void Renderer<Frames>::PrepareAndSetupFrame(const entt::registry& registr
 {
 	auto preparationStartPoint = cpuTimer.GetCurrentTimePoint();
 	resourceCategories.UpdateDescriptorHeap(descriptorHeap);
-	renderQueue.PrepareFrame(registry, 1, preparationContext, cpuTimer); // 1 for now, later when multithreading it should be a setting
+	renderQueue.PrepareFrame(registry, nrOfPreparationBatches, preparationContext,
+		cpuTimer, &threadPool);
 	cpuTimer.MarkPreparation(preparationStartPoint);
 
 	auto setupStartPoint = cpuTimer.GetCurrentTimePoint();
@@ -326,19 +349,19 @@ template<FrameType Frames>
 inline void Renderer<Frames>::ExecuteRenderQueueJobs()
 {
 	auto executionStartPoint = cpuTimer.GetCurrentTimePoint();
-	std::vector<ID3D12GraphicsCommandList*> temp;
-	temp.push_back(mainAllocator.Active().ActiveList());
 	auto bindableDescriptorHeap = descriptorHeap.GetShaderVisibleHeap();
+	jobLists.clear();
 
-	for (ID3D12GraphicsCommandList* list : temp)
+	for (size_t i = 0; i < jobAllocators.Active().NrOfWorkers(); ++i)
 	{
-		list->SetDescriptorHeaps(1, &bindableDescriptorHeap);
+		jobLists.push_back(jobAllocators.Active().ActiveList(i));
+		jobLists.back()->SetDescriptorHeaps(1, &bindableDescriptorHeap);
 	}
 
-	renderQueue.ExecuteJobs(temp, this->resourceContext, cpuTimer, gpuTimer);
+	size_t nrOfUsedLists = renderQueue.ExecuteJobs(jobLists, this->resourceContext,
+		cpuTimer, gpuTimer, &threadPool);
 	blackboard.UploadLocalData();
-	mainAllocator.Active().FinishActiveList(true);
-	mainAllocator.Active().ExecuteCommands(directQueue);
+	jobAllocators.Active().ExecuteCommands(directQueue, nrOfUsedLists);
 	jobsDoneFence.Active().Signal(directQueue);
 	jobsDoneFence.Active().WaitGPU(presentQueue);
 	cpuTimer.MarkExecution(executionStartPoint);
@@ -439,14 +462,26 @@ inline void Renderer<Frames>::Initialize(const RenderSettings& settings)
 		settings.descriptorHeap.startDescriptorsPerFrame);
 	resourceCategories.Initialize(device.GetDevice(),
 		settings.resourceCategories);
-	//workQueue = settings.threading.workQueueToUse;
+
+	size_t nrOfWorkerThreads = settings.threading.nrOfWorkerThreads;
+	if (nrOfWorkerThreads == size_t(-1))
+	{
+		nrOfWorkerThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1;
+	}
+
+	threadPool.Initialize(nrOfWorkerThreads);
+	nrOfPreparationBatches = static_cast<std::uint8_t>(std::clamp<size_t>(
+		threadPool.NrOfThreads() * settings.threading.preparationBatchesPerThread,
+		1, UINT8_MAX));
+	jobAllocators.Initialize(&ManagedWorkerCommandAllocators::Initialize,
+		device.GetDevice(), D3D12_COMMAND_LIST_TYPE_DIRECT, threadPool.NrOfThreads());
 
 	cpuTimer.SetActive(settings.information.performTimingsCPU);
 	gpuTimer.SetActive(settings.information.performTimingsGPU);
 	renderImgui = settings.information.renderImgui;
 
 	queueContext.Initialize(&renderQueue);
-	preparationContext.Initialize(&descriptorHeap);
+	preparationContext.Initialize(&descriptorHeap, &resourceCategories);
 	resourceContext.Initialize(&descriptorHeap, &resourceCategories, &blackboard);
 	imguiContext.Initialize(window.GetWindowHandle(), device.GetDevice());
 }
@@ -517,6 +552,7 @@ inline void Renderer<Frames>::WaitForAvailableFrame()
 	jobsDoneFence.SwapFrame();
 	updateAllocator.SwapFrame();
 	mainAllocator.SwapFrame();
+	jobAllocators.SwapFrame();
 
 	descriptorHeap.SwapFrame();
 	resourceCategories.SwapFrame();
@@ -525,6 +561,7 @@ inline void Renderer<Frames>::WaitForAvailableFrame()
 
 	mainAllocator.Active().Reset();
 	updateAllocator.Active().Reset();
+	jobAllocators.Active().Reset();
 	gpuTimer.ResolveQueries(mainAllocator.Active().ActiveList(),
 		updateAllocator.Active().ActiveList());
 }
@@ -539,9 +576,12 @@ inline void Renderer<Frames>::SetGlobalFrameResourceDesc(
 template<FrameType Frames>
 inline void Renderer<Frames>::Render(const entt::registry& registry)
 {
-	cpuTimer.SetJobInfo(1, renderQueue.GetNrOfJobs()); // CHANGE THE 1 LATER TO BE BASED ON MULTI THREADING SETTINGS
-	gpuTimer.SetJobInfo(device.GetDevice(), 1, renderQueue.GetNrOfJobs(), directQueue,
-		copyQueue, presentQueue); // CHANGE THE 1 LATER TO BE BASED ON MULTI THREADING SETTINGS
+	// Batches are shared between preparation and execution in the cpu timings
+	size_t nrOfExecutionLists = jobAllocators.Active().NrOfWorkers();
+	cpuTimer.SetJobInfo(std::max<size_t>(nrOfPreparationBatches, nrOfExecutionLists),
+		renderQueue.GetNrOfJobs());
+	gpuTimer.SetJobInfo(device.GetDevice(), static_cast<UINT>(nrOfExecutionLists),
+		renderQueue.GetNrOfJobs(), directQueue, copyQueue, presentQueue);
 
 	auto renderStartPoint = cpuTimer.MarkPreRender();
 	gpuTimer.MarkFrameStart(mainAllocator.Active().ActiveList());
@@ -574,6 +614,22 @@ inline const FrameTimesGPU& Renderer<Frames>::GetLastCycleFrameTimes()
 	return gpuTimer.GetPreviousFrameIterationTimes();
 }
 
+template<FrameType Frames>
+inline RendererAllocatorStatistics Renderer<Frames>::GetAllocatorStatistics() const
+{
+	RendererAllocatorStatistics toReturn;
+	toReturn.resourceCategories = resourceCategories.GetStatistics();
+	toReturn.blackboardHeaps = blackboard.GetHeapStatistics();
+
+	return toReturn;
+}
+
+template<FrameType Frames>
+inline WorkStealingThreadPool& Renderer<Frames>::GetThreadPool()
+{
+	return threadPool;
+}
+
 template<FrameType Frames>
 inline void Renderer<Frames>::AddImguiFunction(std::function<void(ImguiContext&)>& function)
 {
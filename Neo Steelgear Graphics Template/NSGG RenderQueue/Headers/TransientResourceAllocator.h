@@ -6,6 +6,7 @@
 #include <HeapAllocatorGPU.h>
 #include <D3DPtr.h>
 #include <DescriptorAllocator.h>
+#include <AllocatorStatistics.h>
 
 #include "TransientResourceDesc.h"
 #include "ResourceIdentifiers.h"
@@ -97,4 +98,34 @@ public:
 	void AddInitializationBarriers(std::vector<D3D12_RESOURCE_BARRIER>& toAddTo) const;
 	void DiscardRenderTargets(ID3D12GraphicsCommandList* list);
 	void ClearDepthStencils(ID3D12GraphicsCommandList* list);
-};
\ No newline at end of file
+
+	AllocatorStatistics GetStatistics() const;
+};
+
+inline AllocatorStatistics TransientResourceAllocator::GetStatistics() const
+{
+	// Memory chunks are filled linearly, only the space after the last
+	// resource in each chunk can still be allocated from. Nothing is freed
+	// before Clear, so the counters and the peak follow from the chunks.
+	AllocatorStatistics toReturn;
+
+	for (const MemoryChunk& memoryChunk : memoryChunks)
+	{
+		size_t chunkSize = memoryChunk.heapChunk.endOffset -
+			memoryChunk.heapChunk.startOffset;
+		size_t remaining = chunkSize - memoryChunk.currentOffset;
+
+		toReturn.bytesReserved += chunkSize;
+		toReturn.bytesUsed += memoryChunk.currentOffset;
+		toReturn.largestFreeBlock = std::max(toReturn.largestFreeBlock, remaining);
+		toReturn.nrOfAllocations += memoryChunk.resources.size();
+		toReturn.nrOfFreeBlocks += remaining != 0 ? 1 : 0;
+	}
+
+	toReturn.nrOfHeapChunks = memoryChunks.size();
+	toReturn.totalAllocations = toReturn.nrOfAllocations;
+	toReturn.bytesUsedHighWaterMark = toReturn.bytesUsed;
+	toReturn.countersSinceReset = true;
+
+	return toReturn;
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "IndexedHeapHelper.h"
+
+#include "Benchmarks/BenchmarkHelpers.h"
+
+// Compares the latency and fragmentation of the four allocation strategies on
+// synthetic workloads shaped like the per frame uploads and like longer lived
+// buffer allocations
+
+struct WorkloadDescription
+{
+	const char* name = nullptr;
+	size_t heapSize = 0;
+	size_t nrOfFrames = 0;
+	size_t allocationsPerFrame = 0;
+	size_t minimumLifetime = 0; // In frames
+	size_t maximumLifetime = 0;
+	bool textureSizedAllocations = false;
+};
+
+struct Allocation
+{
+	size_t chunkIndex = 0;
+	size_t size = 0;
+	size_t freeFrame = 0;
+};
+
+struct StrategyResult
+{
+	double averageNanoseconds = 0.0;
+	double p99Nanoseconds = 0.0;
+	double maxNanoseconds = 0.0;
+	double averageFragmentation = 0.0;
+	double worstFragmentation = 0.0;
+	size_t failedAllocations = 0;
+};
+
+size_t CreateSize(bool textureSized, std::mt19937_64& generator)
+{
+	if (textureSized && generator() % 4 == 0)
+	{
+		// Mip levels of textures up to 1024x1024 with 4 bytes per texel
+		size_t dimension = size_t(16) << (generator() % 7);
+		return dimension * dimension * 4;
+	}
+
+	// Constant buffers and small vertex or index buffers
+	return 256 + generator() % (64 * 1024 - 256);
+}
+
+StrategyResult RunWorkload(const WorkloadDescription& workload,
+	IndexedAllocationStrategy strategy)
+{
+	std::mt19937_64 generator(workload.heapSize);
+	IndexedHeapHelper<size_t> helper;
+	helper.Initialize(workload.heapSize);
+	std::vector<Allocation> allocations;
+	std::vector<double> latencies;
+	latencies.reserve(workload.nrOfFrames * workload.allocationsPerFrame * 2);
+	StrategyResult toReturn;
+	size_t usedSize = 0;
+
+	for (size_t frame = 0; frame < workload.nrOfFrames; ++frame)
+	{
+		for (size_t i = 0; i < allocations.size();)
+		{
+			if (allocations[i].freeFrame != frame)
+			{
+				++i;
+				continue;
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			helper.DeallocateChunk(allocations[i].chunkIndex);
+			auto end = std::chrono::steady_clock::now();
+			latencies.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+			usedSize -= allocations[i].size;
+			allocations[i] = allocations.back();
+			allocations.pop_back();
+		}
+
+		for (size_t i = 0; i < workload.allocationsPerFrame; ++i)
+		{
+			size_t size = CreateSize(workload.textureSizedAllocations, generator);
+			size_t alignment = size >= 64 * 1024 ? 64 * 1024 : 256;
+
+			auto start = std::chrono::steady_clock::now();
+			size_t chunkIndex = helper.AllocateChunk(size, strategy, alignment);
+			auto end = std::chrono::steady_clock::now();
+			latencies.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+
+			if (chunkIndex == size_t(-1))
+			{
+				++toReturn.failedAllocations;
+				continue;
+			}
+
+			size_t lifetime = workload.minimumLifetime + generator() %
+				(workload.maximumLifetime - workload.minimumLifetime + 1);
+			allocations.push_back({ chunkIndex, size, frame + lifetime });
+			usedSize += size;
+		}
+
+		// Share of the free memory that is not in the largest free chunk
+		size_t freeSize = workload.heapSize - usedSize;
+		double fragmentation = freeSize == 0 ? 0.0 :
+			1.0 - double(helper.GetLargestFreeChunkSize()) / double(freeSize);
+		toReturn.averageFragmentation += fragmentation / workload.nrOfFrames;
+		toReturn.worstFragmentation = std::max(toReturn.worstFragmentation, fragmentation);
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	for (double latency : latencies)
+		toReturn.averageNanoseconds += latency / latencies.size();
+	toReturn.p99Nanoseconds = latencies[latencies.size() * 99 / 100];
+	toReturn.maxNanoseconds = latencies.back();
+
+	return toReturn;
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = QuickRun(argc, argv);
+	size_t nrOfFrames = quick ? 20 : 2000;
+
+	// Uploads live until the frame that recorded them has finished, buffers
+	// live for anything from a few frames to the whole run
+	const WorkloadDescription workloads[] = {
+		{ "upload ring", 128 * 1024 * 1024, nrOfFrames, 64, 1, 3, true },
+		{ "buffer churn", 64 * 1024 * 1024, nrOfFrames, 8, 10, 400, false },
+		{ "mixed", 256 * 1024 * 1024, nrOfFrames, 32, 1, 30, true } };
+
+	const char* strategyNames[] = { "FIRST_FIT", "BEST_FIT", "WORST_FIT", "TLSF" };
+	const IndexedAllocationStrategy strategies[] = { IndexedAllocationStrategy::FIRST_FIT,
+		IndexedAllocationStrategy::BEST_FIT, IndexedAllocationStrategy::WORST_FIT,
+		IndexedAllocationStrategy::TLSF };
+
+	std::printf("%-13s %-10s %9s %9s %10s %10s %10s %7s\n", "workload", "strategy",
+		"avg ns", "p99 ns", "max ns", "avg frag", "worst frag", "failed");
+
+	for (const WorkloadDescription& workload : workloads)
+	{
+		for (size_t i = 0; i < 4; ++i)
+		{
+			StrategyResult result = RunWorkload(workload, strategies[i]);
+			std::printf("%-13s %-10s %9.0f %9.0f %10.0f %9.1f%% %9.1f%% %7zu\n",
+				workload.name, strategyNames[i], result.averageNanoseconds,
+				result.p99Nanoseconds, result.maxNanoseconds,
+				result.averageFragmentation * 100.0, result.worstFragmentation * 100.0,
+				result.failedAllocations);
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
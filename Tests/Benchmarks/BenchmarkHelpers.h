@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+class BenchmarkTimer
+{
+private:
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+	void Restart()
+	{
+		start = std::chrono::steady_clock::now();
+	}
+
+	double ElapsedMilliseconds() const
+	{
+		return std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+	}
+};
+
+// Benchmarks take --quick to run a reduced workload, which is meant for
+// checking that they still run rather than for measuring
+inline bool QuickRun(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+			return true;
+	}
+
+	return false;
+}
+
+// Keeps the optimizer from removing work whose result is otherwise unused
+inline void KeepResult(size_t value)
+{
+	static volatile size_t sink = 0;
+	sink = sink + value;
+}
\ No newline at end of file
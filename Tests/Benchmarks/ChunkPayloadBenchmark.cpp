@@ -0,0 +1,126 @@
+#include <vector>
+#include <random>
+#include <optional>
+#include <cstdint>
+#include <type_traits>
+#include <cstdio>
+
+#include "HeapHelper.h"
+#include "IndexedHeapHelper.h"
+
+#include "Benchmarks/BenchmarkHelpers.h"
+
+// Measures how the size of the per chunk payload affects allocation. HeapHelper
+// stores the payload inside each chunk it scans, IndexedHeapHelper keeps it in a
+// separate array from the fields used while searching.
+
+// Same layout as TextureAllocator's TextureEntry without the Direct3D types
+struct TextureEntryPayload
+{
+	void* resource = nullptr;
+	std::uint32_t currentState = 0;
+	size_t width = 0;
+	size_t height = 0;
+	size_t depthOrArraySize = 0;
+	std::uint8_t texelSize = 0;
+
+	struct ClearValue
+	{
+		std::uint32_t format = 0;
+		float color[4] = {};
+	};
+
+	std::optional<ClearValue> clearValue = std::nullopt;
+};
+
+template<typename Payload>
+Payload CreatePayload(size_t value)
+{
+	if constexpr (std::is_same_v<Payload, TextureEntryPayload>)
+	{
+		TextureEntryPayload toReturn;
+		toReturn.width = value;
+		toReturn.clearValue = TextureEntryPayload::ClearValue();
+		return toReturn;
+	}
+	else
+	{
+		return value;
+	}
+}
+
+template<typename Helper, typename Payload>
+double RunChurn(size_t nrOfLiveChunks, size_t nrOfOperations,
+	AllocationStrategy strategy)
+{
+	std::mt19937_64 generator(nrOfLiveChunks);
+	std::uniform_int_distribution<size_t> sizeDistribution(16, 4096);
+	Helper helper;
+	helper.Initialize(nrOfLiveChunks * 8192);
+	std::vector<size_t> liveChunks;
+
+	for (size_t i = 0; i < nrOfLiveChunks; ++i)
+	{
+		size_t chunkIndex = helper.AllocateChunk(sizeDistribution(generator), strategy, 16);
+		helper[chunkIndex] = CreatePayload<Payload>(i);
+		liveChunks.push_back(chunkIndex);
+	}
+
+	BenchmarkTimer timer;
+
+	for (size_t i = 0; i < nrOfOperations; ++i)
+	{
+		size_t position = generator() % liveChunks.size();
+		helper.DeallocateChunk(liveChunks[position]);
+
+		size_t chunkIndex = helper.AllocateChunk(sizeDistribution(generator), strategy, 16);
+		helper[chunkIndex] = CreatePayload<Payload>(i);
+		liveChunks[position] = chunkIndex;
+	}
+
+	double elapsed = timer.ElapsedMilliseconds();
+	KeepResult(helper.NrOfAllocatedChunks());
+
+	return elapsed * 1000000.0 / nrOfOperations;
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = QuickRun(argc, argv);
+	std::vector<size_t> liveCounts = { 1000, 10000 };
+	size_t nrOfOperations = 10000;
+
+	if (quick)
+	{
+		liveCounts = { 200 };
+		nrOfOperations = 500;
+	}
+
+	const char* strategyNames[] = { "FIRST_FIT", "BEST_FIT" };
+	const AllocationStrategy strategies[] = { AllocationStrategy::FIRST_FIT,
+		AllocationStrategy::BEST_FIT };
+
+	std::printf("payload: %zu bytes for TextureEntry, %zu bytes for size_t\n",
+		sizeof(TextureEntryPayload), sizeof(size_t));
+	std::printf("%-10s %11s %16s %16s %16s %16s\n", "strategy", "live chunks",
+		"old size_t", "old TextureEntry", "new size_t", "new TextureEntry");
+
+	for (size_t nrOfLiveChunks : liveCounts)
+	{
+		for (size_t i = 0; i < 2; ++i)
+		{
+			std::printf("%-10s %11zu %13.0f ns %13.0f ns %13.0f ns %13.0f ns\n",
+				strategyNames[i], nrOfLiveChunks,
+				RunChurn<HeapHelper<size_t>, size_t>(
+					nrOfLiveChunks, nrOfOperations, strategies[i]),
+				RunChurn<HeapHelper<TextureEntryPayload>, TextureEntryPayload>(
+					nrOfLiveChunks, nrOfOperations, strategies[i]),
+				RunChurn<IndexedHeapHelper<size_t>, size_t>(
+					nrOfLiveChunks, nrOfOperations, strategies[i]),
+				RunChurn<IndexedHeapHelper<TextureEntryPayload>, TextureEntryPayload>(
+					nrOfLiveChunks, nrOfOperations, strategies[i]));
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include <vector>
+#include <random>
+#include <cstdio>
+
+#include "FirstFitSearch.h"
+
+#include "Benchmarks/BenchmarkHelpers.h"
+
+// Throughput of the first fit kernels over 10k to 100k free chunks. Requests
+// are larger than almost every chunk so each search reads the whole array.
+
+const char* GetLevelName(FirstFitSearchLevel level)
+{
+	switch (level)
+	{
+	case FirstFitSearchLevel::SSE4_2:
+		return "SSE4.2";
+	case FirstFitSearchLevel::AVX2:
+		return "AVX2";
+	default:
+		return "scalar";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = QuickRun(argc, argv);
+	std::vector<size_t> chunkCounts = { 10000, 30000, 100000 };
+	size_t nrOfSearches = 2000;
+
+	if (quick)
+	{
+		chunkCounts = { 1000 };
+		nrOfSearches = 10;
+	}
+
+	std::printf("detected level: %s\n", GetLevelName(GetFirstFitSearchLevel()));
+	std::printf("%-8s %12s %14s %16s\n", "level", "free chunks", "us per search",
+		"chunks per ns");
+
+	for (size_t chunkCount : chunkCounts)
+	{
+		std::mt19937_64 generator(chunkCount);
+		std::vector<size_t> offsets(chunkCount);
+		std::vector<size_t> sizes(chunkCount);
+
+		for (size_t i = 0; i < chunkCount; ++i)
+		{
+			offsets[i] = i * 8192 + generator() % 4096;
+			sizes[i] = 256 + generator() % 3840;
+		}
+
+		for (int level = 0; level <= int(GetFirstFitSearchLevel()); ++level)
+		{
+			BenchmarkTimer timer;
+			size_t checksum = 0;
+
+			for (size_t i = 0; i < nrOfSearches; ++i)
+			{
+				checksum += SearchFirstFit(offsets.data(), sizes.data(), chunkCount,
+					4000 + i % 96, 256, chunkCount * 8192, FirstFitSearchLevel(level));
+			}
+
+			double microseconds = timer.ElapsedMilliseconds() * 1000.0 / nrOfSearches;
+			KeepResult(checksum);
+			std::printf("%-8s %12zu %14.2f %16.2f\n", GetLevelName(FirstFitSearchLevel(level)),
+				chunkCount, microseconds, chunkCount / (microseconds * 1000.0));
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <vector>
+#include <random>
+#include <cstdio>
+
+#include "HeapHelper.h"
+#include "IndexedHeapHelper.h"
+
+#include "Benchmarks/BenchmarkHelpers.h"
+
+// Allocates and frees randomized sizes and alignments on a heap holding a
+// fixed number of live chunks, comparing the scanning HeapHelper with the
+// indexed free chunks of IndexedHeapHelper
+
+struct Workload
+{
+	size_t nrOfLiveChunks = 0;
+	size_t nrOfOperations = 0;
+};
+
+struct Request
+{
+	size_t size = 0;
+	size_t alignment = 1;
+	size_t toFree = 0; // Position among the live chunks to free before allocating
+};
+
+std::vector<Request> CreateRequests(size_t nrOfRequests, std::mt19937_64& generator)
+{
+	const size_t alignments[] = { 1, 4, 16, 256 };
+	std::uniform_int_distribution<size_t> sizeDistribution(16, 4096);
+	std::uniform_int_distribution<size_t> alignmentDistribution(0, 3);
+	std::vector<Request> toReturn(nrOfRequests);
+
+	for (Request& request : toReturn)
+	{
+		request.size = sizeDistribution(generator);
+		request.alignment = alignments[alignmentDistribution(generator)];
+		request.toFree = generator();
+	}
+
+	return toReturn;
+}
+
+template<typename Helper, typename Strategy>
+double RunWorkload(const Workload& workload, Strategy strategy,
+	const std::vector<Request>& fillRequests, const std::vector<Request>& requests)
+{
+	Helper helper;
+	helper.Initialize(workload.nrOfLiveChunks * 8192);
+	std::vector<size_t> liveChunks;
+	liveChunks.reserve(workload.nrOfLiveChunks);
+
+	for (const Request& request : fillRequests)
+	{
+		size_t chunkIndex = helper.AllocateChunk(request.size, strategy, request.alignment);
+		if (chunkIndex != size_t(-1))
+			liveChunks.push_back(chunkIndex);
+	}
+
+	BenchmarkTimer timer;
+	size_t checksum = 0;
+
+	for (const Request& request : requests)
+	{
+		size_t position = request.toFree % liveChunks.size();
+		helper.DeallocateChunk(liveChunks[position]);
+		liveChunks[position] = liveChunks.back();
+		liveChunks.pop_back();
+
+		size_t chunkIndex = helper.AllocateChunk(request.size, strategy, request.alignment);
+		if (chunkIndex != size_t(-1))
+		{
+			liveChunks.push_back(chunkIndex);
+			checksum += helper.GetStartOfChunk(chunkIndex);
+		}
+	}
+
+	double elapsed = timer.ElapsedMilliseconds();
+	KeepResult(checksum);
+
+	return elapsed * 1000000.0 / requests.size();
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<Workload> workloads = { { 1000, 20000 }, { 10000, 20000 },
+		{ 30000, 10000 } };
+
+	if (QuickRun(argc, argv))
+		workloads = { { 200, 500 } };
+
+	const char* strategyNames[] = { "FIRST_FIT", "BEST_FIT", "WORST_FIT" };
+	const AllocationStrategy strategies[] = { AllocationStrategy::FIRST_FIT,
+		AllocationStrategy::BEST_FIT, AllocationStrategy::WORST_FIT };
+
+	std::printf("%-10s %12s %18s %18s %10s\n", "strategy", "live chunks",
+		"HeapHelper ns/op", "Indexed ns/op", "speedup");
+
+	for (const Workload& workload : workloads)
+	{
+		std::mt19937_64 generator(workload.nrOfLiveChunks);
+		std::vector<Request> fillRequests = CreateRequests(workload.nrOfLiveChunks, generator);
+		std::vector<Request> requests = CreateRequests(workload.nrOfOperations, generator);
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			double scanning = RunWorkload<HeapHelper<size_t>>(workload,
+				strategies[i], fillRequests, requests);
+			double indexed = RunWorkload<IndexedHeapHelper<size_t>>(workload,
+				strategies[i], fillRequests, requests);
+
+			std::printf("%-10s %12zu %18.1f %18.1f %9.1fx\n", strategyNames[i],
+				workload.nrOfLiveChunks, scanning, indexed, scanning / indexed);
+		}
+
+		// HeapHelper has no TLSF strategy to compare against
+		double tlsf = RunWorkload<IndexedHeapHelper<size_t>>(workload,
+			IndexedAllocationStrategy::TLSF, fillRequests, requests);
+		std::printf("%-10s %12zu %18s %18.1f %10s\n", "TLSF",
+			workload.nrOfLiveChunks, "-", tlsf, "-");
+	}
+
+	return 0;
+}
\ No newline at end of file
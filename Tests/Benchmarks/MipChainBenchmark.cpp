@@ -0,0 +1,224 @@
+#include <vector>
+#include <string>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+
+#include "MipGenerator.h"
+
+#include "Benchmarks/BenchmarkHelpers.h"
+
+// Generates the mip chains of 4K and 8K RGBA8 and 4K RGBA32 float textures on
+// one thread and through a thread pool, next to a plain per channel box filter
+// as the reference path. The chains are then stored in a MipChainCache and
+// loaded back. Loading with other filter settings has to miss.
+
+DecodedTexture CreateTopMip(size_t dimension, DXGI_FORMAT format,
+	std::uint8_t texelSize)
+{
+	DecodedTexture toReturn;
+	toReturn.width = dimension;
+	toReturn.height = dimension;
+	toReturn.texelSizeInBytes = texelSize;
+	toReturn.format = format;
+	toReturn.subresources.resize(1);
+	toReturn.subresources[0].resize(toReturn.GetSubresourceSize(0));
+
+	if (format != DXGI_FORMAT_R32G32B32A32_FLOAT)
+	{
+		for (size_t i = 0; i < toReturn.subresources[0].size(); ++i)
+			toReturn.subresources[0][i] = static_cast<unsigned char>((i * 7) ^ (i >> 11));
+
+		return toReturn;
+	}
+
+	// HDR values well past 1
+	float* values = reinterpret_cast<float*>(toReturn.subresources[0].data());
+	for (size_t i = 0; i < toReturn.subresources[0].size() / sizeof(float); ++i)
+		values[i] = static_cast<float>((i * 7) % 4099) * 0.01f;
+
+	return toReturn;
+}
+
+// Filters each channel on its own with the sRGB conversions done through pow,
+// as a straightforward implementation would
+void GenerateReferenceMipChain(DecodedTexture& texture, bool srgb)
+{
+	bool floats = texture.format == DXGI_FORMAT_R32G32B32A32_FLOAT;
+	size_t channels = 4;
+	size_t channelSize = floats ? sizeof(float) : 1;
+	size_t nrOfMips = MipGenerator::CalculateNrOfMips(texture.width, texture.height);
+	texture.subresources.resize(nrOfMips);
+
+	auto read = [&](size_t mip, size_t x, size_t y, size_t channel)
+	{
+		size_t index = (y * texture.GetSubresourceWidth(mip) + x) * channels + channel;
+		const unsigned char* source = texture.subresources[mip].data();
+
+		if (floats)
+		{
+			float value = 0.0f;
+			std::memcpy(&value, source + index * channelSize, sizeof(float));
+			return value;
+		}
+
+		float value = source[index] / 255.0f;
+		if (!srgb || channel == 3)
+			return value;
+
+		return value <= 0.04045f ? value / 12.92f :
+			std::pow((value + 0.055f) / 1.055f, 2.4f);
+	};
+
+	for (size_t mip = 1; mip < nrOfMips; ++mip)
+	{
+		size_t width = texture.GetSubresourceWidth(mip);
+		size_t height = texture.GetSubresourceHeight(mip);
+		size_t sourceWidth = texture.GetSubresourceWidth(mip - 1);
+		size_t sourceHeight = texture.GetSubresourceHeight(mip - 1);
+		std::vector<unsigned char>& destination = texture.subresources[mip];
+		destination.resize(texture.GetSubresourceSize(mip));
+
+		for (size_t y = 0; y < height; ++y)
+		{
+			for (size_t x = 0; x < width; ++x)
+			{
+				for (size_t channel = 0; channel < channels; ++channel)
+				{
+					size_t right = std::min(2 * x + 1, sourceWidth - 1);
+					size_t bottom = std::min(2 * y + 1, sourceHeight - 1);
+					float average = 0.25f * (read(mip - 1, 2 * x, 2 * y, channel) +
+						read(mip - 1, right, 2 * y, channel) +
+						read(mip - 1, 2 * x, bottom, channel) +
+						read(mip - 1, right, bottom, channel));
+					size_t index = (y * width + x) * channels + channel;
+
+					if (floats)
+					{
+						std::memcpy(destination.data() + index * channelSize, &average,
+							sizeof(float));
+						continue;
+					}
+
+					if (srgb && channel != 3)
+					{
+						average = average <= 0.0031308f ? average * 12.92f :
+							1.055f * std::pow(average, 1.0f / 2.4f) - 0.055f;
+					}
+
+					destination[index] = static_cast<unsigned char>(
+						std::clamp(average, 0.0f, 1.0f) * 255.0f + 0.5f);
+				}
+			}
+		}
+	}
+}
+
+double MeasureGeneration(const MipGenerator& generator, size_t dimension,
+	DXGI_FORMAT format, std::uint8_t texelSize, WorkStealingThreadPool* threadPool,
+	DecodedTexture& generated)
+{
+	MipGenerationSettings settings;
+	settings.threadPool = threadPool;
+	generated = CreateTopMip(dimension, format, texelSize);
+
+	BenchmarkTimer timer;
+	generator.GenerateMipChain(generated, settings);
+	return timer.ElapsedMilliseconds();
+}
+
+double MeasureReference(size_t dimension, DXGI_FORMAT format, std::uint8_t texelSize)
+{
+	DecodedTexture generated = CreateTopMip(dimension, format, texelSize);
+
+	BenchmarkTimer timer;
+	GenerateReferenceMipChain(generated, format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
+	double toReturn = timer.ElapsedMilliseconds();
+	KeepResult(generated.subresources.back()[0]);
+	return toReturn;
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = QuickRun(argc, argv);
+	std::vector<size_t> dimensions = { 4096, 8192 };
+
+	if (quick)
+		dimensions = { 512 };
+
+	std::filesystem::path directory =
+		std::filesystem::temp_directory_path() / "MipChainBenchmark";
+	std::filesystem::path sourcePath = directory / "source.png";
+	std::filesystem::create_directories(directory);
+	std::ofstream(sourcePath) << "source";
+
+	MipChainCache cache;
+	cache.Initialize(directory.string());
+	MipGenerator generator;
+	WorkStealingThreadPool threadPool;
+	threadPool.Initialize(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+	const char* formatNames[] = { "UNORM", "SRGB", "HDR" };
+	const DXGI_FORMAT formats[] = { DXGI_FORMAT_R8G8B8A8_UNORM,
+		DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R32G32B32A32_FLOAT };
+	const std::uint8_t texelSizes[] = { 4, 4, 16 };
+	int result = 0;
+
+	std::printf("threads for parallel generation: %zu\n", threadPool.NrOfThreads());
+	std::printf("%-6s %-6s %12s %12s %12s %12s %12s\n", "size", "format",
+		"reference", "1 thread", "parallel", "cache store", "cache load");
+
+	for (size_t dimension : dimensions)
+	{
+		for (size_t i = 0; i < 3; ++i)
+		{
+			// A 8K float chain would take well over a gigabyte
+			if (texelSizes[i] == 16 && dimension > 4096)
+				continue;
+
+			double referenceTime = MeasureReference(dimension, formats[i], texelSizes[i]);
+			DecodedTexture generated;
+			double singleTime = MeasureGeneration(generator, dimension, formats[i],
+				texelSizes[i], nullptr, generated);
+			double parallelTime = MeasureGeneration(generator, dimension, formats[i],
+				texelSizes[i], &threadPool, generated);
+
+			MipChainCacheKey key = MipChainCache::CreateKey(sourcePath.string(),
+				generated, MipGenerationSettings());
+			BenchmarkTimer timer;
+			bool stored = cache.Store(key, generated);
+			double storeTime = timer.ElapsedMilliseconds();
+
+			DecodedTexture loaded;
+			timer.Restart();
+			bool hit = cache.Load(key, loaded);
+			double loadTime = timer.ElapsedMilliseconds();
+
+			MipChainCacheKey otherKey = key;
+			otherKey.colorDataIsSRGB = true;
+			DecodedTexture missed;
+
+			if (!stored || !hit || loaded.subresources != generated.subresources ||
+				cache.Load(otherKey, missed))
+			{
+				std::printf("Error: mip chain cache did not round trip its key\n");
+				result = 1;
+			}
+
+			std::printf("%-6zu %-6s %9.2f ms %9.2f ms %9.2f ms %9.2f ms %9.2f ms\n",
+				dimension, formatNames[i], referenceTime, singleTime, parallelTime,
+				storeTime, loadTime);
+			KeepResult(loaded.subresources.size());
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include <vector>
+#include <random>
+#include <cstdio>
+
+#include "PagedComponentData.h"
+
+#include "Benchmarks/BenchmarkHelpers.h"
+
+// Adds and removes small buffers the way a buffer category does, then checks
+// that emptied shared pages and the dedicated pages of components larger than
+// a page are freed again
+
+ResourceIndex CreateIndex(size_t descriptorIndex)
+{
+	ResourceIndex toReturn;
+	toReturn.descriptorIndex = descriptorIndex;
+	return toReturn;
+}
+
+int main(int argc, char** argv)
+{
+	size_t nrOfBuffers = QuickRun(argc, argv) ? 5000 : 100000;
+	size_t nrOfLargeBuffers = nrOfBuffers / 100;
+	const size_t PAGE_SIZE = 65536;
+
+	std::mt19937_64 generator(20);
+	std::uniform_int_distribution<size_t> sizeDistribution(16, 256);
+	std::vector<size_t> sizes(nrOfBuffers);
+
+	for (size_t& size : sizes)
+		size = sizeDistribution(generator);
+
+	PagedComponentData data;
+	data.Initialize(PAGE_SIZE, 16);
+	BenchmarkTimer timer;
+
+	for (size_t i = 0; i < nrOfBuffers; ++i)
+		data.AddComponent(CreateIndex(i), sizes[i]);
+
+	double addTime = timer.ElapsedMilliseconds();
+	size_t smallPages = data.NrOfPages();
+	timer.Restart();
+
+	for (size_t i = 0; i < nrOfBuffers; ++i)
+		data.RemoveComponent(CreateIndex(i));
+
+	double removeTime = timer.ElapsedMilliseconds();
+	size_t pagesAfterRemove = data.NrOfPages();
+	timer.Restart();
+
+	// Half of the buffers are replaced by new ones of another size
+	for (size_t i = 0; i < nrOfBuffers; ++i)
+		data.AddComponent(CreateIndex(i), sizes[i]);
+
+	for (size_t i = 0; i < nrOfBuffers; ++i)
+	{
+		size_t descriptorIndex = generator() % nrOfBuffers;
+		data.RemoveComponent(CreateIndex(descriptorIndex));
+		data.AddComponent(CreateIndex(descriptorIndex), sizeDistribution(generator));
+	}
+
+	double churnTime = timer.ElapsedMilliseconds();
+	size_t churnPages = data.NrOfPages();
+	timer.Restart();
+
+	for (size_t i = 0; i < nrOfLargeBuffers; ++i)
+		data.AddComponent(CreateIndex(nrOfBuffers + i), PAGE_SIZE + 16 * (i + 1));
+
+	size_t largePages = data.NrOfPages();
+
+	for (size_t i = 0; i < nrOfLargeBuffers; ++i)
+		data.RemoveComponent(CreateIndex(nrOfBuffers + i));
+
+	double largeTime = timer.ElapsedMilliseconds();
+	size_t pagesAfterLarge = data.NrOfPages();
+
+	std::printf("%zu buffers of 16 to 256 bytes in %zu byte pages\n",
+		nrOfBuffers, PAGE_SIZE);
+	std::printf("add:    %7.1f ns per buffer, %zu pages\n",
+		addTime * 1000000.0 / nrOfBuffers, smallPages);
+	std::printf("remove: %7.1f ns per buffer, %zu pages after\n",
+		removeTime * 1000000.0 / nrOfBuffers, pagesAfterRemove);
+	std::printf("churn:  %7.1f ns per add or remove, %zu pages\n",
+		churnTime * 1000000.0 / (nrOfBuffers * 3), churnPages);
+	std::printf("large:  %7.1f ns per add and remove, %zu pages while added, %zu after\n",
+		largeTime * 1000000.0 / nrOfLargeBuffers, largePages, pagesAfterLarge);
+	KeepResult(data.GetUsedDataSize());
+
+	if (pagesAfterRemove != 1 || largePages != churnPages + nrOfLargeBuffers ||
+		pagesAfterLarge != churnPages)
+	{
+		std::printf("Error: empty pages were not freed with their components\n");
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
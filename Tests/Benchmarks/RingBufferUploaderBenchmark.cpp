@@ -0,0 +1,127 @@
+#include <vector>
+#include <thread>
+#include <barrier>
+#include <cstdio>
+
+#include "RingBufferUploader.h"
+
+#include "Benchmarks/BenchmarkHelpers.h"
+
+// Staging throughput of RingBufferUploader with several threads staging
+// buffer data at once. The device and command list are stubs, so recording
+// only counts the copies and no GPU work is done.
+
+struct StagingResult
+{
+	double milliseconds = 0.0;
+	size_t failedStagings = 0;
+	size_t copiesRequested = 0;
+	size_t copiesIssued = 0;
+};
+
+StagingResult RunStaging(size_t nrOfThreads, size_t uploadSize, size_t uploadsPerFrame,
+	size_t nrOfFrames)
+{
+	constexpr size_t FRAMES_IN_FLIGHT = 3;
+	ID3D12Device device;
+	ID3D12Resource destination;
+	ID3D12GraphicsCommandList commandList;
+	RingBufferUploader uploader;
+	uploader.Initialize(&device, uploadSize * uploadsPerFrame * (FRAMES_IN_FLIGHT + 1),
+		uploadsPerFrame);
+
+	std::vector<unsigned char> source(uploadSize, 1);
+	std::atomic<size_t> failedStagings = 0;
+	std::barrier frameStart(nrOfThreads + 1);
+	std::barrier frameEnd(nrOfThreads + 1);
+	std::vector<std::thread> threads;
+
+	for (size_t threadIndex = 0; threadIndex < nrOfThreads; ++threadIndex)
+	{
+		threads.emplace_back([&, threadIndex]()
+			{
+				for (size_t frame = 0; frame < nrOfFrames; ++frame)
+				{
+					frameStart.arrive_and_wait();
+
+					// Each thread updates its own part of the destination
+					for (size_t i = threadIndex; i < uploadsPerFrame; i += nrOfThreads)
+					{
+						if (!uploader.StageBufferData(&destination, source.data(),
+							i * uploadSize, uploadSize, 256))
+						{
+							++failedStagings;
+						}
+					}
+
+					frameEnd.arrive_and_wait();
+				}
+			});
+	}
+
+	BenchmarkTimer timer;
+
+	for (size_t frame = 0; frame < nrOfFrames; ++frame)
+	{
+		frameStart.arrive_and_wait();
+		frameEnd.arrive_and_wait();
+
+		uploader.RecordPendingCopies(&commandList);
+		uploader.MarkSubmitted(frame);
+
+		if (frame >= FRAMES_IN_FLIGHT)
+			uploader.ReclaimCompleted(frame - FRAMES_IN_FLIGHT);
+	}
+
+	StagingResult toReturn;
+	toReturn.milliseconds = timer.ElapsedMilliseconds();
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	toReturn.failedStagings = failedStagings;
+	toReturn.copiesRequested = uploader.GetNrOfCopiesRequested();
+	toReturn.copiesIssued = uploader.GetNrOfCopiesIssued();
+
+	return toReturn;
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = QuickRun(argc, argv);
+	std::vector<size_t> threadCounts = { 1, 2, 4, 8 };
+	std::vector<size_t> uploadSizes = { 256, 4096, 65536 };
+	size_t bytesPerFrame = 16 * 1024 * 1024;
+	size_t nrOfFrames = 60;
+
+	if (quick)
+	{
+		threadCounts = { 1, 2 };
+		uploadSizes = { 4096 };
+		bytesPerFrame = 1024 * 1024;
+		nrOfFrames = 4;
+	}
+
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	std::printf("%8s %12s %14s %12s %10s %18s\n", "threads", "upload size",
+		"uploads/ms", "GB/s", "failed", "copies req/issued");
+
+	for (size_t uploadSize : uploadSizes)
+	{
+		size_t uploadsPerFrame = bytesPerFrame / uploadSize;
+
+		for (size_t nrOfThreads : threadCounts)
+		{
+			StagingResult result = RunStaging(nrOfThreads, uploadSize,
+				uploadsPerFrame, nrOfFrames);
+			double nrOfUploads = double(uploadsPerFrame * nrOfFrames);
+
+			std::printf("%8zu %12zu %14.0f %12.2f %10zu %10zu/%zu\n", nrOfThreads,
+				uploadSize, nrOfUploads / result.milliseconds,
+				nrOfUploads * uploadSize / (result.milliseconds * 1000000.0),
+				result.failedStagings, result.copiesRequested, result.copiesIssued);
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
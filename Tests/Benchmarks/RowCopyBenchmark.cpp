@@ -0,0 +1,133 @@
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <cstdio>
+
+#include "RowCopy.h"
+#include "WorkStealingThreadPool.h"
+
+#include "Benchmarks/BenchmarkHelpers.h"
+
+// Copies textures from 1K to 8K into upload sized buffers, comparing the plain
+// per row memcpy MemcpyTextureData used to do with CopyRows and
+// CopyRowsParallel. The texel sizes cover R8, RGBA8, RGBA16F and RGBA32F rows.
+// The padded layout gives every destination row 256 extra bytes so the rows can
+// not be merged into a single copy.
+
+constexpr size_t ROW_PADDING = 256;
+
+void CopyRowsMemcpy(const RowCopyInfo& info)
+{
+	unsigned char* destination = static_cast<unsigned char*>(info.destination);
+	const unsigned char* source = static_cast<const unsigned char*>(info.source);
+
+	for (size_t row = 0; row < info.nrOfRows; ++row)
+	{
+		std::memcpy(destination + row * info.destinationPitch,
+			source + row * info.sourcePitch, info.rowSize);
+	}
+}
+
+template<typename CopyFunction>
+double MeasureCopy(const RowCopyInfo& info, size_t nrOfIterations, CopyFunction copy)
+{
+	copy(info);
+
+	BenchmarkTimer timer;
+
+	for (size_t i = 0; i < nrOfIterations; ++i)
+		copy(info);
+
+	return timer.ElapsedMilliseconds() / nrOfIterations;
+}
+
+bool CheckCopy(const RowCopyInfo& info)
+{
+	const unsigned char* destination = static_cast<const unsigned char*>(info.destination);
+	const unsigned char* source = static_cast<const unsigned char*>(info.source);
+
+	for (size_t row = 0; row < info.nrOfRows; ++row)
+	{
+		if (std::memcmp(destination + row * info.destinationPitch,
+			source + row * info.sourcePitch, info.rowSize) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = QuickRun(argc, argv);
+	std::vector<size_t> dimensions = { 1024, 2048, 4096, 8192 };
+	std::vector<size_t> texelSizes = { 1, 4, 8, 16 };
+	size_t nrOfIterations = 5;
+
+	if (quick)
+	{
+		dimensions = { 1024 };
+		texelSizes = { 1, 16 };
+		nrOfIterations = 1;
+	}
+
+	WorkStealingThreadPool threadPool;
+	threadPool.Initialize(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+	const char* layoutNames[] = { "packed", "padded" };
+
+	std::printf("threads for parallel copy: %zu\n", threadPool.NrOfThreads());
+	std::printf("%-6s %-6s %-7s %12s %12s %12s %13s\n", "size", "texel", "layout",
+		"memcpy", "CopyRows", "parallel", "parallel GB/s");
+
+	for (size_t texelSize : texelSizes)
+	{
+		for (size_t dimension : dimensions)
+		{
+			size_t rowSize = dimension * texelSize;
+			std::vector<unsigned char> source(rowSize * dimension);
+			std::vector<unsigned char> destination((rowSize + ROW_PADDING) * dimension);
+
+			for (size_t i = 0; i < source.size(); ++i)
+				source[i] = static_cast<unsigned char>(i * 31 + (i >> 12));
+
+			for (size_t layout = 0; layout < 2; ++layout)
+			{
+				RowCopyInfo info;
+				info.destination = destination.data();
+				info.destinationPitch = rowSize + (layout == 0 ? 0 : ROW_PADDING);
+				info.source = source.data();
+				info.sourcePitch = rowSize;
+				info.rowSize = rowSize;
+				info.nrOfRows = dimension;
+
+				double memcpyTime = MeasureCopy(info, nrOfIterations, CopyRowsMemcpy);
+				double copyRowsTime = MeasureCopy(info, nrOfIterations,
+					[](const RowCopyInfo& toCopy) { CopyRows(toCopy); });
+
+				std::memset(destination.data(), 0, destination.size());
+				double parallelTime = MeasureCopy(info, nrOfIterations,
+					[&threadPool](const RowCopyInfo& toCopy)
+					{
+						CopyRowsParallel(toCopy, threadPool);
+					});
+
+				if (!CheckCopy(info))
+				{
+					std::printf("Error: copied rows do not match the source\n");
+					return 1;
+				}
+
+				double gigabytesPerSecond =
+					(rowSize * dimension) / (parallelTime * 1000000.0);
+				std::printf("%-6zu %-6zu %-7s %9.2f ms %9.2f ms %9.2f ms %13.2f\n",
+					dimension, texelSize, layoutNames[layout], memcpyTime, copyRowsTime,
+					parallelTime, gigabytesPerSecond);
+				KeepResult(destination[destination.size() / 2]);
+			}
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
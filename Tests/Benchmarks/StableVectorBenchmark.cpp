@@ -0,0 +1,86 @@
+#include <vector>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <cstdio>
+
+#include "StableVector.h"
+#include "GenerationalVector.h"
+
+#include "Benchmarks/BenchmarkHelpers.h"
+
+// Expands a vector and fills every slot with explicit index inserts in a
+// shuffled order, the way descriptors are placed at fixed heap indices.
+// StableVector walks its free list for each AddAt, so it is measured on
+// smaller vectors than GenerationalVector.
+
+struct FillResult
+{
+	double expandMilliseconds = 0.0;
+	double fillMilliseconds = 0.0;
+};
+
+template<typename Vector>
+FillResult FillWithExplicitIndices(const std::vector<size_t>& order)
+{
+	FillResult toReturn;
+	Vector vector;
+	BenchmarkTimer timer;
+	vector.Expand(order.size());
+	toReturn.expandMilliseconds = timer.ElapsedMilliseconds();
+
+	timer.Restart();
+	for (size_t index : order)
+		vector.AddAt(index, index);
+	toReturn.fillMilliseconds = timer.ElapsedMilliseconds();
+
+	KeepResult(vector.ActiveSize());
+
+	return toReturn;
+}
+
+std::vector<size_t> CreateOrder(size_t nrOfSlots)
+{
+	std::vector<size_t> toReturn(nrOfSlots);
+	std::iota(toReturn.begin(), toReturn.end(), size_t(0));
+	std::shuffle(toReturn.begin(), toReturn.end(), std::mt19937_64(nrOfSlots));
+
+	return toReturn;
+}
+
+void PrintResult(const char* name, size_t nrOfSlots, const FillResult& result)
+{
+	std::printf("%-20s %10zu %12.2f %12.2f %12.1f\n", name, nrOfSlots,
+		result.expandMilliseconds, result.fillMilliseconds,
+		result.fillMilliseconds * 1000000.0 / nrOfSlots);
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = QuickRun(argc, argv);
+	std::vector<size_t> stableSizes = { 10000, 30000 };
+	std::vector<size_t> generationalSizes = { 10000, 30000, 1000000 };
+
+	if (quick)
+	{
+		stableSizes = { 1000 };
+		generationalSizes = { 1000 };
+	}
+
+	std::printf("%-20s %10s %12s %12s %12s\n", "vector", "slots", "expand ms",
+		"fill ms", "ns per AddAt");
+
+	for (size_t nrOfSlots : stableSizes)
+	{
+		PrintResult("StableVector", nrOfSlots,
+			FillWithExplicitIndices<StableVector<size_t>>(CreateOrder(nrOfSlots)));
+	}
+
+	for (size_t nrOfSlots : generationalSizes)
+	{
+		PrintResult("GenerationalVector", nrOfSlots,
+			FillWithExplicitIndices<GenerationalVector<size_t>>(CreateOrder(nrOfSlots)));
+	}
+
+	return 0;
+}
\ No newline at end of file
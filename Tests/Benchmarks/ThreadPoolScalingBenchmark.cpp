@@ -0,0 +1,122 @@
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <algorithm>
+
+#include "JobBatches.h"
+#include "WorkStealingThreadPool.h"
+
+#include "Benchmarks/BenchmarkHelpers.h"
+
+// Measures how preparing a frame of synthetic render jobs scales with the
+// number of worker threads. As in RenderQueue::PrepareFrame, CreateJobBatches
+// splits the jobs into a few batches per thread of roughly equal cost. Their
+// costs are uneven so that threads finishing early have to steal.
+
+struct SyntheticJob
+{
+	size_t iterations = 0;
+	std::uint64_t result = 0;
+};
+
+void PrepareJob(SyntheticJob& job)
+{
+	std::uint64_t value = job.iterations;
+
+	for (size_t i = 0; i < job.iterations; ++i)
+		value = value * 6364136223846793005ull + 1442695040888963407ull;
+
+	job.result = value;
+}
+
+double RunFrames(std::vector<SyntheticJob>& jobs, size_t nrOfWorkerThreads,
+	size_t batchesPerThread, size_t nrOfFrames)
+{
+	WorkStealingThreadPool pool;
+	pool.Initialize(nrOfWorkerThreads);
+	std::vector<JobBatch> batches;
+	CreateJobBatches(jobs.size(), pool.NrOfThreads() * batchesPerThread,
+		[&](size_t jobIndex) { return jobs[jobIndex].iterations; }, batches);
+
+	BenchmarkTimer timer;
+
+	for (size_t frame = 0; frame < nrOfFrames; ++frame)
+	{
+		pool.ParallelFor(batches.size(), [&](size_t batchIndex)
+			{
+				const JobBatch& batch = batches[batchIndex];
+				for (size_t i = 0; i < batch.nrOfJobs; ++i)
+					PrepareJob(jobs[batch.startJobIndex + i]);
+			});
+	}
+
+	return timer.ElapsedMilliseconds() / nrOfFrames;
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = QuickRun(argc, argv);
+	size_t nrOfJobs = 256;
+	size_t nrOfFrames = 50;
+	size_t maxIterations = 40000;
+
+	if (quick)
+	{
+		nrOfFrames = 2;
+		maxIterations = 2000;
+	}
+
+	// A few expensive jobs among many cheap ones
+	std::mt19937_64 generator(24);
+	std::vector<SyntheticJob> jobs(nrOfJobs);
+	for (SyntheticJob& job : jobs)
+	{
+		job.iterations = generator() % 8 == 0 ?
+			maxIterations : 1 + generator() % (maxIterations / 10);
+	}
+
+	size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	std::vector<size_t> workerCounts = { 0, 1, 3, 7 };
+	if (hardwareThreads > 8)
+		workerCounts.push_back(hardwareThreads - 1);
+
+	std::vector<std::uint64_t> expected(nrOfJobs);
+	RunFrames(jobs, 0, 1, 1);
+	for (size_t i = 0; i < nrOfJobs; ++i)
+		expected[i] = jobs[i].result;
+
+	std::printf("%zu jobs, %zu hardware threads\n", nrOfJobs, hardwareThreads);
+	std::printf("%8s %17s %12s %10s\n", "threads", "batches/thread", "frame", "speedup");
+
+	double singleThreaded = 0.0;
+	for (size_t nrOfWorkerThreads : workerCounts)
+	{
+		for (size_t batchesPerThread : { size_t(1), size_t(4) })
+		{
+			for (SyntheticJob& job : jobs)
+				job.result = 0;
+
+			double elapsed = RunFrames(jobs, nrOfWorkerThreads, batchesPerThread,
+				nrOfFrames);
+			if (nrOfWorkerThreads == 0 && batchesPerThread == 1)
+				singleThreaded = elapsed;
+
+			for (size_t i = 0; i < nrOfJobs; ++i)
+			{
+				if (jobs[i].result != expected[i])
+				{
+					std::printf("job %zu was not prepared\n", i);
+					return 1;
+				}
+			}
+
+			std::printf("%8zu %17zu %9.3f ms %9.2fx\n", nrOfWorkerThreads + 1,
+				batchesPerThread, elapsed, singleThreaded / elapsed);
+			KeepResult(static_cast<size_t>(jobs.front().result));
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <vector>
+#include <utility>
+
+#include "AllocatorStatistics.h"
+#include "CountingHeapAllocatorGPU.h"
+#include "HeapHelper.h"
+
+#include "TestFramework.h"
+
+// Hands out consecutive ranges of a single fake heap and reports what it has
+// handed out, like the allocators in the library that keep no counters
+class FakeHeapAllocator : public HeapAllocatorGPU
+{
+private:
+	size_t nextOffset = 0;
+	size_t bytesUsed = 0;
+	size_t nrOfAllocations = 0;
+
+public:
+	FakeHeapAllocator() = default;
+	virtual ~FakeHeapAllocator() = default;
+	FakeHeapAllocator(const FakeHeapAllocator& other) = delete;
+	FakeHeapAllocator& operator=(const FakeHeapAllocator& other) = delete;
+	FakeHeapAllocator(FakeHeapAllocator&& other) = default;
+	FakeHeapAllocator& operator=(FakeHeapAllocator&& other) = default;
+
+	HeapChunk AllocateChunk(size_t minimumRequiredSize, D3D12_HEAP_TYPE requiredType,
+		D3D12_HEAP_FLAGS requiredFlags) override
+	{
+		HeapChunk toReturn;
+		toReturn.heapType = requiredType;
+		toReturn.heapFlags = requiredFlags;
+		toReturn.startOffset = nextOffset;
+		toReturn.endOffset = nextOffset + minimumRequiredSize;
+		nextOffset = toReturn.endOffset;
+		bytesUsed += minimumRequiredSize;
+		++nrOfAllocations;
+
+		return toReturn;
+	}
+
+	void DeallocateChunk(HeapChunk& chunk) override
+	{
+		bytesUsed -= chunk.endOffset - chunk.startOffset;
+		--nrOfAllocations;
+		chunk = HeapChunk();
+	}
+
+	AllocatorStatistics GetStatistics() const
+	{
+		AllocatorStatistics toReturn;
+		toReturn.bytesReserved = nextOffset;
+		toReturn.bytesUsed = bytesUsed;
+		toReturn.nrOfAllocations = nrOfAllocations;
+
+		return toReturn;
+	}
+};
+
+TEST_CASE(AccumulateSumsAndKeepsLargestBlock)
+{
+	AllocatorStatistics first;
+	first.bytesReserved = 1000;
+	first.bytesUsed = 400;
+	first.largestFreeBlock = 300;
+	first.nrOfHeapChunks = 1;
+	first.nrOfAllocations = 4;
+	first.nrOfFreeBlocks = 2;
+	first.totalAllocations = 10;
+	first.totalDeallocations = 6;
+	first.bytesUsedHighWaterMark = 500;
+
+	AllocatorStatistics second = first;
+	second.largestFreeBlock = 100;
+	second.countersSinceReset = true;
+
+	AllocatorStatistics total;
+	total.Accumulate(first);
+	total.Accumulate(second);
+
+	CHECK(total.bytesReserved == 2000);
+	CHECK(total.bytesUsed == 800);
+	CHECK(total.largestFreeBlock == 300);
+	CHECK(total.nrOfHeapChunks == 2);
+	CHECK(total.nrOfAllocations == 8);
+	CHECK(total.nrOfFreeBlocks == 4);
+	CHECK(total.totalAllocations == 20);
+	CHECK(total.totalDeallocations == 12);
+	CHECK(total.bytesUsedHighWaterMark == 1000);
+	CHECK(total.countersSinceReset);
+}
+
+TEST_CASE(FragmentationOfFreeMemory)
+{
+	AllocatorStatistics statistics;
+	statistics.bytesReserved = 1000;
+	statistics.bytesUsed = 1000;
+	CHECK(statistics.GetFragmentation() == 0.0);
+
+	statistics.bytesUsed = 600;
+	statistics.largestFreeBlock = 400;
+	CHECK(statistics.GetFragmentation() == 0.0);
+
+	statistics.largestFreeBlock = 100;
+	CHECK(statistics.GetFragmentation() == 0.75);
+}
+
+TEST_CASE(AllocatedRangesGiveGapsAsFreeBlocks)
+{
+	// Unsorted, with gaps before, between and after the allocations
+	std::vector<std::pair<size_t, size_t>> ranges = { { 500, 100 }, { 100, 200 },
+		{ 300, 50 } };
+	AllocatorStatistics statistics;
+	AccumulateAllocatedRanges(ranges, 1000, statistics);
+
+	CHECK(statistics.bytesReserved == 1000);
+	CHECK(statistics.bytesUsed == 350);
+	CHECK(statistics.nrOfAllocations == 3);
+	CHECK(statistics.nrOfHeapChunks == 1);
+	CHECK(statistics.nrOfFreeBlocks == 3); // [0, 100), [350, 500), [600, 1000)
+	CHECK(statistics.largestFreeBlock == 400);
+
+	// A full heap adds no free blocks, an empty one is a single block
+	ranges = { { 0, 64 } };
+	AccumulateAllocatedRanges(ranges, 64, statistics);
+	ranges.clear();
+	AccumulateAllocatedRanges(ranges, 2000, statistics);
+
+	CHECK(statistics.bytesReserved == 3064);
+	CHECK(statistics.bytesUsed == 414);
+	CHECK(statistics.nrOfHeapChunks == 3);
+	CHECK(statistics.nrOfFreeBlocks == 4);
+	CHECK(statistics.largestFreeBlock == 2000);
+}
+
+TEST_CASE(TrackerKeepsPeaksAndCumulativeCounters)
+{
+	AllocatorStatisticsTracker tracker;
+	AllocatorStatistics sample;
+	sample.bytesReserved = 1000;
+	sample.bytesUsed = 300;
+	sample.nrOfAllocations = 3;
+	sample.totalAllocations = 5;
+	sample.totalDeallocations = 2;
+	tracker.Sample(sample);
+
+	sample.bytesReserved = 800;
+	sample.bytesUsed = 100;
+	sample.bytesUsedHighWaterMark = 700;
+	sample.nrOfAllocations = 1;
+	sample.totalAllocations = 6;
+	sample.totalDeallocations = 5;
+	tracker.Sample(sample);
+
+	CHECK(tracker.GetNrOfSamples() == 2);
+	CHECK(tracker.GetPeakBytesReserved() == 1000);
+	CHECK(tracker.GetPeakBytesUsed() == 700);
+	CHECK(tracker.GetPeakNrOfAllocations() == 3);
+
+	// Counters that are not reset are already totals
+	CHECK(tracker.GetTotalAllocations() == 6);
+	CHECK(tracker.GetTotalDeallocations() == 5);
+	CHECK(tracker.GetLatest().bytesUsed == 100);
+
+	tracker.Reset();
+	CHECK(tracker.GetNrOfSamples() == 0);
+	CHECK(tracker.GetPeakBytesUsed() == 0);
+}
+
+TEST_CASE(TrackerSumsCountersSinceReset)
+{
+	AllocatorStatisticsTracker tracker;
+	AllocatorStatistics sample;
+	sample.countersSinceReset = true;
+	sample.nrOfAllocations = 4;
+	sample.totalAllocations = 4;
+	tracker.Sample(sample);
+
+	// The reset between the samples freed the 4 allocations of the first
+	sample.nrOfAllocations = 2;
+	sample.totalAllocations = 3;
+	sample.totalDeallocations = 1;
+	tracker.Sample(sample);
+
+	CHECK(tracker.GetTotalAllocations() == 7);
+	CHECK(tracker.GetTotalDeallocations() == 5);
+	CHECK(tracker.GetPeakNrOfAllocations() == 4);
+}
+
+TEST_CASE(CountingAllocatorCountsAndKeepsPeak)
+{
+	CountingHeapAllocatorGPU<FakeHeapAllocator> allocator;
+	HeapChunk first = allocator.AllocateChunk(100, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	HeapChunk second = allocator.AllocateChunk(300, D3D12_HEAP_TYPE_UPLOAD,
+		D3D12_HEAP_FLAG_NONE);
+
+	CHECK(second.startOffset == 100);
+	CHECK(second.heapType == D3D12_HEAP_TYPE_UPLOAD);
+
+	allocator.DeallocateChunk(first);
+	HeapChunk third = allocator.AllocateChunk(50, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+
+	// The wrapped allocator's own numbers are kept, the counters are added
+	AllocatorStatistics statistics = allocator.GetStatistics();
+	CHECK(statistics.bytesReserved == 450);
+	CHECK(statistics.bytesUsed == 350);
+	CHECK(statistics.nrOfAllocations == 2);
+	CHECK(statistics.totalAllocations == 3);
+	CHECK(statistics.totalDeallocations == 1);
+	CHECK(statistics.bytesUsedHighWaterMark == 400);
+
+	allocator.DeallocateChunk(second);
+	allocator.DeallocateChunk(third);
+	statistics = allocator.GetStatistics();
+	CHECK(statistics.bytesUsed == 0);
+	CHECK(statistics.totalDeallocations == 3);
+	CHECK(statistics.bytesUsedHighWaterMark == 400);
+}
+
+TEST_CASE(HeapHelperKeepsAllocatedChunkSizes)
+{
+	// The texture and buffer allocator statistics read these back
+	HeapHelper<int> helper;
+	helper.Initialize(4096);
+	size_t first = helper.AllocateChunk(100, AllocationStrategy::FIRST_FIT, 1);
+	size_t second = helper.AllocateChunk(1000, AllocationStrategy::FIRST_FIT, 256);
+
+	CHECK(helper.GetStartOfChunk(second) == 256);
+	CHECK(helper.GetSizeOfChunk(first) == 100);
+	CHECK(helper.GetSizeOfChunk(second) == 1000);
+
+	std::vector<std::pair<size_t, size_t>> ranges;
+	for (size_t i = 0; i < helper.GetCurrentMaxIndex(); ++i)
+	{
+		if (helper.ChunkActive(i))
+			ranges.push_back({ helper.GetStartOfChunk(i), helper.GetSizeOfChunk(i) });
+	}
+
+	AllocatorStatistics statistics;
+	AccumulateAllocatedRanges(ranges, helper.TotalSize(), statistics);
+	CHECK(statistics.bytesUsed == 1100);
+	CHECK(statistics.nrOfFreeBlocks == 2);
+	CHECK(statistics.largestFreeBlock == 4096 - 1256);
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <utility>
+
+#include "CompactionPlanner.h"
+
+#include "TestFramework.h"
+
+typedef CompactionPlanner<size_t> Planner;
+
+std::vector<Planner::Allocation> CreateAllocations(
+	const std::vector<std::pair<size_t, size_t>>& ranges, size_t firstIdentifier,
+	size_t alignment = 1)
+{
+	std::vector<Planner::Allocation> toReturn;
+
+	for (const auto& range : ranges)
+		toReturn.push_back({ firstIdentifier++, range.first, range.second, alignment });
+
+	return toReturn;
+}
+
+TEST_CASE(PlanEvacuatesLightlyUsedHeap)
+{
+	Planner planner;
+	planner.AddHeap(1000, CreateAllocations({ { 0, 400 } }, 0));
+	planner.AddHeap(1000, CreateAllocations({ { 500, 100 } }, 1));
+	planner.Plan();
+
+	CHECK(planner.GetEvacuatedHeaps() == std::vector<size_t>{ 1 });
+	CHECK(planner.GetMoves().size() == 1);
+
+	const Planner::Move& move = planner.GetMoves().front();
+	CHECK(move.identifier == 1);
+	CHECK(move.sourceHeap == 1);
+	CHECK(move.sourceOffset == 500);
+	CHECK(move.destinationHeap == 0);
+	CHECK(move.destinationOffset == 400);
+	CHECK(move.size == 100);
+	CHECK(planner.GetBytesToMove() == 100);
+}
+
+TEST_CASE(PlanKeepsHeapsThatDoNotFitElsewhere)
+{
+	// One of the two allocations fits, but moving only it frees nothing
+	Planner planner;
+	planner.AddHeap(1000, CreateAllocations({ { 0, 900 } }, 0));
+	planner.AddHeap(1000, CreateAllocations({ { 0, 50 }, { 100, 200 } }, 1));
+	planner.Plan();
+
+	CHECK(planner.GetEvacuatedHeaps().empty());
+	CHECK(planner.GetMoves().empty());
+	CHECK(planner.Finished());
+}
+
+TEST_CASE(PlanReleasesEmptyHeapsWithoutMoves)
+{
+	Planner planner;
+	planner.AddHeap(1000, CreateAllocations({ { 0, 10 } }, 0));
+	planner.AddHeap(1000, {});
+	planner.Plan();
+
+	CHECK(planner.HeapReleasable(1));
+	CHECK(!planner.HeapReleasable(0));
+}
+
+TEST_CASE(PlanRespectsAlignment)
+{
+	Planner planner;
+	planner.AddHeap(4096, CreateAllocations({ { 0, 100 } }, 0));
+	planner.AddHeap(4096, CreateAllocations({ { 256, 64 } }, 1, 256));
+	planner.Plan();
+
+	CHECK(planner.GetMoves().size() == 1);
+	CHECK(planner.GetMoves().front().destinationOffset == 256);
+}
+
+TEST_CASE(PlanRejectsOverlappingAllocations)
+{
+	Planner planner;
+	CHECK_THROWS(planner.AddHeap(1000, CreateAllocations({ { 0, 100 }, { 50, 100 } }, 0)));
+	CHECK_THROWS(planner.AddHeap(1000, CreateAllocations({ { 950, 100 } }, 0)));
+}
+
+TEST_CASE(MovesNeverOverlap)
+{
+	std::mt19937_64 generator(3);
+
+	for (size_t round = 0; round < 50; ++round)
+	{
+		Planner planner;
+		std::vector<std::vector<std::pair<size_t, size_t>>> occupied(8);
+		size_t identifier = 0;
+
+		for (size_t heap = 0; heap < 8; ++heap)
+		{
+			std::vector<std::pair<size_t, size_t>> ranges;
+			size_t offset = 0;
+
+			while (generator() % 4 != 0)
+			{
+				offset += generator() % 512;
+				size_t size = 16 + generator() % 1024;
+
+				if (offset + size > 16384)
+					break;
+
+				ranges.push_back({ offset, size });
+				offset += size;
+			}
+
+			occupied[heap] = ranges;
+			planner.AddHeap(16384, CreateAllocations(ranges, identifier));
+			identifier += ranges.size();
+		}
+
+		planner.Plan();
+
+		for (const Planner::Move& move : planner.GetMoves())
+		{
+			std::vector<std::pair<size_t, size_t>>& destination =
+				occupied[move.destinationHeap];
+
+			for (const auto& range : destination)
+			{
+				CHECK(move.destinationOffset + move.size <= range.first ||
+					range.first + range.second <= move.destinationOffset);
+			}
+
+			CHECK(move.destinationOffset + move.size <= 16384);
+			destination.push_back({ move.destinationOffset, move.size });
+		}
+
+		// Evacuated heaps never receive data
+		for (size_t heap : planner.GetEvacuatedHeaps())
+		{
+			for (const Planner::Move& move : planner.GetMoves())
+				CHECK(move.destinationHeap != heap);
+		}
+	}
+}
+
+TEST_CASE(GetNextMovesKeepsToByteBudget)
+{
+	Planner planner;
+	planner.AddHeap(10000, CreateAllocations({ { 0, 1000 } }, 0));
+	planner.AddHeap(10000, CreateAllocations({ { 0, 300 }, { 1000, 200 } }, 1));
+	planner.AddHeap(10000, CreateAllocations({ { 0, 400 }, { 2000, 500 } }, 3));
+	planner.Plan();
+
+	CHECK(planner.GetEvacuatedHeaps().size() == 2);
+
+	size_t bytesToMove = 0;
+	for (const Planner::Move& move : planner.GetMoves())
+		bytesToMove += move.size;
+	CHECK(planner.GetBytesToMove() == bytesToMove);
+
+	// A budget below the first move still makes progress
+	std::vector<Planner::Move> issued;
+	CHECK(planner.GetNextMoves(1, issued) == planner.GetMoves()[0].size);
+	CHECK(issued.size() == 1);
+
+	size_t firstEvacuated = planner.GetEvacuatedHeaps()[0];
+	size_t secondEvacuated = planner.GetEvacuatedHeaps()[1];
+	CHECK(!planner.HeapReleasable(firstEvacuated));
+
+	// Only a single move may go over the budget
+	while (!planner.Finished())
+	{
+		issued.clear();
+		size_t issuedBytes = planner.GetNextMoves(700, issued);
+		CHECK(!issued.empty());
+		CHECK(issuedBytes <= 700 || issued.size() == 1);
+	}
+
+	CHECK(planner.HeapReleasable(firstEvacuated));
+	CHECK(planner.HeapReleasable(secondEvacuated));
+	CHECK(planner.GetBytesToMove() == 0);
+	CHECK(planner.GetNextMoves(700, issued) == 0);
+}
+
+TEST_CASE(HeapReleasableOnlyAfterItsMoves)
+{
+	Planner planner;
+	planner.AddHeap(10000, CreateAllocations({ { 0, 5000 } }, 0));
+	planner.AddHeap(10000, CreateAllocations({ { 0, 100 } }, 1));
+	planner.AddHeap(10000, CreateAllocations({ { 0, 200 }, { 500, 200 } }, 2));
+	planner.Plan();
+
+	const std::vector<size_t>& evacuated = planner.GetEvacuatedHeaps();
+	CHECK(evacuated.size() == 2);
+	std::vector<Planner::Move> issued;
+
+	// Moves are issued heap by heap, in the order the heaps were evacuated
+	while (!planner.Finished())
+	{
+		planner.GetNextMoves(1, issued);
+
+		for (size_t heap : evacuated)
+		{
+			bool allIssued = true;
+
+			for (const Planner::Move& move : planner.GetMoves())
+			{
+				if (move.sourceHeap == heap)
+				{
+					allIssued &= std::any_of(issued.begin(), issued.end(),
+						[&](const Planner::Move& issuedMove)
+						{
+							return issuedMove.identifier == move.identifier;
+						});
+				}
+			}
+
+			CHECK(planner.HeapReleasable(heap) == allIssued);
+		}
+	}
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
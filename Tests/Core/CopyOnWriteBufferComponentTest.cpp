@@ -0,0 +1,265 @@
+#include <vector>
+#include <cstring>
+
+#include "CopyOnWriteBufferComponent.h"
+#include "FakeBufferComponent.h"
+
+#include "TestFramework.h"
+
+const FrameType FRAMES = 3;
+const size_t BUFFER_SIZE = 1 << 16;
+const size_t PAGE_SIZE = 256;
+
+// Byte sized elements, so element counts are sizes
+void InitializeComponent(CopyOnWriteBufferComponent<FRAMES>& component,
+	bool shareResources)
+{
+	ReleaseFakeBufferComponents();
+	fakeBuffersShareResources = shareResources;
+	fakeBytesUploaded = 0;
+
+	BufferComponentInfo info;
+	info.bufferInfo.alignment = 1;
+	info.bufferInfo.elementSize = 1;
+	info.mappedResource = false;
+	component.Initialize(nullptr, info, {}, PAGE_SIZE);
+}
+
+std::vector<unsigned char> CreateData(size_t size, unsigned char seed)
+{
+	std::vector<unsigned char> toReturn(size);
+	for (size_t i = 0; i < size; ++i)
+		toReturn[i] = static_cast<unsigned char>(seed + i * 13);
+
+	return toReturn;
+}
+
+// Records the barriers and copies of one frame's updates on a fresh list
+ID3D12GraphicsCommandList* PerformUpdates(CopyOnWriteBufferComponent<FRAMES>& component)
+{
+	static ID3D12GraphicsCommandList list;
+	list.bufferCopies = 0;
+	list.bytesCopied = 0;
+	list.barriers = 0;
+
+	ResourceUploader uploader;
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	component.PrepareResourcesForUpdates(barriers);
+	component.PerformUpdates(&list, uploader);
+
+	return &list;
+}
+
+bool ContentsEqual(CopyOnWriteBufferComponent<FRAMES>& component,
+	const ResourceIndex& index, const std::vector<unsigned char>& expected)
+{
+	BufferHandle handle = component.GetBufferHandle(index);
+	return std::memcmp(handle.resource->memory + handle.startOffset, expected.data(),
+		expected.size()) == 0;
+}
+
+TEST_CASE(RangedWritesCopyTheOldVersionOnTheGPU)
+{
+	CopyOnWriteBufferComponent<FRAMES> component;
+	InitializeComponent(component, false);
+
+	ResourceIndex index = component.CreateBuffer(BUFFER_SIZE);
+	std::vector<unsigned char> expected = CreateData(BUFFER_SIZE, 1);
+	component.SetUpdateData(index, expected.data());
+
+	ResourceUploader uploader;
+	ID3D12GraphicsCommandList list;
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	component.PrepareResourcesForUpdates(barriers);
+	component.PerformUpdates(&list, uploader);
+	CHECK(fakeBytesUploaded == BUFFER_SIZE);
+	CHECK(list.bufferCopies == 0);
+	component.SwapFrame();
+
+	// A small write uploads the page it touches, the rest is copied
+	std::vector<unsigned char> written = CreateData(16, 2);
+	component.SetUpdateDataRange(index, written.data(), 1000, written.size());
+	std::memcpy(expected.data() + 1000, written.data(), written.size());
+
+	fakeBytesUploaded = 0;
+	list.barriers = 0;
+	component.PrepareResourcesForUpdates(barriers);
+	component.PerformUpdates(&list, uploader);
+	CHECK(fakeBytesUploaded == PAGE_SIZE);
+	CHECK(list.bufferCopies == 1);
+	CHECK(list.bytesCopied == BUFFER_SIZE);
+	CHECK(list.barriers == 2);
+	CHECK(ContentsEqual(component, index, expected));
+}
+
+TEST_CASE(WritesBetweenUpdatesShareAVersion)
+{
+	CopyOnWriteBufferComponent<FRAMES> component;
+	InitializeComponent(component, false);
+
+	ResourceIndex index = component.CreateBuffer(BUFFER_SIZE);
+	std::vector<unsigned char> expected = CreateData(BUFFER_SIZE, 3);
+	component.SetUpdateData(index, expected.data());
+	PerformUpdates(component);
+	component.SwapFrame();
+
+	for (size_t offset : { 0, 5000, 60000 })
+	{
+		std::vector<unsigned char> written = CreateData(100,
+			static_cast<unsigned char>(offset));
+		component.SetUpdateDataRange(index, written.data(), offset, written.size());
+		std::memcpy(expected.data() + offset, written.data(), written.size());
+	}
+
+	CHECK(component.NrOfRetiredVersions() == 1);
+	ID3D12GraphicsCommandList* list = PerformUpdates(component);
+	CHECK(list->bufferCopies == 1);
+	CHECK(ContentsEqual(component, index, expected));
+
+	// Once updated, the next write makes another version
+	component.SetUpdateDataRange(index, expected.data(), 0, 1);
+	CHECK(component.NrOfRetiredVersions() == 2);
+}
+
+TEST_CASE(VersionsRetireAfterEveryFrameHasSwapped)
+{
+	CopyOnWriteBufferComponent<FRAMES> component;
+	InitializeComponent(component, false);
+
+	ResourceIndex index = component.CreateBuffer(BUFFER_SIZE);
+	std::vector<unsigned char> original = CreateData(BUFFER_SIZE, 4);
+	component.SetUpdateData(index, original.data());
+	PerformUpdates(component);
+	component.SwapFrame();
+
+	BufferHandle oldHandle = component.GetBufferHandle(index);
+	size_t oldDescriptorIndex = component.GetResourceIndex(index).descriptorIndex;
+	std::vector<unsigned char> written = CreateData(BUFFER_SIZE, 5);
+	component.SetUpdateData(index, written.data());
+	PerformUpdates(component);
+
+	// The descriptor index follows the new version, the old one is untouched
+	// for the frames still reading it
+	CHECK(component.GetResourceIndex(index).descriptorIndex != oldDescriptorIndex);
+	CHECK(ContentsEqual(component, index, written));
+	CHECK(std::memcmp(oldHandle.resource->memory + oldHandle.startOffset,
+		original.data(), BUFFER_SIZE) == 0);
+
+	const BufferComponent& frameCopy = *fakeBufferComponents.begin()->first;
+	CHECK(NrOfLiveFakeBuffers(frameCopy) == 2);
+
+	for (FrameType i = 1; i < FRAMES; ++i)
+	{
+		component.SwapFrame();
+		CHECK(component.NrOfRetiredVersions() == 1);
+		CHECK(NrOfLiveFakeBuffers(frameCopy) == 2);
+		CHECK(std::memcmp(oldHandle.resource->memory + oldHandle.startOffset,
+			original.data(), BUFFER_SIZE) == 0);
+	}
+
+	component.SwapFrame();
+	CHECK(component.NrOfRetiredVersions() == 0);
+	CHECK(NrOfLiveFakeBuffers(frameCopy) == 1);
+
+	// Removal retires the current version the same way
+	component.RemoveComponent(index);
+	for (FrameType i = 1; i < FRAMES; ++i)
+		component.SwapFrame();
+
+	CHECK(NrOfLiveFakeBuffers(frameCopy) == 1);
+	component.SwapFrame();
+	CHECK(NrOfLiveFakeBuffers(frameCopy) == 0);
+}
+
+TEST_CASE(EmptyRangesStillCarryOver)
+{
+	CopyOnWriteBufferComponent<FRAMES> component;
+	InitializeComponent(component, false);
+
+	ResourceIndex index = component.CreateBuffer(BUFFER_SIZE);
+	std::vector<unsigned char> expected = CreateData(BUFFER_SIZE, 6);
+	component.SetUpdateData(index, expected.data());
+	PerformUpdates(component);
+	component.SwapFrame();
+
+	// Nothing is dirty, but the copy needs the destination state
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	component.ChangeToState(barriers, D3D12_RESOURCE_STATE_COMMON);
+	component.SetUpdateDataRange(index, expected.data(), 0, 0);
+	barriers.clear();
+	component.PrepareResourcesForUpdates(barriers);
+	CHECK(!barriers.empty());
+	CHECK(component.GetCurrentState() == D3D12_RESOURCE_STATE_COPY_DEST);
+
+	ID3D12GraphicsCommandList* list = PerformUpdates(component);
+	CHECK(list->bufferCopies == 1);
+	CHECK(ContentsEqual(component, index, expected));
+}
+
+TEST_CASE(VersionsInOneResourceUploadEverything)
+{
+	// A copy within one resource would need it in two states at once
+	CopyOnWriteBufferComponent<FRAMES> component;
+	InitializeComponent(component, true);
+
+	ResourceIndex index = component.CreateBuffer(BUFFER_SIZE);
+	std::vector<unsigned char> expected = CreateData(BUFFER_SIZE, 7);
+	component.SetUpdateData(index, expected.data());
+	PerformUpdates(component);
+	component.SwapFrame();
+
+	std::vector<unsigned char> written = CreateData(8, 8);
+	component.SetUpdateDataRange(index, written.data(), 300, written.size());
+	std::memcpy(expected.data() + 300, written.data(), written.size());
+
+	fakeBytesUploaded = 0;
+	ResourceUploader uploader;
+	ID3D12GraphicsCommandList list;
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	component.PrepareResourcesForUpdates(barriers);
+	component.PerformUpdates(&list, uploader);
+	CHECK(list.bufferCopies == 0);
+	CHECK(fakeBytesUploaded == BUFFER_SIZE);
+	CHECK(ContentsEqual(component, index, expected));
+}
+
+TEST_CASE(ManyBuffersKeepTheirContents)
+{
+	CopyOnWriteBufferComponent<FRAMES> component;
+	InitializeComponent(component, false);
+
+	std::vector<ResourceIndex> indices;
+	std::vector<std::vector<unsigned char>> expected;
+	for (size_t i = 0; i < 8; ++i)
+	{
+		indices.push_back(component.CreateBuffer(1000 + i * 100));
+		expected.push_back(CreateData(1000 + i * 100, static_cast<unsigned char>(i)));
+		component.SetUpdateData(indices.back(), expected.back().data());
+	}
+
+	for (size_t frame = 0; frame < 20; ++frame)
+	{
+		PerformUpdates(component);
+		component.SwapFrame();
+
+		for (size_t i = frame % 3; i < indices.size(); i += 3)
+		{
+			size_t offset = (frame * 37 + i * 11) % 900;
+			std::vector<unsigned char> written = CreateData(50, static_cast<unsigned char>(frame));
+			component.SetUpdateDataRange(indices[i], written.data(), offset,
+				written.size());
+			std::memcpy(expected[i].data() + offset, written.data(), written.size());
+		}
+	}
+
+	PerformUpdates(component);
+	for (size_t i = 0; i < indices.size(); ++i)
+		CHECK(ContentsEqual(component, indices[i], expected[i]));
+}
+
+int main()
+{
+	int toReturn = RunTests();
+	ReleaseFakeBufferComponents();
+	return toReturn;
+}
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include <vector>
+#include <random>
+#include <stdexcept>
+
+#include "ComponentData.h"
+
+#include "TestFramework.h"
+
+struct DirtyRange
+{
+	size_t descriptorIndex = 0;
+	size_t offset = 0;
+	size_t size = 0;
+
+	bool operator==(const DirtyRange& other) const = default;
+};
+
+ResourceIndex CreateIndex(size_t descriptorIndex)
+{
+	ResourceIndex toReturn;
+	toReturn.descriptorIndex = descriptorIndex;
+	return toReturn;
+}
+
+std::vector<DirtyRange> Consume(DirtyPageTracker& tracker)
+{
+	std::vector<DirtyRange> toReturn;
+	tracker.ConsumeDirtyRanges([&](const ResourceIndex& resourceIndex, size_t offset,
+		size_t size)
+		{
+			toReturn.push_back({ resourceIndex.descriptorIndex, offset, size });
+		});
+
+	return toReturn;
+}
+
+TEST_CASE(PageSizeMustBeAPowerOfTwo)
+{
+	DirtyPageTracker tracker;
+	CHECK_THROWS(tracker.Initialize(0));
+	CHECK_THROWS(tracker.Initialize(100));
+	CHECK_THROWS(tracker.Initialize(257));
+
+	tracker.Initialize(1);
+	CHECK(tracker.GetPageSize() == 1);
+	tracker.Initialize(4096);
+	CHECK(tracker.GetPageSize() == 4096);
+}
+
+TEST_CASE(RangesAreRoundedOutToPages)
+{
+	DirtyPageTracker tracker;
+	tracker.Initialize(256);
+	tracker.Track(CreateIndex(0), 1000);
+
+	// A single byte dirties its whole page
+	tracker.MarkDirty(CreateIndex(0), 300, 1);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 256, 256 } }));
+
+	// On either side of a page boundary
+	tracker.MarkDirty(CreateIndex(0), 256, 256);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 256, 256 } }));
+	tracker.MarkDirty(CreateIndex(0), 255, 2);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 0, 512 } }));
+	tracker.MarkDirty(CreateIndex(0), 511, 1);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 256, 256 } }));
+
+	// The last page is clamped to the data size
+	tracker.MarkDirty(CreateIndex(0), 999, 1);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 768, 232 } }));
+	tracker.MarkDirty(CreateIndex(0), 0, 1000);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 0, 1000 } }));
+
+	// Empty ranges mark nothing
+	tracker.MarkDirty(CreateIndex(0), 512, 0);
+	CHECK(!tracker.HasDirtyPages());
+	CHECK(Consume(tracker).empty());
+}
+
+TEST_CASE(AdjacentPagesCoalesce)
+{
+	DirtyPageTracker tracker;
+	tracker.Initialize(64);
+	tracker.Track(CreateIndex(0), 64 * 20);
+
+	// Touching and overlapping writes become one run, a gap splits them
+	tracker.MarkDirty(CreateIndex(0), 64 * 2, 64);
+	tracker.MarkDirty(CreateIndex(0), 64 * 3, 10);
+	tracker.MarkDirty(CreateIndex(0), 64 * 3 + 50, 100);
+	tracker.MarkDirty(CreateIndex(0), 64 * 10, 64 * 2);
+	tracker.MarkDirty(CreateIndex(0), 64 * 19, 64);
+
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 64 * 2, 64 * 4 },
+		{ 0, 64 * 10, 64 * 2 }, { 0, 64 * 19, 64 } }));
+}
+
+TEST_CASE(RunsCrossMaskWords)
+{
+	// 200 pages take four mask words, so runs cross words and cover whole ones
+	DirtyPageTracker tracker;
+	tracker.Initialize(1);
+	tracker.Track(CreateIndex(0), 200);
+
+	tracker.MarkDirty(CreateIndex(0), 60, 80);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 60, 80 } }));
+
+	tracker.MarkDirty(CreateIndex(0), 0, 200);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 0, 200 } }));
+
+	tracker.MarkDirty(CreateIndex(0), 63, 1);
+	tracker.MarkDirty(CreateIndex(0), 64, 64);
+	tracker.MarkDirty(CreateIndex(0), 199, 1);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 63, 65 },
+		{ 0, 199, 1 } }));
+
+	tracker.MarkDirty(CreateIndex(0), 128, 1);
+	tracker.MarkDirty(CreateIndex(0), 130, 1);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 128, 1 },
+		{ 0, 130, 1 } }));
+}
+
+TEST_CASE(ComponentsAreConsumedInMarkOrder)
+{
+	DirtyPageTracker tracker;
+	tracker.Initialize(256);
+	tracker.Track(CreateIndex(0), 512);
+	tracker.Track(CreateIndex(3), 512);
+	tracker.Track(CreateIndex(7), 100);
+
+	CHECK(!tracker.HasDirtyPages());
+	tracker.MarkDirty(CreateIndex(7), 0, 1);
+	tracker.MarkDirty(CreateIndex(0), 300, 10);
+	tracker.MarkDirty(CreateIndex(7), 50, 50);
+	CHECK(tracker.HasDirtyPages());
+
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 7, 0, 100 },
+		{ 0, 256, 256 } }));
+	CHECK(!tracker.HasDirtyPages());
+	CHECK(Consume(tracker).empty());
+}
+
+TEST_CASE(UntrackDropsPendingPages)
+{
+	DirtyPageTracker tracker;
+	tracker.Initialize(256);
+	tracker.Track(CreateIndex(1), 1024);
+	tracker.Track(CreateIndex(2), 1024);
+
+	tracker.MarkDirty(CreateIndex(1), 0, 10);
+	tracker.MarkDirty(CreateIndex(2), 0, 10);
+	tracker.Untrack(CreateIndex(1));
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 2, 0, 256 } }));
+
+	tracker.MarkDirty(CreateIndex(2), 0, 10);
+	tracker.Untrack(CreateIndex(2));
+	CHECK(!tracker.HasDirtyPages());
+
+	// A reused index starts out clean with its new size
+	tracker.Track(CreateIndex(2), 300);
+	CHECK(!tracker.HasDirtyPages());
+	tracker.MarkDirty(CreateIndex(2), 299, 1);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 2, 256, 44 } }));
+
+	// Untracking what was never tracked does nothing
+	tracker.Untrack(CreateIndex(50));
+}
+
+TEST_CASE(RangesOfOneComponentCanBeConsumed)
+{
+	DirtyPageTracker tracker;
+	tracker.Initialize(64);
+	tracker.Track(CreateIndex(0), 64 * 200);
+	tracker.Track(CreateIndex(1), 64 * 4);
+
+	tracker.MarkDirty(CreateIndex(0), 0, 64 * 200);
+	tracker.MarkDirty(CreateIndex(1), 0, 1);
+
+	// Only the overlapped pages of the one component are consumed
+	std::vector<DirtyRange> consumed;
+	auto record = [&](const ResourceIndex& resourceIndex, size_t offset, size_t size)
+	{
+		consumed.push_back({ resourceIndex.descriptorIndex, offset, size });
+	};
+
+	tracker.ConsumeDirtyRanges(CreateIndex(0), 64 * 60 + 1, 64 * 10, record);
+	CHECK(consumed == std::vector<DirtyRange>({ { 0, 64 * 60, 64 * 11 } }));
+	consumed.clear();
+	tracker.ConsumeDirtyRanges(CreateIndex(0), 64 * 60, 64 * 20, record);
+	CHECK(consumed == std::vector<DirtyRange>({ { 0, 64 * 71, 64 * 9 } }));
+
+	// Empty ranges and unknown components consume nothing
+	consumed.clear();
+	tracker.ConsumeDirtyRanges(CreateIndex(0), 0, 0, record);
+	tracker.ConsumeDirtyRanges(CreateIndex(9), 0, 64, record);
+	CHECK(consumed.empty());
+
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 0, 0, 64 * 60 },
+		{ 0, 64 * 80, 64 * 120 }, { 1, 0, 64 } }));
+
+	// A component consumed by ranges is clean, and can be marked again
+	tracker.MarkDirty(CreateIndex(1), 64 * 3, 10);
+	tracker.ConsumeDirtyRanges(CreateIndex(1), 0, 64 * 4, record);
+	CHECK(!tracker.HasDirtyPages());
+	tracker.MarkDirty(CreateIndex(1), 64 * 2, 1);
+	CHECK(Consume(tracker) == std::vector<DirtyRange>({ { 1, 64 * 2, 64 } }));
+}
+
+TEST_CASE(RandomMarksMatchReference)
+{
+	std::mt19937 generator(19);
+	DirtyPageTracker tracker;
+
+	for (size_t round = 0; round < 2000; ++round)
+	{
+		size_t pageSize = size_t(1) << (generator() % 9);
+		size_t nrOfComponents = 1 + generator() % 4;
+		tracker.Initialize(pageSize);
+
+		std::vector<size_t> dataSizes(nrOfComponents);
+		std::vector<std::vector<bool>> dirtyPages(nrOfComponents);
+
+		for (size_t i = 0; i < nrOfComponents; ++i)
+		{
+			dataSizes[i] = 1 + generator() % (pageSize * 300);
+			dirtyPages[i].assign((dataSizes[i] + pageSize - 1) / pageSize, false);
+			tracker.Track(CreateIndex(i), dataSizes[i]);
+		}
+
+		for (size_t mark = generator() % 20; mark > 0; --mark)
+		{
+			size_t component = generator() % nrOfComponents;
+			size_t offset = generator() % dataSizes[component];
+			size_t size = generator() % (dataSizes[component] - offset + 1);
+			tracker.MarkDirty(CreateIndex(component), offset, size);
+
+			for (size_t byte = offset; byte < offset + size; byte += pageSize)
+				dirtyPages[component][byte / pageSize] = true;
+			if (size != 0)
+				dirtyPages[component][(offset + size - 1) / pageSize] = true;
+		}
+
+		std::vector<std::vector<bool>> consumedPages(nrOfComponents);
+		for (size_t i = 0; i < nrOfComponents; ++i)
+			consumedPages[i].assign(dirtyPages[i].size(), false);
+
+		std::vector<DirtyRange> ranges = Consume(tracker);
+		for (size_t i = 0; i < ranges.size(); ++i)
+		{
+			const DirtyRange& range = ranges[i];
+			CHECK(range.size != 0);
+			CHECK(range.offset % pageSize == 0);
+			CHECK(range.offset + range.size <= dataSizes[range.descriptorIndex]);
+
+			// Runs are maximal, so two of a component never touch
+			if (i > 0 && ranges[i - 1].descriptorIndex == range.descriptorIndex)
+				CHECK(ranges[i - 1].offset + ranges[i - 1].size < range.offset);
+
+			for (size_t byte = range.offset; byte < range.offset + range.size;
+				byte += pageSize)
+			{
+				consumedPages[range.descriptorIndex][byte / pageSize] = true;
+			}
+		}
+
+		CHECK(consumedPages == dirtyPages);
+		CHECK(!tracker.HasDirtyPages());
+	}
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include "BufferComponent.h"
+#include "BufferComponentData.h"
+
+// The buffer component and uploader live in the prebuilt library. These stand
+// ins keep each component's state in a table keyed by its address, since the
+// real class has no room for it, and upload by writing straight into the
+// memory of the stubbed resources.
+struct FakeBuffer
+{
+	ID3D12Resource* resource = nullptr;
+	size_t startOffset = 0;
+	size_t nrOfElements = 0;
+	bool removed = false;
+};
+
+struct FakeBufferComponentState
+{
+	size_t elementSize = 0;
+	D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+	ID3D12Resource* sharedResource = nullptr;
+	size_t sharedResourceUsed = 0;
+	std::vector<ID3D12Resource*> resources;
+	std::vector<FakeBuffer> buffers; // Indexed by descriptor index, never reused
+};
+
+// Set before a component is initialized to place all of its buffers in one
+// resource, rather than one resource each
+bool fakeBuffersShareResources = false;
+size_t fakeBytesUploaded = 0;
+std::map<const BufferComponent*, FakeBufferComponentState> fakeBufferComponents;
+
+const size_t FAKE_SHARED_RESOURCE_SIZE = 1 << 22;
+
+ID3D12Resource* CreateFakeResource(size_t size)
+{
+	ID3D12Resource* toReturn = new ID3D12Resource();
+	toReturn->desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	toReturn->desc.Width = size;
+	toReturn->memory = static_cast<unsigned char*>(std::calloc(size, 1));
+	return toReturn;
+}
+
+void ReleaseFakeBufferComponents()
+{
+	for (auto& [component, state] : fakeBufferComponents)
+	{
+		for (ID3D12Resource* resource : state.resources)
+			resource->Release();
+	}
+
+	fakeBufferComponents.clear();
+}
+
+size_t NrOfLiveFakeBuffers(const BufferComponent& component)
+{
+	size_t toReturn = 0;
+	for (const FakeBuffer& buffer : fakeBufferComponents.at(&component).buffers)
+		toReturn += buffer.removed ? 0 : 1;
+
+	return toReturn;
+}
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+}
+
+ResourceAllocator::~ResourceAllocator()
+{
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapCBV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapSRV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapUAV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapRTV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapDSV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+size_t ResourceComponent::NrOfDescriptors() const
+{
+	return 0;
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE BufferComponent::GetDescriptorHeapCBV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE BufferComponent::GetDescriptorHeapSRV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE BufferComponent::GetDescriptorHeapUAV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE BufferComponent::GetDescriptorHeapRTV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+bool BufferComponent::HasDescriptorsOfType(ViewType) const
+{
+	return false;
+}
+
+void BufferComponent::Initialize(ID3D12Device*, const BufferComponentInfo& bufferInfo,
+	const std::vector<DescriptorAllocationInfo<BufferViewDesc>>&)
+{
+	FakeBufferComponentState& state = fakeBufferComponents[this];
+	state.elementSize = bufferInfo.bufferInfo.elementSize;
+
+	if (fakeBuffersShareResources)
+	{
+		state.sharedResource = CreateFakeResource(FAKE_SHARED_RESOURCE_SIZE);
+		state.resources.push_back(state.sharedResource);
+	}
+}
+
+ResourceIndex BufferComponent::CreateBuffer(size_t nrOfElements,
+	const BufferReplacementViews&)
+{
+	FakeBufferComponentState& state = fakeBufferComponents.at(this);
+	size_t size = nrOfElements * state.elementSize;
+	FakeBuffer buffer;
+	buffer.nrOfElements = nrOfElements;
+
+	if (state.sharedResource != nullptr)
+	{
+		if (state.sharedResourceUsed + size > FAKE_SHARED_RESOURCE_SIZE)
+			throw std::runtime_error("Error: Fake shared resource is full");
+
+		buffer.resource = state.sharedResource;
+		buffer.startOffset = state.sharedResourceUsed;
+		state.sharedResourceUsed += size;
+	}
+	else
+	{
+		buffer.resource = CreateFakeResource(size);
+		state.resources.push_back(buffer.resource);
+	}
+
+	ResourceIndex toReturn;
+	toReturn.descriptorIndex = state.buffers.size();
+	state.buffers.push_back(buffer);
+
+	return toReturn;
+}
+
+void BufferComponent::RemoveComponent(const ResourceIndex& indexToRemove)
+{
+	FakeBuffer& buffer = fakeBufferComponents.at(this).buffers.at(
+		indexToRemove.descriptorIndex);
+
+	if (buffer.removed)
+		throw std::runtime_error("Error: Fake buffer removed twice");
+
+	buffer.removed = true;
+}
+
+BufferHandle BufferComponent::GetBufferHandle(const ResourceIndex& resourceIndex)
+{
+	const FakeBuffer& buffer = fakeBufferComponents.at(this).buffers.at(
+		resourceIndex.descriptorIndex);
+
+	if (buffer.removed)
+		throw std::runtime_error("Error: Fake buffer used after removal");
+
+	return { buffer.resource, buffer.startOffset, buffer.nrOfElements };
+}
+
+const BufferHandle BufferComponent::GetBufferHandle(
+	const ResourceIndex& resourceIndex) const
+{
+	return const_cast<BufferComponent*>(this)->GetBufferHandle(resourceIndex);
+}
+
+unsigned char* BufferComponent::GetMappedPtr(const ResourceIndex& resourceIndex)
+{
+	BufferHandle handle = GetBufferHandle(resourceIndex);
+	return handle.resource->memory + handle.startOffset;
+}
+
+D3D12_RESOURCE_STATES BufferComponent::GetCurrentState()
+{
+	return fakeBufferComponents.at(this).state;
+}
+
+void BufferComponent::CreateTransitionBarrier(D3D12_RESOURCE_STATES newState,
+	std::vector<D3D12_RESOURCE_BARRIER>& barriers, D3D12_RESOURCE_BARRIER_FLAGS flag,
+	std::optional<D3D12_RESOURCE_STATES> assumedInitialState)
+{
+	FakeBufferComponentState& state = fakeBufferComponents.at(this);
+
+	for (ID3D12Resource* resource : state.resources)
+	{
+		D3D12_RESOURCE_BARRIER barrier;
+		barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		barrier.Flags = flag;
+		barrier.Transition.pResource = resource;
+		barrier.Transition.StateBefore = assumedInitialState.value_or(state.state);
+		barrier.Transition.StateAfter = newState;
+		barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+		barriers.push_back(barrier);
+	}
+
+	state.state = newState;
+}
+
+// Only used by categories without shadow data, which these tests do not make
+void BufferComponentData::Initialize(ID3D12Device*, FrameType, UpdateType,
+	unsigned int, unsigned int)
+{
+	throw std::runtime_error("Error: Fake buffer components keep no component data");
+}
+
+void BufferComponentData::AddComponent(const ResourceIndex&, size_t, unsigned int,
+	void*)
+{
+}
+
+void BufferComponentData::RemoveComponent(const ResourceIndex&)
+{
+}
+
+void BufferComponentData::UpdateComponentData(const ResourceIndex&, void*)
+{
+}
+
+void BufferComponentData::PrepareUpdates(std::vector<D3D12_RESOURCE_BARRIER>&,
+	BufferComponent&)
+{
+}
+
+void BufferComponentData::UpdateComponentResources(ID3D12GraphicsCommandList*,
+	ResourceUploader&, BufferComponent&, size_t)
+{
+}
+
+bool ResourceUploader::UploadBufferResourceData(ID3D12Resource* toUploadTo,
+	ID3D12GraphicsCommandList*, void* data, size_t offsetFromStart, size_t dataSize,
+	size_t)
+{
+	std::memcpy(toUploadTo->memory + offsetFromStart, data, dataSize);
+	fakeBytesUploaded += dataSize;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <vector>
+#include <random>
+
+#include "FirstFitSearch.h"
+
+#include "TestFramework.h"
+
+// Every kernel the CPU supports has to pick the same chunk as the scalar search
+
+std::vector<FirstFitSearchLevel> GetSupportedLevels()
+{
+	std::vector<FirstFitSearchLevel> toReturn = { FirstFitSearchLevel::SCALAR };
+
+	if (GetFirstFitSearchLevel() >= FirstFitSearchLevel::SSE4_2)
+		toReturn.push_back(FirstFitSearchLevel::SSE4_2);
+
+	if (GetFirstFitSearchLevel() >= FirstFitSearchLevel::AVX2)
+		toReturn.push_back(FirstFitSearchLevel::AVX2);
+
+	return toReturn;
+}
+
+TEST_CASE(KernelsMatchScalarSearch)
+{
+	std::mt19937_64 generator(7);
+	const size_t alignments[] = { 1, 4, 256, 65536 };
+
+	for (size_t round = 0; round < 2000; ++round)
+	{
+		size_t count = generator() % 67;
+		std::vector<size_t> offsets(count);
+		std::vector<size_t> sizes(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			offsets[i] = generator() % (size_t(1) << 30);
+			sizes[i] = generator() % 100000;
+		}
+
+		size_t dataSize = round % 50 == 0 ? 0 : generator() % 100000;
+		size_t alignment = alignments[generator() % 4];
+		size_t expected = SearchFirstFit(offsets.data(), sizes.data(), count,
+			dataSize, alignment, size_t(1) << 31, FirstFitSearchLevel::SCALAR);
+
+		for (FirstFitSearchLevel level : GetSupportedLevels())
+		{
+			CHECK(SearchFirstFit(offsets.data(), sizes.data(), count, dataSize,
+				alignment, size_t(1) << 31, level) == expected);
+		}
+	}
+}
+
+TEST_CASE(PaddingMustLeaveRoomForData)
+{
+	// Aligning the first chunk uses up all of it, the second one fits exactly
+	std::vector<size_t> offsets = { 1, 512, 2, 3, 5 };
+	std::vector<size_t> sizes = { 255, 256, 1, 1, 1 };
+
+	for (FirstFitSearchLevel level : GetSupportedLevels())
+	{
+		CHECK(SearchFirstFit(offsets.data(), sizes.data(), 5, 0, 256, 1024, level) == 1);
+		CHECK(SearchFirstFit(offsets.data(), sizes.data(), 5, 256, 256, 1024, level) == 1);
+		CHECK(SearchFirstFit(offsets.data(), sizes.data(), 5, 257, 256, 1024, level) ==
+			size_t(-1));
+	}
+}
+
+TEST_CASE(LargeValuesUseScalarSearch)
+{
+	std::vector<size_t> offsets = { size_t(1) << 63, 16 };
+	std::vector<size_t> sizes = { 64, 64 };
+
+	for (FirstFitSearchLevel level : GetSupportedLevels())
+	{
+		CHECK(SearchFirstFit(offsets.data(), sizes.data(), 2, 32, 16,
+			size_t(-1), level) == 1);
+	}
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include <vector>
+#include <random>
+#include <cstring>
+
+#include "FrameBufferComponent.h"
+#include "FakeBufferComponent.h"
+
+#include "TestFramework.h"
+
+const short FRAMES = 3;
+const size_t PAGE_SIZE = 64;
+
+// Byte sized elements, so element counts are sizes
+void InitializeComponent(FrameBufferComponent<FRAMES>& component)
+{
+	ReleaseFakeBufferComponents();
+	fakeBuffersShareResources = false;
+	fakeBytesUploaded = 0;
+
+	BufferComponentInfo info;
+	info.bufferInfo.alignment = 1;
+	info.bufferInfo.elementSize = 1;
+	info.mappedResource = true;
+	component.Initialize(nullptr, UpdateType::MAP_UPDATE, info, {}, PAGE_SIZE);
+}
+
+std::vector<unsigned char> CreateData(size_t size, unsigned char seed)
+{
+	std::vector<unsigned char> toReturn(size);
+	for (size_t i = 0; i < size; ++i)
+		toReturn[i] = static_cast<unsigned char>(seed + i * 13);
+
+	return toReturn;
+}
+
+// Ends the active frame the way the resource categories do
+void EndFrame(FrameBufferComponent<FRAMES>& component)
+{
+	ResourceUploader uploader;
+	ID3D12GraphicsCommandList list;
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	component.PrepareResourcesForUpdates(barriers);
+	component.PerformUpdates(&list, uploader);
+
+	// Map updated buffers are never uploaded or transitioned
+	CHECK(barriers.empty());
+	CHECK(list.bufferCopies == 0);
+	CHECK(fakeBytesUploaded == 0);
+
+	component.SwapFrame();
+}
+
+// What the GPU reads for the active frame, once its updates are performed
+std::vector<unsigned char> ReadActiveCopy(FrameBufferComponent<FRAMES>& component,
+	const ResourceIndex& index)
+{
+	BufferHandle handle = component.GetBufferHandle(index);
+	unsigned char* start = handle.resource->memory + handle.startOffset;
+	return std::vector<unsigned char>(start, start + handle.nrOfElements);
+}
+
+std::vector<unsigned char> PerformAndReadActiveCopy(
+	FrameBufferComponent<FRAMES>& component, const ResourceIndex& index)
+{
+	ResourceUploader uploader;
+	ID3D12GraphicsCommandList list;
+	component.PerformUpdates(&list, uploader);
+	return ReadActiveCopy(component, index);
+}
+
+TEST_CASE(MapUpdatedBuffersHaveNoShadowData)
+{
+	FrameBufferComponent<FRAMES> component;
+	InitializeComponent(component);
+	component.SwapFrame();
+
+	ResourceIndex index = component.CreateBuffer(1000);
+	CHECK(component.GetUpdateData(index) == nullptr);
+
+	// Whole writes land in the mapped copy of the active frame at once
+	std::vector<unsigned char> data = CreateData(1000, 1);
+	component.SetUpdateData(index, data.data());
+	CHECK(ReadActiveCopy(component, index) == data);
+}
+
+TEST_CASE(WritesReachEveryFrameCopy)
+{
+	FrameBufferComponent<FRAMES> component;
+	InitializeComponent(component);
+	component.SwapFrame();
+
+	ResourceIndex index = component.CreateBuffer(1000);
+	std::vector<unsigned char> expected = CreateData(1000, 2);
+	component.SetUpdateData(index, expected.data());
+
+	std::vector<unsigned char> written = CreateData(30, 3);
+	component.SetUpdateDataRange(index, written.data(), 100, written.size());
+	std::memcpy(expected.data() + 100, written.data(), written.size());
+
+	// Each copy is caught up as its frame becomes active, and then stays so
+	for (size_t frame = 0; frame < FRAMES * 3; ++frame)
+	{
+		CHECK(PerformAndReadActiveCopy(component, index) == expected);
+		EndFrame(component);
+	}
+}
+
+TEST_CASE(LaterFramesOverwriteOnlyWhatTheyWrite)
+{
+	FrameBufferComponent<FRAMES> component;
+	InitializeComponent(component);
+	component.SwapFrame();
+
+	ResourceIndex index = component.CreateBuffer(1000);
+	std::vector<unsigned char> expected = CreateData(1000, 4);
+	component.SetUpdateData(index, expected.data());
+	EndFrame(component);
+
+	// Partial pages around the write keep what the earlier frame wrote
+	std::vector<unsigned char> written = CreateData(10, 5);
+	component.SetUpdateDataRange(index, written.data(), PAGE_SIZE + 7, written.size());
+	std::memcpy(expected.data() + PAGE_SIZE + 7, written.data(), written.size());
+	std::vector<unsigned char> activeCopy = ReadActiveCopy(component, index);
+	CHECK(std::memcmp(activeCopy.data() + PAGE_SIZE, expected.data() + PAGE_SIZE,
+		PAGE_SIZE) == 0);
+	EndFrame(component);
+
+	written = CreateData(200, 6);
+	component.SetUpdateDataRange(index, written.data(), 0, written.size());
+	std::memcpy(expected.data(), written.data(), written.size());
+	EndFrame(component);
+
+	for (size_t frame = 0; frame < FRAMES * 2; ++frame)
+	{
+		CHECK(PerformAndReadActiveCopy(component, index) == expected);
+		EndFrame(component);
+	}
+}
+
+TEST_CASE(WritePointerWritesAreKept)
+{
+	FrameBufferComponent<FRAMES> component;
+	InitializeComponent(component);
+	component.SwapFrame();
+
+	ResourceIndex index = component.CreateBuffer(500);
+	std::vector<unsigned char> expected = CreateData(500, 7);
+	component.SetUpdateData(index, expected.data());
+	EndFrame(component);
+
+	// The pointer sees the earlier write, and its own write is passed on
+	unsigned char* pointer = static_cast<unsigned char*>(component.GetWritePointer(index));
+	CHECK(std::memcmp(pointer, expected.data(), expected.size()) == 0);
+	pointer[250] = 0xab;
+	expected[250] = 0xab;
+
+	for (size_t frame = 0; frame < FRAMES * 2; ++frame)
+	{
+		CHECK(PerformAndReadActiveCopy(component, index) == expected);
+		EndFrame(component);
+	}
+
+	// Written in place every frame, as per object data is
+	for (size_t frame = 0; frame < FRAMES * 2; ++frame)
+	{
+		pointer = static_cast<unsigned char*>(component.GetWritePointer(index));
+		pointer[frame] = static_cast<unsigned char>(frame);
+		expected[frame] = static_cast<unsigned char>(frame);
+		CHECK(PerformAndReadActiveCopy(component, index) == expected);
+		EndFrame(component);
+	}
+
+	FrameBufferComponent<FRAMES> uninitialized;
+	CHECK_THROWS(uninitialized.GetWritePointer(index));
+}
+
+TEST_CASE(RandomWritesMatchReference)
+{
+	std::mt19937 generator(23);
+	FrameBufferComponent<FRAMES> component;
+	InitializeComponent(component);
+	component.SwapFrame();
+
+	std::vector<ResourceIndex> indices;
+	std::vector<std::vector<unsigned char>> expected;
+
+	for (size_t frame = 0; frame < 500; ++frame)
+	{
+		// Buffers come and go, created ones start out written
+		if (indices.size() < 8 || generator() % 10 == 0)
+		{
+			size_t size = 1 + generator() % 700;
+			indices.push_back(component.CreateBuffer(size));
+			expected.push_back(CreateData(size, static_cast<unsigned char>(frame)));
+			component.SetUpdateData(indices.back(), expected.back().data());
+		}
+
+		if (generator() % 10 == 0)
+		{
+			size_t toRemove = generator() % indices.size();
+			component.RemoveComponent(indices[toRemove]);
+			indices.erase(indices.begin() + toRemove);
+			expected.erase(expected.begin() + toRemove);
+		}
+
+		for (size_t write = generator() % 6; write > 0; --write)
+		{
+			size_t buffer = generator() % indices.size();
+			size_t offset = generator() % expected[buffer].size();
+			size_t size = generator() % (expected[buffer].size() - offset + 1);
+			std::vector<unsigned char> written = CreateData(size,
+				static_cast<unsigned char>(generator()));
+
+			if (generator() % 4 == 0)
+			{
+				unsigned char* pointer = static_cast<unsigned char*>(
+					component.GetWritePointer(indices[buffer]));
+				std::memcpy(pointer + offset, written.data(), size);
+			}
+			else
+			{
+				component.SetUpdateDataRange(indices[buffer], written.data(), offset, size);
+			}
+
+			std::memcpy(expected[buffer].data() + offset, written.data(), size);
+		}
+
+		ResourceUploader uploader;
+		ID3D12GraphicsCommandList list;
+		component.PerformUpdates(&list, uploader);
+
+		for (size_t i = 0; i < indices.size(); ++i)
+			CHECK(ReadActiveCopy(component, indices[i]) == expected[i]);
+
+		EndFrame(component);
+	}
+}
+
+int main()
+{
+	int toReturn = RunTests();
+	ReleaseFakeBufferComponents();
+	return toReturn;
+}
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include <vector>
+#include <random>
+
+#include "FrameResourceComponent.h"
+
+#include "TestFramework.h"
+
+// The prebuilt library normally provides these, the tested component never
+// allocates descriptors
+DescriptorAllocator::~DescriptorAllocator()
+{
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapCBV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapSRV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapUAV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapRTV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapDSV() const
+{
+	return D3D12_CPU_DESCRIPTOR_HANDLE();
+}
+
+size_t ResourceComponent::NrOfDescriptors() const
+{
+	return 0;
+}
+
+// A creation or removal as applied to one frame copy, creations are
+// identified by a value and removals by the descriptor index
+struct AppliedOperation
+{
+	bool creation = false;
+	size_t value = 0;
+
+	bool operator==(const AppliedOperation& other) const = default;
+};
+
+struct MockCreationOperation
+{
+	size_t value;
+};
+
+// Stands in for a buffer or texture component, recording what is applied to it
+struct MockComponent
+{
+	std::vector<AppliedOperation> applied;
+
+	void Initialize()
+	{
+		applied.clear();
+	}
+
+	void RemoveComponent(const ResourceIndex& indexToRemove)
+	{
+		applied.push_back({ false, indexToRemove.descriptorIndex });
+	}
+
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapCBV() const { return {}; }
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapSRV() const { return {}; }
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapUAV() const { return {}; }
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapRTV() const { return {}; }
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapDSV() const { return {}; }
+	bool HasDescriptorsOfType(ViewType) const { return false; }
+	size_t NrOfDescriptors() const { return 0; }
+	AllocatorStatistics GetStatistics() const { return AllocatorStatistics(); }
+};
+
+template<FrameType Frames>
+class MockFrameComponent :
+	public FrameResourceComponent<MockComponent, Frames, MockCreationOperation>
+{
+private:
+	typedef FrameResourceComponent<MockComponent, Frames, MockCreationOperation> Base;
+
+	void HandleStoredOperations(const typename Base::StoredLifetimeOperation* operations,
+		size_t nrOfOperations) override
+	{
+		MockComponent& active = this->resourceComponents[this->activeFrame];
+		++nrOfReplays;
+
+		for (size_t i = 0; i < nrOfOperations; ++i)
+		{
+			if (operations[i].type == Base::LifetimeOperationType::CREATION)
+				active.applied.push_back({ true, operations[i].creation.value });
+			else
+				active.RemoveComponent(operations[i].removal.indexToRemove);
+		}
+	}
+
+public:
+	size_t nrOfReplays = 0;
+
+	void Create(size_t value)
+	{
+		this->resourceComponents[this->activeFrame].applied.push_back({ true, value });
+
+		typename Base::StoredLifetimeOperation toStore;
+		toStore.type = Base::LifetimeOperationType::CREATION;
+		toStore.creation.value = value;
+		this->StoreLifetimeOperation(toStore);
+	}
+
+	const std::vector<AppliedOperation>& GetApplied(FrameType frame) const
+	{
+		return this->resourceComponents[frame].applied;
+	}
+
+	FrameType GetActiveFrame() const
+	{
+		return this->activeFrame;
+	}
+
+	size_t NrOfStoredOperations() const
+	{
+		size_t toReturn = 0;
+		for (const auto& batch : this->storedLifetimeOperations)
+			toReturn += batch.size();
+
+		return toReturn;
+	}
+};
+
+ResourceIndex CreateIndex(size_t descriptorIndex)
+{
+	ResourceIndex toReturn;
+	toReturn.descriptorIndex = descriptorIndex;
+	return toReturn;
+}
+
+TEST_CASE(BatchesReplayInOrderAndRetire)
+{
+	MockFrameComponent<3> component;
+	component.Initialize();
+	component.SwapFrame();
+	CHECK(component.GetActiveFrame() == 0);
+
+	component.Create(1);
+	component.Create(2);
+	component.RemoveComponent(CreateIndex(1));
+	component.SwapFrame();
+
+	// Frame 1 replays what frame 0 recorded before it records its own
+	std::vector<AppliedOperation> expected = { { true, 1 }, { true, 2 },
+		{ false, 1 } };
+	CHECK(component.GetApplied(1) == expected);
+	component.Create(3);
+	component.SwapFrame();
+
+	// Frame 2 replays both batches, oldest first
+	expected.push_back({ true, 3 });
+	CHECK(component.GetApplied(2) == expected);
+	component.RemoveComponent(CreateIndex(2));
+	component.SwapFrame();
+
+	// Back on frame 0, whose own batch has now been replayed everywhere
+	expected.push_back({ false, 2 });
+	CHECK(component.GetApplied(0) == expected);
+	CHECK(component.NrOfStoredOperations() == 2);
+
+	component.SwapFrame();
+	CHECK(component.GetApplied(1) == expected);
+	CHECK(component.NrOfStoredOperations() == 1);
+	component.SwapFrame();
+	CHECK(component.GetApplied(2) == expected);
+	CHECK(component.NrOfStoredOperations() == 0);
+
+	// Cleared batches are not replayed again
+	size_t nrOfReplays = component.nrOfReplays;
+	for (size_t i = 0; i < 6; ++i)
+		component.SwapFrame();
+
+	CHECK(component.nrOfReplays == nrOfReplays);
+	for (FrameType frame = 0; frame < 3; ++frame)
+		CHECK(component.GetApplied(frame) == expected);
+}
+
+TEST_CASE(BulkRemovalKeepsOrder)
+{
+	MockFrameComponent<2> component;
+	component.Initialize();
+
+	std::vector<ResourceIndex> toRemove;
+	for (size_t i = 0; i < 100; ++i)
+	{
+		component.Create(i);
+		toRemove.push_back(CreateIndex(99 - i));
+	}
+
+	component.RemoveComponents(toRemove);
+	component.SwapFrame();
+	CHECK(component.GetApplied(0) == component.GetApplied(1));
+	CHECK(component.GetApplied(0).size() == 200);
+	CHECK(component.GetApplied(0)[100] == AppliedOperation({ false, 99 }));
+	CHECK(component.GetApplied(0).back() == AppliedOperation({ false, 0 }));
+}
+
+TEST_CASE(SingleFrameStoresNothing)
+{
+	MockFrameComponent<1> component;
+	component.Initialize();
+	component.Create(1);
+	component.RemoveComponent(CreateIndex(1));
+	component.SwapFrame();
+
+	CHECK(component.NrOfStoredOperations() == 0);
+	CHECK(component.nrOfReplays == 0);
+	CHECK(component.GetApplied(0).size() == 2);
+}
+
+TEST_CASE(EveryCopySeesEveryOperationInOrder)
+{
+	std::mt19937 generator(21);
+	MockFrameComponent<3> component;
+	component.Initialize();
+	std::vector<AppliedOperation> performed;
+
+	for (size_t round = 0; round < 2000; ++round)
+	{
+		for (size_t i = generator() % 4; i > 0; --i)
+		{
+			size_t value = generator() % 1000;
+
+			if (generator() % 2 == 0)
+			{
+				component.Create(value);
+				performed.push_back({ true, value });
+			}
+			else
+			{
+				component.RemoveComponent(CreateIndex(value));
+				performed.push_back({ false, value });
+			}
+		}
+
+		component.SwapFrame();
+
+		// The copy that just became active has caught up with every operation
+		CHECK(component.GetApplied(component.GetActiveFrame()) == performed);
+		CHECK(component.NrOfStoredOperations() <= performed.size());
+	}
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
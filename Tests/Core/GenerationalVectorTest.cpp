@@ -0,0 +1,181 @@
+#include <vector>
+
+#include "GenerationalVector.h"
+
+#include "TestFramework.h"
+
+TEST_CASE(HandlesBecomeStaleAfterRemove)
+{
+	GenerationalVector<int> vector;
+	size_t handle = vector.GetHandle(vector.Add(1));
+	CHECK(vector.CheckIfValid(handle));
+	CHECK(vector.Get(handle) == 1);
+
+	size_t index = GenerationalVector<int>::GetIndexFromHandle(handle);
+	vector.Remove(index);
+	CHECK(!vector.CheckIfValid(handle));
+
+	// The slot is reused, but the old handle has to stay invalid
+	size_t newIndex = vector.Add(2);
+	CHECK(newIndex == index);
+	CHECK(!vector.CheckIfValid(handle));
+	CHECK(vector.CheckIfValid(vector.GetHandle(newIndex)));
+}
+
+TEST_CASE(AddAtOverActiveSlotInvalidatesHandle)
+{
+	GenerationalVector<int> vector;
+	vector.Expand(8);
+	size_t handle = vector.GetHandle(vector.AddAt(1, 5));
+	vector.AddAt(2, 5);
+
+	CHECK(!vector.CheckIfValid(handle));
+	CHECK(vector[5] == 2);
+	CHECK(vector.ActiveSize() == 1);
+}
+
+TEST_CASE(IterationVisitsOnlyActiveSlots)
+{
+	GenerationalVector<size_t> vector;
+
+	for (size_t i = 0; i < 200; ++i)
+		vector.Add(i);
+
+	for (size_t i = 0; i < 200; ++i)
+	{
+		if (i % 3 != 0)
+			vector.Remove(i);
+	}
+
+	std::vector<size_t> visited;
+	vector.ForEachActive([&](size_t index, size_t& element)
+		{
+			CHECK(index == element);
+			visited.push_back(index);
+		});
+
+	CHECK(visited.size() == vector.ActiveSize());
+
+	for (size_t i = 0; i < visited.size(); ++i)
+		CHECK(visited[i] == i * 3);
+
+	CHECK(vector.NextActive(199) == vector.TotalSize());
+}
+
+TEST_CASE(AddReusesRemovedSlotsBeforeExpandedOnes)
+{
+	GenerationalVector<int> vector;
+	vector.Add(0);
+	vector.Add(1);
+	vector.Remove(0);
+	vector.Expand(5);
+
+	CHECK(vector.Add(2) == 0);
+	CHECK(vector.Add(3) == 2);
+	CHECK(vector.Add(4) == 3);
+	CHECK(vector.Add(5) == 4);
+	CHECK(vector.Add(6) == 5);
+	CHECK(vector.TotalSize() == 6);
+}
+
+TEST_CASE(AddAtIntoFreedSlotUnlinksOnlyThatSlot)
+{
+	GenerationalVector<int> vector;
+	for (int i = 0; i < 10; ++i)
+		vector.Add(i);
+
+	size_t staleHandle = vector.GetHandle(5);
+	vector.Remove(2);
+	vector.Remove(5);
+	vector.Remove(7);
+
+	// 5 sits in the middle of the free list, between 7 and 2
+	CHECK(vector.AddAt(50, 5) == 5);
+	CHECK(vector[5] == 50);
+	CHECK(vector.ActiveSize() == 8);
+	CHECK(!vector.CheckIfValid(staleHandle));
+	CHECK(vector.CheckIfValid(vector.GetHandle(5)));
+
+	// The rest of the free list is intact and handed out most recent first
+	CHECK(vector.Add(70) == 7);
+	CHECK(vector.Add(20) == 2);
+	CHECK(vector.Add(100) == 10);
+	CHECK(vector.ActiveSize() == 11);
+
+	// Head and tail of the free list
+	vector.Remove(3);
+	vector.Remove(8);
+	CHECK(vector.AddAt(80, 8) == 8);
+	CHECK(vector.Add(30) == 3);
+	vector.Remove(1);
+	vector.Remove(9);
+	CHECK(vector.AddAt(10, 1) == 1);
+	CHECK(vector.Add(90) == 9);
+	CHECK(vector.Add(110) == 11);
+}
+
+TEST_CASE(AddAtIntoUnlinkedTail)
+{
+	GenerationalVector<int> vector;
+	vector.Expand(10);
+	CHECK(vector.Add(0) == 0);
+
+	// The slots skipped over before 6 are linked, 7 to 9 stay in the tail
+	CHECK(vector.AddAt(6, 6) == 6);
+	CHECK(vector.ActiveSize() == 2);
+	CHECK(vector.TotalSize() == 10);
+
+	std::vector<size_t> added;
+	for (int i = 0; i < 8; ++i)
+		added.push_back(vector.Add(i));
+
+	CHECK(added == std::vector<size_t>({ 5, 4, 3, 2, 1, 7, 8, 9 }));
+	CHECK(vector.Add(10) == 10);
+	CHECK(vector.ActiveSize() == 11);
+
+	for (size_t i = 0; i < vector.TotalSize(); ++i)
+		CHECK(vector.CheckIfActive(i));
+}
+
+TEST_CASE(AddAtIntoUnlinkedTailFirstSlot)
+{
+	GenerationalVector<int> vector;
+	vector.Expand(4);
+
+	// Nothing is skipped, so nothing is linked
+	CHECK(vector.AddAt(0, 0) == 0);
+	CHECK(vector.Add(1) == 1);
+	CHECK(vector.AddAt(3, 3) == 3);
+	CHECK(vector.Add(2) == 2);
+	CHECK(vector.Add(4) == 4);
+}
+
+TEST_CASE(AddAtPastTheEndGrows)
+{
+	GenerationalVector<int> vector;
+	vector.Add(0);
+
+	CHECK(vector.AddAt(20, 20) == 20);
+	CHECK(vector.TotalSize() == 21);
+	CHECK(vector.ActiveSize() == 2);
+	CHECK(vector[20] == 20);
+	CHECK(vector.NextActive(1) == 20);
+
+	// Every slot skipped over is handed out before the vector grows again
+	std::vector<bool> seen(21, false);
+	for (int i = 1; i < 20; ++i)
+	{
+		size_t index = vector.Add(i);
+		CHECK(index > 0 && index < 20 && !seen[index]);
+		if (index < seen.size())
+			seen[index] = true;
+	}
+
+	CHECK(vector.Add(21) == 21);
+	CHECK(vector.ActiveSize() == 22);
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include <vector>
+#include <map>
+#include <iterator>
+#include <random>
+
+#include "HeapHelper.h"
+#include "IndexedHeapHelper.h"
+
+#include "TestFramework.h"
+
+// Runs the same million operation stream of allocations, frees and RemoveIf
+// calls against HeapHelper and IndexedHeapHelper, checking every result
+// against a model of the occupied ranges. Timing the helpers is left to
+// HeapHelperBenchmark.
+
+struct LiveChunk
+{
+	size_t chunkIndex = 0;
+	size_t startOffset = 0;
+	size_t tag = 0;
+};
+
+class OccupiedRanges
+{
+private:
+	std::map<size_t, size_t> ranges; // Start offset to end offset
+	size_t heapSize = 0;
+
+public:
+	OccupiedRanges(size_t heapSize) : heapSize(heapSize)
+	{
+		// Empty
+	}
+
+	bool Insert(size_t startOffset, size_t size, size_t alignment)
+	{
+		if (startOffset % alignment != 0 || startOffset + size > heapSize)
+			return false;
+
+		auto next = ranges.lower_bound(startOffset);
+		if (next != ranges.end() && next->first < startOffset + size)
+			return false;
+
+		if (next != ranges.begin() && std::prev(next)->second > startOffset)
+			return false;
+
+		ranges[startOffset] = startOffset + size;
+		return true;
+	}
+
+	void Erase(size_t startOffset)
+	{
+		ranges.erase(startOffset);
+	}
+};
+
+constexpr size_t NR_OF_OPERATIONS = 1000000;
+constexpr size_t MAX_LIVE_CHUNKS = 256;
+constexpr size_t REMOVE_IF_INTERVAL = 10000;
+constexpr size_t HEAP_SIZE = MAX_LIVE_CHUNKS * 4096 * 4;
+
+template<typename Helper, typename Strategy>
+void RunOperations(Strategy strategy, size_t& nrOfFailedAllocations)
+{
+	const size_t alignments[] = { 1, 4, 16, 256 };
+	std::mt19937_64 generator(12345);
+	std::uniform_int_distribution<size_t> sizeDistribution(1, 4096);
+	Helper helper;
+	helper.Initialize(HEAP_SIZE);
+	OccupiedRanges occupied(HEAP_SIZE);
+	std::vector<LiveChunk> liveChunks;
+	size_t nextTag = 0;
+	nrOfFailedAllocations = 0;
+
+	for (size_t operation = 1; operation <= NR_OF_OPERATIONS; ++operation)
+	{
+		if (operation % REMOVE_IF_INTERVAL == 0)
+		{
+			helper.RemoveIf([](const size_t& tag) { return tag % 3 == 0; });
+
+			std::vector<LiveChunk> remaining;
+			for (const LiveChunk& liveChunk : liveChunks)
+			{
+				if (liveChunk.tag % 3 == 0)
+					occupied.Erase(liveChunk.startOffset);
+				else
+					remaining.push_back(liveChunk);
+			}
+
+			liveChunks.swap(remaining);
+			CHECK(helper.NrOfAllocatedChunks() == liveChunks.size());
+			continue;
+		}
+
+		bool allocate = liveChunks.empty() ||
+			(liveChunks.size() < MAX_LIVE_CHUNKS && generator() % 2 == 0);
+
+		if (allocate)
+		{
+			size_t size = sizeDistribution(generator);
+			size_t alignment = alignments[generator() % 4];
+			size_t chunkIndex = helper.AllocateChunk(size, strategy, alignment);
+
+			if (chunkIndex == size_t(-1))
+			{
+				++nrOfFailedAllocations;
+				continue;
+			}
+
+			size_t startOffset = helper.GetStartOfChunk(chunkIndex);
+			CHECK(occupied.Insert(startOffset, size, alignment));
+			helper[chunkIndex] = ++nextTag;
+			liveChunks.push_back({ chunkIndex, startOffset, nextTag });
+		}
+		else
+		{
+			size_t position = generator() % liveChunks.size();
+			LiveChunk& toFree = liveChunks[position];
+			CHECK(helper[toFree.chunkIndex] == toFree.tag);
+			helper.DeallocateChunk(toFree.chunkIndex);
+			occupied.Erase(toFree.startOffset);
+			toFree = liveChunks.back();
+			liveChunks.pop_back();
+		}
+	}
+
+	for (const LiveChunk& liveChunk : liveChunks)
+		helper.DeallocateChunk(liveChunk.chunkIndex);
+
+	// Everything freed has to have been merged back into a single chunk
+	CHECK(helper.NrOfAllocatedChunks() == 0);
+	size_t wholeHeap = helper.AllocateChunk(HEAP_SIZE, strategy, 1);
+	CHECK(wholeHeap != size_t(-1));
+	CHECK(wholeHeap == size_t(-1) || helper.GetStartOfChunk(wholeHeap) == 0);
+}
+
+template<typename Strategy, typename IndexedStrategy>
+void RunBothHelpers(Strategy strategy, IndexedStrategy indexedStrategy)
+{
+	size_t scanningFailures = 0;
+	size_t indexedFailures = 0;
+	RunOperations<HeapHelper<size_t>>(strategy, scanningFailures);
+	RunOperations<IndexedHeapHelper<size_t>>(indexedStrategy, indexedFailures);
+
+	// The heap is large enough that no allocation should fail
+	CHECK(scanningFailures == 0);
+	CHECK(indexedFailures == 0);
+}
+
+TEST_CASE(MillionOperationsFirstFit)
+{
+	RunBothHelpers(AllocationStrategy::FIRST_FIT, IndexedAllocationStrategy::FIRST_FIT);
+}
+
+TEST_CASE(MillionOperationsBestFit)
+{
+	RunBothHelpers(AllocationStrategy::BEST_FIT, IndexedAllocationStrategy::BEST_FIT);
+}
+
+TEST_CASE(MillionOperationsWorstFit)
+{
+	RunBothHelpers(AllocationStrategy::WORST_FIT, IndexedAllocationStrategy::WORST_FIT);
+}
+
+TEST_CASE(MillionOperationsTLSF)
+{
+	size_t failures = 0;
+	RunOperations<IndexedHeapHelper<size_t>>(IndexedAllocationStrategy::TLSF, failures);
+
+	CHECK(failures == 0);
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
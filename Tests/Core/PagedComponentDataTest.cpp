@@ -0,0 +1,177 @@
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cstring>
+
+#include "PagedComponentData.h"
+
+#include "TestFramework.h"
+
+ResourceIndex CreateIndex(size_t descriptorIndex)
+{
+	ResourceIndex toReturn;
+	toReturn.descriptorIndex = descriptorIndex;
+	return toReturn;
+}
+
+// Every byte of a component's data depends on its descriptor index and the
+// number of times it has been added
+std::vector<unsigned char> CreateData(size_t descriptorIndex, size_t version,
+	size_t size)
+{
+	std::vector<unsigned char> toReturn(size);
+	for (size_t i = 0; i < size; ++i)
+		toReturn[i] = static_cast<unsigned char>(descriptorIndex * 31 + version * 7 + i);
+
+	return toReturn;
+}
+
+TEST_CASE(InvalidSettingsThrow)
+{
+	PagedComponentData data;
+	CHECK_THROWS(data.Initialize(0, 16));
+	CHECK_THROWS(data.Initialize(4096, 0));
+	CHECK_THROWS(data.Initialize(4096, 24));
+}
+
+TEST_CASE(DataIsZeroedOrCopied)
+{
+	PagedComponentData data;
+	data.Initialize(1024, 16);
+
+	const unsigned char* zeroed = static_cast<const unsigned char*>(
+		data.AddComponent(CreateIndex(0), 100));
+	for (size_t i = 0; i < 100; ++i)
+		CHECK(zeroed[i] == 0);
+
+	std::vector<unsigned char> initial = CreateData(1, 0, 60);
+	void* copied = data.AddComponent(CreateIndex(1), 60, initial.data());
+	CHECK(std::memcmp(copied, initial.data(), 60) == 0);
+	CHECK(data.GetComponentData(CreateIndex(1)) == copied);
+	CHECK(data.GetComponentDataSize(CreateIndex(1)) == 60);
+
+	std::vector<unsigned char> updated = CreateData(1, 1, 60);
+	data.UpdateComponentData(CreateIndex(1), updated.data());
+	CHECK(std::memcmp(copied, updated.data(), 60) == 0);
+	CHECK(data.GetUsedDataSize() == 160);
+
+	// Empty components have no data, unknown indices neither
+	CHECK(data.AddComponent(CreateIndex(2), 0) == nullptr);
+	CHECK(data.GetComponentData(CreateIndex(100)) == nullptr);
+	CHECK(data.GetComponentDataSize(CreateIndex(100)) == 0);
+}
+
+TEST_CASE(DataIsAlignedAsRequested)
+{
+	for (size_t alignment : { 16, 64, 256, 4096 })
+	{
+		PagedComponentData data;
+		data.Initialize(65536, alignment);
+
+		// Odd sizes, and sizes that need dedicated pages
+		for (size_t i = 0; i < 64; ++i)
+		{
+			size_t size = i % 8 == 7 ? 70000 + i : 1 + i * 37;
+			void* added = data.AddComponent(CreateIndex(i), size);
+			CHECK(reinterpret_cast<std::uintptr_t>(added) % alignment == 0);
+		}
+	}
+}
+
+TEST_CASE(EntriesNeverMoveAndSurviveChurn)
+{
+	std::mt19937 generator(20);
+	PagedComponentData data;
+	data.Initialize(4096, 16);
+
+	const size_t NR_OF_INDICES = 500;
+	std::vector<void*> pointers(NR_OF_INDICES, nullptr);
+	std::vector<size_t> versions(NR_OF_INDICES, 0);
+	std::vector<size_t> sizes(NR_OF_INDICES, 0);
+
+	for (size_t round = 0; round < 20000; ++round)
+	{
+		size_t index = generator() % NR_OF_INDICES;
+
+		if (pointers[index] != nullptr && generator() % 2 == 0)
+		{
+			data.RemoveComponent(CreateIndex(index));
+			pointers[index] = nullptr;
+			sizes[index] = 0;
+		}
+		else
+		{
+			// Mostly small, now and then larger than a page
+			size_t size = generator() % 50 == 0 ? 4096 + generator() % 8192 :
+				1 + generator() % 300;
+			std::vector<unsigned char> initial = CreateData(index, ++versions[index], size);
+			pointers[index] = data.AddComponent(CreateIndex(index), size, initial.data());
+			sizes[index] = size;
+		}
+
+		if (round % 1000 != 999)
+			continue;
+
+		// Everything else is where it was, with the data it was given
+		size_t usedDataSize = 0;
+		for (size_t i = 0; i < NR_OF_INDICES; ++i)
+		{
+			CHECK(data.GetComponentData(CreateIndex(i)) == pointers[i]);
+			CHECK(data.GetComponentDataSize(CreateIndex(i)) == sizes[i]);
+			usedDataSize += sizes[i];
+
+			if (pointers[i] != nullptr)
+			{
+				std::vector<unsigned char> expected = CreateData(i, versions[i], sizes[i]);
+				CHECK(std::memcmp(pointers[i], expected.data(), sizes[i]) == 0);
+			}
+		}
+
+		CHECK(data.GetUsedDataSize() == usedDataSize);
+	}
+}
+
+TEST_CASE(EmptyPagesAreFreed)
+{
+	PagedComponentData data;
+	data.Initialize(1024, 16);
+
+	// Four shared pages of four components each
+	for (size_t i = 0; i < 16; ++i)
+		data.AddComponent(CreateIndex(i), 256);
+	CHECK(data.NrOfPages() == 4);
+
+	// Emptying a page frees it, but the last shared page is kept
+	for (size_t i = 0; i < 4; ++i)
+		data.RemoveComponent(CreateIndex(i));
+	CHECK(data.NrOfPages() == 3);
+
+	for (size_t i = 4; i < 16; ++i)
+		data.RemoveComponent(CreateIndex(i));
+	CHECK(data.NrOfPages() == 1);
+	CHECK(data.GetUsedDataSize() == 0);
+
+	// Dedicated pages always go with their component
+	data.AddComponent(CreateIndex(0), 5000);
+	data.AddComponent(CreateIndex(1), 3000);
+	CHECK(data.NrOfPages() == 3);
+	data.RemoveComponent(CreateIndex(0));
+	data.RemoveComponent(CreateIndex(1));
+	CHECK(data.NrOfPages() == 1);
+
+	// Freed pages are reused rather than added to
+	for (size_t i = 0; i < 16; ++i)
+		data.AddComponent(CreateIndex(i), 256);
+	CHECK(data.NrOfPages() == 4);
+
+	// Adding again replaces the old data, freeing what it leaves empty
+	data.AddComponent(CreateIndex(3), 2000);
+	CHECK(data.NrOfPages() == 5);
+	data.AddComponent(CreateIndex(3), 256);
+	CHECK(data.NrOfPages() == 4);
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
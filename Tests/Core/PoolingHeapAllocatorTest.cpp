@@ -0,0 +1,313 @@
+#include <stdexcept>
+
+#include "PoolingHeapAllocatorGPU.h"
+
+#include "TestFramework.h"
+
+// The prebuilt library normally provides this, here the heaps come from the
+// stub device so that they can be counted
+ID3D12Heap* HeapAllocatorGPU::CreateHeap(size_t heapSize, D3D12_HEAP_TYPE heapType,
+	D3D12_HEAP_FLAGS heapFlags)
+{
+	D3D12_HEAP_DESC desc = {};
+	desc.SizeInBytes = heapSize;
+	desc.Properties.Type = heapType;
+	desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	desc.Flags = heapFlags;
+
+	ID3D12Heap* toReturn = nullptr;
+	if (FAILED(device->CreateHeap(&desc, IID_PPV_ARGS(&toReturn))))
+		throw std::runtime_error("Error: Could not create heap");
+
+	return toReturn;
+}
+
+ID3D12Device device;
+
+// Small sizes keep the size classes easy to follow: with a minimum of 1024
+// and 4 classes per doubling, 5000 rounds up to 5120 and 40000 to 40960
+PoolingHeapSettings SmallHeapSettings()
+{
+	PoolingHeapSettings settings;
+	settings.minimumHeapSize = 1024;
+	settings.sizeClassesPerDoubling = 4;
+	settings.maximumReuseFactor = 2;
+	settings.framesBeforeTrim = size_t(-1);
+
+	return settings;
+}
+
+size_t ChunkSize(const HeapChunk& chunk)
+{
+	return chunk.endOffset - chunk.startOffset;
+}
+
+TEST_CASE(ReleasedHeapIsReusedForSimilarSize)
+{
+	PoolingHeapAllocatorGPU allocator;
+	allocator.Initialize(&device, SmallHeapSettings());
+
+	HeapChunk first = allocator.AllocateChunk(5000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(first.startOffset == 0);
+	CHECK(ChunkSize(first) == 5120);
+	CHECK(first.heap->GetDesc().SizeInBytes == 5120);
+
+	ID3D12Heap* firstHeap = first.heap;
+	allocator.DeallocateChunk(first);
+	CHECK(first.heap == nullptr);
+
+	// Same size class, so the idle heap is handed out again
+	HeapChunk second = allocator.AllocateChunk(4500, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(second.heap == firstHeap);
+	CHECK(allocator.GetNrOfHeapsCreated() == 1);
+	CHECK(allocator.GetNrOfHeapsReused() == 1);
+
+	// An idle heap of another type is never handed out
+	allocator.DeallocateChunk(second);
+	HeapChunk upload = allocator.AllocateChunk(5000, D3D12_HEAP_TYPE_UPLOAD,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(upload.heap != firstHeap);
+	CHECK(upload.heapType == D3D12_HEAP_TYPE_UPLOAD);
+	CHECK(allocator.GetNrOfHeapsCreated() == 2);
+	allocator.DeallocateChunk(upload);
+}
+
+TEST_CASE(IdleHeapsMuchLargerThanTheRequestAreNotReused)
+{
+	PoolingHeapAllocatorGPU allocator;
+	allocator.Initialize(&device, SmallHeapSettings());
+
+	HeapChunk large = allocator.AllocateChunk(65536, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	ID3D12Heap* largeHeap = large.heap;
+	allocator.DeallocateChunk(large);
+
+	// 65536 is more than twice the 5120 class, so a new heap is created
+	HeapChunk small = allocator.AllocateChunk(5000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(small.heap != largeHeap);
+	CHECK(ChunkSize(small) == 5120);
+	CHECK(allocator.GetNrOfHeapsReused() == 0);
+
+	// It is within twice the 40960 class, and the whole heap is handed out
+	HeapChunk medium = allocator.AllocateChunk(40000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(medium.heap == largeHeap);
+	CHECK(ChunkSize(medium) == 65536);
+	CHECK(allocator.GetNrOfHeapsCreated() == 2);
+	CHECK(allocator.GetNrOfHeapsReused() == 1);
+
+	allocator.DeallocateChunk(small);
+	allocator.DeallocateChunk(medium);
+}
+
+TEST_CASE(SmallRequestsShareBlocks)
+{
+	PoolingHeapSettings settings = SmallHeapSettings();
+	settings.subAllocationThreshold = 4096;
+	settings.subAllocationBlockSize = 65536;
+	settings.subAllocationAlignment = 256;
+	PoolingHeapAllocatorGPU allocator;
+	allocator.Initialize(&device, settings);
+
+	HeapChunk chunks[3];
+	chunks[0] = allocator.AllocateChunk(100, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	chunks[1] = allocator.AllocateChunk(1000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	chunks[2] = allocator.AllocateChunk(4096, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+
+	for (size_t i = 0; i < 3; ++i)
+	{
+		CHECK(chunks[i].heap == chunks[0].heap);
+		CHECK(chunks[i].startOffset % 256 == 0);
+		CHECK(chunks[i].endOffset <= 65536);
+
+		for (size_t j = 0; j < i; ++j)
+		{
+			CHECK(chunks[i].startOffset >= chunks[j].endOffset ||
+				chunks[j].startOffset >= chunks[i].endOffset);
+		}
+	}
+
+	CHECK(ChunkSize(chunks[1]) == 1000);
+	CHECK(allocator.GetNrOfHeapsCreated() == 1);
+
+	// Above the threshold the request gets a heap of its own
+	HeapChunk whole = allocator.AllocateChunk(4097, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(whole.heap != chunks[0].heap);
+	CHECK(whole.startOffset == 0);
+	CHECK(allocator.GetNrOfHeapsCreated() == 2);
+
+	// A freed range is handed out again from the same block
+	size_t freedOffset = chunks[1].startOffset;
+	allocator.DeallocateChunk(chunks[1]);
+	chunks[1] = allocator.AllocateChunk(1000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(chunks[1].heap == chunks[0].heap);
+	CHECK(chunks[1].startOffset == freedOffset);
+	CHECK(allocator.GetNrOfHeapsCreated() == 2);
+
+	for (HeapChunk& chunk : chunks)
+		allocator.DeallocateChunk(chunk);
+	allocator.DeallocateChunk(whole);
+}
+
+TEST_CASE(RequestsLargerThanTheBlockGetTheirOwnBlock)
+{
+	PoolingHeapSettings settings = SmallHeapSettings();
+	settings.subAllocationThreshold = 4096;
+	settings.subAllocationBlockSize = 2048;
+	settings.subAllocationAlignment = 256;
+	PoolingHeapAllocatorGPU allocator;
+	allocator.Initialize(&device, settings);
+
+	// The block grows to the size class of the request instead of failing
+	HeapChunk oversized = allocator.AllocateChunk(3000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(oversized.heap->GetDesc().SizeInBytes == 3072);
+	CHECK(ChunkSize(oversized) == 3000);
+
+	// What is left of it is too small, so a new block of the normal size is made
+	HeapChunk next = allocator.AllocateChunk(1500, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(next.heap != oversized.heap);
+	CHECK(next.heap->GetDesc().SizeInBytes == 2048);
+	CHECK(allocator.GetNrOfHeapsCreated() == 2);
+
+	allocator.DeallocateChunk(oversized);
+	allocator.DeallocateChunk(next);
+}
+
+TEST_CASE(IdleHeapsAreReleasedAfterEnoughFrames)
+{
+	PoolingHeapSettings settings = SmallHeapSettings();
+	settings.subAllocationThreshold = 4096;
+	settings.subAllocationBlockSize = 65536;
+	settings.framesBeforeTrim = 2;
+	size_t liveBefore = ID3D12Heap::nrOfLiveHeaps;
+	PoolingHeapAllocatorGPU allocator;
+	allocator.Initialize(&device, settings);
+
+	HeapChunk whole = allocator.AllocateChunk(5000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	HeapChunk shared = allocator.AllocateChunk(100, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	HeapChunk kept = allocator.AllocateChunk(100, D3D12_HEAP_TYPE_UPLOAD,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(ID3D12Heap::nrOfLiveHeaps == liveBefore + 3);
+
+	allocator.DeallocateChunk(whole);
+	allocator.DeallocateChunk(shared);
+	allocator.AdvanceFrame();
+	CHECK(ID3D12Heap::nrOfLiveHeaps == liveBefore + 3);
+
+	// The idle heap and the empty block go, the block still in use stays
+	allocator.AdvanceFrame();
+	CHECK(ID3D12Heap::nrOfLiveHeaps == liveBefore + 1);
+	CHECK(allocator.GetStatistics().nrOfHeapChunks == 1);
+
+	// Released heaps are not handed out again
+	whole = allocator.AllocateChunk(5000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	CHECK(allocator.GetNrOfHeapsReused() == 0);
+	CHECK(allocator.GetNrOfHeapsCreated() == 4);
+
+	allocator.DeallocateChunk(whole);
+	allocator.DeallocateChunk(kept);
+}
+
+TEST_CASE(TrimAndDestructionReleaseHeaps)
+{
+	size_t liveBefore = ID3D12Heap::nrOfLiveHeaps;
+
+	{
+		PoolingHeapAllocatorGPU allocator;
+		allocator.Initialize(&device, SmallHeapSettings());
+
+		HeapChunk idle = allocator.AllocateChunk(5000, D3D12_HEAP_TYPE_DEFAULT,
+			D3D12_HEAP_FLAG_NONE);
+		HeapChunk inUse = allocator.AllocateChunk(40000, D3D12_HEAP_TYPE_DEFAULT,
+			D3D12_HEAP_FLAG_NONE);
+		allocator.DeallocateChunk(idle);
+
+		// Kept forever by the settings, until trimmed by hand
+		for (size_t i = 0; i < 10; ++i)
+			allocator.AdvanceFrame();
+		CHECK(ID3D12Heap::nrOfLiveHeaps == liveBefore + 2);
+
+		allocator.TrimIdleHeaps(0);
+		CHECK(ID3D12Heap::nrOfLiveHeaps == liveBefore + 1);
+
+		// The heap still in use is released with the allocator
+		CHECK(inUse.heap != nullptr);
+	}
+
+	CHECK(ID3D12Heap::nrOfLiveHeaps == liveBefore);
+}
+
+TEST_CASE(StatisticsCoverWholeAndSharedHeaps)
+{
+	PoolingHeapSettings settings = SmallHeapSettings();
+	settings.subAllocationThreshold = 4096;
+	settings.subAllocationBlockSize = 65536;
+	settings.subAllocationAlignment = 256;
+	PoolingHeapAllocatorGPU allocator;
+	allocator.Initialize(&device, settings);
+
+	HeapChunk inUse = allocator.AllocateChunk(5000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	HeapChunk idle = allocator.AllocateChunk(40000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	HeapChunk shared = allocator.AllocateChunk(1000, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	allocator.DeallocateChunk(idle);
+
+	AllocatorStatistics statistics = allocator.GetStatistics();
+	CHECK(statistics.bytesReserved == 5120 + 40960 + 65536);
+	CHECK(statistics.bytesUsed == 5120 + 1000);
+	CHECK(statistics.nrOfHeapChunks == 3);
+	CHECK(statistics.nrOfAllocations == 2);
+	CHECK(statistics.largestFreeBlock >= 40960);
+	CHECK(statistics.totalAllocations == 3);
+	CHECK(statistics.totalDeallocations == 1);
+
+	allocator.DeallocateChunk(inUse);
+	allocator.DeallocateChunk(shared);
+}
+
+TEST_CASE(ForeignChunksAndInvalidSettingsThrow)
+{
+	PoolingHeapSettings settings = SmallHeapSettings();
+	settings.subAllocationThreshold = 4096;
+	PoolingHeapAllocatorGPU allocator;
+	allocator.Initialize(&device, settings);
+
+	HeapChunk foreign;
+	ID3D12Heap foreignHeap;
+	foreign.heap = &foreignHeap;
+	foreign.startOffset = 0;
+	foreign.endOffset = 100;
+	CHECK_THROWS(allocator.DeallocateChunk(foreign));
+
+	// A shared block only knows the offsets it handed out
+	HeapChunk shared = allocator.AllocateChunk(100, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_NONE);
+	HeapChunk wrongOffset = shared;
+	wrongOffset.startOffset += 8;
+	CHECK_THROWS(allocator.DeallocateChunk(wrongOffset));
+	allocator.DeallocateChunk(shared);
+
+	settings.sizeClassesPerDoubling = 0;
+	PoolingHeapAllocatorGPU invalid;
+	CHECK_THROWS(invalid.Initialize(&device, settings));
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <set>
+#include <chrono>
+#include <stdexcept>
+
+#include "WorkStealingThreadPool.h"
+
+#include "TestFramework.h"
+
+// Runs ParallelFor and checks that every index was called exactly once
+bool CoversEveryIndexOnce(WorkStealingThreadPool& pool, size_t nrOfTasks)
+{
+	std::vector<std::atomic<size_t>> calls(nrOfTasks);
+	pool.ParallelFor(nrOfTasks, [&](size_t index)
+		{
+			++calls[index];
+		});
+
+	for (const std::atomic<size_t>& count : calls)
+	{
+		if (count.load() != 1)
+			return false;
+	}
+
+	return true;
+}
+
+TEST_CASE(ParallelForHitsEveryIndexOnce)
+{
+	WorkStealingThreadPool pool;
+	pool.Initialize(3);
+	CHECK(pool.NrOfThreads() == 4);
+
+	// Fewer, equal and more tasks than queues, repeated to vary the stealing
+	for (size_t round = 0; round < 200; ++round)
+	{
+		for (size_t nrOfTasks : { size_t(0), size_t(1), size_t(3), size_t(4),
+			size_t(17), size_t(1000) })
+		{
+			CHECK(CoversEveryIndexOnce(pool, nrOfTasks));
+		}
+	}
+}
+
+TEST_CASE(ParallelForRunsOnWorkers)
+{
+	WorkStealingThreadPool pool;
+	pool.Initialize(2);
+	std::mutex threadMutex;
+	std::set<std::thread::id> threads;
+
+	// Slow enough tasks that the workers wake up before they are all taken
+	pool.ParallelFor(64, [&](size_t)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			std::lock_guard<std::mutex> lock(threadMutex);
+			threads.insert(std::this_thread::get_id());
+		});
+
+	CHECK(threads.size() > 1);
+	CHECK(threads.size() <= pool.NrOfThreads());
+}
+
+TEST_CASE(ParallelForPropagatesExceptions)
+{
+	WorkStealingThreadPool pool;
+	pool.Initialize(3);
+	std::atomic<size_t> nrOfCalls = 0;
+
+	CHECK_THROWS(pool.ParallelFor(100, [&](size_t index)
+		{
+			++nrOfCalls;
+			if (index % 10 == 3)
+				throw std::runtime_error("Error: Task failed");
+		}));
+
+	// The tasks that did not throw still ran before the exception was rethrown
+	CHECK(nrOfCalls.load() == 100);
+
+	// The pool can still be used after a task has thrown
+	CHECK(CoversEveryIndexOnce(pool, 100));
+}
+
+TEST_CASE(InitializeWithoutWorkersRunsInOrderOnCaller)
+{
+	WorkStealingThreadPool pool;
+	pool.Initialize(0);
+	CHECK(pool.NrOfThreads() == 1);
+
+	std::thread::id caller = std::this_thread::get_id();
+	std::vector<size_t> order;
+	bool onCaller = true;
+
+	pool.ParallelFor(50, [&](size_t index)
+		{
+			order.push_back(index);
+			onCaller &= std::this_thread::get_id() == caller;
+		});
+
+	CHECK(onCaller);
+	CHECK(order.size() == 50);
+	for (size_t i = 0; i < order.size(); ++i)
+		CHECK(order[i] == i);
+
+	CHECK_THROWS(pool.ParallelFor(5, [](size_t index)
+		{
+			if (index == 2)
+				throw std::runtime_error("Error: Task failed");
+		}));
+}
+
+TEST_CASE(ReinitializeAndShutdown)
+{
+	WorkStealingThreadPool pool;
+	pool.Initialize(4);
+	CHECK(CoversEveryIndexOnce(pool, 500));
+
+	pool.Initialize(1);
+	CHECK(pool.NrOfThreads() == 2);
+	CHECK(CoversEveryIndexOnce(pool, 500));
+
+	// A shut down pool still runs everything on the calling thread
+	pool.Shutdown();
+	CHECK(pool.NrOfThreads() == 1);
+	CHECK(CoversEveryIndexOnce(pool, 500));
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include <vector>
+#include <random>
+#include <thread>
+#include <stdexcept>
+
+#include "JobBatches.h"
+
+#include "TestFramework.h"
+
+// Stands in for a command list, recording only which jobs were recorded on it
+struct MockCommandList
+{
+	std::vector<size_t> recordedJobs;
+	std::thread::id recordingThread;
+	size_t nrOfRecordings = 0;
+};
+
+std::vector<size_t> CreateCosts(std::mt19937_64& generator, size_t nrOfJobs)
+{
+	std::vector<size_t> costs(nrOfJobs);
+
+	// Some free jobs and some far more expensive than the rest
+	for (size_t& cost : costs)
+	{
+		size_t kind = generator() % 8;
+		cost = kind == 0 ? 0 : (kind == 1 ? 1000 + generator() % 1000 : generator() % 50);
+	}
+
+	return costs;
+}
+
+bool BatchesCoverJobsInOrder(const std::vector<JobBatch>& batches, size_t nrOfJobs)
+{
+	size_t nextJobIndex = 0;
+
+	for (const JobBatch& batch : batches)
+	{
+		if (batch.nrOfJobs == 0 || batch.startJobIndex != nextJobIndex)
+			return false;
+
+		nextJobIndex += batch.nrOfJobs;
+	}
+
+	return nextJobIndex == nrOfJobs;
+}
+
+// Records every batch and checks that the lists read in order give the jobs
+// in order, with each used list recorded exactly once
+void CheckRecording(const std::vector<JobBatch>& batches, size_t nrOfJobs,
+	size_t nrOfLists, WorkStealingThreadPool* threadPool)
+{
+	std::vector<MockCommandList> mockLists(nrOfLists);
+	std::vector<MockCommandList*> lists;
+	for (MockCommandList& list : mockLists)
+		lists.push_back(&list);
+
+	RecordJobBatches(batches, lists, threadPool,
+		[](const JobBatch& batch, size_t, MockCommandList* list)
+		{
+			++list->nrOfRecordings;
+			for (size_t i = 0; i < batch.nrOfJobs; ++i)
+				list->recordedJobs.push_back(batch.startJobIndex + i);
+		});
+
+	std::vector<size_t> submittedJobs;
+	for (size_t i = 0; i < nrOfLists; ++i)
+	{
+		CHECK(mockLists[i].nrOfRecordings == (i < batches.size() ? 1 : 0));
+		submittedJobs.insert(submittedJobs.end(), mockLists[i].recordedJobs.begin(),
+			mockLists[i].recordedJobs.end());
+	}
+
+	CHECK(submittedJobs.size() == nrOfJobs);
+	for (size_t i = 0; i < submittedJobs.size(); ++i)
+		CHECK(submittedJobs[i] == i);
+}
+
+TEST_CASE(CreateJobBatchesSplitsByCost)
+{
+	std::vector<size_t> costs = { 10, 10, 10, 10, 10, 10, 10, 10 };
+	std::vector<JobBatch> batches;
+	CreateJobBatches(costs.size(), 4, [&](size_t i) { return costs[i]; }, batches);
+
+	CHECK(batches.size() == 4);
+	for (size_t i = 0; i < batches.size(); ++i)
+	{
+		CHECK(batches[i].startJobIndex == i * 2);
+		CHECK(batches[i].nrOfJobs == 2);
+	}
+
+	// An expensive job ends its batch early
+	costs = { 100, 1, 1, 1, 1, 1, 1, 1 };
+	CreateJobBatches(costs.size(), 2, [&](size_t i) { return costs[i]; }, batches);
+	CHECK(batches.size() == 2);
+	CHECK(batches[0].nrOfJobs == 1);
+	CHECK(batches[1].startJobIndex == 1);
+	CHECK(batches[1].nrOfJobs == 7);
+}
+
+TEST_CASE(CreateJobBatchesEdgeCases)
+{
+	std::vector<JobBatch> batches = { { 3, 3 } };
+	CreateJobBatches(0, 4, [](size_t) { return size_t(1); }, batches);
+	CHECK(batches.empty());
+
+	// No partitions is treated as one
+	CreateJobBatches(5, 0, [](size_t) { return size_t(1); }, batches);
+	CHECK(batches.size() == 1);
+	CHECK(BatchesCoverJobsInOrder(batches, 5));
+
+	// Fewer jobs than partitions, and jobs that cost nothing
+	CreateJobBatches(3, 8, [](size_t) { return size_t(1); }, batches);
+	CHECK(batches.size() <= 3);
+	CHECK(BatchesCoverJobsInOrder(batches, 3));
+
+	CreateJobBatches(10, 4, [](size_t) { return size_t(0); }, batches);
+	CHECK(batches.size() <= 4);
+	CHECK(BatchesCoverJobsInOrder(batches, 10));
+}
+
+TEST_CASE(CreateJobBatchesNeverExceedsPartitions)
+{
+	std::mt19937_64 generator(25);
+	std::vector<JobBatch> batches;
+
+	for (size_t round = 0; round < 5000; ++round)
+	{
+		size_t nrOfJobs = generator() % 200;
+		size_t nrOfPartitions = 1 + generator() % 32;
+		std::vector<size_t> costs = CreateCosts(generator, nrOfJobs);
+		CreateJobBatches(nrOfJobs, nrOfPartitions, [&](size_t i) { return costs[i]; },
+			batches);
+
+		CHECK(batches.size() <= nrOfPartitions);
+		CHECK(BatchesCoverJobsInOrder(batches, nrOfJobs));
+	}
+}
+
+TEST_CASE(RecordJobBatchesKeepsJobOrder)
+{
+	std::mt19937_64 generator(250);
+	WorkStealingThreadPool pool;
+	pool.Initialize(3);
+	std::vector<JobBatch> batches;
+
+	for (size_t round = 0; round < 500; ++round)
+	{
+		size_t nrOfJobs = generator() % 300;
+		size_t nrOfLists = 1 + generator() % 16;
+		std::vector<size_t> costs = CreateCosts(generator, nrOfJobs);
+
+		// As in ExecuteJobs, one partition per command list
+		CreateJobBatches(nrOfJobs, nrOfLists, [&](size_t i) { return costs[i]; },
+			batches);
+		CHECK(batches.size() <= nrOfLists);
+
+		CheckRecording(batches, nrOfJobs, nrOfLists, &pool);
+		CheckRecording(batches, nrOfJobs, nrOfLists, nullptr);
+	}
+}
+
+TEST_CASE(RecordJobBatchesWithoutPoolUsesCaller)
+{
+	std::vector<JobBatch> batches;
+	CreateJobBatches(40, 4, [](size_t) { return size_t(1); }, batches);
+
+	MockCommandList mockLists[4];
+	std::vector<MockCommandList*> lists = { &mockLists[0], &mockLists[1],
+		&mockLists[2], &mockLists[3] };
+	std::vector<size_t> recordedBatches;
+
+	RecordJobBatches(batches, lists, nullptr,
+		[&](const JobBatch&, size_t batchIndex, MockCommandList* list)
+		{
+			CHECK(list == lists[batchIndex]);
+			list->recordingThread = std::this_thread::get_id();
+			recordedBatches.push_back(batchIndex);
+		});
+
+	CHECK(recordedBatches == std::vector<size_t>({ 0, 1, 2, 3 }));
+	for (const MockCommandList& list : mockLists)
+		CHECK(list.recordingThread == std::this_thread::get_id());
+}
+
+TEST_CASE(RecordJobBatchesNeedsAListPerBatch)
+{
+	std::vector<JobBatch> batches;
+	CreateJobBatches(8, 4, [](size_t) { return size_t(1); }, batches);
+
+	MockCommandList mockLists[3];
+	std::vector<MockCommandList*> lists = { &mockLists[0], &mockLists[1],
+		&mockLists[2] };
+	bool recorded = false;
+
+	CHECK_THROWS(RecordJobBatches(batches, lists, nullptr,
+		[&](const JobBatch&, size_t, MockCommandList*) { recorded = true; }));
+	CHECK(!recorded);
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
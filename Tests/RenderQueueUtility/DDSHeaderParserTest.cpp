@@ -0,0 +1,248 @@
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include "DDSHeaderParser.h"
+
+#include "TestFramework.h"
+
+// Builds DDS headers in memory, the offsets follow the DDS_HEADER layout with
+// the magic in front of it
+class DDSBuilder
+{
+private:
+	std::vector<unsigned char> data = std::vector<unsigned char>(128, 0);
+
+	void Write(size_t offset, std::uint32_t value)
+	{
+		if (data.size() < offset + sizeof(value))
+			data.resize(offset + sizeof(value), 0);
+
+		std::memcpy(data.data() + offset, &value, sizeof(value));
+	}
+
+public:
+	DDSBuilder(std::uint32_t width, std::uint32_t height, std::uint32_t mipLevels)
+	{
+		Write(0, 0x20534444); // "DDS "
+		Write(4, 124);
+		Write(12, height);
+		Write(16, width);
+		Write(28, mipLevels);
+		Write(76, 32);
+	}
+
+	DDSBuilder& RGBA8()
+	{
+		Write(80, 0x41); // RGB and alpha
+		Write(88, 32);
+		Write(92, 0xff);
+		Write(96, 0xff00);
+		Write(100, 0xff0000);
+		Write(104, 0xff000000);
+		return *this;
+	}
+
+	DDSBuilder& FourCC(const char* fourCC)
+	{
+		std::uint32_t value = 0;
+		std::memcpy(&value, fourCC, sizeof(value));
+		Write(80, 0x4);
+		Write(84, value);
+		return *this;
+	}
+
+	DDSBuilder& DX10(DDSFormat format, std::uint32_t dimension,
+		std::uint32_t arraySize, std::uint32_t miscFlag = 0)
+	{
+		FourCC("DX10");
+		Write(128, static_cast<std::uint32_t>(format));
+		Write(132, dimension);
+		Write(136, miscFlag);
+		Write(140, arraySize);
+		Write(144, 0);
+		return *this;
+	}
+
+	DDSBuilder& Volume(std::uint32_t depth)
+	{
+		Write(8, 0x800000);
+		Write(24, depth);
+		return *this;
+	}
+
+	DDSBuilder& Caps2(std::uint32_t caps2)
+	{
+		Write(112, caps2);
+		return *this;
+	}
+
+	DDSBuilder& Set(size_t offset, std::uint32_t value)
+	{
+		Write(offset, value);
+		return *this;
+	}
+
+	const std::vector<unsigned char>& GetData() const
+	{
+		return data;
+	}
+};
+
+size_t Parse(const DDSBuilder& builder, DDSHeaderDesc& desc)
+{
+	return DDSHeaderParser::Parse(builder.GetData().data(),
+		builder.GetData().size(), desc);
+}
+
+TEST_CASE(ParsesLegacyTexture2D)
+{
+	DDSHeaderDesc desc;
+	size_t dataOffset = Parse(DDSBuilder(16, 8, 5).RGBA8(), desc);
+
+	CHECK(dataOffset == 128);
+	CHECK(desc.dimension == DDSDimension::TEXTURE2D);
+	CHECK(desc.format == DDSFormat::R8G8B8A8_UNORM);
+	CHECK(desc.width == 16);
+	CHECK(desc.height == 8);
+	CHECK(desc.depth == 1);
+	CHECK(desc.arraySize == 1);
+	CHECK(desc.mipLevels == 5);
+	CHECK(!desc.blockCompressed);
+	CHECK(desc.bytesPerElement == 4);
+
+	std::vector<DDSSubresource> layout;
+	size_t endOffset = DDSHeaderParser::CalculateSubresourceLayout(desc,
+		dataOffset, layout);
+
+	CHECK(layout.size() == 5);
+	CHECK(layout[0].offset == 128);
+	CHECK(layout[0].rowSize == 64);
+	CHECK(layout[0].nrOfRows == 8);
+	CHECK(layout[1].offset == 128 + 16 * 8 * 4);
+	CHECK(layout[4].width == 1);
+	CHECK(layout[4].height == 1);
+	CHECK(endOffset == 128 + (128 + 32 + 8 + 2 + 1) * 4);
+}
+
+TEST_CASE(ParsesLegacyFourCCFormats)
+{
+	DDSHeaderDesc desc;
+	Parse(DDSBuilder(8, 8, 1).FourCC("DXT1"), desc);
+	CHECK(desc.format == DDSFormat::BC1_UNORM);
+	CHECK(desc.bytesPerElement == 8);
+
+	Parse(DDSBuilder(8, 8, 1).FourCC("DXT5"), desc);
+	CHECK(desc.format == DDSFormat::BC3_UNORM);
+	CHECK(desc.bytesPerElement == 16);
+
+	Parse(DDSBuilder(8, 8, 1).FourCC("ATI2"), desc);
+	CHECK(desc.format == DDSFormat::BC5_UNORM);
+
+	Parse(DDSBuilder(8, 8, 1).Set(80, 0x4).Set(84, 113), desc);
+	CHECK(desc.format == DDSFormat::R16G16B16A16_FLOAT);
+}
+
+TEST_CASE(BlockCompressedLayoutRoundsUpToBlocks)
+{
+	DDSHeaderDesc desc;
+	size_t dataOffset = Parse(
+		DDSBuilder(13, 7, 3).DX10(DDSFormat::BC1_UNORM, 3, 2), desc);
+
+	CHECK(dataOffset == 148);
+	CHECK(desc.blockCompressed);
+	CHECK(desc.arraySize == 2);
+
+	std::vector<DDSSubresource> layout;
+	size_t endOffset = DDSHeaderParser::CalculateSubresourceLayout(desc,
+		dataOffset, layout);
+
+	// 13x7, 6x3 and 3x1 texels are 4x2, 2x1 and 1x1 blocks of 8 bytes
+	CHECK(layout.size() == 6);
+	CHECK(layout[0].rowSize == 32);
+	CHECK(layout[0].nrOfRows == 2);
+	CHECK(layout[1].rowSize == 16);
+	CHECK(layout[1].nrOfRows == 1);
+	CHECK(layout[2].rowSize == 8);
+	CHECK(layout[2].nrOfRows == 1);
+
+	// Every mip of the first slice comes before the second slice
+	size_t sliceSize = 64 + 16 + 8;
+	CHECK(layout[3].offset == dataOffset + sliceSize);
+	CHECK(layout[3].width == 13);
+	CHECK(endOffset == dataOffset + 2 * sliceSize);
+}
+
+TEST_CASE(ParsesCubeMapsAndVolumes)
+{
+	DDSHeaderDesc desc;
+	Parse(DDSBuilder(4, 4, 1).DX10(DDSFormat::R16G16B16A16_FLOAT, 3, 2, 0x4), desc);
+	CHECK(desc.cubeMap);
+	CHECK(desc.arraySize == 12);
+
+	Parse(DDSBuilder(4, 4, 1).RGBA8().Caps2(0x200 | 0xfc00), desc);
+	CHECK(desc.cubeMap);
+	CHECK(desc.arraySize == 6);
+
+	size_t dataOffset = Parse(DDSBuilder(8, 4, 2).RGBA8().Volume(4), desc);
+	CHECK(desc.dimension == DDSDimension::TEXTURE3D);
+	CHECK(desc.depth == 4);
+
+	std::vector<DDSSubresource> layout;
+	size_t endOffset = DDSHeaderParser::CalculateSubresourceLayout(desc,
+		dataOffset, layout);
+	CHECK(layout.size() == 2);
+	CHECK(layout[0].slicePitch == 8 * 4 * 4);
+	CHECK(layout[1].depth == 2);
+	CHECK(endOffset == dataOffset + 8 * 4 * 4 * 4 + 4 * 2 * 4 * 2);
+}
+
+TEST_CASE(RejectsInvalidHeaders)
+{
+	DDSHeaderDesc desc;
+	std::vector<unsigned char> tooSmall(64, 0);
+	CHECK_THROWS(DDSHeaderParser::Parse(tooSmall.data(), tooSmall.size(), desc));
+
+	CHECK_THROWS(Parse(DDSBuilder(8, 8, 1).RGBA8().Set(0, 0), desc));
+	CHECK_THROWS(Parse(DDSBuilder(8, 8, 1).RGBA8().Set(4, 100), desc));
+	CHECK_THROWS(Parse(DDSBuilder(8, 8, 5).RGBA8(), desc));
+	CHECK_THROWS(Parse(DDSBuilder(0, 8, 1).RGBA8(), desc));
+	CHECK_THROWS(Parse(DDSBuilder(32768, 8, 1).RGBA8(), desc));
+	CHECK_THROWS(Parse(DDSBuilder(8, 8, 1).FourCC("ABCD"), desc));
+	CHECK_THROWS(Parse(DDSBuilder(8, 8, 1).DX10(DDSFormat::R8G8B8A8_UNORM, 7, 1), desc));
+	CHECK_THROWS(Parse(DDSBuilder(8, 8, 1).DX10(DDSFormat::R8G8B8A8_UNORM, 4, 2), desc));
+	CHECK_THROWS(Parse(DDSBuilder(8, 8, 1).RGBA8().Caps2(0x200 | 0x400), desc));
+
+	// The DX10 header is announced but missing
+	DDSBuilder truncated = DDSBuilder(8, 8, 1).FourCC("DX10");
+	CHECK_THROWS(Parse(truncated, desc));
+}
+
+TEST_CASE(FormatInfo)
+{
+	bool blockCompressed = false;
+	size_t bytesPerElement = 0;
+
+	CHECK(DDSHeaderParser::GetFormatInfo(DDSFormat::BC7_UNORM_SRGB,
+		blockCompressed, bytesPerElement));
+	CHECK(blockCompressed);
+	CHECK(bytesPerElement == 16);
+
+	CHECK(DDSHeaderParser::GetFormatInfo(DDSFormat::R32G32B32_FLOAT,
+		blockCompressed, bytesPerElement));
+	CHECK(!blockCompressed);
+	CHECK(bytesPerElement == 12);
+
+	CHECK(DDSHeaderParser::GetFormatInfo(DDSFormat::A8_UNORM,
+		blockCompressed, bytesPerElement));
+	CHECK(bytesPerElement == 1);
+
+	CHECK(!DDSHeaderParser::GetFormatInfo(DDSFormat::UNKNOWN,
+		blockCompressed, bytesPerElement));
+	CHECK(bytesPerElement == 0);
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
@@ -0,0 +1,357 @@
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+
+#include "MipGenerator.h"
+
+#include "TestFramework.h"
+
+// The generated chains are compared with a plain per channel box filter, with
+// the sRGB conversions done through pow instead of tables
+
+double DecodeSRGB(double encoded)
+{
+	return encoded <= 0.04045 ? encoded / 12.92 : std::pow((encoded + 0.055) / 1.055, 2.4);
+}
+
+double EncodeSRGB(double linear)
+{
+	return linear <= 0.0031308 ? linear * 12.92 :
+		1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+}
+
+DecodedTexture CreateTopMip(size_t width, size_t height, DXGI_FORMAT format,
+	std::uint8_t texelSize, std::mt19937& generator)
+{
+	DecodedTexture toReturn;
+	toReturn.width = width;
+	toReturn.height = height;
+	toReturn.texelSizeInBytes = texelSize;
+	toReturn.format = format;
+	toReturn.subresources.resize(1);
+	toReturn.subresources[0].resize(toReturn.GetSubresourceSize(0));
+
+	if (format == DXGI_FORMAT_R8G8B8A8_UNORM || format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)
+	{
+		for (unsigned char& value : toReturn.subresources[0])
+			value = static_cast<unsigned char>(generator());
+	}
+	else
+	{
+		std::uniform_real_distribution<float> distribution(0.0f, 16.0f);
+		float* values = reinterpret_cast<float*>(toReturn.subresources[0].data());
+
+		for (size_t i = 0; i < toReturn.subresources[0].size() / sizeof(float); ++i)
+			values[i] = distribution(generator);
+	}
+
+	return toReturn;
+}
+
+// Reads channel values as doubles, linear for the colour of sRGB textures
+double ReadValue(const DecodedTexture& texture, size_t mip, size_t x, size_t y,
+	size_t channel, bool srgb)
+{
+	size_t channels = texture.format == DXGI_FORMAT_R8G8B8A8_UNORM ||
+		texture.format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ? 4 :
+		texture.texelSizeInBytes / sizeof(float);
+	size_t index = (y * texture.GetSubresourceWidth(mip) + x) * channels + channel;
+
+	if (channels == 4 && texture.texelSizeInBytes == 4)
+	{
+		double value = texture.subresources[mip][index] / 255.0;
+		return srgb && channel < 3 ? DecodeSRGB(value) : value;
+	}
+
+	float value = 0.0f;
+	std::memcpy(&value, texture.subresources[mip].data() + index * sizeof(float),
+		sizeof(float));
+	return value;
+}
+
+// Checks every mip against a box filter of the mip above it, with the
+// source texel clamped at odd edges
+bool MatchesReference(const DecodedTexture& texture, bool srgb)
+{
+	bool bytes = texture.texelSizeInBytes == 4 &&
+		texture.format != DXGI_FORMAT_R32_FLOAT;
+	size_t channels = bytes ? 4 : texture.texelSizeInBytes / sizeof(float);
+
+	if (texture.subresources.size() !=
+		MipGenerator::CalculateNrOfMips(texture.width, texture.height))
+	{
+		return false;
+	}
+
+	for (size_t mip = 1; mip < texture.subresources.size(); ++mip)
+	{
+		if (texture.subresources[mip].size() != texture.GetSubresourceSize(mip))
+			return false;
+
+		size_t sourceWidth = texture.GetSubresourceWidth(mip - 1);
+		size_t sourceHeight = texture.GetSubresourceHeight(mip - 1);
+
+		for (size_t y = 0; y < texture.GetSubresourceHeight(mip); ++y)
+		{
+			for (size_t x = 0; x < texture.GetSubresourceWidth(mip); ++x)
+			{
+				size_t left = std::min(2 * x, sourceWidth - 1);
+				size_t right = std::min(2 * x + 1, sourceWidth - 1);
+				size_t top = std::min(2 * y, sourceHeight - 1);
+				size_t bottom = std::min(2 * y + 1, sourceHeight - 1);
+
+				for (size_t channel = 0; channel < channels; ++channel)
+				{
+					double average = 0.25 *
+						(ReadValue(texture, mip - 1, left, top, channel, srgb) +
+						ReadValue(texture, mip - 1, right, top, channel, srgb) +
+						ReadValue(texture, mip - 1, left, bottom, channel, srgb) +
+						ReadValue(texture, mip - 1, right, bottom, channel, srgb));
+
+					if (!bytes)
+					{
+						double actual = ReadValue(texture, mip, x, y, channel, false);
+						if (std::abs(actual - average) > 1e-5 * std::max(average, 1.0))
+							return false;
+
+						continue;
+					}
+
+					// Rounded to the nearest code, pow and the midpoint table may
+					// disagree on values right at a midpoint
+					double expected = srgb && channel < 3 ? EncodeSRGB(average) : average;
+					double actual = texture.subresources[mip][
+						(y * texture.GetSubresourceWidth(mip) + x) * 4 + channel];
+					if (std::abs(actual - expected * 255.0) > 0.5 + 1e-3)
+						return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+struct FormatCase
+{
+	DXGI_FORMAT format;
+	std::uint8_t texelSize;
+	bool srgb;
+};
+
+const FormatCase FORMAT_CASES[] = {
+	{ DXGI_FORMAT_R8G8B8A8_UNORM, 4, false },
+	{ DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4, true },
+	{ DXGI_FORMAT_R32_FLOAT, 4, false },
+	{ DXGI_FORMAT_R32G32_FLOAT, 8, false },
+	{ DXGI_FORMAT_R32G32B32_FLOAT, 12, false },
+	{ DXGI_FORMAT_R32G32B32A32_FLOAT, 16, false } };
+
+TEST_CASE(OddSizesMatchReference)
+{
+	// Sizes below, at and past the four texels done at once with SIMD
+	const size_t sizes[][2] = { { 1, 1 }, { 2, 1 }, { 1, 7 }, { 3, 3 }, { 7, 5 },
+		{ 9, 2 }, { 17, 33 }, { 31, 16 }, { 67, 45 }, { 128, 3 } };
+	std::mt19937 generator(16);
+	MipGenerator mipGenerator;
+
+	for (const FormatCase& formatCase : FORMAT_CASES)
+	{
+		for (const auto& size : sizes)
+		{
+			DecodedTexture texture = CreateTopMip(size[0], size[1], formatCase.format,
+				formatCase.texelSize, generator);
+			mipGenerator.GenerateMipChain(texture);
+			CHECK(MatchesReference(texture, formatCase.srgb));
+		}
+	}
+}
+
+TEST_CASE(UnormColourCanBeFilteredAsSRGB)
+{
+	std::mt19937 generator(160);
+	MipGenerator mipGenerator;
+	MipGenerationSettings settings;
+	settings.colorDataIsSRGB = true;
+
+	DecodedTexture texture = CreateTopMip(45, 23, DXGI_FORMAT_R8G8B8A8_UNORM, 4,
+		generator);
+	mipGenerator.GenerateMipChain(texture, settings);
+
+	// Checked as sRGB, the format is left as it was
+	texture.format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	CHECK(MatchesReference(texture, true));
+}
+
+TEST_CASE(SRGBIsFilteredInLinearSpace)
+{
+	// One white and three black texels per 2x2 block, wide enough for the SIMD
+	// path and with a scalar tail
+	MipGenerator mipGenerator;
+	DecodedTexture texture;
+	texture.width = 22;
+	texture.height = 2;
+	texture.texelSizeInBytes = 4;
+	texture.format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	texture.subresources.resize(1);
+	texture.subresources[0].assign(texture.GetSubresourceSize(0), 0);
+
+	for (size_t x = 0; x < texture.width; x += 2)
+	{
+		for (size_t channel = 0; channel < 4; ++channel)
+			texture.subresources[0][x * 4 + channel] = 255;
+	}
+
+	mipGenerator.GenerateMipChain(texture);
+
+	// A quarter in linear space is code 137, a quarter of the codes would be 64
+	for (size_t x = 0; x < texture.GetSubresourceWidth(1); ++x)
+	{
+		for (size_t channel = 0; channel < 3; ++channel)
+			CHECK(texture.subresources[1][x * 4 + channel] == 137);
+
+		CHECK(texture.subresources[1][x * 4 + 3] == 64); // Alpha stays linear
+	}
+}
+
+TEST_CASE(EverySRGBCodeSurvivesFiltering)
+{
+	// A flat texture has to come back unchanged, so every code has to be
+	// encoded back to itself in both the SIMD and the scalar path
+	MipGenerator mipGenerator;
+	DecodedTexture texture;
+	texture.width = 256 * 2 + 6;
+	texture.height = 2;
+	texture.texelSizeInBytes = 4;
+	texture.format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	texture.subresources.resize(1);
+	texture.subresources[0].resize(texture.GetSubresourceSize(0));
+
+	for (size_t y = 0; y < texture.height; ++y)
+	{
+		for (size_t x = 0; x < texture.width; ++x)
+		{
+			unsigned char code = static_cast<unsigned char>(std::min<size_t>(x / 2, 255));
+			unsigned char* texel = &texture.subresources[0][(y * texture.width + x) * 4];
+			texel[0] = code;
+			texel[1] = static_cast<unsigned char>(255 - code);
+			texel[2] = code;
+			texel[3] = code;
+		}
+	}
+
+	mipGenerator.GenerateMipChain(texture);
+
+	for (size_t x = 0; x < texture.GetSubresourceWidth(1); ++x)
+	{
+		unsigned char code = static_cast<unsigned char>(std::min<size_t>(x, 255));
+		const unsigned char* texel = &texture.subresources[1][x * 4];
+		CHECK(texel[0] == code);
+		CHECK(texel[1] == 255 - code);
+		CHECK(texel[2] == code);
+		CHECK(texel[3] == code);
+	}
+}
+
+TEST_CASE(ThreadPoolGivesTheSameChain)
+{
+	std::mt19937 generator(1600);
+	MipGenerator mipGenerator;
+	WorkStealingThreadPool threadPool;
+	threadPool.Initialize(3);
+
+	MipGenerationSettings parallelSettings;
+	parallelSettings.threadPool = &threadPool;
+	parallelSettings.minimumBytesPerThread = 1; // Split even the small mips
+
+	for (const FormatCase& formatCase : FORMAT_CASES)
+	{
+		DecodedTexture serial = CreateTopMip(157, 83, formatCase.format,
+			formatCase.texelSize, generator);
+		DecodedTexture parallel = serial;
+
+		mipGenerator.GenerateMipChain(serial);
+		mipGenerator.GenerateMipChain(parallel, parallelSettings);
+		CHECK(parallel.subresources == serial.subresources);
+	}
+}
+
+TEST_CASE(InvalidTexturesThrow)
+{
+	std::mt19937 generator(16000);
+	MipGenerator mipGenerator;
+
+	DecodedTexture empty;
+	CHECK_THROWS(mipGenerator.GenerateMipChain(empty));
+
+	DecodedTexture truncated = CreateTopMip(8, 8, DXGI_FORMAT_R8G8B8A8_UNORM, 4,
+		generator);
+	truncated.subresources[0].pop_back();
+	CHECK_THROWS(mipGenerator.GenerateMipChain(truncated));
+
+	DecodedTexture unsupported = CreateTopMip(8, 8, DXGI_FORMAT_R8G8B8A8_UNORM, 4,
+		generator);
+	unsupported.format = DXGI_FORMAT_UNKNOWN;
+	CHECK_THROWS(mipGenerator.GenerateMipChain(unsupported));
+}
+
+TEST_CASE(CachedDecoderNeedsFormatAndHitsCache)
+{
+	std::filesystem::path directory =
+		std::filesystem::temp_directory_path() / "MipGeneratorTest";
+	std::filesystem::path sourcePath = directory / "source.png";
+	std::filesystem::create_directories(directory);
+	std::ofstream(sourcePath) << "source";
+
+	MipChainCache cache;
+	cache.Initialize((directory / "cache").string());
+	MipGenerator mipGenerator;
+	MipGenerationSettings settings;
+
+	std::atomic<size_t> nrOfDecodes = 0;
+	TextureDecoder decoder = [&](const std::string&, DecodedTexture& texture)
+	{
+		std::mt19937 generator(160000);
+		texture = CreateTopMip(40, 24, DXGI_FORMAT_R8G8B8A8_UNORM, 4, generator);
+		++nrOfDecodes;
+		return true;
+	};
+
+	// Without the format the cache could never be hit
+	CHECK_THROWS(CreateMipGeneratingDecoder(decoder, &mipGenerator, settings, &cache));
+	CHECK_THROWS(CreateMipGeneratingDecoder(decoder, &mipGenerator, settings, &cache,
+		DXGI_FORMAT_R8G8B8A8_UNORM));
+
+	TextureDecoder cached = CreateMipGeneratingDecoder(decoder, &mipGenerator, settings,
+		&cache, DXGI_FORMAT_R8G8B8A8_UNORM, 4);
+	DecodedTexture first;
+	DecodedTexture second;
+	CHECK(cached(sourcePath.string(), first));
+	CHECK(cached(sourcePath.string(), second));
+
+	CHECK(nrOfDecodes == 1);
+	CHECK(first.subresources.size() == MipGenerator::CalculateNrOfMips(40, 24));
+	CHECK(second.subresources == first.subresources);
+	CHECK(MatchesReference(second, false));
+
+	// No cache needs no format
+	TextureDecoder uncached = CreateMipGeneratingDecoder(decoder, &mipGenerator,
+		settings);
+	DecodedTexture third;
+	CHECK(uncached(sourcePath.string(), third));
+	CHECK(nrOfDecodes == 2);
+	CHECK(third.subresources == first.subresources);
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
@@ -0,0 +1,401 @@
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <stdexcept>
+
+#include "PackedTexture.h"
+#include "TextureCooker.h"
+
+#include "TestFramework.h"
+
+// The uploader lives in the prebuilt library, this one records what it is
+// given. The data must already be tightly packed.
+struct RecordedUpload
+{
+	std::vector<unsigned char> data;
+	TextureUploadInfo uploadInfo;
+	unsigned int subresourceIndex = 0;
+};
+
+std::vector<RecordedUpload> recordedUploads;
+
+bool ResourceUploader::UploadTextureResourceData(ID3D12Resource*,
+	ID3D12GraphicsCommandList*, void* data, const TextureUploadInfo& uploadInfo,
+	unsigned int subresourceIndex)
+{
+	RecordedUpload upload;
+	size_t size = uploadInfo.width * uploadInfo.height * uploadInfo.depth *
+		uploadInfo.texelSizeInBytes;
+	upload.data.assign(static_cast<unsigned char*>(data),
+		static_cast<unsigned char*>(data) + size);
+	upload.uploadInfo = uploadInfo;
+	upload.subresourceIndex = subresourceIndex;
+	recordedUploads.push_back(std::move(upload));
+
+	return true;
+}
+
+std::filesystem::path GetTestDirectory()
+{
+	std::filesystem::path directory =
+		std::filesystem::temp_directory_path() / "PackedTextureTest";
+	std::filesystem::create_directories(directory);
+	return directory;
+}
+
+std::vector<unsigned char> ReadFile(const std::filesystem::path& path)
+{
+	std::ifstream input(path, std::ios::binary);
+	return std::vector<unsigned char>(std::istreambuf_iterator<char>(input),
+		std::istreambuf_iterator<char>());
+}
+
+PackedTextureDesc CreateDesc(D3D12_RESOURCE_DIMENSION dimension, unsigned int width,
+	unsigned int height, unsigned int depth, unsigned int arraySize,
+	unsigned int mipLevels)
+{
+	PackedTextureDesc desc;
+	desc.dimension = dimension;
+	desc.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	desc.width = width;
+	desc.height = height;
+	desc.depth = depth;
+	desc.arraySize = arraySize;
+	desc.mipLevels = mipLevels;
+	desc.bytesPerElement = 4;
+
+	return desc;
+}
+
+// Tightly packed data with a different value in every byte of every subresource
+std::vector<std::vector<unsigned char>> CreateSubresourceData(
+	const PackedTextureDesc& desc)
+{
+	std::vector<DDSSubresource> tightLayout;
+	DDSFile::CalculateSubresourceLayout(desc, 0, tightLayout);
+	std::vector<std::vector<unsigned char>> toReturn;
+
+	for (size_t i = 0; i < tightLayout.size(); ++i)
+	{
+		const DDSSubresource& subresource = tightLayout[i];
+		toReturn.emplace_back(subresource.rowSize * subresource.nrOfRows *
+			subresource.depth);
+
+		for (size_t j = 0; j < toReturn.back().size(); ++j)
+			toReturn.back()[j] = static_cast<unsigned char>(j * 7 + i * 31 + 1);
+	}
+
+	return toReturn;
+}
+
+std::vector<const unsigned char*> GetPointers(
+	const std::vector<std::vector<unsigned char>>& subresourceData)
+{
+	std::vector<const unsigned char*> toReturn;
+	for (const std::vector<unsigned char>& data : subresourceData)
+		toReturn.push_back(data.data());
+
+	return toReturn;
+}
+
+bool RowsMatch(const PackedTextureFile& file,
+	const std::vector<std::vector<unsigned char>>& subresourceData)
+{
+	if (file.GetSubresources().size() != subresourceData.size())
+		return false;
+
+	for (size_t i = 0; i < subresourceData.size(); ++i)
+	{
+		const PackedSubresource& subresource = file.GetSubresources()[i];
+		size_t nrOfRows = subresource.nrOfRows * subresource.depth;
+
+		for (size_t row = 0; row < nrOfRows; ++row)
+		{
+			if (std::memcmp(file.GetSubresourceData(i) + row * subresource.rowPitch,
+				subresourceData[i].data() + row * subresource.rowSize,
+				subresource.rowSize) != 0)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+TEST_CASE(WriteThenOpenRoundTrips)
+{
+	std::filesystem::path path = GetTestDirectory() / "RoundTrip.nspt";
+	const PackedTextureDesc descs[] = {
+		CreateDesc(D3D12_RESOURCE_DIMENSION_TEXTURE2D, 13, 7, 1, 1, 4),
+		CreateDesc(D3D12_RESOURCE_DIMENSION_TEXTURE2D, 64, 64, 1, 3, 7),
+		CreateDesc(D3D12_RESOURCE_DIMENSION_TEXTURE1D, 100, 1, 1, 2, 2),
+		CreateDesc(D3D12_RESOURCE_DIMENSION_TEXTURE3D, 9, 5, 3, 1, 2) };
+
+	for (const PackedTextureDesc& desc : descs)
+	{
+		std::vector<std::vector<unsigned char>> subresourceData =
+			CreateSubresourceData(desc);
+
+		for (PackedRowLayout rowLayout :
+			{ PackedRowLayout::TIGHT, PackedRowLayout::UPLOAD_PITCHED })
+		{
+			PackedTextureFile::Write(path.string(), desc, GetPointers(subresourceData),
+				rowLayout);
+
+			PackedTextureFile file;
+			file.Open(path.string());
+			CHECK(file.GetRowLayout() == rowLayout);
+			CHECK(file.GetDesc().dimension == desc.dimension);
+			CHECK(file.GetDesc().format == desc.format);
+			CHECK(file.GetDesc().width == desc.width);
+			CHECK(file.GetDesc().height == desc.height);
+			CHECK(file.GetDesc().depth == desc.depth);
+			CHECK(file.GetDesc().arraySize == desc.arraySize);
+			CHECK(file.GetDesc().mipLevels == desc.mipLevels);
+			CHECK(file.GetDesc().bytesPerElement == 4);
+			CHECK(RowsMatch(file, subresourceData));
+
+			for (const PackedSubresource& subresource : file.GetSubresources())
+			{
+				if (rowLayout == PackedRowLayout::TIGHT)
+				{
+					CHECK(subresource.rowPitch == subresource.rowSize);
+					continue;
+				}
+
+				CHECK(subresource.rowPitch % D3D12_TEXTURE_DATA_PITCH_ALIGNMENT == 0);
+				CHECK(subresource.offset % D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT == 0);
+			}
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
+
+TEST_CASE(CopyToGivesTightMips)
+{
+	std::filesystem::path path = GetTestDirectory() / "CopyTo.nspt";
+	PackedTextureDesc desc = CreateDesc(D3D12_RESOURCE_DIMENSION_TEXTURE2D, 37, 11, 1,
+		1, 6);
+	std::vector<std::vector<unsigned char>> subresourceData = CreateSubresourceData(desc);
+	PackedTextureFile::Write(path.string(), desc, GetPointers(subresourceData),
+		PackedRowLayout::UPLOAD_PITCHED);
+
+	DecodedTexture decoded;
+	CHECK(DecodePackedTexture(path.string(), decoded));
+	CHECK(decoded.width == 37);
+	CHECK(decoded.height == 11);
+	CHECK(decoded.texelSizeInBytes == 4);
+	CHECK(decoded.subresources == subresourceData);
+
+	// Arrays cannot be streamed
+	desc.arraySize = 2;
+	subresourceData = CreateSubresourceData(desc);
+	PackedTextureFile::Write(path.string(), desc, GetPointers(subresourceData),
+		PackedRowLayout::TIGHT);
+	CHECK(!DecodePackedTexture(path.string(), decoded));
+	CHECK(!DecodePackedTexture((GetTestDirectory() / "Missing.nspt").string(),
+		decoded));
+
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
+
+TEST_CASE(UploadPacksRowsForEveryLayout)
+{
+	std::filesystem::path path = GetTestDirectory() / "Upload.nspt";
+	PackedTextureDesc desc = CreateDesc(D3D12_RESOURCE_DIMENSION_TEXTURE2D, 21, 6, 1,
+		2, 3);
+	std::vector<std::vector<unsigned char>> subresourceData = CreateSubresourceData(desc);
+	ResourceUploader uploader;
+
+	for (PackedRowLayout rowLayout :
+		{ PackedRowLayout::TIGHT, PackedRowLayout::UPLOAD_PITCHED })
+	{
+		PackedTextureFile::Write(path.string(), desc, GetPointers(subresourceData),
+			rowLayout);
+		PackedTextureFile file;
+		file.Open(path.string());
+
+		recordedUploads.clear();
+		CHECK(file.Upload(uploader, nullptr, nullptr));
+		CHECK(recordedUploads.size() == subresourceData.size());
+
+		for (size_t i = 0; i < recordedUploads.size(); ++i)
+		{
+			CHECK(recordedUploads[i].subresourceIndex == i);
+			CHECK(recordedUploads[i].uploadInfo.width ==
+				file.GetSubresources()[i].width);
+			CHECK(recordedUploads[i].uploadInfo.texelSizeInBytes == 4);
+			CHECK(recordedUploads[i].data == subresourceData[i]);
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
+
+TEST_CASE(BlockCompressedDataMustBeStaged)
+{
+	std::filesystem::path path = GetTestDirectory() / "Compressed.nspt";
+	PackedTextureDesc desc = CreateDesc(D3D12_RESOURCE_DIMENSION_TEXTURE2D, 16, 8, 1,
+		1, 2);
+	desc.format = DXGI_FORMAT_BC1_UNORM;
+	desc.blockCompressed = true;
+	desc.bytesPerElement = 8;
+	std::vector<std::vector<unsigned char>> subresourceData = CreateSubresourceData(desc);
+	PackedTextureFile::Write(path.string(), desc, GetPointers(subresourceData),
+		PackedRowLayout::UPLOAD_PITCHED);
+
+	PackedTextureFile file;
+	file.Open(path.string());
+	CHECK(file.GetDesc().blockCompressed);
+	CHECK(file.GetSubresources()[0].rowSize == 4 * 8); // Rows of 4x4 blocks
+	CHECK(file.GetSubresources()[0].nrOfRows == 2);
+	CHECK(RowsMatch(file, subresourceData));
+
+	ResourceUploader uploader;
+	DecodedTexture decoded;
+	CHECK_THROWS(file.Upload(uploader, nullptr, nullptr));
+	CHECK_THROWS(file.CopyTo(decoded));
+
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
+
+TEST_CASE(CorruptFilesAreRejected)
+{
+	std::filesystem::path path = GetTestDirectory() / "Corrupt.nspt";
+	PackedTextureDesc desc = CreateDesc(D3D12_RESOURCE_DIMENSION_TEXTURE2D, 16, 16, 1,
+		1, 5);
+	std::vector<std::vector<unsigned char>> subresourceData = CreateSubresourceData(desc);
+	PackedTextureFile::Write(path.string(), desc, GetPointers(subresourceData),
+		PackedRowLayout::UPLOAD_PITCHED);
+	const std::vector<unsigned char> original = ReadFile(path);
+
+	PackedTextureFile file;
+	file.Parse(original.data(), original.size());
+	size_t dataOffset = file.GetSubresources().front().offset;
+
+	// Every truncation is caught, whether in the header, table or data
+	for (size_t size = 0; size < original.size(); ++size)
+		CHECK_THROWS(file.Parse(original.data(), size));
+
+	// Header fields, in order: magic, version, format, dimension, width,
+	// height, depth, array size, mip levels, flags, subresources, row layout
+	const std::vector<std::pair<size_t, std::uint32_t>> corruptions = {
+		{ 0, 0x12345678 }, { 4, 2 }, { 8, 0 }, { 8, 1000 }, { 12, 1 }, { 12, 5 },
+		{ 16, 0 }, { 16, 32 }, { 20, 20000 }, { 24, 2 }, { 28, 0 }, { 32, 0 },
+		{ 32, 16 }, { 36, 0x1 }, { 40, 4 }, { 44, 2 } };
+
+	for (const auto& [offset, value] : corruptions)
+	{
+		std::vector<unsigned char> corrupt = original;
+		std::memcpy(corrupt.data() + offset, &value, sizeof(value));
+		CHECK_THROWS(file.Parse(corrupt.data(), corrupt.size()));
+	}
+
+	// Each field of the first table entry, which follows the 64 byte header
+	for (size_t offset = 64; offset < 64 + 32; offset += 4)
+	{
+		std::vector<unsigned char> corrupt = original;
+		corrupt[offset] ^= 0x40;
+		CHECK_THROWS(file.Parse(corrupt.data(), corrupt.size()));
+	}
+
+	// Texel data is not validated, and the last good parse is kept
+	std::vector<unsigned char> changedTexels = original;
+	changedTexels[dataOffset] ^= 0xFF;
+	file.Parse(changedTexels.data(), changedTexels.size());
+	CHECK(file.GetDesc().mipLevels == 5);
+	CHECK(file.GetSubresourceData(0) == changedTexels.data() + dataOffset);
+
+	std::ofstream(path, std::ios::binary | std::ios::trunc).write(
+		reinterpret_cast<const char*>(original.data()), original.size() / 2);
+	CHECK_THROWS(file.Open(path.string()));
+
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
+
+TEST_CASE(WriteNeedsEverySubresource)
+{
+	std::filesystem::path path = GetTestDirectory() / "Incomplete.nspt";
+	PackedTextureDesc desc = CreateDesc(D3D12_RESOURCE_DIMENSION_TEXTURE2D, 8, 8, 1,
+		1, 4);
+	std::vector<std::vector<unsigned char>> subresourceData = CreateSubresourceData(desc);
+	std::vector<const unsigned char*> pointers = GetPointers(subresourceData);
+	pointers.pop_back();
+
+	CHECK_THROWS(PackedTextureFile::Write(path.string(), desc, pointers,
+		PackedRowLayout::TIGHT));
+	CHECK(!std::filesystem::exists(path));
+}
+
+TEST_CASE(CookedImagesKeepTheirMipChain)
+{
+	// A binary PPM is the simplest format stb_image reads
+	std::filesystem::path directory = GetTestDirectory() / "Cooker";
+	std::filesystem::path sourcePath = directory / "Source" / "Image.ppm";
+	std::filesystem::create_directories(sourcePath.parent_path());
+	const unsigned int width = 19;
+	const unsigned int height = 10;
+
+	{
+		std::ofstream source(sourcePath, std::ios::binary);
+		source << "P6\n" << width << " " << height << "\n255\n";
+		for (unsigned int i = 0; i < width * height * 3; ++i)
+			source.put(static_cast<char>(i * 13));
+	}
+
+	DecodedTexture expected;
+	CHECK(DecodeTextureStandard(sourcePath.string(), expected));
+	MipGenerator().GenerateMipChain(expected);
+
+	TextureCooker cooker;
+	std::filesystem::path cookedPath = directory / "Image.nspt";
+	cooker.Cook(sourcePath.string(), cookedPath.string());
+
+	// The default layout is pitched and must still upload
+	PackedTextureFile file;
+	file.Open(cookedPath.string());
+	CHECK(file.GetRowLayout() == PackedRowLayout::UPLOAD_PITCHED);
+	CHECK(file.GetDesc().mipLevels == expected.subresources.size());
+	CHECK(RowsMatch(file, expected.subresources));
+
+	ResourceUploader uploader;
+	recordedUploads.clear();
+	CHECK(file.Upload(uploader, nullptr, nullptr));
+	CHECK(recordedUploads.size() == expected.subresources.size());
+	CHECK(recordedUploads.back().data == expected.subresources.back());
+
+	// Directories keep their relative paths and skip what is up to date
+	std::vector<std::string> errors;
+	TextureCookerSettings settings;
+	settings.rowLayout = PackedRowLayout::TIGHT;
+	settings.colorDataIsSRGB = true;
+	std::filesystem::path destination = directory / "Destination";
+	CHECK(cooker.CookDirectory((directory / "Source").string(), destination.string(),
+		settings, errors) == 1);
+	CHECK(errors.empty());
+	CHECK(cooker.CookDirectory((directory / "Source").string(), destination.string(),
+		settings, errors) == 0);
+
+	PackedTextureFile tightFile;
+	tightFile.Open((destination / "Image.nspt").string());
+	CHECK(tightFile.GetRowLayout() == PackedRowLayout::TIGHT);
+	CHECK(tightFile.GetDesc().format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
+	CHECK(tightFile.GetSubresources()[0].rowPitch == width * 4);
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
@@ -0,0 +1,494 @@
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+#include "TextureStreamer.h"
+
+#include "TestFramework.h"
+
+// The streamer only passes categories and identifiers through, so the tests
+// use plain integers for both. Negative categories fail in the sink.
+typedef TextureStreamer<int, size_t> Streamer;
+
+class StubUploadSink : public TextureUploadSink<int, size_t>
+{
+public:
+	struct Upload
+	{
+		size_t identifier = size_t(-1);
+		std::uint8_t subresourceIndex = 0;
+		size_t size = 0;
+	};
+
+	size_t nextIdentifier = 100;
+	std::vector<size_t> createdTextures;
+	std::vector<Upload> uploads;
+	std::vector<TextureResidency<size_t>> residencies;
+
+	bool CreateTexture(const int& category, const DecodedTexture& texture,
+		size_t& created) override
+	{
+		if (category < 0 || texture.subresources.empty())
+			return false;
+
+		created = nextIdentifier++;
+		createdTextures.push_back(created);
+		return true;
+	}
+
+	void UploadSubresource(const size_t& identifier, const DecodedTexture& texture,
+		std::uint8_t subresourceIndex) override
+	{
+		uploads.push_back({ identifier, subresourceIndex,
+			texture.subresources[subresourceIndex].size() });
+	}
+
+	void SetResidency(const TextureResidency<size_t>& residency) override
+	{
+		residencies.push_back(residency);
+	}
+};
+
+struct CallbackResult
+{
+	size_t requestIndex = size_t(-1);
+	bool success = false;
+	size_t identifier = size_t(-1);
+};
+
+struct CallbackLog
+{
+	std::vector<CallbackResult> results;
+
+	TextureStreamCallback<size_t> Create(size_t requestIndex)
+	{
+		return [this, requestIndex](bool success, const size_t& identifier)
+		{
+			results.push_back({ requestIndex, success, identifier });
+		};
+	}
+
+	size_t Count(bool success) const
+	{
+		size_t toReturn = 0;
+
+		for (const CallbackResult& result : results)
+			toReturn += result.success == success ? 1 : 0;
+
+		return toReturn;
+	}
+};
+
+TextureDecoder CreateSyntheticDecoder(size_t dimension, size_t nrOfMips)
+{
+	return [dimension, nrOfMips](const std::string&, DecodedTexture& toDecodeInto)
+	{
+		toDecodeInto.width = dimension;
+		toDecodeInto.height = dimension;
+		toDecodeInto.texelSizeInBytes = 4;
+		toDecodeInto.subresources.resize(nrOfMips);
+
+		for (size_t i = 0; i < nrOfMips; ++i)
+			toDecodeInto.subresources[i].resize(toDecodeInto.GetSubresourceSize(i));
+
+		return true;
+	};
+}
+
+// Holds the worker until released, so requests can be queued behind it
+struct DecodeGate
+{
+	std::atomic<bool> released = false;
+
+	TextureDecoder Create(size_t dimension)
+	{
+		TextureDecoder decoder = CreateSyntheticDecoder(dimension, 1);
+
+		return [this, decoder](const std::string& filePath, DecodedTexture& toDecodeInto)
+		{
+			while (!released)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+			return decoder(filePath, toDecodeInto);
+		};
+	}
+};
+
+bool UpdateUntilFinished(Streamer& streamer)
+{
+	for (size_t i = 0; i < 10000; ++i)
+	{
+		streamer.Update();
+
+		if (streamer.GetNrOfUnfinishedRequests() == 0)
+			return true;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return false;
+}
+
+TEST_CASE(InitializeNeedsSinkAndWorkers)
+{
+	StubUploadSink sink;
+	TextureStreamerSettings settings;
+	settings.nrOfDecodeWorkers = 0;
+
+	Streamer streamer;
+	CHECK_THROWS(streamer.Initialize(nullptr));
+	CHECK_THROWS(streamer.Initialize(&sink, settings));
+}
+
+TEST_CASE(RequestsAreDecodedInPriorityOrder)
+{
+	StubUploadSink sink;
+	TextureStreamerSettings settings;
+	settings.nrOfDecodeWorkers = 1;
+
+	std::mutex orderMutex;
+	std::vector<std::string> decodeOrder;
+	TextureDecoder synthetic = CreateSyntheticDecoder(16, 1);
+	TextureDecoder recording = [&](const std::string& filePath, DecodedTexture& texture)
+	{
+		{
+			std::lock_guard<std::mutex> lock(orderMutex);
+			decodeOrder.push_back(filePath);
+		}
+
+		return synthetic(filePath, texture);
+	};
+
+	DecodeGate gate;
+	CallbackLog log;
+	Streamer streamer;
+	streamer.Initialize(&sink, settings);
+	streamer.RequestTexture("gate", 0, gate.Create(16), log.Create(0));
+
+	// Let the worker pick up the gate before anything else is queued
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	streamer.RequestTexture("low", 0, recording, log.Create(1), -1);
+	streamer.RequestTexture("first high", 0, recording, log.Create(2), 5);
+	streamer.RequestTexture("middle", 0, recording, log.Create(3), 1);
+	streamer.RequestTexture("second high", 0, recording, log.Create(4), 5);
+	gate.released = true;
+
+	CHECK(UpdateUntilFinished(streamer));
+	CHECK((decodeOrder == std::vector<std::string>{ "first high", "second high",
+		"middle", "low" }));
+	CHECK(log.results.size() == 5);
+	CHECK(log.Count(true) == 5);
+	CHECK(sink.createdTextures.size() == 5);
+}
+
+TEST_CASE(FailuresAreReported)
+{
+	StubUploadSink sink;
+	CallbackLog log;
+	Streamer streamer;
+	streamer.Initialize(&sink);
+
+	TextureDecoder failing = [](const std::string&, DecodedTexture&) { return false; };
+	TextureDecoder throwing = [](const std::string&, DecodedTexture&) -> bool
+	{
+		throw std::runtime_error("Error: Decoder failure");
+	};
+	TextureDecoder malformed = [](const std::string& filePath, DecodedTexture& texture)
+	{
+		CreateSyntheticDecoder(16, 2)(filePath, texture);
+		texture.subresources[1].pop_back();
+		return true;
+	};
+
+	streamer.RequestTexture("good", 0, CreateSyntheticDecoder(16, 2), log.Create(0));
+	streamer.RequestTexture("failing", 0, failing, log.Create(1));
+	streamer.RequestTexture("throwing", 0, throwing, log.Create(2));
+	streamer.RequestTexture("malformed", 0, malformed, log.Create(3));
+	streamer.RequestTexture("no category", -1, CreateSyntheticDecoder(16, 1), log.Create(4));
+
+	CHECK(UpdateUntilFinished(streamer));
+	CHECK(log.results.size() == 5);
+
+	for (const CallbackResult& result : log.results)
+	{
+		CHECK(result.success == (result.requestIndex == 0));
+
+		if (result.success)
+			CHECK(result.identifier == sink.createdTextures.front());
+	}
+
+	CHECK(sink.createdTextures.size() == 1);
+	CHECK(sink.uploads.size() == 2);
+}
+
+TEST_CASE(UploadsKeepToFrameBudget)
+{
+	StubUploadSink sink;
+	TextureStreamerSettings settings;
+	settings.nrOfDecodeWorkers = 4;
+	settings.uploadBytesPerFrame = 64 * 64 * 4;
+
+	CallbackLog log;
+	Streamer streamer;
+	streamer.Initialize(&sink, settings);
+
+	size_t expectedBytes = 0;
+	for (size_t i = 0; i < 200; ++i)
+	{
+		size_t dimension = size_t(8) << (i % 4);
+		streamer.RequestTexture(std::to_string(i), 0,
+			CreateSyntheticDecoder(dimension, 3), log.Create(i), int(i % 7));
+
+		for (size_t mip = 0; mip < 3; ++mip)
+			expectedBytes += (dimension >> mip) * (dimension >> mip) * 4;
+	}
+
+	bool finished = false;
+	for (size_t i = 0; i < 10000 && !finished; ++i)
+	{
+		streamer.Update();
+		CHECK(streamer.GetBytesUploadedLastUpdate() <= settings.uploadBytesPerFrame);
+		finished = streamer.GetNrOfUnfinishedRequests() == 0;
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+
+	size_t uploadedBytes = 0;
+	for (const StubUploadSink::Upload& upload : sink.uploads)
+		uploadedBytes += upload.size;
+
+	CHECK(finished);
+	CHECK(log.Count(true) == 200);
+	CHECK(uploadedBytes == expectedBytes);
+}
+
+TEST_CASE(LargeSubresourceStillMakesProgress)
+{
+	StubUploadSink sink;
+	TextureStreamerSettings settings;
+	settings.uploadBytesPerFrame = 1;
+
+	CallbackLog log;
+	Streamer streamer;
+	streamer.Initialize(&sink, settings);
+	streamer.RequestTexture("large", 0, CreateSyntheticDecoder(256, 2), log.Create(0));
+
+	CHECK(UpdateUntilFinished(streamer));
+	CHECK(log.Count(true) == 1);
+	CHECK(sink.uploads.size() == 2);
+}
+
+TEST_CASE(ShutdownFailsQueuedRequests)
+{
+	StubUploadSink sink;
+	TextureStreamerSettings settings;
+	settings.nrOfDecodeWorkers = 1;
+
+	DecodeGate gate;
+	CallbackLog log;
+	Streamer streamer;
+	streamer.Initialize(&sink, settings);
+	streamer.RequestTexture("gate", 0, gate.Create(16), log.Create(0));
+
+	for (size_t i = 1; i < 6; ++i)
+	{
+		streamer.RequestTexture(std::to_string(i), 0, CreateSyntheticDecoder(16, 1),
+			log.Create(i));
+	}
+
+	std::thread releaser([&gate]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			gate.released = true;
+		});
+
+	streamer.Shutdown();
+	releaser.join();
+
+	CHECK(log.results.size() == 6);
+	CHECK(log.Count(false) == 6);
+	CHECK(streamer.GetNrOfUnfinishedRequests() == 0);
+
+	// Nothing is reported twice
+	streamer.Shutdown();
+	CHECK(log.results.size() == 6);
+}
+
+TEST_CASE(ShutdownFailsPartiallyUploadedRequests)
+{
+	StubUploadSink sink;
+	TextureStreamerSettings settings;
+	settings.uploadBytesPerFrame = 1;
+
+	CallbackLog log;
+	Streamer streamer;
+	streamer.Initialize(&sink, settings);
+	streamer.RequestTexture("partial", 0, CreateSyntheticDecoder(64, 3), log.Create(0));
+
+	for (size_t i = 0; i < 10000 && sink.createdTextures.empty(); ++i)
+	{
+		streamer.Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	CHECK(sink.createdTextures.size() == 1);
+	CHECK(sink.uploads.size() == 1);
+	CHECK(log.results.empty());
+
+	// The created texture is reported so that it can be removed again
+	streamer.Shutdown();
+	CHECK(log.results.size() == 1);
+	CHECK(!log.results.front().success);
+	CHECK(log.results.front().identifier == sink.createdTextures.front());
+}
+
+TEST_CASE(ProgressiveUploadsLeastDetailedMipFirst)
+{
+	StubUploadSink sink;
+	TextureStreamerSettings settings;
+	settings.uploadBytesPerFrame = 1; // A single subresource per update
+
+	CallbackLog log;
+	std::vector<TextureResidency<size_t>> reported;
+	size_t residentMipsWhenFinished = 0;
+	Streamer streamer;
+	streamer.Initialize(&sink, settings);
+	streamer.RequestTextureProgressive("progressive", 0, CreateSyntheticDecoder(64, 4),
+		[&](const TextureResidency<size_t>& residency)
+		{
+			// The sink has already been told when the callback runs
+			CHECK(sink.residencies.size() == reported.size() + 1);
+			reported.push_back(residency);
+		},
+		[&](bool success, const size_t& identifier)
+		{
+			residentMipsWhenFinished = reported.size();
+			log.Create(0)(success, identifier);
+		});
+
+	CHECK(UpdateUntilFinished(streamer));
+	CHECK(log.Count(true) == 1);
+	CHECK(residentMipsWhenFinished == 4);
+
+	CHECK(sink.uploads.size() == 4);
+	CHECK(reported.size() == 4);
+	for (size_t i = 0; i < reported.size(); ++i)
+	{
+		std::uint8_t expectedMip = static_cast<std::uint8_t>(3 - i);
+		CHECK(sink.uploads[i].subresourceIndex == expectedMip);
+		CHECK(reported[i].identifier == sink.createdTextures.front());
+		CHECK(reported[i].mostDetailedMip == expectedMip);
+		CHECK(reported[i].mipLevels == 4);
+		CHECK(reported[i].GetMinLODClamp() == static_cast<float>(expectedMip));
+		CHECK(sink.residencies[i].mostDetailedMip == expectedMip);
+	}
+}
+
+TEST_CASE(MipTailsComeBeforeDetailedMips)
+{
+	StubUploadSink sink;
+	TextureStreamerSettings settings;
+	settings.nrOfDecodeWorkers = 1;
+	settings.mipTailBytes = 1024; // Mips 2 and 3 of a 64x64 texture
+
+	std::atomic<size_t> nrOfDecoded = 0;
+	TextureDecoder synthetic = CreateSyntheticDecoder(64, 4);
+	TextureDecoder counting = [&](const std::string& filePath, DecodedTexture& texture)
+	{
+		bool toReturn = synthetic(filePath, texture);
+		++nrOfDecoded;
+		return toReturn;
+	};
+
+	CallbackLog log;
+	std::vector<TextureResidency<size_t>> reported;
+	auto residencyCallback = [&](const TextureResidency<size_t>& residency)
+	{
+		reported.push_back(residency);
+	};
+
+	Streamer streamer;
+	streamer.Initialize(&sink, settings);
+	streamer.RequestTextureProgressive("first", 0, counting, residencyCallback,
+		log.Create(0));
+	streamer.RequestTextureProgressive("second", 0, counting, residencyCallback,
+		log.Create(1));
+
+	// Both have to be decoded before the first update to see the ordering
+	while (nrOfDecoded < 2)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	streamer.Update();
+	CHECK(log.Count(true) == 2);
+	CHECK(sink.uploads.size() == 8);
+
+	// Both tails, then the detailed mips in request order
+	std::vector<std::uint8_t> expectedMips = { 3, 2, 3, 2, 1, 0, 1, 0 };
+	for (size_t i = 0; i < sink.uploads.size(); ++i)
+	{
+		CHECK(sink.uploads[i].subresourceIndex == expectedMips[i]);
+		CHECK(sink.uploads[i].identifier == sink.createdTextures[(i % 4) / 2]);
+	}
+
+	// Residency is reported once per update, with everything uploaded by then
+	CHECK(reported.size() == 2);
+	for (const TextureResidency<size_t>& residency : reported)
+	{
+		CHECK(residency.mostDetailedMip == 0);
+		CHECK(residency.GetMinLODClamp() == 0.0f);
+	}
+}
+
+TEST_CASE(ResidencyIsReportedOncePerUpdate)
+{
+	StubUploadSink sink;
+	TextureStreamerSettings settings;
+	settings.uploadBytesPerFrame = 16 * 16 * 4 + 8 * 8 * 4 + 4 * 4 * 4;
+
+	CallbackLog log;
+	std::vector<TextureResidency<size_t>> reported;
+	Streamer streamer;
+	streamer.Initialize(&sink, settings);
+	streamer.RequestTextureProgressive("progressive", 0, CreateSyntheticDecoder(32, 4),
+		[&](const TextureResidency<size_t>& residency)
+		{
+			reported.push_back(residency);
+		},
+		log.Create(0));
+
+	CHECK(UpdateUntilFinished(streamer));
+	CHECK(log.Count(true) == 1);
+
+	// The three smallest mips fit the first update, the largest the next
+	CHECK(reported.size() == 2);
+	CHECK(reported[0].mostDetailedMip == 1);
+	CHECK(reported[0].GetMinLODClamp() == 1.0f);
+	CHECK(reported[1].mostDetailedMip == 0);
+	CHECK(sink.residencies.size() == 2);
+
+	// Progressive requests need somewhere to report residency
+	CHECK_THROWS(streamer.RequestTextureProgressive("none", 0,
+		CreateSyntheticDecoder(32, 1), nullptr, log.Create(1)));
+}
+
+TEST_CASE(PlainRequestsReportNoResidency)
+{
+	StubUploadSink sink;
+	CallbackLog log;
+	Streamer streamer;
+	streamer.Initialize(&sink);
+	streamer.RequestTexture("plain", 0, CreateSyntheticDecoder(32, 4), log.Create(0));
+
+	CHECK(UpdateUntilFinished(streamer));
+	CHECK(log.Count(true) == 1);
+	CHECK(sink.residencies.empty());
+}
+
+int main()
+{
+	return RunTests();
+}
\ No newline at end of file
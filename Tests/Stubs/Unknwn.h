@@ -0,0 +1,15 @@
+#pragma once
+
+// Minimal stand-ins for the Windows SDK, just enough for the headless tests and
+// benchmarks to compile the Direct3D facing headers. Nothing here talks to a GPU.
+
+struct IUnknown
+{
+	virtual ~IUnknown() = default;
+
+	unsigned long Release()
+	{
+		delete this;
+		return 0;
+	}
+};
\ No newline at end of file
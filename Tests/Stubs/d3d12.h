@@ -0,0 +1,389 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+
+#include "Unknwn.h"
+#include "dxgi1_6.h"
+
+// Resources created through the stub device are plain system memory, and
+// command lists count the copies and barriers recorded on them. Buffer copies
+// between resources with memory are carried out when recorded.
+
+// Windows.h provides these as macros
+using std::max;
+using std::min;
+
+typedef unsigned int UINT;
+typedef std::uint16_t UINT16;
+typedef unsigned long long UINT64;
+typedef long HRESULT;
+typedef std::size_t SIZE_T;
+typedef UINT64 D3D12_GPU_VIRTUAL_ADDRESS;
+
+#define FAILED(hr) ((hr) < 0)
+#define SUCCEEDED(hr) ((hr) >= 0)
+#define IID_PPV_ARGS(pointer) reinterpret_cast<void**>(pointer)
+#define ZeroMemory(destination, length) std::memset((destination), 0, (length))
+
+#define D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT (65536)
+#define D3D12_TEXTURE_DATA_PITCH_ALIGNMENT (256)
+#define D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT (512)
+#define D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES (0xffffffff)
+
+enum D3D12_HEAP_TYPE
+{
+	D3D12_HEAP_TYPE_DEFAULT = 1,
+	D3D12_HEAP_TYPE_UPLOAD = 2,
+	D3D12_HEAP_TYPE_READBACK = 3
+};
+
+enum D3D12_HEAP_FLAGS
+{
+	D3D12_HEAP_FLAG_NONE = 0
+};
+
+enum D3D12_CPU_PAGE_PROPERTY
+{
+	D3D12_CPU_PAGE_PROPERTY_UNKNOWN = 0
+};
+
+enum D3D12_MEMORY_POOL
+{
+	D3D12_MEMORY_POOL_UNKNOWN = 0
+};
+
+enum D3D12_RESOURCE_DIMENSION
+{
+	D3D12_RESOURCE_DIMENSION_UNKNOWN = 0,
+	D3D12_RESOURCE_DIMENSION_BUFFER = 1,
+	D3D12_RESOURCE_DIMENSION_TEXTURE1D = 2,
+	D3D12_RESOURCE_DIMENSION_TEXTURE2D = 3,
+	D3D12_RESOURCE_DIMENSION_TEXTURE3D = 4
+};
+
+enum D3D12_TEXTURE_LAYOUT
+{
+	D3D12_TEXTURE_LAYOUT_UNKNOWN = 0,
+	D3D12_TEXTURE_LAYOUT_ROW_MAJOR = 1
+};
+
+enum D3D12_RESOURCE_FLAGS
+{
+	D3D12_RESOURCE_FLAG_NONE = 0
+};
+
+enum D3D12_RESOURCE_STATES
+{
+	D3D12_RESOURCE_STATE_COMMON = 0,
+	D3D12_RESOURCE_STATE_COPY_DEST = 0x400,
+	D3D12_RESOURCE_STATE_COPY_SOURCE = 0x800,
+	D3D12_RESOURCE_STATE_GENERIC_READ = 0xac3
+};
+
+enum D3D12_RESOURCE_BARRIER_TYPE
+{
+	D3D12_RESOURCE_BARRIER_TYPE_TRANSITION = 0,
+	D3D12_RESOURCE_BARRIER_TYPE_ALIASING = 1,
+	D3D12_RESOURCE_BARRIER_TYPE_UAV = 2
+};
+
+enum D3D12_RESOURCE_BARRIER_FLAGS
+{
+	D3D12_RESOURCE_BARRIER_FLAG_NONE = 0
+};
+
+enum D3D12_BUFFER_SRV_FLAGS
+{
+	D3D12_BUFFER_SRV_FLAG_NONE = 0,
+	D3D12_BUFFER_SRV_FLAG_RAW = 0x1
+};
+
+enum D3D12_BUFFER_UAV_FLAGS
+{
+	D3D12_BUFFER_UAV_FLAG_NONE = 0,
+	D3D12_BUFFER_UAV_FLAG_RAW = 0x1
+};
+
+enum D3D12_TEXTURE_COPY_TYPE
+{
+	D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX = 0,
+	D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT = 1
+};
+
+enum D3D12_DESCRIPTOR_HEAP_TYPE
+{
+	D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV = 0,
+	D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER = 1,
+	D3D12_DESCRIPTOR_HEAP_TYPE_RTV = 2,
+	D3D12_DESCRIPTOR_HEAP_TYPE_DSV = 3
+};
+
+struct D3D12_CPU_DESCRIPTOR_HANDLE
+{
+	SIZE_T ptr;
+};
+
+// Views are only stored by the stubbed users, never read
+struct D3D12_CONSTANT_BUFFER_VIEW_DESC
+{
+	UINT64 BufferLocation;
+	UINT SizeInBytes;
+};
+
+struct D3D12_SHADER_RESOURCE_VIEW_DESC
+{
+	DXGI_FORMAT Format;
+};
+
+struct D3D12_UNORDERED_ACCESS_VIEW_DESC
+{
+	DXGI_FORMAT Format;
+};
+
+struct D3D12_RENDER_TARGET_VIEW_DESC
+{
+	DXGI_FORMAT Format;
+};
+
+struct D3D12_DEPTH_STENCIL_VIEW_DESC
+{
+	DXGI_FORMAT Format;
+};
+
+struct D3D12_HEAP_PROPERTIES
+{
+	D3D12_HEAP_TYPE Type;
+	D3D12_CPU_PAGE_PROPERTY CPUPageProperty;
+	D3D12_MEMORY_POOL MemoryPoolPreference;
+	UINT CreationNodeMask;
+	UINT VisibleNodeMask;
+};
+
+struct D3D12_HEAP_DESC
+{
+	UINT64 SizeInBytes;
+	D3D12_HEAP_PROPERTIES Properties;
+	UINT64 Alignment;
+	D3D12_HEAP_FLAGS Flags;
+};
+
+struct D3D12_RESOURCE_DESC
+{
+	D3D12_RESOURCE_DIMENSION Dimension;
+	UINT64 Alignment;
+	UINT64 Width;
+	UINT Height;
+	UINT16 DepthOrArraySize;
+	UINT16 MipLevels;
+	DXGI_FORMAT Format;
+	DXGI_SAMPLE_DESC SampleDesc;
+	D3D12_TEXTURE_LAYOUT Layout;
+	D3D12_RESOURCE_FLAGS Flags;
+};
+
+struct D3D12_RESOURCE_ALLOCATION_INFO
+{
+	UINT64 SizeInBytes;
+	UINT64 Alignment;
+};
+
+struct D3D12_RANGE
+{
+	SIZE_T Begin;
+	SIZE_T End;
+};
+
+struct D3D12_CLEAR_VALUE
+{
+	DXGI_FORMAT Format;
+	float Color[4];
+};
+
+struct D3D12_BOX
+{
+	UINT left;
+	UINT top;
+	UINT front;
+	UINT right;
+	UINT bottom;
+	UINT back;
+};
+
+struct D3D12_SUBRESOURCE_FOOTPRINT
+{
+	DXGI_FORMAT Format;
+	UINT Width;
+	UINT Height;
+	UINT Depth;
+	UINT RowPitch;
+};
+
+struct D3D12_PLACED_SUBRESOURCE_FOOTPRINT
+{
+	UINT64 Offset;
+	D3D12_SUBRESOURCE_FOOTPRINT Footprint;
+};
+
+// Heaps own no memory, they only count how many are alive
+struct ID3D12Heap : IUnknown
+{
+	static inline std::atomic<size_t> nrOfLiveHeaps = 0;
+	D3D12_HEAP_DESC desc = {};
+
+	ID3D12Heap()
+	{
+		++nrOfLiveHeaps;
+	}
+
+	~ID3D12Heap()
+	{
+		--nrOfLiveHeaps;
+	}
+
+	D3D12_HEAP_DESC GetDesc()
+	{
+		return desc;
+	}
+};
+
+struct ID3D12DescriptorHeap : IUnknown
+{
+};
+
+struct ID3D12Resource : IUnknown
+{
+	D3D12_RESOURCE_DESC desc = {};
+	unsigned char* memory = nullptr;
+
+	~ID3D12Resource()
+	{
+		std::free(memory);
+	}
+
+	HRESULT Map(UINT, const D3D12_RANGE*, void** data)
+	{
+		*data = memory;
+		return 0;
+	}
+
+	void Unmap(UINT, const D3D12_RANGE*)
+	{
+	}
+
+	D3D12_RESOURCE_DESC GetDesc()
+	{
+		return desc;
+	}
+};
+
+struct D3D12_RESOURCE_TRANSITION_BARRIER
+{
+	ID3D12Resource* pResource;
+	UINT Subresource;
+	D3D12_RESOURCE_STATES StateBefore;
+	D3D12_RESOURCE_STATES StateAfter;
+};
+
+struct D3D12_RESOURCE_ALIASING_BARRIER
+{
+	ID3D12Resource* pResourceBefore;
+	ID3D12Resource* pResourceAfter;
+};
+
+struct D3D12_RESOURCE_UAV_BARRIER
+{
+	ID3D12Resource* pResource;
+};
+
+struct D3D12_RESOURCE_BARRIER
+{
+	D3D12_RESOURCE_BARRIER_TYPE Type;
+	D3D12_RESOURCE_BARRIER_FLAGS Flags;
+
+	union
+	{
+		D3D12_RESOURCE_TRANSITION_BARRIER Transition;
+		D3D12_RESOURCE_ALIASING_BARRIER Aliasing;
+		D3D12_RESOURCE_UAV_BARRIER UAV;
+	};
+};
+
+struct D3D12_TEXTURE_COPY_LOCATION
+{
+	ID3D12Resource* pResource;
+	D3D12_TEXTURE_COPY_TYPE Type;
+
+	union
+	{
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT PlacedFootprint;
+		UINT SubresourceIndex;
+	};
+};
+
+// Only buffers get memory, footprints are not needed by the stubbed users
+struct ID3D12Device : IUnknown
+{
+	HRESULT CreateCommittedResource(const D3D12_HEAP_PROPERTIES*, D3D12_HEAP_FLAGS,
+		const D3D12_RESOURCE_DESC* desc, D3D12_RESOURCE_STATES,
+		const D3D12_CLEAR_VALUE*, void** resource)
+	{
+		ID3D12Resource* created = new ID3D12Resource();
+		created->desc = *desc;
+
+		if (desc->Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+			created->memory = static_cast<unsigned char*>(std::calloc(desc->Width, 1));
+
+		*resource = created;
+		return 0;
+	}
+
+	HRESULT CreateHeap(const D3D12_HEAP_DESC* desc, void** heap)
+	{
+		ID3D12Heap* created = new ID3D12Heap();
+		created->desc = *desc;
+		*heap = created;
+		return 0;
+	}
+
+	void GetCopyableFootprints(const D3D12_RESOURCE_DESC*, UINT, UINT, UINT64,
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT*, UINT*, UINT64*, UINT64*)
+	{
+	}
+};
+
+struct ID3D12GraphicsCommandList : IUnknown
+{
+	std::atomic<size_t> bufferCopies = 0;
+	std::atomic<size_t> textureCopies = 0;
+	std::atomic<size_t> bytesCopied = 0;
+	std::atomic<size_t> barriers = 0;
+
+	void CopyBufferRegion(ID3D12Resource* destination, UINT64 destinationOffset,
+		ID3D12Resource* source, UINT64 sourceOffset, UINT64 nrOfBytes)
+	{
+		++bufferCopies;
+		bytesCopied += nrOfBytes;
+
+		if (destination->memory != nullptr && source->memory != nullptr)
+		{
+			std::memcpy(destination->memory + destinationOffset,
+				source->memory + sourceOffset, nrOfBytes);
+		}
+	}
+
+	void ResourceBarrier(UINT nrOfBarriers, const D3D12_RESOURCE_BARRIER*)
+	{
+		barriers += nrOfBarriers;
+	}
+
+	void CopyTextureRegion(const D3D12_TEXTURE_COPY_LOCATION*, UINT, UINT, UINT,
+		const D3D12_TEXTURE_COPY_LOCATION*, const D3D12_BOX*)
+	{
+		++textureCopies;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+#include "dxgi1_6.h"
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+enum DXGI_FORMAT
+{
+	DXGI_FORMAT_UNKNOWN = 0,
+	DXGI_FORMAT_R32G32B32A32_FLOAT = 2,
+	DXGI_FORMAT_R32G32B32_FLOAT = 6,
+	DXGI_FORMAT_R16G16B16A16_FLOAT = 10,
+	DXGI_FORMAT_R32G32_FLOAT = 16,
+	DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+	DXGI_FORMAT_R8G8B8A8_UNORM_SRGB = 29,
+	DXGI_FORMAT_R32_FLOAT = 41,
+	DXGI_FORMAT_R8_UNORM = 61,
+	DXGI_FORMAT_BC1_UNORM = 71,
+	DXGI_FORMAT_BC7_UNORM_SRGB = 99,
+	DXGI_FORMAT_B4G4R4A4_UNORM = 115
+};
+
+struct DXGI_SAMPLE_DESC
+{
+	unsigned int Count;
+	unsigned int Quality;
+};
\ No newline at end of file
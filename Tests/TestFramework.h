@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+#include <exception>
+
+// Minimal test registration, each test executable ends with
+// int main() { return RunTests(); }
+
+struct TestCase
+{
+	const char* name = nullptr;
+	void (*function)() = nullptr;
+};
+
+inline std::vector<TestCase>& GetTestCases()
+{
+	static std::vector<TestCase> testCases;
+	return testCases;
+}
+
+inline size_t& GetNrOfFailedChecks()
+{
+	static size_t nrOfFailedChecks = 0;
+	return nrOfFailedChecks;
+}
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* name, void (*function)())
+	{
+		GetTestCases().push_back({ name, function });
+	}
+};
+
+inline void ReportFailedCheck(const char* expression, const char* file, int line)
+{
+	std::printf("    %s(%d): check failed: %s\n", file, line, expression);
+	++GetNrOfFailedChecks();
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static TestRegistrar name##Registrar(#name, &name); \
+	static void name()
+
+#define CHECK(expression) \
+	do \
+	{ \
+		if (!(expression)) \
+			ReportFailedCheck(#expression, __FILE__, __LINE__); \
+	} while (false)
+
+#define CHECK_THROWS(expression) \
+	do \
+	{ \
+		bool threw = false; \
+		try { expression; } catch (...) { threw = true; } \
+		if (!threw) \
+			ReportFailedCheck("throws: " #expression, __FILE__, __LINE__); \
+	} while (false)
+
+inline int RunTests()
+{
+	size_t nrOfFailedTests = 0;
+
+	for (const TestCase& testCase : GetTestCases())
+	{
+		size_t failedBefore = GetNrOfFailedChecks();
+		std::printf("%s\n", testCase.name);
+
+		try
+		{
+			testCase.function();
+		}
+		catch (const std::exception& exception)
+		{
+			std::printf("    unexpected exception: %s\n", exception.what());
+			++GetNrOfFailedChecks();
+		}
+
+		if (GetNrOfFailedChecks() != failedBefore)
+			++nrOfFailedTests;
+	}
+
+	std::printf("%zu of %zu tests passed\n", GetTestCases().size() - nrOfFailedTests,
+		GetTestCases().size());
+
+	return nrOfFailedTests == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+// The implementation of stb_image for targets that decode images, kept in a
+// translation unit of its own as several headers include stb_image.h
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "TextureCooker.h"
+
+int main(int argc, char* argv[])
+{
+	return RunTextureCooker(argc, argv);
+}
\ No newline at end of file